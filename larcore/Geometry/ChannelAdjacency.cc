@@ -0,0 +1,319 @@
+/**
+ * @file   larcore/Geometry/ChannelAdjacency.cc
+ * @brief  Precomputed tables of the neighbouring, crossing and continuation channels.
+ * @see    larcore/Geometry/ChannelAdjacency.h
+ */
+
+// library header
+#include "larcore/Geometry/ChannelAdjacency.h"
+
+// LArSoft libraries
+#include "larcore/Geometry/GeometrySubset.h"
+#include "larcorealg/Geometry/PlaneGeo.h"
+#include "larcorealg/Geometry/WireGeo.h"
+#include "larcorealg/Geometry/WireReadoutGeom.h"
+#include "larcoreobj/SimpleTypesAndConstants/geo_types.h"
+#include "larcoreobj/SimpleTypesAndConstants/geo_vectors.h"
+
+// framework libraries
+#include "cetlib_except/exception.h"
+
+// C/C++ standard libraries
+#include <algorithm> // std::sort(), std::unique(), std::copy(), std::fill(), std::min()...
+#include <array>
+#include <cmath> // std::abs(), std::floor(), std::ceil()
+#include <cstdint>
+#include <unordered_map>
+
+namespace {
+
+  // wires crossing within this distance from an end still cross [cm]
+  constexpr double CrossingTolerance = 1e-4;
+
+  // a plane, with the channel of each of its wires
+  struct PlaneChannels {
+    geo::PlaneGeo const* plane;
+    std::vector<raw::ChannelID_t> channels;
+  };
+
+  // an end of a wire
+  struct WireEnd {
+    geo::Point_t position;
+    geo::TPCID tpc;
+    geo::View_t view;
+    raw::ChannelID_t channel;
+  };
+
+  // cell of a hash grid of wire ends
+  struct CellKey {
+    std::int64_t x, y, z;
+    bool operator==(CellKey const&) const = default;
+  };
+
+  struct CellKeyHash {
+    std::size_t operator()(CellKey const& key) const
+    {
+      return (static_cast<std::size_t>(key.x) * 73856093U) ^
+             (static_cast<std::size_t>(key.y) * 19349663U) ^
+             (static_cast<std::size_t>(key.z) * 83492791U);
+    }
+  };
+
+  // whether `wireA` crosses wire `wireNo` of `planeB`, both projected on the plane
+  bool wiresCross(geo::WireGeo const& wireA, geo::PlaneGeo const& planeB, unsigned int wireNo)
+  {
+    geo::Point_t const start = wireA.GetStart(), end = wireA.GetEnd();
+    double const startCoord = planeB.WireCoordinate(start);
+    double const deltaCoord = planeB.WireCoordinate(end) - startCoord;
+    if (deltaCoord == 0.0) return false; // parallel
+
+    // point of wire A on the line of wire B, which must be on both wires
+    double const t = (wireNo - startCoord) / deltaCoord;
+    double const toleranceA = CrossingTolerance / (2.0 * wireA.HalfL());
+    if ((t < -toleranceA) || (t > 1.0 + toleranceA)) return false;
+
+    geo::WireGeo const& wireB = planeB.Wire(wireNo);
+    geo::Point_t const crossing = start + t * (end - start);
+    return std::abs((crossing - wireB.GetCenter()).Dot(wireB.Direction())) <=
+           wireB.HalfL() + CrossingTolerance;
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+// ---  geo::ChannelAdjacency::Table
+//------------------------------------------------------------------------------
+std::span<raw::ChannelID_t const> geo::ChannelAdjacency::Table::operator()(
+  raw::ChannelID_t channel) const
+{
+  if (!raw::isValidChannelID(channel) || (channel < fBase) ||
+      (channel - fBase + 1 >= fFirst.size()))
+    return {};
+  std::size_t const index = channel - fBase;
+  return std::span<raw::ChannelID_t const>{fChannels}.subspan(fFirst[index],
+                                                              fFirst[index + 1] - fFirst[index]);
+}
+
+//------------------------------------------------------------------------------
+std::size_t geo::ChannelAdjacency::Table::MemoryUsage() const
+{
+  return sizeof(*this) + fFirst.capacity() * sizeof(std::size_t) +
+         fChannels.capacity() * sizeof(raw::ChannelID_t);
+}
+
+//------------------------------------------------------------------------------
+namespace {
+
+  // fills `first` and `channels` with the pairs from `forEachPair(emit)`,
+  // which calls `emit(channel, other)` for each pair (it is called twice);
+  // the lists are of the `nChannels` channels from `base` on
+  template <typename ForEachPair>
+  void buildTable(raw::ChannelID_t base,
+                  std::size_t nChannels,
+                  ForEachPair forEachPair,
+                  std::vector<std::size_t>& first,
+                  std::vector<raw::ChannelID_t>& channels)
+  {
+    auto const accepted = [base, nChannels](raw::ChannelID_t channel, raw::ChannelID_t other) {
+      return (channel != other) && (channel >= base) && (channel - base < nChannels) &&
+             (other >= base) && (other - base < nChannels);
+    };
+
+    // count, then fill
+    std::vector<std::size_t> counts(nChannels, 0);
+    forEachPair([&](raw::ChannelID_t channel, raw::ChannelID_t other) {
+      if (accepted(channel, other)) ++counts[channel - base];
+    });
+    first.assign(nChannels + 1, 0);
+    for (std::size_t channel = 0; channel < nChannels; ++channel)
+      first[channel + 1] = first[channel] + counts[channel];
+    channels.resize(first.back());
+    std::fill(counts.begin(), counts.end(), 0);
+    forEachPair([&](raw::ChannelID_t channel, raw::ChannelID_t other) {
+      if (!accepted(channel, other)) return;
+      std::size_t const index = channel - base;
+      channels[first[index] + counts[index]++] = other;
+    });
+
+    // sort each list and remove the duplicates, compacting the table
+    std::size_t end = 0;
+    for (std::size_t channel = 0; channel < nChannels; ++channel) {
+      auto const begin = channels.begin() + first[channel];
+      auto const stop = channels.begin() + first[channel + 1];
+      std::sort(begin, stop);
+      auto const last = std::unique(begin, stop);
+      first[channel] = end;
+      end = std::copy(begin, last, channels.begin() + end) - channels.begin();
+    }
+    first[nChannels] = end;
+    channels.resize(end);
+    channels.shrink_to_fit();
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+// ---  geo::ChannelAdjacency
+//------------------------------------------------------------------------------
+geo::ChannelAdjacency::ChannelAdjacency(WireReadoutGeom const& wireReadout,
+                                        double continuationDistance,
+                                        GeometrySubset const* subset)
+  : fContinuationDistance{continuationDistance}, fRestricted{subset && !subset->isFull()}
+{
+  // the channels of all the wires, plane by plane (the planes of a TPC are consecutive)
+  std::vector<PlaneChannels> planes;
+  for (PlaneGeo const& plane : wireReadout.Iterate<PlaneGeo>()) {
+    if (fRestricted && !subset->Contains(plane.ID())) continue;
+    PlaneChannels& entry = planes.emplace_back(PlaneChannels{&plane, {}});
+    entry.channels.reserve(plane.Nwires());
+    for (unsigned int w = 0; w < plane.Nwires(); ++w)
+      entry.channels.push_back(wireReadout.PlaneWireToChannel(WireID{plane.ID(), w}));
+  }
+
+  // the tables span all the channels, or the range of the ones of the subset
+  raw::ChannelID_t base = 0;
+  std::size_t nChannels = wireReadout.Nchannels();
+  if (fRestricted) {
+    raw::ChannelID_t low = raw::InvalidChannelID, high = 0;
+    for (PlaneChannels const& entry : planes) {
+      for (raw::ChannelID_t channel : entry.channels) {
+        if (!raw::isValidChannelID(channel)) continue;
+        low = std::min(low, channel);
+        high = std::max(high, channel);
+      }
+    }
+    base = raw::isValidChannelID(low) ? low : 0;
+    nChannels = raw::isValidChannelID(low) ? (high - low + 1) : 0;
+
+    // the range may include channels of wires out of the subset
+    fInSubset.assign(nChannels, false);
+    for (PlaneChannels const& entry : planes) {
+      for (raw::ChannelID_t channel : entry.channels)
+        if (raw::isValidChannelID(channel)) fInSubset[channel - base] = true;
+    }
+  }
+  fNeighbours.fBase = fCrossing.fBase = fContinuations.fBase = base;
+
+  // neighbours: the next wire in the same plane, both ways
+  buildTable(
+    base,
+    nChannels,
+    [&planes](auto emit) {
+      for (PlaneChannels const& entry : planes) {
+        for (std::size_t w = 1; w < entry.channels.size(); ++w) {
+          emit(entry.channels[w - 1], entry.channels[w]);
+          emit(entry.channels[w], entry.channels[w - 1]);
+        }
+      }
+    },
+    fNeighbours.fFirst,
+    fNeighbours.fChannels);
+
+  // crossing: the wires of the adjacent planes of the same TPC within the wire
+  // coordinate range of each wire, checked one by one
+  buildTable(
+    base,
+    nChannels,
+    [&planes](auto emit) {
+      for (std::size_t a = 0; a < planes.size(); ++a) {
+        PlaneGeo const& planeA = *planes[a].plane;
+        for (std::size_t b : {a - 1, a + 1}) {
+          if ((b >= planes.size()) ||
+              (planes[b].plane->ID().asTPCID() != planeA.ID().asTPCID()))
+            continue;
+          PlaneGeo const& planeB = *planes[b].plane;
+          long const lastWireB = static_cast<long>(planeB.Nwires()) - 1;
+          for (unsigned int wa = 0; wa < planeA.Nwires(); ++wa) {
+            WireGeo const& wireA = planeA.Wire(wa);
+            double const startCoord = planeB.WireCoordinate(wireA.GetStart());
+            double const endCoord = planeB.WireCoordinate(wireA.GetEnd());
+            long const from =
+              std::max(0L, static_cast<long>(std::floor(std::min(startCoord, endCoord))));
+            long const to =
+              std::min(lastWireB, static_cast<long>(std::ceil(std::max(startCoord, endCoord))));
+            for (long wb = from; wb <= to; ++wb) {
+              if (wiresCross(wireA, planeB, wb))
+                emit(planes[a].channels[wa], planes[b].channels[wb]);
+            }
+          }
+        }
+      }
+    },
+    fCrossing.fFirst,
+    fCrossing.fChannels);
+
+  // continuations: wire ends closer than the distance, in a hash grid of that cell size
+  std::vector<WireEnd> ends;
+  for (PlaneChannels const& entry : planes) {
+    for (unsigned int w = 0; w < entry.plane->Nwires(); ++w) {
+      WireGeo const& wire = entry.plane->Wire(w);
+      for (Point_t const& position : {wire.GetStart(), wire.GetEnd()}) {
+        ends.push_back(
+          {position, entry.plane->ID().asTPCID(), entry.plane->View(), entry.channels[w]});
+      }
+    }
+  }
+  double const cellSize = std::max(continuationDistance, CrossingTolerance);
+  auto const cellOf = [cellSize](Point_t const& p) {
+    return CellKey{static_cast<std::int64_t>(std::floor(p.X() / cellSize)),
+                   static_cast<std::int64_t>(std::floor(p.Y() / cellSize)),
+                   static_cast<std::int64_t>(std::floor(p.Z() / cellSize))};
+  };
+  std::unordered_map<CellKey, std::vector<std::size_t>, CellKeyHash> grid;
+  for (std::size_t i = 0; i < ends.size(); ++i)
+    grid[cellOf(ends[i].position)].push_back(i);
+
+  buildTable(
+    base,
+    nChannels,
+    [&](auto emit) {
+      for (WireEnd const& end : ends) {
+        CellKey const cell = cellOf(end.position);
+        for (std::int64_t dx = -1; dx <= 1; ++dx) {
+          for (std::int64_t dy = -1; dy <= 1; ++dy) {
+            for (std::int64_t dz = -1; dz <= 1; ++dz) {
+              auto const it = grid.find({cell.x + dx, cell.y + dy, cell.z + dz});
+              if (it == grid.end()) continue;
+              for (std::size_t i : it->second) {
+                WireEnd const& other = ends[i];
+                if ((other.tpc == end.tpc) || (other.view != end.view) ||
+                    (other.tpc.asCryostatID() != end.tpc.asCryostatID()))
+                  continue;
+                if ((other.position - end.position).R() > continuationDistance) continue;
+                emit(end.channel, other.channel);
+              }
+            }
+          }
+        }
+      }
+    },
+    fContinuations.fFirst,
+    fContinuations.fChannels);
+}
+
+//------------------------------------------------------------------------------
+void geo::ChannelAdjacency::throwOutOfSubset(raw::ChannelID_t channel) const
+{
+  throw cet::exception("ChannelAdjacency")
+    << "Channel " << channel << " is not read by a wire of the subset of the detector (its "
+    << "channels are between " << fNeighbours.FirstChannel() << " and "
+    << fNeighbours.EndChannel() << ", excluded).\n";
+}
+
+//------------------------------------------------------------------------------
+std::size_t geo::ChannelAdjacency::MemoryUsage() const
+{
+  return sizeof(*this) - 3 * sizeof(Table) + fInSubset.capacity() / 8 +
+         fNeighbours.MemoryUsage() + fCrossing.MemoryUsage() + fContinuations.MemoryUsage();
+}
+
+//------------------------------------------------------------------------------
+std::vector<std::span<std::byte const>> geo::ChannelAdjacency::MemoryBlocks() const
+{
+  std::vector<std::span<std::byte const>> blocks;
+  for (Table const* table : {&fNeighbours, &fCrossing, &fContinuations}) {
+    blocks.push_back(std::as_bytes(std::span{table->fFirst}));
+    blocks.push_back(std::as_bytes(std::span{table->fChannels}));
+  }
+  return blocks;
+}
@@ -0,0 +1,152 @@
+/**
+ * @file   larcore/Geometry/ChannelAdjacency.h
+ * @brief  Precomputed tables of the neighbouring, crossing and continuation channels.
+ * @see    larcore/Geometry/ChannelAdjacency.cc
+ */
+
+#ifndef LARCORE_GEOMETRY_CHANNELADJACENCY_H
+#define LARCORE_GEOMETRY_CHANNELADJACENCY_H
+
+// LArSoft libraries
+#include "larcorealg/Geometry/fwd.h"
+#include "larcoreobj/SimpleTypesAndConstants/RawTypes.h" // raw::ChannelID_t
+
+// C/C++ standard libraries
+#include <cstddef> // std::size_t, std::byte
+#include <span>
+#include <vector>
+
+namespace geo {
+
+  class GeometrySubset;
+
+  /**
+   * @brief Tables of the channels related to each channel of a wire readout.
+   *
+   * Three relations are precomputed for each channel, from all the wires it
+   * reads:
+   *
+   * * `Neighbours()`: the channels of the wires next to them in the same plane;
+   * * `Crossing()`: the channels of the wires of the previous and next planes
+   *   of the same TPC crossing them (the intersection of the wire lines,
+   *   projected along the plane normal, lies on both wires);
+   * * `Continuations()`: the channels of the wires of the same view in the
+   *   other TPCs of the cryostat with an end closer than a tolerance to an
+   *   end of one of them (the wire continuing across a TPC or APA boundary).
+   *
+   * Each relation is a compressed sparse row table: a single array of sorted,
+   * unique channels and the offset of the list of each channel in it, so that
+   * each query returns a span with no allocation. A channel is never in its
+   * own lists.
+   *
+   * With a `geo::GeometrySubset`, only the wires of its TPCs are related, and
+   * the tables span only the range of their channels: queries on channels not
+   * read by a wire of the subset (in that range or not) throw instead of
+   * answering with an empty list.
+   */
+  class ChannelAdjacency {
+  public:
+    /// A compressed sparse row table of channels.
+    class Table {
+    public:
+      /// Returns the channels related to `channel` (empty if `channel` is not in the table).
+      std::span<raw::ChannelID_t const> operator()(raw::ChannelID_t channel) const;
+
+      /// Returns the first channel in the table.
+      raw::ChannelID_t FirstChannel() const { return fBase; }
+
+      /// Returns the channel after the last one in the table.
+      raw::ChannelID_t EndChannel() const
+      {
+        return fBase + static_cast<raw::ChannelID_t>(fFirst.empty() ? 0 : fFirst.size() - 1);
+      }
+
+      /// Returns the number of channel pairs in the table.
+      std::size_t NEntries() const { return fChannels.size(); }
+
+      /// Returns the memory taken by the table [bytes].
+      std::size_t MemoryUsage() const;
+
+    private:
+      friend class ChannelAdjacency;
+
+      raw::ChannelID_t fBase = 0;             ///< Channel of the first list.
+      std::vector<std::size_t> fFirst;        ///< Start of the list of each channel (and end).
+      std::vector<raw::ChannelID_t> fChannels; ///< All the lists, one after the other.
+    };
+
+    /**
+     * @brief Builds the tables of all the channels of `wireReadout`.
+     * @param wireReadout the wire readout geometry with the wires and channels
+     * @param continuationDistance largest distance between the ends of continuing wires [cm]
+     * @param subset if not `nullptr`, only the wires of its TPCs are related
+     */
+    explicit ChannelAdjacency(WireReadoutGeom const& wireReadout,
+                              double continuationDistance = 1.0,
+                              GeometrySubset const* subset = nullptr);
+
+    /// Returns whether the tables are restricted to a subset of the detector.
+    bool isRestricted() const { return fRestricted; }
+
+    /// Returns the channels of the wires next to the ones of `channel` in the same plane.
+    /// @throw cet::exception (category `ChannelAdjacency`) if restricted and out of the subset
+    std::span<raw::ChannelID_t const> Neighbours(raw::ChannelID_t channel) const
+    {
+      return lookup(fNeighbours, channel);
+    }
+
+    /// Returns the channels of the wires of the adjacent planes crossing the ones of `channel`.
+    /// @throw cet::exception (category `ChannelAdjacency`) if restricted and out of the subset
+    std::span<raw::ChannelID_t const> Crossing(raw::ChannelID_t channel) const
+    {
+      return lookup(fCrossing, channel);
+    }
+
+    /// Returns the channels of the wires continuing the ones of `channel` in other TPCs.
+    /// @throw cet::exception (category `ChannelAdjacency`) if restricted and out of the subset
+    std::span<raw::ChannelID_t const> Continuations(raw::ChannelID_t channel) const
+    {
+      return lookup(fContinuations, channel);
+    }
+
+    /// Returns the table of the neighbouring channels.
+    Table const& NeighbourTable() const { return fNeighbours; }
+
+    /// Returns the table of the crossing channels.
+    Table const& CrossingTable() const { return fCrossing; }
+
+    /// Returns the table of the continuation channels.
+    Table const& ContinuationTable() const { return fContinuations; }
+
+    /// Returns the largest distance between the ends of continuing wires [cm].
+    double ContinuationDistance() const { return fContinuationDistance; }
+
+    /// Returns the memory taken by all the tables [bytes].
+    std::size_t MemoryUsage() const;
+
+    /// Returns the blocks of memory of all the tables (e.g. to move them to huge pages).
+    std::vector<std::span<std::byte const>> MemoryBlocks() const;
+
+  private:
+    double fContinuationDistance;
+    bool fRestricted = false;
+    std::vector<bool> fInSubset; ///< Whether each channel of the tables is of the subset.
+    Table fNeighbours;
+    Table fCrossing;
+    Table fContinuations;
+
+    /// Returns `table(channel)`, checking the subset first if restricted.
+    std::span<raw::ChannelID_t const> lookup(Table const& table, raw::ChannelID_t channel) const
+    {
+      if (fRestricted && ((channel < table.FirstChannel()) || (channel >= table.EndChannel()) ||
+                          !fInSubset[channel - table.FirstChannel()]))
+        throwOutOfSubset(channel);
+      return table(channel);
+    }
+
+    [[noreturn]] void throwOutOfSubset(raw::ChannelID_t channel) const;
+  };
+
+} // namespace geo
+
+#endif // LARCORE_GEOMETRY_CHANNELADJACENCY_H
@@ -0,0 +1,265 @@
+/**
+ * @file   larcore/Geometry/ChannelPartition.cc
+ * @brief  Partition of the readout channels into balanced shards of whole planes or TPCs.
+ * @see    larcore/Geometry/ChannelPartition.h
+ */
+
+// library header
+#include "larcore/Geometry/ChannelPartition.h"
+
+// LArSoft libraries
+#include "larcore/Geometry/GeometrySubset.h"
+#include "larcorealg/Geometry/PlaneGeo.h"
+#include "larcorealg/Geometry/WireGeo.h"
+#include "larcorealg/Geometry/WireReadoutGeom.h"
+
+// framework libraries
+#include "cetlib_except/exception.h"
+
+// C/C++ standard libraries
+#include <algorithm> // std::sort(), std::max(), std::min(), std::upper_bound()
+#include <iterator>  // std::prev()
+#include <numeric>   // std::iota()
+#include <unordered_map>
+#include <utility> // std::pair
+
+namespace {
+
+  // a unit of the partition: planes, with the channel of each of their wires
+  struct Unit {
+    std::vector<geo::PlaneID> planes;
+    std::vector<std::pair<raw::ChannelID_t, double>> wires; ///< Channel and length.
+    std::vector<raw::ChannelID_t> channels;                 ///< Unique channels, sorted.
+    double cost = 0.0;
+  };
+
+  std::size_t findRoot(std::vector<std::size_t>& parent, std::size_t i)
+  {
+    while (parent[i] != i)
+      i = parent[i] = parent[parent[i]];
+    return i;
+  }
+
+  // whether the next unit, of cost `cost`, opens a new group after `sum` in a
+  // group of `size` units with at most `limit` cost
+  bool startsGroup(double sum, std::size_t size, double cost, double limit)
+  {
+    return (size > 0) && (sum + cost > limit);
+  }
+
+  // number of consecutive groups of units of at most `limit` cost each
+  std::size_t countGroups(std::vector<double> const& costs, double limit)
+  {
+    std::size_t groups = 1, size = 0;
+    double sum = 0.0;
+    for (double const cost : costs) {
+      if (startsGroup(sum, size, cost, limit)) {
+        ++groups;
+        sum = 0.0;
+        size = 0;
+      }
+      sum += cost;
+      ++size;
+    }
+    return groups;
+  }
+
+  // ranges of consecutive channels in the sorted, unique `channels`
+  std::vector<geo::ChannelPartition::ChannelRange> channelRanges(
+    std::vector<raw::ChannelID_t> const& channels)
+  {
+    std::vector<geo::ChannelPartition::ChannelRange> ranges;
+    for (raw::ChannelID_t const channel : channels) {
+      if (!ranges.empty() && (ranges.back().end == channel))
+        ++ranges.back().end;
+      else
+        ranges.push_back({channel, channel + 1});
+    }
+    return ranges;
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+geo::ChannelPartition::ChannelPartition(WireReadoutGeom const& wireReadout,
+                                        unsigned int nShards,
+                                        GeometrySubset const* subset)
+  : ChannelPartition{wireReadout, nShards, Config{}, subset}
+{}
+
+//------------------------------------------------------------------------------
+geo::ChannelPartition::ChannelPartition(WireReadoutGeom const& wireReadout,
+                                        unsigned int nShards,
+                                        Config const& config,
+                                        GeometrySubset const* subset)
+  : fCost{config.cost}, fBoundary{config.boundary}
+{
+  if (nShards == 0) {
+    throw cet::exception("ChannelPartition") << "At least one shard must be requested.\n";
+  }
+  if ((fCost == Cost::Weight) && !config.weight) {
+    throw cet::exception("ChannelPartition")
+      << "Channel weight cost model requested without a weight function.\n";
+  }
+
+  // the planes, one unit per plane or per TPC
+  std::vector<Unit> units;
+  for (PlaneGeo const& plane : wireReadout.Iterate<PlaneGeo>()) {
+    if (subset && !subset->Contains(plane.ID())) continue;
+    if (units.empty() || (fBoundary == Boundary::Plane) ||
+        (units.back().planes.back().asTPCID() != plane.ID().asTPCID()))
+      units.emplace_back();
+    Unit& unit = units.back();
+    unit.planes.push_back(plane.ID());
+    for (unsigned int w = 0; w < plane.Nwires(); ++w) {
+      raw::ChannelID_t const channel = wireReadout.PlaneWireToChannel(WireID{plane.ID(), w});
+      if (raw::isValidChannelID(channel)) unit.wires.emplace_back(channel, plane.Wire(w).Length());
+    }
+  }
+
+  // units sharing a channel are merged, at the place of the first one
+  std::vector<std::size_t> parent(units.size());
+  std::iota(parent.begin(), parent.end(), 0);
+  std::unordered_map<raw::ChannelID_t, std::size_t> channelUnit;
+  for (std::size_t i = 0; i < units.size(); ++i) {
+    for (auto const& [channel, length] : units[i].wires) {
+      auto const [it, inserted] = channelUnit.emplace(channel, i);
+      if (inserted) continue;
+      std::size_t const a = findRoot(parent, it->second), b = findRoot(parent, i);
+      if (a != b) parent[std::max(a, b)] = std::min(a, b);
+    }
+  }
+  std::vector<Unit> merged;
+  std::vector<std::size_t> mergedIndex(units.size(), units.size());
+  for (std::size_t i = 0; i < units.size(); ++i) {
+    std::size_t const root = findRoot(parent, i);
+    if (mergedIndex[root] == units.size()) {
+      mergedIndex[root] = merged.size();
+      merged.emplace_back();
+    }
+    Unit& target = merged[mergedIndex[root]];
+    target.planes.insert(target.planes.end(), units[i].planes.begin(), units[i].planes.end());
+    target.wires.insert(target.wires.end(), units[i].wires.begin(), units[i].wires.end());
+  }
+  units.clear();
+
+  // cost of each unit, from its channels
+  std::vector<double> costs;
+  costs.reserve(merged.size());
+  for (Unit& unit : merged) {
+    std::sort(unit.wires.begin(), unit.wires.end());
+    for (std::size_t i = 0; i < unit.wires.size();) {
+      raw::ChannelID_t const channel = unit.wires[i].first;
+      double length = 0.0;
+      for (; (i < unit.wires.size()) && (unit.wires[i].first == channel); ++i)
+        length += unit.wires[i].second;
+      double cost = 1.0;
+      switch (fCost) {
+      case Cost::Channels: break;
+      case Cost::WireLength: cost = length; break;
+      case Cost::Weight: cost = config.weight(channel); break;
+      }
+      if (!(cost >= 0.0)) {
+        throw cet::exception("ChannelPartition")
+          << "Channel " << channel << " has cost " << cost << ", not allowed.\n";
+      }
+      unit.channels.push_back(channel);
+      unit.cost += cost;
+    }
+    unit.wires.clear();
+    unit.wires.shrink_to_fit();
+    costs.push_back(unit.cost);
+  }
+
+  // smallest largest cost of consecutive groups, by bisection
+  std::size_t const nGroups = std::min<std::size_t>(nShards, merged.size());
+  if (nGroups == 0) return;
+  double low = 0.0, high = 0.0;
+  for (double const cost : costs) {
+    low = std::max(low, cost);
+    high += cost;
+  }
+  for (unsigned int iter = 0; (iter < 100) && (high - low > 1e-9 * high); ++iter) {
+    double const limit = 0.5 * (low + high);
+    (countGroups(costs, limit) <= nGroups ? high : low) = limit;
+  }
+
+  // groups of at most that cost; the last units get their own group when needed
+  // for all the shards to be used
+  fShards.resize(nGroups);
+  std::vector<std::vector<raw::ChannelID_t>> shardChannels(nGroups);
+  std::size_t group = 0, size = 0;
+  double sum = 0.0;
+  for (std::size_t i = 0; i < merged.size(); ++i) {
+    bool const forced = (size > 0) && (merged.size() - i == nGroups - group - 1);
+    if ((forced || startsGroup(sum, size, costs[i], high)) && (group + 1 < nGroups)) {
+      ++group;
+      sum = 0.0;
+      size = 0;
+    }
+    sum += costs[i];
+    ++size;
+    Shard& shard = fShards[group];
+    shard.planes.insert(shard.planes.end(), merged[i].planes.begin(), merged[i].planes.end());
+    shard.cost += merged[i].cost;
+    shardChannels[group].insert(
+      shardChannels[group].end(), merged[i].channels.begin(), merged[i].channels.end());
+  }
+
+  for (unsigned int s = 0; s < nGroups; ++s) {
+    Shard& shard = fShards[s];
+    std::sort(shard.planes.begin(), shard.planes.end());
+    std::sort(shardChannels[s].begin(), shardChannels[s].end());
+    shard.nChannels = shardChannels[s].size();
+    shard.channels = channelRanges(shardChannels[s]);
+    for (ChannelRange const& range : shard.channels)
+      fRanges.push_back({range, s});
+  }
+  std::sort(fRanges.begin(), fRanges.end(), [](ShardRange const& a, ShardRange const& b) {
+    return a.channels.first < b.channels.first;
+  });
+}
+
+//------------------------------------------------------------------------------
+unsigned int geo::ChannelPartition::ShardOf(raw::ChannelID_t channel) const
+{
+  auto const next = std::upper_bound(
+    fRanges.begin(), fRanges.end(), channel, [](raw::ChannelID_t channel, ShardRange const& r) {
+      return channel < r.channels.first;
+    });
+  if (next == fRanges.begin()) return InvalidShard;
+  ShardRange const& range = *std::prev(next);
+  return (channel < range.channels.end) ? range.shard : InvalidShard;
+}
+
+//------------------------------------------------------------------------------
+double geo::ChannelPartition::TotalCost() const
+{
+  double total = 0.0;
+  for (Shard const& shard : fShards)
+    total += shard.cost;
+  return total;
+}
+
+//------------------------------------------------------------------------------
+double geo::ChannelPartition::Imbalance() const
+{
+  double const total = TotalCost();
+  if (fShards.empty() || !(total > 0.0)) return 1.0;
+  double largest = 0.0;
+  for (Shard const& shard : fShards)
+    largest = std::max(largest, shard.cost);
+  return largest * fShards.size() / total;
+}
+
+//------------------------------------------------------------------------------
+std::size_t geo::ChannelPartition::MemoryUsage() const
+{
+  std::size_t memory = sizeof(*this) + fShards.capacity() * sizeof(Shard) +
+                       fRanges.capacity() * sizeof(ShardRange);
+  for (Shard const& shard : fShards) {
+    memory += shard.planes.capacity() * sizeof(PlaneID) +
+              shard.channels.capacity() * sizeof(ChannelRange);
+  }
+  return memory;
+}
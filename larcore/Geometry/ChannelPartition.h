@@ -0,0 +1,155 @@
+/**
+ * @file   larcore/Geometry/ChannelPartition.h
+ * @brief  Partition of the readout channels into balanced shards of whole planes or TPCs.
+ * @see    larcore/Geometry/ChannelPartition.cc
+ */
+
+#ifndef LARCORE_GEOMETRY_CHANNELPARTITION_H
+#define LARCORE_GEOMETRY_CHANNELPARTITION_H
+
+// LArSoft libraries
+#include "larcorealg/Geometry/fwd.h"
+#include "larcoreobj/SimpleTypesAndConstants/RawTypes.h" // raw::ChannelID_t
+#include "larcoreobj/SimpleTypesAndConstants/geo_types.h"
+
+// C/C++ standard libraries
+#include <cstddef> // std::size_t
+#include <functional>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace geo {
+
+  class GeometrySubset;
+
+  /**
+   * @brief Split of the channels of a wire readout into shards of balanced cost.
+   *
+   * To spread the processing of the raw data among nodes or threads, the
+   * channels are assigned to shards made of whole planes, or of whole TPCs,
+   * in the order of their IDs. Planes sharing channels (e.g. wires wrapped
+   * around an APA) always end up in the same shard, so that each channel
+   * belongs to exactly one shard.
+   *
+   * The cost of a channel is, depending on the model:
+   *
+   * * `Cost::Channels`: `1` (the shards have similar numbers of channels);
+   * * `Cost::WireLength`: the total length of its wires [cm];
+   * * `Cost::Weight`: the value of a user function of the channel.
+   *
+   * The shards are consecutive runs of planes (or TPCs) with the smallest
+   * possible largest cost. There are as many shards as requested, unless
+   * there are fewer planes (or TPCs) than that.
+   *
+   * `ShardOf()` maps a channel back to its shard, by binary search on the
+   * ranges of consecutive channels of the shards.
+   */
+  class ChannelPartition {
+  public:
+    /// Cost models of the channels.
+    enum class Cost {
+      Channels,   ///< Each channel costs `1`.
+      WireLength, ///< Each channel costs the length of its wires.
+      Weight      ///< Each channel costs what a user function says.
+    };
+
+    /// Units the shards are made of.
+    enum class Boundary {
+      Plane, ///< Shards are made of whole planes.
+      TPC    ///< Shards are made of whole TPCs.
+    };
+
+    /// User cost of a channel, for `Cost::Weight`.
+    using Weight = std::function<double(raw::ChannelID_t)>;
+
+    /// How to split the channels.
+    struct Config {
+      Cost cost = Cost::Channels;
+      Boundary boundary = Boundary::Plane;
+      Weight weight; ///< Cost of each channel (only for `Cost::Weight`).
+    };
+
+    /// A range of consecutive channels, from `first` to `end` (excluded).
+    struct ChannelRange {
+      raw::ChannelID_t first;
+      raw::ChannelID_t end;
+
+      std::size_t size() const { return end - first; }
+    };
+
+    /// A shard: its planes and their channels.
+    struct Shard {
+      std::vector<PlaneID> planes;        ///< Planes of the shard, sorted.
+      std::vector<ChannelRange> channels; ///< Channels of the shard, in sorted ranges.
+      std::size_t nChannels = 0;          ///< Number of channels.
+      double cost = 0.0;                  ///< Total cost of the channels.
+    };
+
+    /// Value returned by `ShardOf()` for channels in no shard.
+    static constexpr unsigned int InvalidShard = std::numeric_limits<unsigned int>::max();
+
+    /**
+     * @brief Splits the channels of `wireReadout` into `nShards` shards.
+     * @param wireReadout the wire readout geometry with the planes and channels
+     * @param nShards number of shards requested
+     * @param config cost model and units of the shards
+     * @param subset if not `nullptr`, only the planes of its TPCs are split
+     * @throw cet::exception (category `ChannelPartition`) if no shard is
+     *        requested, a weight function is required and missing, or a
+     *        channel has a negative cost
+     */
+    ChannelPartition(WireReadoutGeom const& wireReadout,
+                     unsigned int nShards,
+                     Config const& config,
+                     GeometrySubset const* subset = nullptr);
+
+    /// Splits the channels of `wireReadout` into `nShards` shards of whole
+    /// planes with similar numbers of channels.
+    ChannelPartition(WireReadoutGeom const& wireReadout,
+                     unsigned int nShards,
+                     GeometrySubset const* subset = nullptr);
+
+    /// Returns the cost model of the partition.
+    Cost CostModel() const { return fCost; }
+
+    /// Returns the units the shards are made of.
+    Boundary Units() const { return fBoundary; }
+
+    /// Returns the number of shards.
+    unsigned int NShards() const { return static_cast<unsigned int>(fShards.size()); }
+
+    /// Returns all the shards.
+    std::span<Shard const> Shards() const { return fShards; }
+
+    /// Returns the shard number `shard`.
+    Shard const& GetShard(unsigned int shard) const { return fShards.at(shard); }
+
+    /// Returns the shard with `channel` (`InvalidShard` if none).
+    unsigned int ShardOf(raw::ChannelID_t channel) const;
+
+    /// Returns the total cost of all the shards.
+    double TotalCost() const;
+
+    /// Returns the cost of the most expensive shard over the average one (`1`: perfect balance).
+    double Imbalance() const;
+
+    /// Returns the memory taken by the partition [bytes].
+    std::size_t MemoryUsage() const;
+
+  private:
+    /// A range of channels of a shard, for `ShardOf()`.
+    struct ShardRange {
+      ChannelRange channels;
+      unsigned int shard;
+    };
+
+    Cost fCost;
+    Boundary fBoundary;
+    std::vector<Shard> fShards;
+    std::vector<ShardRange> fRanges; ///< Channel ranges of all the shards, sorted.
+  };
+
+} // namespace geo
+
+#endif // LARCORE_GEOMETRY_CHANNELPARTITION_H
@@ -7,6 +7,8 @@
  */
 
 // LArSoft libraries
+#include "larcore/Geometry/GeometryIDRanges.h"
+#include "larcore/Geometry/PixelLattice.h"
 #include "larcore/Geometry/WireReadout.h"
 #include "larcorealg/Geometry/GeometryCore.h"
 #include "larcorealg/Geometry/OpDetGeo.h"
@@ -24,8 +26,20 @@
 #include "fhiclcpp/types/Name.h"
 #include "messagefacility/MessageLogger/MessageLogger.h"
 
+// TBB libraries
+#include "tbb/blocked_range.h"
+#include "tbb/combinable.h"
+#include "tbb/parallel_for.h"
+#include "tbb/task_arena.h"
+
 // C/C++ standard libraries
+#include <algorithm> // std::find(), std::max()
+#include <array>
+#include <chrono>
+#include <cstddef> // std::size_t
 #include <string>
+#include <utility> // std::move()
+#include <vector>
 
 namespace {
   //------------------------------------------------------------------------------
@@ -76,6 +90,54 @@ namespace {
     }
   }
 
+  //------------------------------------------------------------------------------
+  void dumpChannelToPixels(std::string const& OutputCategory,
+                           geo::PixelLattice const& pixels,
+                           raw::ChannelID_t FirstChannel,
+                           raw::ChannelID_t LastChannel)
+  {
+    /// extract general channel range information
+    unsigned int const NChannels = pixels.Nchannels();
+
+    if (NChannels == 0) {
+      mf::LogError(OutputCategory) << "Nice detector we have here, with no pixels.";
+      return;
+    }
+
+    // the pixel channels follow the wire channels: the limits apply to both
+    raw::ChannelID_t const PrintFirst = raw::isValidChannelID(FirstChannel) ?
+                                          std::max(FirstChannel, pixels.FirstChannel()) :
+                                          pixels.FirstChannel();
+    raw::ChannelID_t const PrintLast = raw::isValidChannelID(LastChannel) ?
+                                         std::min(LastChannel, pixels.EndChannel() - 1) :
+                                         pixels.EndChannel() - 1;
+    if (PrintFirst > PrintLast) {
+      mf::LogInfo(OutputCategory) << "No pixel channel to print (pixel channels: "
+                                  << pixels.FirstChannel() << " to " << (pixels.EndChannel() - 1)
+                                  << ")";
+      return;
+    }
+
+    // print intro
+    mf::LogInfo(OutputCategory) << "Printing pixels of channels from " << PrintFirst << " to "
+                                << PrintLast << " (" << NChannels << " pixel channels from "
+                                << pixels.FirstChannel() << ", " << pixels.Pitch()
+                                << " cm pitch)";
+
+    // print map
+    mf::LogVerbatim log(OutputCategory);
+    for (raw::ChannelID_t channel = PrintFirst; channel <= PrintLast; ++channel) {
+      geo::PixelLattice::Pixel const pixel = pixels.ChannelToPixel(channel);
+      log << "\n " << ((int)channel) << " ->";
+      if (!pixel) {
+        log << " no pixel";
+        continue;
+      }
+      log << " { " << std::string(pixel.tpc) << " row " << pixel.row << " column "
+          << pixel.column << " } at " << pixels.ChannelToCenter(channel) << " cm";
+    }
+  }
+
   //------------------------------------------------------------------------------
   void dumpWireToChannel(std::string const& OutputCategory,
                          geo::WireReadoutGeom const& wireReadoutGeom)
@@ -103,6 +165,229 @@ namespace {
     } // for
   }
 
+  //------------------------------------------------------------------------------
+  /// Kinds of inconsistency found by `verifyChannelMap()`.
+  enum class MapError : std::size_t {
+    ChannelWireChannel, ///< a wire of a channel maps to another channel
+    WireNoChannel,      ///< a wire maps to no valid channel
+    WireChannelWire,    ///< a wire is not among the wires of its channel
+    PixelChannel,       ///< the pixel of a channel maps to another channel
+    CenterChannel,      ///< the center of the pixel of a channel is in another channel
+    NErrors
+  };
+
+  constexpr std::array<char const*, static_cast<std::size_t>(MapError::NErrors)> MapErrorNames{
+    "channel -> wire -> other channel",
+    "wire -> invalid channel",
+    "wire -> channel -> other wires",
+    "channel -> pixel -> other channel",
+    "channel -> pixel center -> other channel"};
+
+  /// Statistics and inconsistencies found by (a part of) the verification.
+  struct MapCheckResults {
+    static constexpr std::size_t MaxExamples = 10; ///< Examples kept per kind.
+
+    std::size_t nChannels = 0;      ///< Channels checked.
+    std::size_t nWires = 0;         ///< Wires checked.
+    std::size_t nEmptyChannels = 0; ///< Channels with no wire.
+    std::size_t maxWiresPerChannel = 0;
+    std::array<std::size_t, MapErrorNames.size()> nErrors{};
+    std::array<std::vector<std::string>, MapErrorNames.size()> examples;
+
+    void addError(MapError error, std::string message)
+    {
+      auto const index = static_cast<std::size_t>(error);
+      if (nErrors[index]++ < MaxExamples) examples[index].push_back(std::move(message));
+    }
+
+    std::size_t totalErrors() const
+    {
+      std::size_t total = 0;
+      for (std::size_t const n : nErrors)
+        total += n;
+      return total;
+    }
+
+    MapCheckResults& operator+=(MapCheckResults const& other)
+    {
+      nChannels += other.nChannels;
+      nWires += other.nWires;
+      nEmptyChannels += other.nEmptyChannels;
+      maxWiresPerChannel = std::max(maxWiresPerChannel, other.maxWiresPerChannel);
+      for (std::size_t i = 0; i < nErrors.size(); ++i) {
+        nErrors[i] += other.nErrors[i];
+        for (std::string const& example : other.examples[i]) {
+          if (examples[i].size() < MaxExamples) examples[i].push_back(example);
+        }
+      }
+      return *this;
+    }
+  };
+
+  /// Checks that each wire of the `channels` maps back to its channel.
+  void checkChannelsToWires(MapCheckResults& results,
+                            geo::WireReadoutGeom const& wireReadoutGeom,
+                            geo::IDRange<geo::ChannelIDTable> const& channels)
+  {
+    for (raw::ChannelID_t const channel : channels) {
+      ++results.nChannels;
+      std::vector<geo::WireID> const wires = wireReadoutGeom.ChannelToWire(channel);
+      if (wires.empty()) ++results.nEmptyChannels;
+      results.maxWiresPerChannel = std::max(results.maxWiresPerChannel, wires.size());
+      for (geo::WireID const& wireID : wires) {
+        raw::ChannelID_t const backChannel = wireReadoutGeom.PlaneWireToChannel(wireID);
+        if (backChannel == channel) continue;
+        results.addError(MapError::ChannelWireChannel,
+                         "channel " + std::to_string(channel) + " -> { " + std::string(wireID) +
+                           " } -> channel " + std::to_string(backChannel));
+      }
+    }
+  }
+
+  /// Checks that each of the `wireIDs` is among the wires of its channel.
+  void checkWiresToChannels(MapCheckResults& results,
+                            geo::WireReadoutGeom const& wireReadoutGeom,
+                            geo::IDRange<geo::WireIDTable> const& wireIDs)
+  {
+    for (geo::WireID const wireID : wireIDs) {
+      ++results.nWires;
+      raw::ChannelID_t const channel = wireReadoutGeom.PlaneWireToChannel(wireID);
+      if (!raw::isValidChannelID(channel)) {
+        results.addError(MapError::WireNoChannel, "{ " + std::string(wireID) + " }");
+        continue;
+      }
+      std::vector<geo::WireID> const wires = wireReadoutGeom.ChannelToWire(channel);
+      if (std::find(wires.begin(), wires.end(), wireID) != wires.end()) continue;
+      results.addError(MapError::WireChannelWire,
+                       "{ " + std::string(wireID) + " } -> channel " + std::to_string(channel) +
+                         " (" + std::to_string(wires.size()) + " wires)");
+    }
+  }
+
+  /// Checks that the pixel of each of the `channels` and its center map back to it.
+  void checkChannelsToPixels(MapCheckResults& results,
+                             geo::PixelLattice const& pixels,
+                             tbb::blocked_range<raw::ChannelID_t> const& channels)
+  {
+    for (raw::ChannelID_t channel = channels.begin(); channel != channels.end(); ++channel) {
+      ++results.nChannels;
+      geo::PixelLattice::Pixel const pixel = pixels.ChannelToPixel(channel);
+      raw::ChannelID_t const backChannel = pixels.PixelToChannel(pixel);
+      if (backChannel != channel) {
+        results.addError(MapError::PixelChannel,
+                         "channel " + std::to_string(channel) + " -> { " +
+                           std::string(pixel.tpc) + " row " + std::to_string(pixel.row) +
+                           " column " + std::to_string(pixel.column) + " } -> channel " +
+                           std::to_string(backChannel));
+        continue;
+      }
+      raw::ChannelID_t const centerChannel =
+        pixels.PositionToChannel(pixel.tpc, pixels.ChannelToCenter(channel));
+      if (centerChannel == channel) continue;
+      // the centers of the last row and column may be out of the anode
+      geo::PixelLattice::Anode const& anode = *pixels.AnodeOf(pixel.tpc);
+      if (!raw::isValidChannelID(centerChannel) &&
+          ((pixel.row + 1 == anode.nRows) || (pixel.column + 1 == anode.nColumns)))
+        continue;
+      results.addError(MapError::CenterChannel,
+                       "channel " + std::to_string(channel) + " -> center -> channel " +
+                         std::to_string(centerChannel));
+    }
+  }
+
+  /// Runs `check(results, chunk)` on the chunks TBB splits `range` into, with
+  /// at most `nThreads` threads (`0`: as many as the job allows), and sums the
+  /// results.
+  template <typename Range, typename Check>
+  MapCheckResults checkInParallel(Range const& range, unsigned int nThreads, Check check)
+  {
+    tbb::combinable<MapCheckResults> results;
+    tbb::task_arena arena{nThreads ? static_cast<int>(nThreads) : tbb::task_arena::automatic};
+    arena.execute([&range, &results, &check]() {
+      tbb::parallel_for(range, [&results, &check](Range const& chunk) {
+        check(results.local(), chunk);
+      });
+    });
+
+    MapCheckResults total;
+    results.combine_each([&total](MapCheckResults const& result) { total += result; });
+    return total;
+  }
+
+  /// Logs the inconsistencies in `results`, by kind, with some examples.
+  void logErrors(std::string const& OutputCategory, MapCheckResults const& results)
+  {
+    for (std::size_t i = 0; i < MapErrorNames.size(); ++i) {
+      if (results.nErrors[i] == 0) continue;
+      mf::LogError log(OutputCategory);
+      log << results.nErrors[i] << " inconsistencies of type '" << MapErrorNames[i]
+          << "', e.g.:";
+      for (std::string const& example : results.examples[i])
+        log << "\n  " << example;
+    }
+  }
+
+  /// Checks the round trips of all channels and wires; returns the number of errors.
+  std::size_t verifyChannelMap(std::string const& OutputCategory,
+                               geo::WireReadoutGeom const& wireReadoutGeom,
+                               unsigned int nThreads)
+  {
+    // chunks of a few hundred channels or wires keep the TBB overhead negligible
+    constexpr std::size_t GrainSize = 256;
+
+    auto const start = std::chrono::steady_clock::now();
+
+    geo::ReadoutIDTables const tables{wireReadoutGeom};
+    MapCheckResults results = checkInParallel(
+      geo::IDRange{tables.channels(), GrainSize},
+      nThreads,
+      [&wireReadoutGeom](MapCheckResults& partial, geo::IDRange<geo::ChannelIDTable> const& chunk) {
+        checkChannelsToWires(partial, wireReadoutGeom, chunk);
+      });
+    results += checkInParallel(
+      geo::IDRange{tables.wires(), GrainSize},
+      nThreads,
+      [&wireReadoutGeom](MapCheckResults& partial, geo::IDRange<geo::WireIDTable> const& chunk) {
+        checkWiresToChannels(partial, wireReadoutGeom, chunk);
+      });
+
+    std::chrono::duration<double> const elapsed = std::chrono::steady_clock::now() - start;
+
+    mf::LogInfo(OutputCategory) << "Channel map verified in "
+                                << elapsed.count() << " s: " << results.nChannels
+                                << " channels (" << results.nEmptyChannels
+                                << " with no wire, up to " << results.maxWiresPerChannel
+                                << " wires per channel), " << results.nWires << " wires, "
+                                << results.totalErrors() << " inconsistencies";
+    logErrors(OutputCategory, results);
+    return results.totalErrors();
+  }
+
+  /// Checks the round trips of all the pixel channels; returns the number of errors.
+  std::size_t verifyPixelMap(std::string const& OutputCategory,
+                             geo::PixelLattice const& pixels,
+                             unsigned int nThreads)
+  {
+    constexpr raw::ChannelID_t GrainSize = 1024; // pixel checks are cheap
+
+    auto const start = std::chrono::steady_clock::now();
+
+    MapCheckResults const results = checkInParallel(
+      tbb::blocked_range<raw::ChannelID_t>{pixels.FirstChannel(), pixels.EndChannel(), GrainSize},
+      nThreads,
+      [&pixels](MapCheckResults& partial, tbb::blocked_range<raw::ChannelID_t> const& chunk) {
+        checkChannelsToPixels(partial, pixels, chunk);
+      });
+
+    std::chrono::duration<double> const elapsed = std::chrono::steady_clock::now() - start;
+
+    mf::LogInfo(OutputCategory) << "Pixel map verified in " << elapsed.count()
+                                << " s: " << results.nChannels << " channels, "
+                                << results.totalErrors() << " inconsistencies";
+    logErrors(OutputCategory, results);
+    return results.totalErrors();
+  }
+
   //------------------------------------------------------------------------------
   geo::OpDetGeo const* getOpticalDetector(geo::WireReadoutGeom const& wireReadoutGeom,
                                           unsigned int channelID)
@@ -164,8 +449,22 @@ namespace geo {
  *   each wire
  * - *OpDetChannels* (boolean, default: false): prints for each optical detector
  *   channel ID the optical detector ID and its center
+ * - *PixelChannels* (boolean, default: false): prints for each pixel channel
+ *   its anode, row and column and the center of the pixel (the `WireReadout`
+ *   service must have a pixel readout, like `PixelWireReadout`); the pixel
+ *   channels follow the wire channels, and the other options still print
+ *   and check the wire channels
+ * - *VerifyRoundTrips* (boolean, default: false): checks that each wire of each
+ *   channel maps back to that channel, and that each wire is among the wires
+ *   of the channel it maps to; the channels and the wires are split among
+ *   TBB tasks (see `geo::IDRange`), and a summary of the inconsistencies is printed (ERROR level);
+ *   if any is found, an exception is thrown; with a pixel readout, also checks
+ *   that the pixel of each channel and its center map back to that channel,
+ *   and that the pixel channels do not overlap the wire ones
+ * - *VerifyThreads* (integer, default: 0): maximum number of threads used for
+ *   the verification (`0`: as many as the job allows)
  * - *FirstChannel* (integer, default: no limit): ID of the lowest channel to be
- *   printed
+ *   printed (wire or pixel channel)
  * - *LastChannel* (integer, default: no limit): ID of the highest channel to be
  *   printed
  * - *OutputCategory* (string, default: DumpChannelMap): output category used
@@ -198,6 +497,21 @@ public:
       Comment("print for each optical detector channel ID the optical detector ID and its center"),
       false};
 
+    fhicl::Atom<bool> PixelChannels{
+      Name("PixelChannels"),
+      Comment("print for each pixel channel its anode, row and column and the pixel center"),
+      false};
+
+    fhicl::Atom<bool> VerifyRoundTrips{
+      Name("VerifyRoundTrips"),
+      Comment("check channel -> wires -> channel and wire -> channel -> wires for all"),
+      false};
+
+    fhicl::Atom<unsigned int> VerifyThreads{
+      Name("VerifyThreads"),
+      Comment("maximum threads used for the verification (0: as many as the job allows)"),
+      0U};
+
     fhicl::Atom<raw::ChannelID_t> FirstChannel{
       Name("FirstChannel"),
       Comment("ID of the lowest channel to be printed (default: no limit)"),
@@ -231,6 +545,9 @@ private:
   bool DoChannelToWires;      ///< Dump channel -> wires mapping.
   bool DoWireToChannel;       ///< Dump wire -> channel mapping.
   bool DoOpDetChannels;       ///< Dump optical detector channel -> optical detector.
+  bool DoPixelChannels;       ///< Dump pixel channel -> pixel.
+  bool DoVerifyRoundTrips;    ///< Check channel <-> wire round trips.
+  unsigned int VerifyThreads; ///< Threads for the round trip check.
 
   raw::ChannelID_t FirstChannel; ///< First channel to be printed.
   raw::ChannelID_t LastChannel;  ///< Last channel to be printed.
@@ -244,6 +561,9 @@ geo::DumpChannelMap::DumpChannelMap(Parameters const& config)
   , DoChannelToWires(config().ChannelToWires())
   , DoWireToChannel(config().WireToChannel())
   , DoOpDetChannels(config().OpDetChannels())
+  , DoPixelChannels(config().PixelChannels())
+  , DoVerifyRoundTrips(config().VerifyRoundTrips())
+  , VerifyThreads(config().VerifyThreads())
   , FirstChannel(config().FirstChannel())
   , LastChannel(config().LastChannel())
 {}
@@ -251,13 +571,37 @@ geo::DumpChannelMap::DumpChannelMap(Parameters const& config)
 //------------------------------------------------------------------------------
 void geo::DumpChannelMap::beginRun(art::Run const&)
 {
-  geo::WireReadoutGeom const& wireReadoutGeom = art::ServiceHandle<geo::WireReadout const>()->Get();
+  geo::WireReadout const& wireReadout = *art::ServiceHandle<geo::WireReadout const>();
+  geo::WireReadoutGeom const& wireReadoutGeom = wireReadout.Get();
+  geo::PixelLattice const* pixels = wireReadout.Pixels();
 
   if (DoChannelToWires) {
     dumpChannelToWires(OutputCategory, wireReadoutGeom, FirstChannel, LastChannel);
   }
   if (DoWireToChannel) { dumpWireToChannel(OutputCategory, wireReadoutGeom); }
   if (DoOpDetChannels) { dumpOpticalDetectorChannels(OutputCategory, wireReadoutGeom); }
+  if (DoPixelChannels) {
+    if (pixels)
+      dumpChannelToPixels(OutputCategory, *pixels, FirstChannel, LastChannel);
+    else
+      mf::LogError(OutputCategory) << "The WireReadout service has no pixel readout.";
+  }
+  if (DoVerifyRoundTrips) {
+    std::size_t nErrors = verifyChannelMap(OutputCategory, wireReadoutGeom, VerifyThreads);
+    if (pixels) {
+      nErrors += verifyPixelMap(OutputCategory, *pixels, VerifyThreads);
+      if (pixels->FirstChannel() < wireReadoutGeom.Nchannels()) {
+        mf::LogError(OutputCategory)
+          << "Pixel channels start from " << pixels->FirstChannel() << ", within the "
+          << wireReadoutGeom.Nchannels() << " wire channels.";
+        ++nErrors;
+      }
+    }
+    if (nErrors) {
+      throw art::Exception(art::errors::LogicError)
+        << "Channel map has " << nErrors << " inconsistencies.\n";
+    }
+  }
 }
 
 DEFINE_ART_MODULE(geo::DumpChannelMap)
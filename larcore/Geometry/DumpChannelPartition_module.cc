@@ -0,0 +1,313 @@
+/**
+ * @file    DumpChannelPartition_module.cc
+ * @brief   Prints the split of the readout channels into balanced shards.
+ * @see     larcore/Geometry/ChannelPartition.h
+ */
+
+// LArSoft libraries
+#include "larcore/Geometry/ChannelPartition.h"
+#include "larcore/Geometry/GeometryIDRanges.h"
+#include "larcore/Geometry/WireReadout.h"
+#include "larcorealg/Geometry/PlaneGeo.h"
+#include "larcorealg/Geometry/WireReadoutGeom.h"
+#include "larcoreobj/SimpleTypesAndConstants/RawTypes.h"  // raw::ChannelID_t
+#include "larcoreobj/SimpleTypesAndConstants/geo_types.h" // geo::WireID
+
+// framework libraries
+#include "art/Framework/Core/EDAnalyzer.h"
+#include "art/Framework/Core/ModuleMacros.h"
+#include "art/Framework/Services/Registry/ServiceHandle.h"
+#include "canvas/Utilities/Exception.h"
+#include "fhiclcpp/types/Atom.h"
+#include "fhiclcpp/types/Comment.h"
+#include "fhiclcpp/types/Name.h"
+#include "fhiclcpp/types/Sequence.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+// C/C++ standard libraries
+#include <cstddef> // std::size_t
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+  //------------------------------------------------------------------------------
+  geo::ChannelPartition::Cost parseCost(std::string const& name)
+  {
+    if (name == "channels") return geo::ChannelPartition::Cost::Channels;
+    if (name == "wirelength") return geo::ChannelPartition::Cost::WireLength;
+    if (name == "weight") return geo::ChannelPartition::Cost::Weight;
+    throw art::Exception(art::errors::Configuration)
+      << "Unknown cost model '" << name << "' (choose 'channels', 'wirelength' or 'weight').\n";
+  }
+
+  //------------------------------------------------------------------------------
+  geo::ChannelPartition::Boundary parseBoundary(std::string const& name)
+  {
+    if (name == "plane") return geo::ChannelPartition::Boundary::Plane;
+    if (name == "tpc") return geo::ChannelPartition::Boundary::TPC;
+    throw art::Exception(art::errors::Configuration)
+      << "Unknown shard boundary '" << name << "' (choose 'plane' or 'tpc').\n";
+  }
+
+  //------------------------------------------------------------------------------
+  void dumpPartition(std::string const& OutputCategory,
+                     geo::ChannelPartition const& partition,
+                     std::string const& costName,
+                     std::string const& boundaryName,
+                     bool printChannels)
+  {
+    std::size_t nChannels = 0;
+    for (geo::ChannelPartition::Shard const& shard : partition.Shards())
+      nChannels += shard.nChannels;
+
+    mf::LogInfo(OutputCategory) << "Partition of " << nChannels << " channels into "
+                                << partition.NShards() << " shards of whole " << boundaryName
+                                << "s by " << costName << " cost: total cost "
+                                << partition.TotalCost() << ", imbalance "
+                                << partition.Imbalance() << ", "
+                                << (partition.MemoryUsage() / 1024) << " KiB";
+
+    double const total = partition.TotalCost();
+    mf::LogVerbatim log(OutputCategory);
+    for (unsigned int s = 0; s < partition.NShards(); ++s) {
+      geo::ChannelPartition::Shard const& shard = partition.GetShard(s);
+      log << "\n shard " << s << ": cost " << shard.cost;
+      if (total > 0.0) log << " (" << (100.0 * shard.cost / total) << "%)";
+      log << ", " << shard.nChannels << " channels in " << shard.channels.size()
+          << " ranges, " << shard.planes.size() << " planes:";
+      for (geo::PlaneID const& planeID : shard.planes)
+        log << " { " << std::string(planeID) << " }";
+      if (!printChannels) continue;
+      log << "\n   channels:";
+      for (geo::ChannelPartition::ChannelRange const& range : shard.channels)
+        log << " " << range.first << "-" << (range.end - 1);
+    }
+  }
+
+  //------------------------------------------------------------------------------
+  /// Checks that each channel of the planes is in exactly the shard of its
+  /// planes; returns the number of errors.
+  std::size_t verifyPartition(std::string const& OutputCategory,
+                              geo::ChannelPartition const& partition,
+                              geo::WireReadout const& wireReadout)
+  {
+    geo::WireReadoutGeom const& wireReadoutGeom = wireReadout.Get();
+    constexpr std::size_t MaxExamples = 10;
+
+    std::size_t nErrors = 0, nWires = 0, nChannels = 0;
+    std::vector<std::string> examples;
+    auto addError = [&nErrors, &examples](std::ostringstream const& message) {
+      if (nErrors++ < MaxExamples) examples.push_back(message.str());
+    };
+
+    for (unsigned int s = 0; s < partition.NShards(); ++s) {
+      geo::ChannelPartition::Shard const& shard = partition.GetShard(s);
+
+      // each wire of each plane of the shard has its channel in the shard
+      for (geo::PlaneID const& planeID : shard.planes) {
+        geo::PlaneGeo const& plane = wireReadoutGeom.Plane(planeID);
+        for (unsigned int w = 0; w < plane.Nwires(); ++w) {
+          ++nWires;
+          geo::WireID const wireID{planeID, w};
+          raw::ChannelID_t const channel = wireReadoutGeom.PlaneWireToChannel(wireID);
+          if (partition.ShardOf(channel) == s) continue;
+          std::ostringstream message;
+          message << "{ " << std::string(wireID) << " } of shard " << s << " -> channel "
+                  << channel << " -> shard " << partition.ShardOf(channel);
+          addError(message);
+        }
+      }
+
+      // each channel of the shard maps back to it
+      for (geo::ChannelPartition::ChannelRange const& range : shard.channels) {
+        for (raw::ChannelID_t channel = range.first; channel < range.end; ++channel) {
+          ++nChannels;
+          if (partition.ShardOf(channel) == s) continue;
+          std::ostringstream message;
+          message << "channel " << channel << " of shard " << s << " -> shard "
+                  << partition.ShardOf(channel);
+          addError(message);
+        }
+      }
+    }
+
+    // all the channels are in some shard
+    if (std::size_t const nServed =
+          geo::ChannelIDTable{wireReadout.Get(), wireReadout.Subset()}.size();
+        nChannels != nServed) {
+      std::ostringstream message;
+      message << nChannels << " channels in the shards, " << nServed << " served";
+      addError(message);
+    }
+
+    mf::LogInfo(OutputCategory) << "Partition verified: " << nWires << " wires, " << nChannels
+                                << " channels, " << nErrors << " inconsistencies";
+    if (nErrors > 0) {
+      mf::LogError log(OutputCategory);
+      log << nErrors << " inconsistencies in the partition, e.g.:";
+      for (std::string const& example : examples)
+        log << "\n  " << example;
+    }
+    return nErrors;
+  }
+
+} // local namespace
+
+namespace geo {
+  class DumpChannelPartition;
+}
+
+/** ****************************************************************************
+ * @brief Prints the split of the readout channels into balanced shards.
+ *
+ * The channels served by the `WireReadout` service (all of them, or the ones
+ * of the configured subset of the detector) are split by
+ * `geo::ChannelPartition` at the beginning of each run, and
+ * the shards are printed with their cost, channels and planes.
+ *
+ *
+ * Configuration parameters
+ * =========================
+ *
+ * - *NShards* (integer, mandatory): number of shards
+ * - *CostModel* (string, default: `channels`): cost of each channel, `channels`
+ *   (`1`), `wirelength` (total length of its wires) or `weight` (from
+ *   *PlaneWeights*)
+ * - *Boundary* (string, default: `plane`): shards are made of whole planes
+ *   (`plane`) or whole TPCs (`tpc`)
+ * - *PlaneWeights* (list of reals, default: empty): cost of the channels of
+ *   the planes of each number, for the `weight` model (e.g. `[ 2, 2, 1 ]` for
+ *   induction planes twice as expensive as the collection one); the cost of a
+ *   channel is the one of the plane of its first wire
+ * - *PrintChannels* (boolean, default: false): prints the ranges of channels
+ *   of each shard
+ * - *Verify* (boolean, default: false): checks that each wire of each shard
+ *   has its channel in that shard, that the channels of each shard map back
+ *   to it, and that all the channels are in a shard; throws an exception if
+ *   not
+ * - *OutputCategory* (string, default: DumpChannelPartition): output category
+ *   used by the message facility to output information (INFO level)
+ *
+ */
+class geo::DumpChannelPartition : public art::EDAnalyzer {
+public:
+  /// Module configuration.
+  struct Config {
+    using Name = fhicl::Name;
+    using Comment = fhicl::Comment;
+
+    fhicl::Atom<std::string> OutputCategory{
+      Name("OutputCategory"),
+      Comment("output category used by the message facility to output information (INFO level)"),
+      "DumpChannelPartition"};
+
+    fhicl::Atom<unsigned int> NShards{Name("NShards"), Comment("number of shards")};
+
+    fhicl::Atom<std::string> CostModel{
+      Name("CostModel"),
+      Comment("cost of each channel: 'channels', 'wirelength' or 'weight'"),
+      "channels"};
+
+    fhicl::Atom<std::string> Boundary{
+      Name("Boundary"),
+      Comment("shards are made of whole planes ('plane') or TPCs ('tpc')"),
+      "plane"};
+
+    fhicl::Sequence<double> PlaneWeights{
+      Name("PlaneWeights"),
+      Comment("cost of the channels of the planes of each number, for 'weight' model"),
+      std::vector<double>{}};
+
+    fhicl::Atom<bool> PrintChannels{Name("PrintChannels"),
+                                    Comment("print the ranges of channels of each shard"),
+                                    false};
+
+    fhicl::Atom<bool> Verify{
+      Name("Verify"),
+      Comment("check that each channel is in the shard of its wires, and in only one"),
+      false};
+
+  }; // Config
+
+  using Parameters = art::EDAnalyzer::Table<Config>;
+
+  explicit DumpChannelPartition(Parameters const& config);
+
+  // Plugins should not be copied or assigned.
+  DumpChannelPartition(DumpChannelPartition const&) = delete;
+  DumpChannelPartition(DumpChannelPartition&&) = delete;
+  DumpChannelPartition& operator=(DumpChannelPartition const&) = delete;
+  DumpChannelPartition& operator=(DumpChannelPartition&&) = delete;
+
+  // Required functions
+  void analyze(art::Event const&) override {}
+
+  /// Drives the dumping
+  void beginRun(art::Run const&) override;
+
+private:
+  std::string OutputCategory;        ///< Name of the category for output.
+  unsigned int NShards;              ///< Number of shards.
+  std::string CostName;              ///< Name of the cost model.
+  std::string BoundaryName;          ///< Name of the units of the shards.
+  ChannelPartition::Config Settings; ///< Cost model and units of the shards.
+  std::vector<double> PlaneWeights;  ///< Channel cost for each plane number.
+  bool DoPrintChannels;              ///< Print the channel ranges of each shard.
+  bool DoVerify;                     ///< Check the channel to shard map.
+
+}; // geo::DumpChannelPartition
+
+//------------------------------------------------------------------------------
+geo::DumpChannelPartition::DumpChannelPartition(Parameters const& config)
+  : art::EDAnalyzer(config)
+  , OutputCategory(config().OutputCategory())
+  , NShards(config().NShards())
+  , CostName(config().CostModel())
+  , BoundaryName(config().Boundary())
+  , PlaneWeights(config().PlaneWeights())
+  , DoPrintChannels(config().PrintChannels())
+  , DoVerify(config().Verify())
+{
+  Settings.cost = parseCost(CostName);
+  Settings.boundary = parseBoundary(BoundaryName);
+  if (Settings.cost == ChannelPartition::Cost::Weight && PlaneWeights.empty()) {
+    throw art::Exception(art::errors::Configuration)
+      << "The 'weight' cost model requires PlaneWeights.\n";
+  }
+}
+
+//------------------------------------------------------------------------------
+void geo::DumpChannelPartition::beginRun(art::Run const&)
+{
+  geo::WireReadout const& wireReadout = *art::ServiceHandle<geo::WireReadout const>();
+  geo::WireReadoutGeom const& wireReadoutGeom = wireReadout.Get();
+
+  ChannelPartition::Config settings = Settings;
+  if (settings.cost == ChannelPartition::Cost::Weight) {
+    settings.weight = [this, &wireReadoutGeom](raw::ChannelID_t channel) {
+      std::vector<geo::WireID> const wires = wireReadoutGeom.ChannelToWire(channel);
+      if (wires.empty()) return 0.0;
+      unsigned int const plane = wires.front().Plane;
+      if (plane >= PlaneWeights.size()) {
+        throw art::Exception(art::errors::Configuration)
+          << "PlaneWeights has no weight for plane " << plane << " (channel " << channel
+          << ").\n";
+      }
+      return PlaneWeights[plane];
+    };
+  }
+
+  ChannelPartition const partition{wireReadout.Get(), NShards, settings, wireReadout.Subset()};
+  dumpPartition(OutputCategory, partition, CostName, BoundaryName, DoPrintChannels);
+
+  if (DoVerify) {
+    if (std::size_t const nErrors = verifyPartition(OutputCategory, partition, wireReadout)) {
+      throw art::Exception(art::errors::LogicError)
+        << "Channel partition has " << nErrors << " inconsistencies.\n";
+    }
+  }
+}
+
+DEFINE_ART_MODULE(geo::DumpChannelPartition)
@@ -0,0 +1,106 @@
+/**
+ * @file    ExportChannelMap_module.cc
+ * @brief   Writes the channel map of the wire readout into a standalone file.
+ * @see     larcore/Geometry/StandaloneChannelMap.h
+ */
+
+// LArSoft libraries
+#include "larcore/Geometry/StandaloneChannelMap.h"
+#include "larcore/Geometry/StandaloneChannelMapExport.h"
+#include "larcore/Geometry/WireReadout.h"
+
+// framework libraries
+#include "art/Framework/Core/EDAnalyzer.h"
+#include "art/Framework/Core/ModuleMacros.h"
+#include "art/Framework/Services/Registry/ServiceHandle.h"
+#include "fhiclcpp/types/Atom.h"
+#include "fhiclcpp/types/Comment.h"
+#include "fhiclcpp/types/Name.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+// C/C++ standard libraries
+#include <string>
+
+namespace geo {
+  class ExportChannelMap;
+}
+
+/** ****************************************************************************
+ * @brief Writes the channel map of the wire readout into a standalone file.
+ *
+ * At the beginning of each run, the planes and the channel of each wire of
+ * the `WireReadout` service are written into a file that
+ * `geo::StandaloneChannelMap::Load()` reads without art, ROOT or the geometry
+ * libraries (e.g. in trigger and DAQ decoders). The whole detector is
+ * exported, even when the services serve a subset of it.
+ *
+ *
+ * Configuration parameters
+ * =========================
+ *
+ * - *FileName* (string, mandatory): path of the channel map file to write
+ * - *OutputCategory* (string, default: ExportChannelMap): output category
+ *   used by the message facility to output information (INFO level)
+ *
+ */
+class geo::ExportChannelMap : public art::EDAnalyzer {
+public:
+  /// Module configuration.
+  struct Config {
+    using Name = fhicl::Name;
+    using Comment = fhicl::Comment;
+
+    fhicl::Atom<std::string> FileName{Name("FileName"),
+                                      Comment("path of the channel map file to write")};
+
+    fhicl::Atom<std::string> OutputCategory{
+      Name("OutputCategory"),
+      Comment("output category used by the message facility to output information (INFO level)"),
+      "ExportChannelMap"};
+
+  }; // Config
+
+  using Parameters = art::EDAnalyzer::Table<Config>;
+
+  explicit ExportChannelMap(Parameters const& config);
+
+  // Plugins should not be copied or assigned.
+  ExportChannelMap(ExportChannelMap const&) = delete;
+  ExportChannelMap(ExportChannelMap&&) = delete;
+  ExportChannelMap& operator=(ExportChannelMap const&) = delete;
+  ExportChannelMap& operator=(ExportChannelMap&&) = delete;
+
+  // Required functions
+  void analyze(art::Event const&) override {}
+
+  /// Writes the file.
+  void beginRun(art::Run const&) override;
+
+private:
+  std::string FileName;       ///< Path of the channel map file.
+  std::string OutputCategory; ///< Name of the category for output.
+
+}; // geo::ExportChannelMap
+
+//------------------------------------------------------------------------------
+geo::ExportChannelMap::ExportChannelMap(Parameters const& config)
+  : art::EDAnalyzer(config)
+  , FileName(config().FileName())
+  , OutputCategory(config().OutputCategory())
+{}
+
+//------------------------------------------------------------------------------
+void geo::ExportChannelMap::beginRun(art::Run const&)
+{
+  geo::WireReadout const& wireReadout = *art::ServiceHandle<geo::WireReadout const>();
+  StandaloneChannelMap const channelMap = exportChannelMap(wireReadout.Get());
+  channelMap.Save(FileName);
+
+  mf::LogInfo(OutputCategory) << "Channel map of " << channelMap.Nchannels() << " channels, "
+                              << channelMap.Planes().size() << " planes and "
+                              << channelMap.NWires() << " wires written into '" << FileName
+                              << "' (" << (channelMap.MemoryUsage() / 1024)
+                              << " KiB in memory)";
+}
+
+DEFINE_ART_MODULE(geo::ExportChannelMap)
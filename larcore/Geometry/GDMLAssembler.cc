@@ -0,0 +1,245 @@
+/**
+ * @file   larcore/Geometry/GDMLAssembler.cc
+ * @brief  Assembles a GDML detector description from GDML fragments.
+ * @see    larcore/Geometry/GDMLAssembler.h
+ */
+
+// library header
+#include "larcore/Geometry/GDMLAssembler.h"
+
+// framework libraries
+#include "cetlib_except/exception.h"
+
+// C/C++ standard libraries
+#include <algorithm> // std::find_if()
+#include <cctype>    // std::isalnum(), std::isdigit(), std::isspace()
+#include <fstream>
+#include <iterator> // std::istreambuf_iterator
+#include <ostream>
+#include <sstream>
+
+namespace {
+
+  // the GDML sections merged from the fragments, in output order
+  constexpr char const* Sections[] = {"define", "materials", "solids", "structure"};
+  constexpr std::size_t NSections = std::size(Sections);
+
+  // ---------------------------------------------------------------------------
+  std::string readFile(std::string const& path)
+  {
+    std::ifstream in{path};
+    if (!in) {
+      throw cet::exception("GDMLAssembler") << "Could not open file '" << path << "' for read.\n";
+    }
+    return {std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+  }
+
+  // ---------------------------------------------------------------------------
+  std::string trim(std::string const& s)
+  {
+    auto const isSpace = [](unsigned char c) { return std::isspace(c); };
+    auto const b = std::find_if_not(s.begin(), s.end(), isSpace);
+    auto const e = std::find_if_not(s.rbegin(), s.rend(), isSpace).base();
+    return (b < e) ? std::string{b, e} : std::string{};
+  }
+
+  // ---------------------------------------------------------------------------
+  std::string removeComments(std::string text)
+  {
+    std::size_t start = 0;
+    while ((start = text.find("<!--", start)) != std::string::npos) {
+      std::size_t const end = text.find("-->", start);
+      text.erase(start, (end == std::string::npos) ? end : end + 3 - start);
+    }
+    return text;
+  }
+
+  // ---------------------------------------------------------------------------
+  // Returns the content of all `<tag>...</tag>` blocks in `text`, in order.
+  std::vector<std::string> blocks(std::string const& text, std::string const& tag)
+  {
+    std::string const open = "<" + tag + ">", close = "</" + tag + ">";
+    std::vector<std::string> found;
+    std::size_t pos = 0;
+    while ((pos = text.find(open, pos)) != std::string::npos) {
+      pos += open.length();
+      std::size_t const end = text.find(close, pos);
+      if (end == std::string::npos) break;
+      found.push_back(text.substr(pos, end - pos));
+      pos = end + close.length();
+    }
+    return found;
+  }
+
+  // ---------------------------------------------------------------------------
+  // Returns the value of the attribute `name` in `element` (empty if none).
+  std::string attribute(std::string const& element, std::string const& name)
+  {
+    std::string const key = name + "=\"";
+    std::size_t const start = element.find(key);
+    if (start == std::string::npos) return {};
+    std::size_t const end = element.find('"', start + key.length());
+    return element.substr(start + key.length(), end - start - key.length());
+  }
+
+  // ---------------------------------------------------------------------------
+  std::string directoryOf(std::string const& path)
+  {
+    std::size_t const slash = path.rfind('/');
+    return (slash == std::string::npos) ? std::string{} : path.substr(0, slash + 1);
+  }
+
+  // ---------------------------------------------------------------------------
+  bool isWordChar(char c)
+  {
+    return std::isalnum(static_cast<unsigned char>(c)) || (c == '_');
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+geo::GDMLAssembler::GDMLAssembler(std::string const& fragmentListPath) : fSections(NSections)
+{
+  fInputFiles.push_back(fragmentListPath);
+  std::string const list = removeComments(readFile(fragmentListPath));
+
+  if (std::size_t const config = list.find("<config"); config != std::string::npos) {
+    fDetectorName = attribute(list.substr(config, list.find('>', config) - config), "detector");
+  }
+
+  auto const fragmentPath = [baseDir = directoryOf(fragmentListPath)](std::string name) {
+    name = trim(name);
+    return (name.empty() || (name.front() == '/')) ? name : baseDir + name;
+  };
+
+  for (std::string const& group : blocks(list, "constantfiles")) {
+    for (std::string const& name : blocks(group, "filename")) {
+      fInputFiles.push_back(fragmentPath(name));
+      readConstants(fInputFiles.back());
+    }
+  }
+  for (std::string const& group : blocks(list, "gdmlfiles")) {
+    for (std::string const& name : blocks(group, "filename")) {
+      fInputFiles.push_back(fragmentPath(name));
+      readFragment(fInputFiles.back());
+    }
+  }
+
+  for (std::size_t i = 0; i < fConstants.size(); ++i)
+    fConstantIndex[fConstants[i].first].push_back(i);
+}
+
+//------------------------------------------------------------------------------
+std::string geo::GDMLAssembler::assemble() const
+{
+  std::ostringstream out;
+  out << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>"
+         "\n<gdml xmlns:gdml=\"http://cern.ch/2001/Schemas/GDML\""
+         "\n      xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\""
+         "\n      xsi:noNamespaceSchemaLocation=\"GDMLSchema/gdml.xsd\">\n";
+
+  std::vector<std::string> cache(fConstants.size());
+  for (std::size_t iSection = 0; iSection < NSections; ++iSection) {
+    out << "<" << Sections[iSection] << ">"
+        << substituteConstants(fSections[iSection], fConstants.size(), cache) << "</"
+        << Sections[iSection] << ">\n";
+  }
+
+  out << "\n<setup name=\"Default\" version=\"1.0\">"
+         "\n  <world ref=\"volWorld\" />"
+         "\n</setup>"
+         "\n\n</gdml>\n";
+  return out.str();
+}
+
+//------------------------------------------------------------------------------
+void geo::GDMLAssembler::writeGDML(std::string const& path) const
+{
+  std::ofstream out{path};
+  if (!out) {
+    throw cet::exception("GDMLAssembler") << "Could not open '" << path << "' for writing.\n";
+  }
+  out << assemble();
+  if (!out) {
+    throw cet::exception("GDMLAssembler") << "Error while writing '" << path << "'.\n";
+  }
+}
+
+//------------------------------------------------------------------------------
+void geo::GDMLAssembler::writeDependencies(std::ostream& out,
+                                           std::vector<std::string> const& targets) const
+{
+  for (std::string const& target : targets)
+    out << target << " ";
+  out << ":";
+  for (std::string const& input : fInputFiles)
+    out << " \\\n  " << input;
+  out << "\n";
+}
+
+//------------------------------------------------------------------------------
+void geo::GDMLAssembler::readConstants(std::string const& path)
+{
+  // like make_gdml.pl, one definition per line: <constant name="..." value="..." />
+  std::istringstream lines{readFile(path)};
+  for (std::string line; std::getline(lines, line);) {
+    std::string const element = trim(line);
+    if (element.compare(0, 10, "<constant ") != 0) continue;
+    fConstants.emplace_back(attribute(element, "name"), attribute(element, "value"));
+  }
+}
+
+//------------------------------------------------------------------------------
+void geo::GDMLAssembler::readFragment(std::string const& path)
+{
+  std::string const text = readFile(path);
+  for (std::size_t iSection = 0; iSection < NSections; ++iSection) {
+    for (std::string const& block : blocks(text, Sections[iSection]))
+      fSections[iSection] += block;
+  }
+}
+
+//------------------------------------------------------------------------------
+std::string geo::GDMLAssembler::substituteConstants(std::string const& text,
+                                                    std::size_t limit,
+                                                    std::vector<std::string>& cache) const
+{
+  std::string result;
+  result.reserve(text.size());
+
+  auto it = text.begin();
+  while (it != text.end()) {
+    if (!isWordChar(*it)) {
+      result += *it++;
+      continue;
+    }
+    auto const wordEnd = std::find_if_not(it, text.end(), isWordChar);
+    std::string const word{it, wordEnd};
+    it = wordEnd;
+
+    // numbers (including e.g. `1e3`) are not constant names
+    auto const iIndex = std::isdigit(static_cast<unsigned char>(word.front())) ?
+                          fConstantIndex.end() :
+                          fConstantIndex.find(word);
+    if (iIndex == fConstantIndex.end()) {
+      result += word;
+      continue;
+    }
+
+    // the latest definition before `limit` wins
+    auto const& indices = iIndex->second;
+    auto const iDef = std::find_if(
+      indices.rbegin(), indices.rend(), [limit](std::size_t i) { return i < limit; });
+    if (iDef == indices.rend()) {
+      result += word;
+      continue;
+    }
+
+    std::string& value = cache[*iDef];
+    if (value.empty()) {
+      value = "(" + substituteConstants(fConstants[*iDef].second, *iDef, cache) + ")";
+    }
+    result += value;
+  }
+  return result;
+}
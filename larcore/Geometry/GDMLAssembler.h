@@ -0,0 +1,96 @@
+/**
+ * @file   larcore/Geometry/GDMLAssembler.h
+ * @brief  Assembles a GDML detector description from GDML fragments.
+ * @see    larcore/Geometry/GDMLAssembler.cc
+ *
+ * This is the compiled counterpart of `make_gdml.pl` in `larcore/Geometry/gdml`.
+ */
+
+#ifndef LARCORE_GEOMETRY_GDMLASSEMBLER_H
+#define LARCORE_GEOMETRY_GDMLASSEMBLER_H
+
+// C/C++ standard libraries
+#include <cstddef> // std::size_t
+#include <iosfwd>
+#include <string>
+#include <unordered_map>
+#include <utility> // std::pair
+#include <vector>
+
+namespace geo {
+
+  /**
+   * @brief Builds a GDML file out of a list of GDML fragments.
+   *
+   * The input is a fragment list in the same XML format accepted by
+   * `make_gdml.pl` (e.g. `bo-gdml-fragments.xml`):
+   *
+   *     <config detector="bo">
+   *       <constantfiles> <filename> global-defs.gdml </filename> ... </constantfiles>
+   *       <gdmlfiles> <filename> materials.gdml </filename> ... </gdmlfiles>
+   *     </config>
+   *
+   * The files in the list are relative to the directory of the list itself,
+   * unless they are absolute paths.
+   *
+   * The output is equivalent to the one of `make_gdml.pl`:
+   *  * all the `<constant>` definitions from the constant files are
+   *    substituted, each surrounded by parentheses, into the GDML text;
+   *  * the `<define>`, `<materials>`, `<solids>` and `<structure>` sections
+   *    of all GDML fragments are merged, in this order, into a single GDML
+   *    document, with `volWorld` as world volume.
+   *
+   * Constants are substituted as whole identifiers in a single pass over the
+   * text, rather than with one text replacement per constant: a constant whose
+   * name is the prefix of another one is never substituted into the latter.
+   * A constant value may use only constants defined before it.
+   * Sections appearing more than once in a fragment are kept in file order.
+   */
+  class GDMLAssembler {
+  public:
+    /// Reads the fragment list at `fragmentListPath` and all the fragments in it.
+    /// @throw cet::exception (category: `GDMLAssembler`) if any file is unreadable
+    explicit GDMLAssembler(std::string const& fragmentListPath);
+
+    /// Returns the detector name in the fragment list (may be empty).
+    std::string const& detectorName() const { return fDetectorName; }
+
+    /// Returns the path of all the files the output depends on.
+    std::vector<std::string> const& inputFiles() const { return fInputFiles; }
+
+    /// Returns the assembled GDML document.
+    std::string assemble() const;
+
+    /// Writes the assembled GDML document into the file `path`.
+    void writeGDML(std::string const& path) const;
+
+    /// Writes a Makefile-style dependency rule for `targets` (as `DEPFILE`).
+    void writeDependencies(std::ostream& out, std::vector<std::string> const& targets) const;
+
+  private:
+    using Constant_t = std::pair<std::string, std::string>; ///< Name and value.
+
+    std::string fDetectorName;             ///< Name of the detector in the list.
+    std::vector<std::string> fInputFiles;  ///< Fragment list and all fragments.
+    std::vector<Constant_t> fConstants;    ///< All constants, in definition order.
+    std::vector<std::string> fSections;    ///< Merged text of each section.
+
+    /// Definitions (indices in `fConstants`) of each constant name.
+    std::unordered_map<std::string, std::vector<std::size_t>> fConstantIndex;
+
+    /// Parses a file with `<constant>` definitions.
+    void readConstants(std::string const& path);
+
+    /// Extracts and merges the sections of a GDML fragment.
+    void readFragment(std::string const& path);
+
+    /// Returns `text` with the constants (defined before `limit`) substituted.
+    std::string substituteConstants(std::string const& text,
+                                    std::size_t limit,
+                                    std::vector<std::string>& cache) const;
+
+  }; // class GDMLAssembler
+
+} // namespace geo
+
+#endif // LARCORE_GEOMETRY_GDMLASSEMBLER_H
@@ -10,33 +10,152 @@
 
 // LArSoft includes
 #include "larcore/CoreUtils/ServiceUtil.h"
+#include "larcore/Geometry/PrebuiltGeometry.h"
+#include "larcore/Geometry/SlimGeometry.h"
 #include "larcorealg/CoreUtils/SearchPathPlusRelative.h"
 #include "larcorealg/Geometry/GeoObjectSorter.h"
+#include "larcorealg/Geometry/GeometryBuilder.h"
 #include "larcorealg/Geometry/GeometryBuilderStandard.h"
 #include "larcoreobj/SummaryData/GeometryConfigurationInfo.h"
 
 // Framework includes
 #include "art/Utilities/make_tool.h"
+#include "cetlib/filesystem.h"
+#include "cetlib_except/exception.h"
 #include "fhiclcpp/ParameterSet.h"
 #include "messagefacility/MessageLogger/MessageLogger.h"
 
 // C/C++ standard libraries
+#include <memory>
 #include <string>
 #include <utility> // std::move()
+#include <vector>
 
 // check that the requirements for geo::Geometry are satisfied
 template struct lar::details::ServiceRequirementsChecker<geo::Geometry>;
 
+namespace {
+
+  // Returns the path of `fileName`, either as is or from the search path.
+  std::string findGeometryFile(std::string const& relPath, std::string const& fileName)
+  {
+    if (cet::file_exists(fileName)) return fileName;
+    return lar::searchPathPlusRelative(relPath, fileName);
+  }
+
+} // local namespace
+
+//......................................................................
+std::unique_ptr<geo::GeometryBuilder> geo::details::prepareGeometry(
+  fhicl::ParameterSet const& pset)
+{
+  auto const builderConfig = pset.get<fhicl::ParameterSet>("Builder", {});
+  auto const prebuilt = pset.get<std::string>("PrebuiltROOT", "");
+  auto const relPath = pset.get<std::string>("RelativePath", "");
+  bool const slim = pset.get<bool>("Slim", false);
+
+  // a builder tool may replace the ROOT geometry on construction
+  // (e.g. geo::GeometryBuilderParametric), discarding the one loaded here
+  if (builderConfig.has_key("tool_type") && (slim || !prebuilt.empty())) {
+    throw cet::exception("Geometry")
+      << "The geometry builder tool '" << builderConfig.get<std::string>("tool_type")
+      << "' can't be used with a PrebuiltROOT or Slim geometry.\n";
+  }
+
+  if (slim) {
+    if (!prebuilt.empty()) {
+      throw cet::exception("Geometry")
+        << "Slim geometry mode can't be used with a PrebuiltROOT geometry ('" << prebuilt
+        << "').\n";
+    }
+    std::string const gdmlPath = findGeometryFile(relPath, pset.get<std::string>("GDML"));
+    geo::SlimGeometryStats const stats =
+      geo::LoadSlimGeometry(gdmlPath, pset.get<bool>("SlimKeepAuxDets", true));
+    mf::LogInfo("Geometry") << "Loaded slim geometry from '" << gdmlPath << "': "
+                            << stats.slimNodes << "/" << stats.fullNodes
+                            << " physical volumes kept (" << stats.removedNodes
+                            << " placements removed, " << stats.placeholderVolumes
+                            << " volumes with placeholder material) in " << stats.loadSeconds
+                            << " s, " << stats.residentKiB << " KiB of resident memory";
+  }
+  else if (!prebuilt.empty()) {
+    std::string const rootPath = findGeometryFile(relPath, prebuilt);
+    if (pset.get<bool>("CheckPrebuiltROOT", true)) {
+      geo::CheckPrebuiltGeometry(rootPath,
+                                 findGeometryFile(relPath, pset.get<std::string>("GDML")));
+    }
+    else {
+      mf::LogWarning("Geometry") << "Prebuilt geometry '" << rootPath
+                                 << "' is used without checking it against the GDML file.";
+    }
+
+    geo::LoadPrebuiltGeometry(rootPath);
+    mf::LogInfo("Geometry") << "Loaded prebuilt ROOT geometry from '" << rootPath << "'";
+  }
+
+  if (!builderConfig.has_key("tool_type"))
+    return std::make_unique<geo::GeometryBuilderStandard>(builderConfig);
+  return art::make_tool<geo::GeometryBuilder>(builderConfig);
+}
+
+//......................................................................
+geo::GeometrySubset geo::details::makeGeometrySubset(GeometryCore const& geom,
+                                                     fhicl::ParameterSet const& pset)
+{
+  std::vector<geo::CryostatID> cryostats;
+  for (unsigned int const c : pset.get<std::vector<unsigned int>>("Cryostats", {}))
+    cryostats.emplace_back(c);
+
+  std::vector<geo::TPCID> tpcs;
+  for (auto const& id : pset.get<std::vector<std::vector<unsigned int>>>("TPCs", {})) {
+    if (id.size() != 2) {
+      throw cet::exception("Geometry")
+        << "Subset.TPCs entries must be [ cryostat, TPC ] pairs (" << id.size()
+        << " numbers found).\n";
+    }
+    tpcs.emplace_back(id[0], id[1]);
+  }
+
+  geo::GeometrySubset subset{geom, cryostats, tpcs};
+  if (!subset.isFull()) {
+    mf::LogInfo("Geometry") << "Serving " << subset.TPCIDs().size() << " of "
+                            << subset.NAllTPCs() << " TPCs in "
+                            << subset.CryostatIDs().size() << " cryostats.";
+  }
+  return subset;
+}
+
 //......................................................................
 geo::Geometry::Geometry(fhicl::ParameterSet const& pset)
+  : Geometry{pset, details::prepareGeometry(pset)}
+{}
+
+//......................................................................
+geo::Geometry::Geometry(fhicl::ParameterSet const& pset,
+                        std::unique_ptr<GeometryBuilder> builder)
   : GeometryCore{
       pset,
-      std::make_unique<GeometryBuilderStandard>(pset.get<fhicl::ParameterSet>("Builder", {})),
+      std::move(builder),
       art::make_tool<GeoObjectSorter>(pset.get<fhicl::ParameterSet>("SortingParameters", {}))}
+  , fSlim{pset.get<bool>("Slim", false)}
+  , fNavigators{ROOTGeoManager(), pset.get<unsigned int>("MaxNavigationThreads", 0)}
+  , fCursors{*this, pset.get<double>("PositionEpsilon", GeometryCursor::DefaultPositionEpsilon)}
+  , fSubset{details::makeGeometrySubset(*this, pset.get<fhicl::ParameterSet>("Subset", {}))}
+  , fCryostatIDs{*this, [this](CryostatID const& id) { return fSubset.Contains(id); }}
+  , fTPCIDs{*this, [this](TPCID const& id) { return fSubset.Contains(id); }}
 {
   FillGeometryConfigurationInfo(pset);
 }
 
+//......................................................................
+void geo::Geometry::throwSlimModeQuery(char const* query) const
+{
+  throw cet::exception("Geometry")
+    << "geo::Geometry::" << query << " met the placeholder material '"
+    << SlimPlaceholderMaterial << "' of the volumes removed in Slim mode."
+    << " Set `Slim: false` to enable material queries there.\n";
+}
+
 //......................................................................
 void geo::Geometry::FillGeometryConfigurationInfo(fhicl::ParameterSet const& config)
 {
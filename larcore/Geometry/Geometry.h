@@ -9,6 +9,12 @@
 #define LARCORE_GEOMETRY_GEOMETRY_H
 
 // LArSoft libraries
+#include "larcore/Geometry/GeometryCursor.h"
+#include "larcore/Geometry/GeometryIDRanges.h"
+#include "larcore/Geometry/GeometryQueryProbe.h"
+#include "larcore/Geometry/GeometrySubset.h"
+#include "larcore/Geometry/NavigatorPool.h"
+#include "larcore/Geometry/SlimGeometry.h"
 #include "larcorealg/Geometry/GeometryCore.h"
 #include "larcoreobj/SummaryData/GeometryConfigurationInfo.h"
 
@@ -16,8 +22,33 @@
 #include "art/Framework/Services/Registry/ServiceDeclarationMacros.h"
 #include "fhiclcpp/fwd.h"
 
+// C/C++ standard libraries
+#include <cmath>  // std::isnan()
+#include <memory> // std::unique_ptr
+#include <string>
+
 namespace geo {
 
+  class GeometryBuilder;
+
+  namespace details {
+
+    /**
+     * @brief Prepares the construction of a `GeometryCore` from `pset`.
+     * @return the builder configured in the `Builder` parameter set
+     * @throw cet::exception if a `Builder` tool is configured together with
+     *        `PrebuiltROOT` or `Slim`
+     *
+     * The `PrebuiltROOT` or `Slim` geometry, if configured, is loaded first,
+     * and only then the builder is created.
+     */
+    std::unique_ptr<GeometryBuilder> prepareGeometry(fhicl::ParameterSet const& pset);
+
+    /// Returns the subset of `geom` configured in `pset` (the `Subset` parameter set).
+    GeometrySubset makeGeometrySubset(GeometryCore const& geom, fhicl::ParameterSet const& pset);
+
+  } // namespace details
+
   /**
    * @brief The geometry of one entire detector, as served by art
    *
@@ -31,12 +62,106 @@ namespace geo {
    * parameters are supported:
    *
    * - *Builder* (a parameter set: default: empty): configuration for the geometry
-   *   builder; if omitted, the standard builder (`geo::GeometryBuilderStandard`) with
-   *   standard configuration will be used; if specified, currently the standard builder
-   *   is nevertheless used; this interface can be "toolized", in which case this
-   *   parameter set will select and configure the chosen tool.
+   *   builder; if it contains a `tool_type`, the builder is the _art_ tool so chosen
+   *   and configured (e.g. `geo::GeometryBuilderParametric`, which constructs the
+   *   geometry from parameters rather than from the GDML file); otherwise, the standard
+   *   builder (`geo::GeometryBuilderStandard`) is used with this configuration.
+   *   A builder tool can't be used together with `PrebuiltROOT` or `Slim`.
    * - *SortingParameters* (a parameter set; default: empty): this configuration is used
    *   to create a GeoObjectSorter tool, which sorts the LArSoft geometry objects.
+   * - *PrebuiltROOT* (string, default: empty): ROOT file with the geometry already
+   *   converted from the GDML file by `gdml_to_root`; if specified, the ROOT geometry
+   *   is loaded from it, skipping the parsing of the GDML file, which is still served
+   *   (e.g. to Geant4) as `GDMLFile()`. The file is looked for as is first, then with
+   *   `RelativePath` in the `FW_SEARCH_PATH` like the GDML file.
+   * - *CheckPrebuiltROOT* (boolean, default: `true`): verifies that the checksum of the
+   *   GDML file matches the one recorded in the `PrebuiltROOT` file, and throws an
+   *   exception if it does not.
+   * - *MaxNavigationThreads* (integer, default: `0`): number of threads which
+   *   get their own ROOT navigator for the point queries of this service (see
+   *   "Point queries" below); `0` keeps the single navigator of the geometry.
+   * - *Slim* (boolean, default: `false`): loads only the volumes needed by the
+   *   readout (TPC, planes, wires, optical detectors, auxiliary detectors and
+   *   their ancestors) and drops all the passive ones (see
+   *   `geo::LoadSlimGeometry()`); `VolumeName()` and `FindNode()` only see the
+   *   kept volumes. The ancestors which lost daughters have the placeholder
+   *   material `geo::SlimPlaceholderMaterial`, with a density which is not a
+   *   number: material queries through this service throw an exception where
+   *   they meet it, and the same queries through `provider()` return the
+   *   placeholder material or a NaN column density. Not compatible with
+   *   `PrebuiltROOT`.
+   * - *SlimKeepAuxDets* (boolean, default: `true`): keeps the auxiliary detectors
+   *   in `Slim` mode.
+   * - *Subset* (a parameter set; default: empty): restricts the job to a part
+   *   of the detector (see "Partial detector" below), with `Cryostats` (list of
+   *   cryostat numbers, all of their TPCs) and `TPCs` (list of `[ cryostat, TPC ]`
+   *   pairs); empty selects the whole detector.
+   *
+   * Point queries
+   * ==============
+   *
+   * The queries at a point navigating the ROOT geometry (`VolumeName()`,
+   * `Material()`, `MassBetweenPoints()`, `FindNode()`) are served through a
+   * `geo::NavigatorPool`, and can be called concurrently through this service.
+   * By default they share the single navigator of the geometry, one query at a
+   * time. With `MaxNavigationThreads` set, each of that many threads gets its
+   * own navigator and their queries run concurrently; the queries from further
+   * threads are served one at a time.
+   *
+   * @note The pool serves only the calls on this service. The same queries on
+   *       the service provider (`provider()`, or any `geo::GeometryCore const&`)
+   *       are the ones of `geo::GeometryCore`, which use the current navigator
+   *       of `gGeoManager`. By default that is the single navigator, usable
+   *       from any thread but not concurrently. With `MaxNavigationThreads`
+   *       set, the ROOT geometry is in multi-thread mode and those queries work
+   *       only in threads that already made a query through the service, which
+   *       creates the navigator of the thread: jobs using them, or `gGeoManager`
+   *       directly, should keep the default.
+   *
+   * Finding the TPC or cryostat at a point can be sped up for spatially coherent
+   * sequences of points (e.g. along a track) by first checking the volume found
+   * by the previous query: `FindTPCAtPositionHinted()` and the similar methods
+   * use a `geo::GeometryCursor` remembering the last volume for each thread, and
+   * `hintStatistics()` reports how often the remembered volume was the answer.
+   * Their answers are always the ones of the queries without hint.
+   * Callers can also manage the locality on their own with a cursor from
+   * `makeCursor()`.
+   *
+   * All the queries above, and the queries of the TPC and cryostat at a
+   * position (`FindTPCAtPosition()`, `PositionToTPCID()`, `PositionToTPCptr()`,
+   * `PositionToTPC()` and the cryostat ones), are reported to the
+   * `GeometryQueryMonitor` service, if it is configured (see
+   * `geo::QueryProbe`). The same queries through `provider()` are not.
+   *
+   * Parallel loops
+   * ===============
+   *
+   * `CryostatIDs()` and `TPCIDs()` return random access ranges of the IDs, in
+   * the same order as `Iterate<geo::CryostatID>()` and `Iterate<geo::TPCID>()`,
+   * which C++17 parallel algorithms and `tbb::parallel_for()` can split among
+   * threads (see `geo::IDRange`). The tables of planes, wires and channels are
+   * built on the readout geometry of the `geo::WireReadout` service (see
+   * `geo::ReadoutIDTables`).
+   *
+   * Partial detector
+   * =================
+   *
+   * With a `Subset` configured, `Subset()` tells which cryostats and TPCs the
+   * job works on, keeping the IDs of the whole detector, and `Subset().Require()`
+   * throws for IDs out of it. `CryostatIDs()` and `TPCIDs()` only cover the
+   * subset, and the `geo::WireReadout` service restricts its tables to it.
+   *
+   * Everything else still describes the whole detector: the queries of a
+   * cryostat or TPC, by ID or by position, answer for all of them, and the
+   * callers restricting their work to the subset check with `Subset()`. The
+   * memory and the start-up time of the geometry are not reduced either.
+   *
+   * @note Building only the selected TPCs is blocked on larcorealg:
+   *       `geo::GeometryCore` and `geo::WireReadoutGeom` build all the
+   *       cryostats, TPCs and wires of the GDML file, with a numbering which
+   *       depends on all of them, and offer no way to skip part of them. Until
+   *       they do, only the tables built by this and the `geo::WireReadout`
+   *       service shrink with the subset.
    */
 
   class Geometry : public GeometryCore {
@@ -51,7 +176,180 @@ namespace geo {
     /// Returns the current geometry configuration information.
     sumdata::GeometryConfigurationInfo const& configurationInfo() const { return fConfInfo; }
 
+    // --- BEGIN -- Thread-safe point queries ----------------------------------
+    /// @name Thread-safe point queries
+    /// @{
+
+    /// Returns the deepest ROOT geometry node containing `point`.
+    TGeoNode const* FindNode(Point_t const& point) const
+    {
+      QueryProbe<GeometryQuery::FindNode> const probe{point};
+      return fNavigators.FindNode(point);
+    }
+
+    /// Returns the name of the deepest volume containing `point`.
+    std::string VolumeName(Point_t const& point) const
+    {
+      QueryProbe<GeometryQuery::VolumeName> const probe{point};
+      return fNavigators.VolumeName(point);
+    }
+
+    /// Returns the material at `point` (`nullptr` if none).
+    /// @throw cet::exception (category: `Geometry`) in `Slim` mode, at a point
+    ///        whose material was removed
+    TGeoMaterial const* Material(Point_t const& point) const
+    {
+      QueryProbe<GeometryQuery::Material> const probe{point};
+      TGeoMaterial const* material = fNavigators.Material(point);
+      if (fSlim && isSlimPlaceholder(material)) throwSlimModeQuery("Material()");
+      return material;
+    }
+
+    /// Returns the column density [g/cm^2] along the segment from `p1` to `p2`.
+    /// @throw cet::exception (category: `Geometry`) in `Slim` mode, if the
+    ///        segment crosses volumes whose material was removed
+    double MassBetweenPoints(Point_t const& p1, Point_t const& p2) const
+    {
+      QueryProbe<GeometryQuery::MassBetweenPoints> const probe{p1, p2};
+      double const mass = fNavigators.MassBetweenPoints(p1, p2);
+      if (fSlim && std::isnan(mass)) throwSlimModeQuery("MassBetweenPoints()");
+      return mass;
+    }
+
+    /// Returns whether only the volumes needed by the readout are loaded.
+    bool isSlim() const { return fSlim; }
+
+    /// Returns the pool of navigators serving the point queries.
+    NavigatorPool const& navigators() const { return fNavigators; }
+
+    /// @}
+    // --- END -- Thread-safe point queries ------------------------------------
+
+    // --- BEGIN -- Hinted point queries ---------------------------------------
+    /// @name Point queries starting from the last volume found by the thread
+    /// @{
+
+    /// Returns the TPC containing `point` (`nullptr` if none).
+    TPCGeo const* PositionToTPCptrHinted(Point_t const& point) const
+    {
+      QueryProbe<GeometryQuery::FindTPCHinted> const probe{point};
+      return fCursors.local().PositionToTPCptr(point);
+    }
+
+    /// Returns the ID of the TPC containing `point` (invalid if none).
+    TPCID FindTPCAtPositionHinted(Point_t const& point) const
+    {
+      QueryProbe<GeometryQuery::FindTPCHinted> const probe{point};
+      return fCursors.local().FindTPCAtPosition(point);
+    }
+
+    /// Returns the cryostat containing `point` (`nullptr` if none).
+    CryostatGeo const* PositionToCryostatPtrHinted(Point_t const& point) const
+    {
+      QueryProbe<GeometryQuery::FindCryostatHinted> const probe{point};
+      return fCursors.local().PositionToCryostatPtr(point);
+    }
+
+    /// Returns the ID of the cryostat containing `point` (invalid if none).
+    CryostatID PositionToCryostatIDHinted(Point_t const& point) const
+    {
+      QueryProbe<GeometryQuery::FindCryostatHinted> const probe{point};
+      return fCursors.local().PositionToCryostatID(point);
+    }
+
+    /// Returns the hits and misses of the hinted queries of all threads.
+    GeometryCursor::Stats hintStatistics() const { return fCursors.stats(); }
+
+    /// Returns a new cursor, for callers managing their own locality.
+    GeometryCursor makeCursor() const { return fCursors.makeCursor(); }
+
+    /// @}
+    // --- END -- Hinted point queries -----------------------------------------
+
+    // --- BEGIN -- Ranges for parallel loops ----------------------------------
+    /// @name Ranges of IDs for parallel loops
+    /// @{
+
+    /// Returns all the cryostat IDs of the subset, split by TBB down to `grainSize` IDs.
+    IDRange<IDList<CryostatID>> CryostatIDs(std::size_t grainSize = 1) const
+    {
+      return IDRange{fCryostatIDs, grainSize};
+    }
+
+    /// Returns all the TPC IDs of the subset, split by TBB down to `grainSize` IDs.
+    IDRange<IDList<TPCID>> TPCIDs(std::size_t grainSize = 1) const
+    {
+      return IDRange{fTPCIDs, grainSize};
+    }
+
+    /// @}
+    // --- END -- Ranges for parallel loops ------------------------------------
+
+    /// Returns the cryostats and TPCs served to this job.
+    GeometrySubset const& Subset() const { return fSubset; }
+
+    // --- BEGIN -- Monitored position queries ---------------------------------
+    /// @name Queries of TPC and cryostat at a position, reported to the monitor
+    /// @{
+
+    /// Returns the ID of the TPC containing `point` (invalid if none).
+    TPCID FindTPCAtPosition(Point_t const& point) const
+    {
+      QueryProbe<GeometryQuery::FindTPC> const probe{point};
+      return GeometryCore::FindTPCAtPosition(point);
+    }
+
+    /// Returns the ID of the TPC containing `point` (invalid if none).
+    TPCID PositionToTPCID(Point_t const& point) const
+    {
+      QueryProbe<GeometryQuery::FindTPC> const probe{point};
+      return GeometryCore::PositionToTPCID(point);
+    }
+
+    /// Returns the TPC containing `point` (`nullptr` if none).
+    TPCGeo const* PositionToTPCptr(Point_t const& point) const
+    {
+      QueryProbe<GeometryQuery::FindTPC> const probe{point};
+      return GeometryCore::PositionToTPCptr(point);
+    }
+
+    /// Returns the TPC containing `point`.
+    /// @throw cet::exception if no TPC contains `point`
+    TPCGeo const& PositionToTPC(Point_t const& point) const
+    {
+      QueryProbe<GeometryQuery::FindTPC> const probe{point};
+      return GeometryCore::PositionToTPC(point);
+    }
+
+    /// Returns the ID of the cryostat containing `point` (invalid if none).
+    CryostatID PositionToCryostatID(Point_t const& point) const
+    {
+      QueryProbe<GeometryQuery::FindCryostat> const probe{point};
+      return GeometryCore::PositionToCryostatID(point);
+    }
+
+    /// Returns the cryostat containing `point` (`nullptr` if none).
+    CryostatGeo const* PositionToCryostatPtr(Point_t const& point) const
+    {
+      QueryProbe<GeometryQuery::FindCryostat> const probe{point};
+      return GeometryCore::PositionToCryostatPtr(point);
+    }
+
+    /// Returns the cryostat containing `point`.
+    /// @throw cet::exception if no cryostat contains `point`
+    CryostatGeo const& PositionToCryostat(Point_t const& point) const
+    {
+      QueryProbe<GeometryQuery::FindCryostat> const probe{point};
+      return GeometryCore::PositionToCryostat(point);
+    }
+
+    /// @}
+    // --- END -- Monitored position queries -----------------------------------
+
   private:
+    /// Constructor with the `builder` created after loading the geometry.
+    Geometry(fhicl::ParameterSet const& pset, std::unique_ptr<GeometryBuilder> builder);
+
     // --- BEGIN -- Configuration information checks ---------------------------
     /// @name Configuration information checks
     /// @{
@@ -62,7 +360,21 @@ namespace geo {
     /// @}
     // --- END -- Configuration information checks -----------------------------
 
+    /// Throws the exception for `query` meeting the placeholder material of `Slim` mode.
+    [[noreturn]] void throwSlimModeQuery(char const* query) const;
+
     sumdata::GeometryConfigurationInfo fConfInfo; ///< Summary of service configuration.
+
+    bool fSlim; ///< Whether only the volumes needed by the readout are loaded.
+
+    NavigatorPool fNavigators; ///< Per-thread ROOT navigators for point queries.
+
+    ThreadCursors fCursors; ///< Per-thread cursors for hinted point queries.
+
+    GeometrySubset fSubset; ///< The cryostats and TPCs served to this job.
+
+    IDList<CryostatID> fCryostatIDs; ///< Cryostat IDs of the subset, for `CryostatIDs()`.
+    IDList<TPCID> fTPCIDs;           ///< TPC IDs of the subset, for `TPCIDs()`.
   };
 
 } // namespace geo
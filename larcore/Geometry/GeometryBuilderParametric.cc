@@ -0,0 +1,264 @@
+/**
+ * @file   larcore/Geometry/GeometryBuilderParametric.cc
+ * @brief  Geometry builder constructing the detector from configuration parameters.
+ * @see    larcore/Geometry/GeometryBuilderParametric.h
+ */
+
+// library header
+#include "larcore/Geometry/GeometryBuilderParametric.h"
+
+// framework libraries
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/ParameterSet.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+// ROOT libraries
+#include "TGeoBBox.h"
+#include "TGeoElement.h"
+#include "TGeoManager.h"
+#include "TGeoMaterial.h"
+#include "TGeoMatrix.h"
+#include "TGeoMedium.h"
+#include "TGeoTube.h"
+#include "TGeoVolume.h"
+
+// C/C++ standard libraries
+#include <array>
+#include <map>
+#include <string>
+#include <utility> // std::pair
+#include <vector>
+
+namespace {
+
+  using Vector_t = std::array<double, 3>;
+
+  // --- BEGIN -- Materials ----------------------------------------------------
+  // same definitions as in generate_voltpc.pl
+
+  struct ElementDef {
+    char const* name;
+    char const* formula;
+    int Z;
+    double A;
+  };
+
+  constexpr ElementDef Elements[] = {
+    {"videRef", "VACUUM", 1, 1.0},
+    {"nitrogen", "N", 7, 14.0067},
+    {"oxygen", "O", 8, 15.999},
+    {"carbon", "C", 6, 12.0107},
+    {"chromium", "Cr", 24, 51.9961},
+    {"iron", "Fe", 26, 55.8450},
+    {"nickel", "Ni", 28, 58.6934},
+    {"argon", "Ar", 18, 39.9480},
+  };
+
+  struct MaterialDef {
+    char const* name;
+    double density; // g/cm^3
+    std::vector<std::pair<char const*, double>> fractions;
+  };
+
+  MaterialDef const Materials[] = {
+    {"Vacuum", 1.e-25, {{"videRef", 1.0}}},
+    {"STEEL_STAINLESS_Fe7Cr2Ni",
+     7.9300,
+     {{"carbon", 0.0010}, {"chromium", 0.1800}, {"iron", 0.7298}, {"nickel", 0.0900}}},
+    {"LAr", 1.40, {{"argon", 1.0}}},
+    {"Air", 0.001205, {{"nitrogen", 0.78084}, {"oxygen", 0.209476}, {"argon", 0.00934}}},
+  };
+
+  // --- END -- Materials ------------------------------------------------------
+
+  /// Builds all the volumes of the detector.
+  class ParametricGeometryMaker {
+  public:
+    ParametricGeometryMaker();
+
+    TGeoVolume* makeWorld(fhicl::ParameterSet const& pset) const;
+
+  private:
+    std::map<std::string, TGeoMedium*> fMedia;
+
+    TGeoMedium* medium(std::string const& name) const;
+
+    TGeoVolume* makeBox(std::string const& name,
+                        fhicl::ParameterSet const& pset,
+                        std::string const& defaultMaterial) const;
+    TGeoVolume* makeCryostat(fhicl::ParameterSet const& pset) const;
+    TGeoVolume* makeTPC(fhicl::ParameterSet const& pset) const;
+    TGeoVolume* makePlane(fhicl::ParameterSet const& pset) const;
+
+    /// Places `daughter` into `mother` as described by `pset`.
+    static void place(TGeoVolume* mother,
+                      TGeoVolume* daughter,
+                      fhicl::ParameterSet const& pset,
+                      int copy = 1);
+  };
+
+  // ---------------------------------------------------------------------------
+  // Rotation with the same convention as ROOT GDML parser.
+  TGeoRotation* makeRotation(Vector_t const& angles)
+  {
+    auto* rot = new TGeoRotation;
+    rot->RotateZ(-angles[2]);
+    rot->RotateY(-angles[1]);
+    rot->RotateX(-angles[0]);
+    return rot;
+  }
+
+  TGeoMatrix* makeMatrix(Vector_t const& position, Vector_t const& rotation)
+  {
+    return new TGeoCombiTrans(position[0], position[1], position[2], makeRotation(rotation));
+  }
+
+  // ---------------------------------------------------------------------------
+  ParametricGeometryMaker::ParametricGeometryMaker()
+  {
+    std::map<std::string, TGeoElement*> elements;
+    for (ElementDef const& def : Elements)
+      elements[def.name] = new TGeoElement{def.name, def.formula, def.Z, def.A};
+
+    int mediumID = 0;
+    for (MaterialDef const& def : Materials) {
+      auto* mixture =
+        new TGeoMixture{def.name, static_cast<int>(def.fractions.size()), def.density};
+      for (auto const& [element, fraction] : def.fractions)
+        mixture->AddElement(elements.at(element), fraction);
+      fMedia[def.name] = new TGeoMedium{def.name, ++mediumID, mixture};
+    }
+  }
+
+  // ---------------------------------------------------------------------------
+  TGeoMedium* ParametricGeometryMaker::medium(std::string const& name) const
+  {
+    auto const it = fMedia.find(name);
+    if (it == fMedia.end()) {
+      throw cet::exception("GeometryBuilderParametric") << "Unknown material: '" << name << "'\n";
+    }
+    return it->second;
+  }
+
+  // ---------------------------------------------------------------------------
+  TGeoVolume* ParametricGeometryMaker::makeBox(std::string const& name,
+                                               fhicl::ParameterSet const& pset,
+                                               std::string const& defaultMaterial) const
+  {
+    auto const size = pset.get<Vector_t>("Size");
+    auto* shape = new TGeoBBox{name.substr(3).c_str(), size[0] / 2, size[1] / 2, size[2] / 2};
+    return new TGeoVolume{
+      name.c_str(), shape, medium(pset.get<std::string>("Material", defaultMaterial))};
+  }
+
+  // ---------------------------------------------------------------------------
+  TGeoVolume* ParametricGeometryMaker::makeWorld(fhicl::ParameterSet const& pset) const
+  {
+    auto const enclosurePars = pset.get<fhicl::ParameterSet>("Enclosure");
+    TGeoVolume* world = makeBox("volWorld", pset.get<fhicl::ParameterSet>("World"), "Air");
+    TGeoVolume* enclosure = makeBox("volDetEnclosure", enclosurePars, "Air");
+
+    int copy = 0;
+    for (auto const& cryostatPars : pset.get<std::vector<fhicl::ParameterSet>>("Cryostats"))
+      place(enclosure, makeCryostat(cryostatPars), cryostatPars, ++copy);
+
+    place(world, enclosure, enclosurePars);
+    return world;
+  }
+
+  // ---------------------------------------------------------------------------
+  TGeoVolume* ParametricGeometryMaker::makeCryostat(fhicl::ParameterSet const& pset) const
+  {
+    TGeoVolume* cryostat = makeBox("volCryostat", pset, "LAr");
+    int copy = 0;
+    for (auto const& tpcPars : pset.get<std::vector<fhicl::ParameterSet>>("TPCs"))
+      place(cryostat, makeTPC(tpcPars), tpcPars, ++copy);
+    return cryostat;
+  }
+
+  // ---------------------------------------------------------------------------
+  TGeoVolume* ParametricGeometryMaker::makeTPC(fhicl::ParameterSet const& pset) const
+  {
+    TGeoVolume* TPC = makeBox("volTPC", pset, "LAr");
+    int copy = 0;
+    for (auto const& planePars : pset.get<std::vector<fhicl::ParameterSet>>("Planes"))
+      place(TPC, makePlane(planePars), planePars, ++copy);
+    return TPC;
+  }
+
+  // ---------------------------------------------------------------------------
+  TGeoVolume* ParametricGeometryMaker::makePlane(fhicl::ParameterSet const& pset) const
+  {
+    TGeoVolume* plane = makeBox("volTPCPlane", pset, "LAr");
+
+    auto const nWires = pset.get<unsigned int>("NWires");
+    if (nWires == 0) {
+      throw cet::exception("GeometryBuilderParametric") << "Wire plane with no wires.\n";
+    }
+    auto const firstWire = pset.get<Vector_t>("FirstWirePosition");
+    auto const step = pset.get<Vector_t>("WireStep");
+    auto const rotation = pset.get<Vector_t>("WireRotation", {0.0, 0.0, 0.0});
+
+    auto* wireShape = new TGeoTubeSeg{"TPCWire",
+                                      0.0,
+                                      pset.get<double>("WireDiameter") / 2,
+                                      pset.get<double>("WireLength") / 2,
+                                      0.0,
+                                      360.0};
+    auto* wire = new TGeoVolume{
+      "volTPCWire",
+      wireShape,
+      medium(pset.get<std::string>("WireMaterial", "STEEL_STAINLESS_Fe7Cr2Ni"))};
+
+    for (unsigned int iWire = 0; iWire < nWires; ++iWire) {
+      Vector_t const center{firstWire[0] + iWire * step[0],
+                            firstWire[1] + iWire * step[1],
+                            firstWire[2] + iWire * step[2]};
+      plane->AddNode(wire, iWire + 1, makeMatrix(center, rotation));
+    }
+    return plane;
+  }
+
+  // ---------------------------------------------------------------------------
+  void ParametricGeometryMaker::place(TGeoVolume* mother,
+                                      TGeoVolume* daughter,
+                                      fhicl::ParameterSet const& pset,
+                                      int copy /* = 1 */)
+  {
+    mother->AddNode(daughter,
+                    copy,
+                    makeMatrix(pset.get<Vector_t>("Position", {0.0, 0.0, 0.0}),
+                               pset.get<Vector_t>("Rotation", {0.0, 0.0, 0.0})));
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+TGeoManager* geo::BuildParametricGeometry(fhicl::ParameterSet const& pset)
+{
+  if (gGeoManager) {
+    TGeoManager::UnlockGeometry();
+    delete gGeoManager;
+  }
+  else {
+    // same unit setting as in geo::GeometryCore
+    TGeoManager::LockDefaultUnits(false);
+    TGeoManager::SetDefaultUnits(TGeoManager::kRootUnits);
+    TGeoManager::LockDefaultUnits(true);
+  }
+
+  auto* manager = new TGeoManager{"Parametric", "Geometry built from parameters"};
+  ParametricGeometryMaker maker;
+  manager->SetTopVolume(maker.makeWorld(pset));
+  manager->CloseGeometry();
+  manager->LockGeometry();
+  return manager;
+}
+
+//------------------------------------------------------------------------------
+geo::GeometryBuilderParametric::GeometryBuilderParametric(fhicl::ParameterSet const& pset)
+  : GeometryBuilderStandard{pset.get<fhicl::ParameterSet>("StandardBuilder", {})}
+{
+  BuildParametricGeometry(pset);
+  mf::LogInfo("GeometryBuilderParametric") << "Geometry built in memory from parameters.";
+}
@@ -0,0 +1,78 @@
+/**
+ * @file   larcore/Geometry/GeometryBuilderParametric.h
+ * @brief  Geometry builder constructing the detector from configuration parameters.
+ * @see    larcore/Geometry/GeometryBuilderParametric.cc
+ */
+
+#ifndef LARCORE_GEOMETRY_GEOMETRYBUILDERPARAMETRIC_H
+#define LARCORE_GEOMETRY_GEOMETRYBUILDERPARAMETRIC_H
+
+// LArSoft libraries
+#include "larcorealg/Geometry/GeometryBuilderStandard.h"
+
+// framework libraries
+#include "fhiclcpp/fwd.h"
+
+// ROOT libraries
+class TGeoManager;
+
+namespace geo {
+
+  /**
+   * @brief Builds the ROOT geometry from the parametric description in `pset`.
+   * @param pset the description of the detector (see `GeometryBuilderParametric`)
+   * @return the new `gGeoManager`, closed and locked
+   * @throw cet::exception (category: `GeometryBuilderParametric`) on invalid configuration
+   *
+   * Any existing `gGeoManager` is replaced.
+   */
+  TGeoManager* BuildParametricGeometry(fhicl::ParameterSet const& pset);
+
+  /**
+   * @brief Geometry builder for detectors described by a parameter table.
+   *
+   * Design studies scanning detector parameters usually write a GDML file for
+   * each parameter set (e.g. with `generate_voltpc.pl`), which the geometry
+   * service then parses. This builder instead constructs the ROOT geometry in
+   * memory directly from its configuration, with the same volume structure
+   * those scripts produce: world, detector enclosure, cryostats, TPCs, planes
+   * and wires. The LArSoft geometry objects are then extracted from it by the
+   * standard builder.
+   *
+   * The builder is an _art_ tool selected in the `Builder` configuration of
+   * `geo::Geometry` service. The GDML file configured in the service is still
+   * served to the clients that need it (e.g. Geant4), but it is not parsed.
+   *
+   * Configuration
+   * --------------
+   *
+   * All lengths are in centimeters, angles in degrees, sizes are full sizes, and
+   * positions are of the center of a volume in the frame of its mother volume.
+   * Rotations (`[ x, y, z ]`) follow the GDML convention.
+   *
+   * - *StandardBuilder* (table, default: empty): configuration of the
+   *   standard builder (`geo::GeometryBuilderStandard`) extracting the objects
+   * - *World*, *Enclosure* (tables): `Size`, `Material` (default: `"Air"`) and,
+   *   for the enclosure only, `Position` in the world volume
+   * - *Cryostats* (sequence of tables): `Size`, `Position` (default: origin),
+   *   `Material` (default: `"LAr"`) and `TPCs`
+   *   - *TPCs* (sequence of tables): `Size`, `Position`, `Rotation` (default: none),
+   *     `Material` (default: `"LAr"`) and `Planes`
+   *     - *Planes* (sequence of tables): `Size`, `Position`, `Rotation` and
+   *       the wire layout: `NWires`, `FirstWirePosition` of the center of the first
+   *       wire, `WireStep` between the centers of consecutive wires,
+   *       `WireRotation`, `WireDiameter`, `WireLength` and `WireMaterial` (default:
+   *       `"STEEL_STAINLESS_Fe7Cr2Ni"`); a wire without rotation lies along _z_
+   *
+   * The available materials are `Vacuum`, `Air`, `LAr` and
+   * `STEEL_STAINLESS_Fe7Cr2Ni`, defined as in `generate_voltpc.pl`.
+   * `geometry_voltpc_parametric.fcl` describes the same detector as `voltpc.gdml`.
+   */
+  class GeometryBuilderParametric : public GeometryBuilderStandard {
+  public:
+    explicit GeometryBuilderParametric(fhicl::ParameterSet const& pset);
+  };
+
+} // namespace geo
+
+#endif // LARCORE_GEOMETRY_GEOMETRYBUILDERPARAMETRIC_H
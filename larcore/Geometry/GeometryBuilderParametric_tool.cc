@@ -0,0 +1,4 @@
+#include "art/Utilities/ToolMacros.h"
+#include "larcore/Geometry/GeometryBuilderParametric.h"
+
+DEFINE_ART_CLASS_TOOL(geo::GeometryBuilderParametric)
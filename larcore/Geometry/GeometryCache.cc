@@ -0,0 +1,116 @@
+/**
+ * @file   larcore/Geometry/GeometryCache.cc
+ * @brief  Cache of complete detector geometries, with least-recently-used eviction.
+ * @see    larcore/Geometry/GeometryCache.h
+ */
+
+// library header
+#include "larcore/Geometry/GeometryCache.h"
+
+// framework libraries
+#include "cetlib_except/exception.h"
+
+// ROOT libraries
+#include "TGeoManager.h"
+
+// C/C++ standard libraries
+#include <algorithm> // std::max()
+#include <utility>   // std::move()
+
+//------------------------------------------------------------------------------
+geo::BuiltGeometry::~BuiltGeometry()
+{
+  wires.reset();
+  geom.reset();
+  if (!manager) return;
+
+  // ROOT resets `gGeoManager` when deleting any geometry
+  TGeoManager* const current = gGeoManager;
+  TGeoManager::UnlockGeometry();
+  delete manager;
+  gGeoManager = (current == manager) ? nullptr : current;
+  if (gGeoManager) TGeoManager::LockGeometry();
+}
+
+//------------------------------------------------------------------------------
+void geo::BuiltGeometry::activate() const
+{
+  gGeoManager = manager;
+}
+
+//------------------------------------------------------------------------------
+void geo::BuiltGeometry::detachCurrentManager()
+{
+  TGeoManager::UnlockGeometry();
+  gGeoManager = nullptr;
+}
+
+//------------------------------------------------------------------------------
+geo::GeometryCache::GeometryCache(std::size_t capacity, Builder_t builder)
+  : fCapacity{std::max(capacity, std::size_t{1})}, fBuilder{std::move(builder)}
+{}
+
+//------------------------------------------------------------------------------
+auto geo::GeometryCache::get(std::string const& name) -> Entry_t
+{
+  std::lock_guard const lock{fMutex};
+
+  if (auto const it = fIndex.find(name); it != fIndex.end()) {
+    ++fHits;
+    fEntries.splice(fEntries.begin(), fEntries, it->second);
+    return fEntries.front();
+  }
+
+  ++fMisses;
+  std::unique_ptr<BuiltGeometry> built = fBuilder(name);
+  if (!built) {
+    throw cet::exception("GeometryCache") << "Failed to build geometry '" << name << "'.\n";
+  }
+
+  if (fEntries.size() >= fCapacity) {
+    fIndex.erase(fEntries.back()->name);
+    fEntries.pop_back();
+  }
+  built->name = name;
+  fEntries.push_front(std::move(built));
+  fIndex[name] = fEntries.begin();
+  return fEntries.front();
+}
+
+//------------------------------------------------------------------------------
+bool geo::GeometryCache::contains(std::string const& name) const
+{
+  std::lock_guard const lock{fMutex};
+  return fIndex.count(name) > 0;
+}
+
+//------------------------------------------------------------------------------
+std::vector<std::string> geo::GeometryCache::names() const
+{
+  std::lock_guard const lock{fMutex};
+  std::vector<std::string> result;
+  for (Entry_t const& entry : fEntries)
+    result.push_back(entry->name);
+  return result;
+}
+
+//------------------------------------------------------------------------------
+std::size_t geo::GeometryCache::size() const
+{
+  std::lock_guard const lock{fMutex};
+  return fEntries.size();
+}
+
+//------------------------------------------------------------------------------
+unsigned int geo::GeometryCache::hits() const
+{
+  std::lock_guard const lock{fMutex};
+  return fHits;
+}
+
+//------------------------------------------------------------------------------
+unsigned int geo::GeometryCache::misses() const
+{
+  std::lock_guard const lock{fMutex};
+  return fMisses;
+}
@@ -0,0 +1,119 @@
+/**
+ * @file   larcore/Geometry/GeometryCache.h
+ * @brief  Cache of complete detector geometries, with least-recently-used eviction.
+ * @see    larcore/Geometry/GeometryCache.cc
+ */
+
+#ifndef LARCORE_GEOMETRY_GEOMETRYCACHE_H
+#define LARCORE_GEOMETRY_GEOMETRYCACHE_H
+
+// LArSoft libraries
+#include "larcorealg/Geometry/GeometryCore.h"
+#include "larcorealg/Geometry/WireReadoutGeom.h"
+
+// C/C++ standard libraries
+#include <cstddef> // std::size_t
+#include <functional>
+#include <list>
+#include <memory> // std::shared_ptr, std::unique_ptr
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// ROOT libraries
+class TGeoManager;
+
+namespace geo {
+
+  /**
+   * @brief A detector geometry with its own ROOT geometry manager.
+   *
+   * ROOT supports a single current geometry (`gGeoManager`). This object owns
+   * one ROOT geometry, not necessarily the current one, and the LArSoft
+   * geometry description extracted from it. Use `activate()` to make it the
+   * current ROOT geometry before navigating it.
+   */
+  struct BuiltGeometry {
+    std::string name;                             ///< Detector name (lower case).
+    TGeoManager* manager = nullptr;               ///< ROOT geometry (owned).
+    std::unique_ptr<GeometryCore const> geom;     ///< LArSoft geometry.
+    std::unique_ptr<WireReadoutGeom const> wires; ///< Wire readout of `geom`.
+
+    BuiltGeometry() = default;
+    BuiltGeometry(BuiltGeometry const&) = delete;
+    BuiltGeometry& operator=(BuiltGeometry const&) = delete;
+
+    /// Deletes the ROOT geometry, leaving the current one (if other) untouched.
+    ~BuiltGeometry();
+
+    /// Makes this the current ROOT geometry (`gGeoManager`).
+    void activate() const;
+
+    /**
+     * @brief Prepares ROOT for a new geometry without deleting the current one.
+     *
+     * ROOT deletes the current geometry whenever a new one is created, and
+     * refuses to create one if the current one is locked. This function
+     * detaches the current geometry, which stays alive, so that the next one
+     * is loaded anew. The detached geometry is usually owned by another
+     * `BuiltGeometry`.
+     */
+    static void detachCurrentManager();
+  };
+
+  /**
+   * @brief Keeps up to a fixed number of built geometries, by name.
+   *
+   * Geometries are built on demand by the function passed at construction,
+   * and cached. When the cache is full, the least recently requested geometry
+   * is dropped; it is destroyed when the last copy of its pointer is released.
+   *
+   * The cache is thread-safe, but building a geometry is serialized and
+   * changes the current ROOT geometry: it is meant to be used at run
+   * boundaries, not while events are being processed.
+   */
+  class GeometryCache {
+  public:
+    using Entry_t = std::shared_ptr<BuiltGeometry const>;
+    using Builder_t = std::function<std::unique_ptr<BuiltGeometry>(std::string const&)>;
+
+    /// Constructor: cache of up to `capacity` geometries (at least one) built by `builder`.
+    GeometryCache(std::size_t capacity, Builder_t builder);
+
+    /// Returns the geometry called `name`, building it if not in the cache.
+    Entry_t get(std::string const& name);
+
+    /// Returns whether the geometry called `name` is in the cache.
+    bool contains(std::string const& name) const;
+
+    /// Returns the names of the cached geometries, most recently used first.
+    std::vector<std::string> names() const;
+
+    /// Returns the number of cached geometries.
+    std::size_t size() const;
+
+    /// Returns the maximum number of cached geometries.
+    std::size_t capacity() const { return fCapacity; }
+
+    /// Returns how many requests were served from the cache.
+    unsigned int hits() const;
+
+    /// Returns how many requests required a geometry to be built.
+    unsigned int misses() const;
+
+  private:
+    using List_t = std::list<Entry_t>;
+
+    std::size_t const fCapacity;                       ///< Maximum number of entries.
+    Builder_t fBuilder;                                ///< Builds missing geometries.
+    List_t fEntries;                                   ///< Cached entries, recent first.
+    std::unordered_map<std::string, List_t::iterator> fIndex; ///< Entries by name.
+    unsigned int fHits = 0;                            ///< Requests served from cache.
+    unsigned int fMisses = 0;                          ///< Requests requiring a build.
+    mutable std::mutex fMutex;                         ///< Protects all the above.
+  };
+
+} // namespace geo
+
+#endif // LARCORE_GEOMETRY_GEOMETRYCACHE_H
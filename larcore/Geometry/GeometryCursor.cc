@@ -0,0 +1,116 @@
+/**
+ * @file   larcore/Geometry/GeometryCursor.cc
+ * @brief  Point-to-TPC and point-to-cryostat queries hinted by the last result.
+ * @see    larcore/Geometry/GeometryCursor.h
+ */
+
+// library header
+#include "larcore/Geometry/GeometryCursor.h"
+
+// LArSoft libraries
+#include "larcorealg/Geometry/CryostatGeo.h"
+#include "larcorealg/Geometry/TPCGeo.h"
+
+// C/C++ standard libraries
+#include <cmath> // std::abs()
+
+namespace {
+
+  std::atomic<std::uint64_t> NextThreadCursorsID{0};
+
+  // cursors of the current thread, by owner; owners are never many
+  struct ThreadCursor {
+    std::uint64_t ownerID;
+    geo::GeometryCursor* cursor;
+  };
+  thread_local std::vector<ThreadCursor> ThreadCursorList;
+
+  // whether `c` is in [ `min`, `max` ] farther from both than the full search
+  // extends them (`BoxBoundedGeo::CoordinateContained()` with wiggle 1 + `epsilon`)
+  bool insideBeyondTolerance(double c, double min, double max, double epsilon)
+  {
+    return (c - min > std::abs(min) * epsilon) && (max - c > std::abs(max) * epsilon);
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+bool geo::GeometryCursor::containsBeyondTolerance(BoxBoundedGeo const& box,
+                                                  Point_t const& point) const
+{
+  return insideBeyondTolerance(point.X(), box.MinX(), box.MaxX(), fPositionEpsilon) &&
+         insideBeyondTolerance(point.Y(), box.MinY(), box.MaxY(), fPositionEpsilon) &&
+         insideBeyondTolerance(point.Z(), box.MinZ(), box.MaxZ(), fPositionEpsilon);
+}
+
+//------------------------------------------------------------------------------
+geo::TPCGeo const* geo::GeometryCursor::PositionToTPCptr(Point_t const& point)
+{
+  if (fTPC && containsBeyondTolerance(*fTPC, point)) {
+    countHit();
+    return fTPC;
+  }
+  countMiss();
+  fTPC = fGeom->PositionToTPCptr(point);
+  if (fTPC) fCryostat = &fGeom->Cryostat(fTPC->ID());
+  return fTPC;
+}
+
+//------------------------------------------------------------------------------
+geo::TPCID geo::GeometryCursor::FindTPCAtPosition(Point_t const& point)
+{
+  TPCGeo const* tpc = PositionToTPCptr(point);
+  return tpc ? tpc->ID() : TPCID{};
+}
+
+//------------------------------------------------------------------------------
+geo::CryostatGeo const* geo::GeometryCursor::PositionToCryostatPtr(Point_t const& point)
+{
+  if (fCryostat && containsBeyondTolerance(*fCryostat, point)) {
+    countHit();
+    return fCryostat;
+  }
+  countMiss();
+  fCryostat = fGeom->PositionToCryostatPtr(point);
+  return fCryostat;
+}
+
+//------------------------------------------------------------------------------
+geo::CryostatID geo::GeometryCursor::PositionToCryostatID(Point_t const& point)
+{
+  CryostatGeo const* cryostat = PositionToCryostatPtr(point);
+  return cryostat ? cryostat->ID() : CryostatID{};
+}
+
+//------------------------------------------------------------------------------
+geo::ThreadCursors::ThreadCursors(GeometryCore const& geom,
+                                  double positionEpsilon /* = DefaultPositionEpsilon */)
+  : fGeom{&geom}, fPositionEpsilon{positionEpsilon}, fID{NextThreadCursorsID++}
+{}
+
+//------------------------------------------------------------------------------
+geo::GeometryCursor& geo::ThreadCursors::local() const
+{
+  for (ThreadCursor const& entry : ThreadCursorList) {
+    if (entry.ownerID == fID) return *entry.cursor;
+  }
+
+  GeometryCursor* cursor = nullptr;
+  {
+    std::lock_guard const lock{fMutex};
+    fCursors.push_back(std::make_unique<GeometryCursor>(*fGeom, fPositionEpsilon));
+    cursor = fCursors.back().get();
+  }
+  ThreadCursorList.push_back({fID, cursor});
+  return *cursor;
+}
+
+//------------------------------------------------------------------------------
+geo::GeometryCursor::Stats geo::ThreadCursors::stats() const
+{
+  GeometryCursor::Stats total;
+  std::lock_guard const lock{fMutex};
+  for (auto const& cursor : fCursors)
+    total += cursor->stats();
+  return total;
+}
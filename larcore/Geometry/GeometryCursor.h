@@ -0,0 +1,159 @@
+/**
+ * @file   larcore/Geometry/GeometryCursor.h
+ * @brief  Point-to-TPC and point-to-cryostat queries hinted by the last result.
+ * @see    larcore/Geometry/GeometryCursor.cc
+ */
+
+#ifndef LARCORE_GEOMETRY_GEOMETRYCURSOR_H
+#define LARCORE_GEOMETRY_GEOMETRYCURSOR_H
+
+// LArSoft libraries
+#include "larcorealg/Geometry/BoxBoundedGeo.h"
+#include "larcorealg/Geometry/GeometryCore.h"
+#include "larcoreobj/SimpleTypesAndConstants/geo_types.h"
+
+// C/C++ standard libraries
+#include <atomic>
+#include <cstdint> // std::uint64_t
+#include <memory>  // std::unique_ptr
+#include <mutex>
+#include <vector>
+
+namespace geo {
+
+  /**
+   * @brief Finds the TPC and cryostat at a point, starting from the last found.
+   *
+   * Consecutive points of a track or of a stream of energy deposits are
+   * usually in the same TPC. The cursor remembers the TPC and cryostat of its
+   * last answer, and checks them first; only if the point is outside them, the
+   * full search of `geo::GeometryCore` is performed (and its result remembered).
+   *
+   * The full search also accepts points just outside a volume, within the
+   * relative tolerance `PositionEpsilon` of the `geo::GeometryCore`
+   * configuration, and answers the first volume so found. Near a boundary
+   * between two volumes, that may be either of them. The remembered volume is
+   * therefore accepted only if the point is inside it by more than that
+   * tolerance, where no other volume can be found; closer to its faces, the
+   * full search is performed. The answer is always the one of the full search.
+   *
+   * A cursor is not thread-safe: each thread should use its own (see
+   * `geo::ThreadCursors`), except for `stats()`, which may be called anytime.
+   */
+  class GeometryCursor {
+  public:
+    /// Number of queries answered by the remembered volume or by a full search.
+    struct Stats {
+      std::uint64_t hits = 0;
+      std::uint64_t misses = 0;
+
+      /// Returns the fraction of queries answered by the remembered volume.
+      double hitRate() const
+      {
+        return (hits + misses) ? double(hits) / (hits + misses) : 0.0;
+      }
+
+      Stats& operator+=(Stats const& other)
+      {
+        hits += other.hits;
+        misses += other.misses;
+        return *this;
+      }
+    };
+
+    /// Default of the `PositionEpsilon` of the `geo::GeometryCore` configuration.
+    static constexpr double DefaultPositionEpsilon = 1.e-4;
+
+    /**
+     * @brief Constructor: queries `geom`.
+     * @param geom the geometry to be queried
+     * @param positionEpsilon the `PositionEpsilon` `geom` was configured with
+     */
+    explicit GeometryCursor(GeometryCore const& geom,
+                            double positionEpsilon = DefaultPositionEpsilon)
+      : fGeom{&geom}, fPositionEpsilon{positionEpsilon}
+    {}
+
+    /// Returns the TPC containing `point` (`nullptr` if none).
+    TPCGeo const* PositionToTPCptr(Point_t const& point);
+
+    /// Returns the ID of the TPC containing `point` (invalid if none).
+    TPCID FindTPCAtPosition(Point_t const& point);
+
+    /// Returns the cryostat containing `point` (`nullptr` if none).
+    CryostatGeo const* PositionToCryostatPtr(Point_t const& point);
+
+    /// Returns the ID of the cryostat containing `point` (invalid if none).
+    CryostatID PositionToCryostatID(Point_t const& point);
+
+    /// Forgets the remembered volumes.
+    void reset()
+    {
+      fTPC = nullptr;
+      fCryostat = nullptr;
+    }
+
+    /// Returns the number of hits and misses so far.
+    Stats stats() const { return {fHits.load(), fMisses.load()}; }
+
+    /// Resets the hit and miss counters.
+    void resetStats()
+    {
+      fHits = 0;
+      fMisses = 0;
+    }
+
+  private:
+    GeometryCore const* fGeom;              ///< Geometry being queried.
+    double fPositionEpsilon;                ///< Relative tolerance of the full search.
+    TPCGeo const* fTPC = nullptr;           ///< Last TPC found.
+    CryostatGeo const* fCryostat = nullptr; ///< Last cryostat found.
+
+    // atomic only to be read by other threads; written by the owner only
+    std::atomic<std::uint64_t> fHits{0};   ///< Queries answered by the hint.
+    std::atomic<std::uint64_t> fMisses{0}; ///< Queries requiring full search.
+
+    void countHit() { fHits.fetch_add(1, std::memory_order_relaxed); }
+    void countMiss() { fMisses.fetch_add(1, std::memory_order_relaxed); }
+
+    /// Returns whether `point` is inside `box` farther than the tolerance from its faces.
+    bool containsBeyondTolerance(BoxBoundedGeo const& box, Point_t const& point) const;
+  };
+
+  /**
+   * @brief One `GeometryCursor` for each thread querying a geometry.
+   *
+   * Each thread gets its own cursor the first time it asks for one with
+   * `local()`, and keeps it until this object is destroyed. The statistics of
+   * all the cursors are summed by `stats()`.
+   */
+  class ThreadCursors {
+  public:
+    /// Constructor: cursors on `geom` (see `GeometryCursor::GeometryCursor()`).
+    explicit ThreadCursors(GeometryCore const& geom,
+                           double positionEpsilon = GeometryCursor::DefaultPositionEpsilon);
+
+    ThreadCursors(ThreadCursors const&) = delete;
+    ThreadCursors& operator=(ThreadCursors const&) = delete;
+
+    /// Returns the cursor of the calling thread.
+    GeometryCursor& local() const;
+
+    /// Returns the statistics summed over all the cursors.
+    GeometryCursor::Stats stats() const;
+
+    /// Returns a new cursor, not owned by this object.
+    GeometryCursor makeCursor() const { return GeometryCursor{*fGeom, fPositionEpsilon}; }
+
+  private:
+    GeometryCore const* fGeom; ///< Geometry being queried.
+    double fPositionEpsilon;   ///< Relative tolerance of the full search.
+    std::uint64_t fID;         ///< Unique identifier of this object.
+
+    mutable std::vector<std::unique_ptr<GeometryCursor>> fCursors; ///< All cursors.
+    mutable std::mutex fMutex; ///< Protects `fCursors`.
+  };
+
+} // namespace geo
+
+#endif // LARCORE_GEOMETRY_GEOMETRYCURSOR_H
@@ -0,0 +1,83 @@
+/**
+ * @file   larcore/Geometry/GeometryIDRanges.cc
+ * @brief  Random-access, splittable ranges of geometry IDs for parallel loops.
+ * @see    larcore/Geometry/GeometryIDRanges.h
+ */
+
+// library header
+#include "larcore/Geometry/GeometryIDRanges.h"
+
+// LArSoft libraries
+#include "larcore/Geometry/GeometrySubset.h"
+#include "larcorealg/Geometry/PlaneGeo.h"
+#include "larcorealg/Geometry/WireReadoutGeom.h"
+
+// C/C++ standard libraries
+#include <algorithm> // std::upper_bound(), std::sort(), std::unique()
+#include <iterator>  // std::prev(), std::distance()
+
+//------------------------------------------------------------------------------
+geo::WireIDTable::WireIDTable(WireReadoutGeom const& wireReadout, GeometrySubset const* subset)
+  : fFirstWire{0}
+{
+  for (PlaneGeo const& plane : wireReadout.Iterate<PlaneGeo>()) {
+    if (subset && !subset->Contains(plane.ID())) continue;
+    fPlanes.push_back(plane.ID());
+    fFirstWire.push_back(fFirstWire.back() + plane.Nwires());
+  }
+}
+
+//------------------------------------------------------------------------------
+geo::WireID geo::WireIDTable::operator[](std::size_t i) const
+{
+  // the last plane starting at or before `i`
+  auto const next = std::upper_bound(fFirstWire.begin(), fFirstWire.end(), i);
+  std::size_t const iPlane = std::distance(fFirstWire.begin(), std::prev(next));
+  return {fPlanes[iPlane], static_cast<WireID::WireID_t>(i - fFirstWire[iPlane])};
+}
+
+//------------------------------------------------------------------------------
+geo::ChannelIDTable::ChannelIDTable(WireReadoutGeom const& wireReadout,
+                                    GeometrySubset const* subset)
+  : fFirstIndex{0}
+{
+  if (!subset || subset->isFull()) {
+    fFirstChannel.push_back(0);
+    fFirstIndex.push_back(wireReadout.Nchannels());
+    return;
+  }
+
+  // the channels of the wires of the subset, merged into ranges
+  std::vector<raw::ChannelID_t> channels;
+  for (PlaneGeo const& plane : wireReadout.Iterate<PlaneGeo>()) {
+    if (!subset->Contains(plane.ID())) continue;
+    for (unsigned int w = 0; w < plane.Nwires(); ++w)
+      channels.push_back(wireReadout.PlaneWireToChannel(WireID{plane.ID(), w}));
+  }
+  std::sort(channels.begin(), channels.end());
+  channels.erase(std::unique(channels.begin(), channels.end()), channels.end());
+  for (std::size_t i = 0; i < channels.size(); ++i) {
+    if ((i > 0) && (channels[i] == channels[i - 1] + 1)) continue;
+    fFirstChannel.push_back(channels[i]);
+    if (i > 0) fFirstIndex.push_back(i);
+  }
+  fFirstIndex.push_back(channels.size());
+}
+
+//------------------------------------------------------------------------------
+raw::ChannelID_t geo::ChannelIDTable::channelAt(std::size_t i) const
+{
+  // the last range starting at or before `i`
+  auto const next = std::upper_bound(fFirstIndex.begin(), fFirstIndex.end() - 1, i);
+  std::size_t const iRange = std::distance(fFirstIndex.begin(), std::prev(next));
+  return fFirstChannel[iRange] + static_cast<raw::ChannelID_t>(i - fFirstIndex[iRange]);
+}
+
+//------------------------------------------------------------------------------
+geo::ReadoutIDTables::ReadoutIDTables(WireReadoutGeom const& wireReadout,
+                                      GeometrySubset const* subset)
+  : fPlanes{wireReadout,
+            [subset](PlaneID const& id) { return !subset || subset->Contains(id); }}
+  , fWires{wireReadout, subset}
+  , fChannels{wireReadout, subset}
+{}
@@ -0,0 +1,237 @@
+/**
+ * @file   larcore/Geometry/GeometryIDRanges.h
+ * @brief  Random-access, splittable ranges of geometry IDs for parallel loops.
+ * @see    larcore/Geometry/GeometryIDRanges.cc
+ *
+ * The ID iterators of the geometry (e.g. `Iterate<geo::WireID>()`) step from
+ * one ID to the next, and can't be split among threads. The ranges in this
+ * file give access to the N-th ID in constant time (logarithmic for wires), in
+ * the same order as those iterators. They have random access iterators, which
+ * C++17 parallel algorithms can split, and they are themselves ranges for TBB
+ * (`tbb::parallel_for(range, body)` with `body` taking a range).
+ */
+
+#ifndef LARCORE_GEOMETRY_GEOMETRYIDRANGES_H
+#define LARCORE_GEOMETRY_GEOMETRYIDRANGES_H
+
+// LArSoft libraries
+#include "larcorealg/Geometry/fwd.h"
+#include "larcoreobj/SimpleTypesAndConstants/RawTypes.h" // raw::ChannelID_t
+#include "larcoreobj/SimpleTypesAndConstants/geo_types.h"
+
+// TBB libraries
+#include "tbb/blocked_range.h" // tbb::split
+
+// C/C++ standard libraries
+#include <cassert>
+#include <cstddef> // std::size_t, std::ptrdiff_t
+#include <iterator>
+#include <vector>
+
+namespace geo {
+
+  class GeometrySubset;
+
+  /**
+   * @brief A range of consecutive entries of an ID table, splittable by TBB.
+   * @tparam Table type of table (`value_type`, `size()` and `operator[]`)
+   *
+   * The range refers to a table which must outlive it. It models the TBB
+   * _Range_ concept: `tbb::parallel_for()` splits it in halves down to
+   * `grainSize` entries. Its iterators are random access iterators
+   * dereferencing to an ID _value_ (not a reference).
+   */
+  template <typename Table>
+  class IDRange {
+  public:
+    using value_type = typename Table::value_type;
+
+    /// Random access iterator to the IDs in a table.
+    class iterator {
+    public:
+      using iterator_category = std::random_access_iterator_tag;
+      using value_type = typename Table::value_type;
+      using difference_type = std::ptrdiff_t;
+      using pointer = void;
+      using reference = value_type;
+
+      iterator() = default;
+      iterator(Table const* table, std::size_t index) : fTable{table}, fIndex{index} {}
+
+      value_type operator*() const { return (*fTable)[fIndex]; }
+      value_type operator[](difference_type n) const { return (*fTable)[fIndex + n]; }
+
+      iterator& operator++() { return ++fIndex, *this; }
+      iterator operator++(int) { return {fTable, fIndex++}; }
+      iterator& operator--() { return --fIndex, *this; }
+      iterator operator--(int) { return {fTable, fIndex--}; }
+      iterator& operator+=(difference_type n) { return fIndex += n, *this; }
+      iterator& operator-=(difference_type n) { return fIndex -= n, *this; }
+      iterator operator+(difference_type n) const { return {fTable, fIndex + n}; }
+      iterator operator-(difference_type n) const { return {fTable, fIndex - n}; }
+      friend iterator operator+(difference_type n, iterator const& it) { return it + n; }
+      difference_type operator-(iterator const& other) const
+      {
+        return static_cast<difference_type>(fIndex) - static_cast<difference_type>(other.fIndex);
+      }
+
+      bool operator==(iterator const& other) const { return fIndex == other.fIndex; }
+      bool operator!=(iterator const& other) const { return fIndex != other.fIndex; }
+      bool operator<(iterator const& other) const { return fIndex < other.fIndex; }
+      bool operator>(iterator const& other) const { return fIndex > other.fIndex; }
+      bool operator<=(iterator const& other) const { return fIndex <= other.fIndex; }
+      bool operator>=(iterator const& other) const { return fIndex >= other.fIndex; }
+
+      /// Returns the position of the iterator in the whole table.
+      std::size_t index() const { return fIndex; }
+
+    private:
+      Table const* fTable = nullptr;
+      std::size_t fIndex = 0;
+    }; // class iterator
+
+    using const_iterator = iterator;
+
+    /// The whole `table`, split by TBB down to `grainSize` entries.
+    explicit IDRange(Table const& table, std::size_t grainSize = 1)
+      : IDRange{table, 0, table.size(), grainSize}
+    {}
+
+    /// The entries of `table` from `begin` to `end` (excluded).
+    IDRange(Table const& table, std::size_t begin, std::size_t end, std::size_t grainSize = 1)
+      : fTable{&table}, fBegin{begin}, fEnd{end}, fGrainSize{grainSize ? grainSize : 1}
+    {
+      assert(fBegin <= fEnd);
+      assert(fEnd <= table.size());
+    }
+
+    /// Splitting constructor for TBB: takes the second half of `other`.
+    IDRange(IDRange& other, tbb::split)
+      : fTable{other.fTable}
+      , fBegin{other.fBegin + other.size() / 2}
+      , fEnd{other.fEnd}
+      , fGrainSize{other.fGrainSize}
+    {
+      other.fEnd = fBegin;
+    }
+
+    iterator begin() const { return {fTable, fBegin}; }
+    iterator end() const { return {fTable, fEnd}; }
+
+    std::size_t size() const { return fEnd - fBegin; }
+    bool empty() const { return fBegin == fEnd; }
+
+    /// Returns the `i`-th ID of the range.
+    value_type operator[](std::size_t i) const { return (*fTable)[fBegin + i]; }
+
+    /// Returns the number of entries under which TBB does not split the range.
+    std::size_t grainsize() const { return fGrainSize; }
+
+    /// Returns whether TBB may split this range.
+    bool is_divisible() const { return size() > fGrainSize; }
+
+  private:
+    Table const* fTable;
+    std::size_t fBegin;
+    std::size_t fEnd;
+    std::size_t fGrainSize;
+  }; // class IDRange
+
+  /// A table of IDs copied, in order, from an `Iterate<ID>()` of a geometry.
+  template <typename ID>
+  class IDList {
+  public:
+    using value_type = ID;
+
+    /// Copies all the IDs of type `ID` of `geom` (e.g. a `geo::GeometryCore`).
+    template <typename Geometry>
+    explicit IDList(Geometry const& geom)
+    {
+      for (ID const& id : geom.template Iterate<ID>())
+        fIDs.push_back(id);
+    }
+
+    /// Copies the IDs of type `ID` of `geom` for which `keep(id)` is `true`.
+    template <typename Geometry, typename Pred>
+    IDList(Geometry const& geom, Pred keep)
+    {
+      for (ID const& id : geom.template Iterate<ID>())
+        if (keep(id)) fIDs.push_back(id);
+    }
+
+    std::size_t size() const { return fIDs.size(); }
+    ID operator[](std::size_t i) const { return fIDs[i]; }
+
+  private:
+    std::vector<ID> fIDs;
+  }; // class IDList
+
+  /**
+   * @brief Table of all the wire IDs of a readout geometry.
+   *
+   * The table stores only the planes and the index of the first wire of each,
+   * and finds the `i`-th wire by binary search on the planes. With a `subset`,
+   * only the planes of its TPCs are included.
+   */
+  class WireIDTable {
+  public:
+    using value_type = WireID;
+
+    explicit WireIDTable(WireReadoutGeom const& wireReadout,
+                         GeometrySubset const* subset = nullptr);
+
+    std::size_t size() const { return fFirstWire.back(); }
+    WireID operator[](std::size_t i) const;
+
+  private:
+    std::vector<PlaneID> fPlanes;        ///< All planes, in iteration order.
+    std::vector<std::size_t> fFirstWire; ///< Index of first wire of each plane, and total.
+  }; // class WireIDTable
+
+  /**
+   * @brief Table of all the channels of a readout geometry (`0` to `Nchannels() - 1`).
+   *
+   * With a `subset`, only the channels of the wires of its TPCs are included,
+   * in increasing order: the table stores the ranges of consecutive channels,
+   * and finds the `i`-th channel by binary search on them.
+   */
+  class ChannelIDTable {
+  public:
+    using value_type = raw::ChannelID_t;
+
+    explicit ChannelIDTable(WireReadoutGeom const& wireReadout,
+                            GeometrySubset const* subset = nullptr);
+
+    std::size_t size() const { return fFirstIndex.back(); }
+    raw::ChannelID_t operator[](std::size_t i) const
+    {
+      if (fFirstChannel.size() == 1) return fFirstChannel[0] + static_cast<raw::ChannelID_t>(i);
+      return channelAt(i);
+    }
+
+  private:
+    std::vector<raw::ChannelID_t> fFirstChannel; ///< First channel of each range.
+    std::vector<std::size_t> fFirstIndex; ///< Index of the first channel of each range, and total.
+
+    raw::ChannelID_t channelAt(std::size_t i) const;
+  }; // class ChannelIDTable
+
+  /// The plane, wire and channel tables of a readout geometry (or of a `subset` of it).
+  class ReadoutIDTables {
+  public:
+    explicit ReadoutIDTables(WireReadoutGeom const& wireReadout,
+                             GeometrySubset const* subset = nullptr);
+
+    IDList<PlaneID> const& planes() const { return fPlanes; }
+    WireIDTable const& wires() const { return fWires; }
+    ChannelIDTable const& channels() const { return fChannels; }
+
+  private:
+    IDList<PlaneID> fPlanes;
+    WireIDTable fWires;
+    ChannelIDTable fChannels;
+  }; // class ReadoutIDTables
+
+} // namespace geo
+
+#endif // LARCORE_GEOMETRY_GEOMETRYIDRANGES_H
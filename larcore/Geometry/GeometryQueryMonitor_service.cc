@@ -0,0 +1,358 @@
+/**
+ * @file   larcore/Geometry/GeometryQueryMonitor_service.cc
+ * @brief  Service counting and timing the geometry queries of each module.
+ * @see    larcore/Geometry/GeometryQueryProbe.h
+ */
+
+// LArSoft libraries
+#include "larcore/Geometry/GeometryQueryProbe.h"
+
+// framework libraries
+#include "art/Framework/Services/Registry/ActivityRegistry.h"
+#include "art/Framework/Services/Registry/ServiceDeclarationMacros.h"
+#include "art/Framework/Services/Registry/ServiceDefinitionMacros.h"
+#include "art/Framework/Services/Registry/ServiceTable.h"
+#include "art/Persistency/Provenance/ModuleContext.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/types/Atom.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+// C/C++ standard libraries
+#include <algorithm> // std::max(), std::min()
+#include <array>
+#include <atomic>
+#include <bit> // std::bit_width()
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory> // std::unique_ptr
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+namespace geo {
+  class GeometryQueryMonitor;
+}
+/**
+ * @brief Counts and times the geometry queries of each module.
+ *
+ * When this service is configured, the point and position queries served by
+ * the `geo::Geometry` service and the channel and wire queries served by the
+ * `geo::WireReadout` service are counted for each module and query type (see
+ * `geo::GeometryQuery`). One call out of
+ * `SamplingPeriod` of each type is also timed, and its duration is added to a
+ * histogram with logarithmic bins (powers of 2 in nanoseconds).
+ * Queries outside of the event processing of a module are attributed to
+ * `(no module)`.
+ *
+ * At the end of the job, a summary table is printed (`GeometryQueryMonitor`
+ * category, INFO level) and the same information, with the full histograms,
+ * is written into a JSON file.
+ *
+ * When the service is not configured, the queries are not instrumented (each
+ * query only checks that no recorder is installed).
+ *
+ * @note Only the queries made on the services are monitored. The queries to
+ *       the service providers are not: neither the ones through
+ *       `geo::Geometry::provider()` (or any `geo::GeometryCore const&`) nor
+ *       the ones on the `geo::WireReadoutGeom` returned by
+ *       `geo::WireReadout::Get()`.
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * services.GeometryQueryMonitor: {
+ *   SamplingPeriod: 64
+ *   JSONFile: "GeometryQueries.json"
+ * }
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * Configuration
+ * -------------
+ *
+ * - *SamplingPeriod* (integer, default: `64`): one call every this many of the
+ *   same type in the same thread is timed (`1`: all of them)
+ * - *JSONFile* (string, default: `GeometryQueries.json`): path of the JSON
+ *   summary; if empty, no file is written
+ *
+ * This service can't be used together with `GeometryQueryTracer`.
+ */
+class geo::GeometryQueryMonitor : public geo::QueryRecorder {
+public:
+  struct Config {
+    fhicl::Atom<unsigned int> SamplingPeriod{
+      fhicl::Name("SamplingPeriod"),
+      fhicl::Comment("time one call every this many of each type (per thread)"),
+      64U};
+    fhicl::Atom<std::string> JSONFile{fhicl::Name("JSONFile"),
+                                      fhicl::Comment("JSON summary file (empty: none)"),
+                                      "GeometryQueries.json"};
+  };
+  using Parameters = art::ServiceTable<Config>;
+
+  GeometryQueryMonitor(Parameters const& config, art::ActivityRegistry& reg);
+
+  ~GeometryQueryMonitor() override;
+
+  bool startQuery(GeometryQuery query, double const* args, unsigned int nArgs) override;
+
+  void endQuery(GeometryQuery query, std::int64_t ns) override;
+
+private:
+  static constexpr std::size_t NQueries = static_cast<std::size_t>(GeometryQuery::NQueries);
+  static constexpr std::size_t NBins = 40; ///< Up to 2^39 ns (about 9 minutes).
+
+  /// Statistics of one query type.
+  struct QueryStats {
+    std::uint64_t calls = 0;
+    std::uint64_t timed = 0;
+    std::uint64_t totalNs = 0;
+    std::array<std::uint64_t, NBins> histogram{}; ///< Bin `b`: `[ 2^(b-1), 2^b [` ns.
+
+    QueryStats& operator+=(QueryStats const& other);
+
+    double meanNs() const { return timed ? double(totalNs) / timed : 0.0; }
+
+    /// Returns the upper edge of the bin with the `q` quantile of the times.
+    std::uint64_t quantileNs(double q) const;
+  };
+
+  using ModuleStats = std::array<QueryStats, NQueries>;
+
+  /// Statistics collected by a single thread.
+  struct ThreadTable {
+    std::unordered_map<std::string, ModuleStats> modules;
+    std::array<unsigned int, NQueries> untilSample{};
+  };
+
+  unsigned int const fSamplingPeriod;
+  std::string const fJSONFile;
+  std::uint64_t const fID; ///< Unique identifier of this object.
+
+  std::vector<std::unique_ptr<ThreadTable>> fTables; ///< One per thread.
+  std::mutex fTablesMutex;                           ///< Protects `fTables`.
+
+  /// Per-thread state: table and statistics of the current module.
+  struct ThreadState {
+    ThreadTable* table;
+    ModuleStats* module;
+  };
+
+  /// Returns the state of the calling thread, creating its table if needed.
+  ThreadState& threadState();
+
+  void preModule(art::ModuleContext const& context);
+  void postModule(art::ModuleContext const& context);
+  void postEndJob();
+
+  /// Merges the statistics of all threads, by module.
+  std::map<std::string, ModuleStats> collect() const;
+
+  void printSummary(std::map<std::string, ModuleStats> const& stats) const;
+  void writeJSON(std::map<std::string, ModuleStats> const& stats) const;
+
+}; // geo::GeometryQueryMonitor
+
+// -----------------------------------------------------------------------------
+// --- implementation
+// -----------------------------------------------------------------------------
+namespace {
+
+  constexpr char const* NoModule = "(no module)";
+
+  std::atomic<std::uint64_t> NextMonitorID{0};
+
+} // local namespace
+
+// -----------------------------------------------------------------------------
+auto geo::GeometryQueryMonitor::QueryStats::operator+=(QueryStats const& other) -> QueryStats&
+{
+  calls += other.calls;
+  timed += other.timed;
+  totalNs += other.totalNs;
+  for (std::size_t b = 0; b < NBins; ++b)
+    histogram[b] += other.histogram[b];
+  return *this;
+}
+
+// -----------------------------------------------------------------------------
+std::uint64_t geo::GeometryQueryMonitor::QueryStats::quantileNs(double q) const
+{
+  std::uint64_t const target = static_cast<std::uint64_t>(q * timed);
+  std::uint64_t seen = 0;
+  for (std::size_t b = 0; b < NBins; ++b) {
+    seen += histogram[b];
+    if (seen > target) return std::uint64_t{1} << b;
+  }
+  return std::uint64_t{1} << (NBins - 1);
+}
+
+// -----------------------------------------------------------------------------
+geo::GeometryQueryMonitor::GeometryQueryMonitor(Parameters const& config,
+                                                art::ActivityRegistry& reg)
+  : fSamplingPeriod{std::max(config().SamplingPeriod(), 1U)}
+  , fJSONFile{config().JSONFile()}
+  , fID{NextMonitorID++}
+{
+  if (QueryRecorder::install(this)) {
+    QueryRecorder::install(nullptr);
+    throw cet::exception("GeometryQueryMonitor") << "Another geometry query recorder is active.\n";
+  }
+  reg.sPreModule.watch(this, &GeometryQueryMonitor::preModule);
+  reg.sPostModule.watch(this, &GeometryQueryMonitor::postModule);
+  reg.sPostEndJob.watch(this, &GeometryQueryMonitor::postEndJob);
+}
+
+// -----------------------------------------------------------------------------
+geo::GeometryQueryMonitor::~GeometryQueryMonitor()
+{
+  if (QueryRecorder::current() == this) QueryRecorder::install(nullptr);
+}
+
+// -----------------------------------------------------------------------------
+bool geo::GeometryQueryMonitor::startQuery(GeometryQuery query,
+                                          double const* /* args */,
+                                          unsigned int /* nArgs */)
+{
+  unsigned int& countdown = threadState().table->untilSample[static_cast<std::size_t>(query)];
+  if (countdown > 0) {
+    --countdown;
+    return false;
+  }
+  countdown = fSamplingPeriod - 1;
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+void geo::GeometryQueryMonitor::endQuery(GeometryQuery query, std::int64_t ns)
+{
+  QueryStats& stats = (*threadState().module)[static_cast<std::size_t>(query)];
+  ++stats.calls;
+  if (ns < 0) return;
+  ++stats.timed;
+  stats.totalNs += ns;
+  ++stats.histogram[std::min<std::size_t>(std::bit_width(std::uint64_t(ns)), NBins - 1)];
+}
+
+// -----------------------------------------------------------------------------
+auto geo::GeometryQueryMonitor::threadState() -> ThreadState&
+{
+  // states of the current thread, by monitor; monitors are never many
+  struct OwnedState {
+    std::uint64_t ownerID;
+    ThreadState state;
+  };
+  thread_local std::vector<OwnedState> States;
+
+  for (OwnedState& entry : States) {
+    if (entry.ownerID == fID) return entry.state;
+  }
+
+  ThreadTable* table = nullptr;
+  {
+    std::lock_guard const lock{fTablesMutex};
+    fTables.push_back(std::make_unique<ThreadTable>());
+    table = fTables.back().get();
+  }
+  States.push_back({fID, {table, &table->modules[NoModule]}});
+  return States.back().state;
+}
+
+// -----------------------------------------------------------------------------
+void geo::GeometryQueryMonitor::preModule(art::ModuleContext const& context)
+{
+  ThreadState& state = threadState();
+  state.module = &state.table->modules[context.moduleLabel()];
+}
+
+// -----------------------------------------------------------------------------
+void geo::GeometryQueryMonitor::postModule(art::ModuleContext const&)
+{
+  ThreadState& state = threadState();
+  state.module = &state.table->modules[NoModule];
+}
+
+// -----------------------------------------------------------------------------
+void geo::GeometryQueryMonitor::postEndJob()
+{
+  auto const stats = collect();
+  printSummary(stats);
+  if (!fJSONFile.empty()) writeJSON(stats);
+}
+
+// -----------------------------------------------------------------------------
+auto geo::GeometryQueryMonitor::collect() const -> std::map<std::string, ModuleStats>
+{
+  std::map<std::string, ModuleStats> merged;
+  for (auto const& table : fTables) {
+    for (auto const& [label, moduleStats] : table->modules) {
+      ModuleStats& total = merged[label];
+      for (std::size_t q = 0; q < NQueries; ++q)
+        total[q] += moduleStats[q];
+    }
+  }
+  return merged;
+}
+
+// -----------------------------------------------------------------------------
+void geo::GeometryQueryMonitor::printSummary(std::map<std::string, ModuleStats> const& stats) const
+{
+  mf::LogInfo log{"GeometryQueryMonitor"};
+  log << "Geometry queries (" << fTables.size() << " threads, one call in " << fSamplingPeriod
+      << " timed):\n"
+      << std::setw(24) << std::left << "module" << std::setw(20) << "query" << std::right
+      << std::setw(14) << "calls" << std::setw(10) << "timed" << std::setw(12) << "mean [ns]"
+      << std::setw(12) << "p50 [ns]" << std::setw(12) << "p99 [ns]";
+  for (auto const& [label, moduleStats] : stats) {
+    for (std::size_t q = 0; q < NQueries; ++q) {
+      QueryStats const& s = moduleStats[q];
+      if (s.calls == 0) continue;
+      log << "\n"
+          << std::setw(24) << std::left << label << std::setw(20)
+          << queryName(static_cast<GeometryQuery>(q)) << std::right << std::setw(14) << s.calls
+          << std::setw(10) << s.timed << std::setw(12) << std::fixed << std::setprecision(0)
+          << s.meanNs() << std::setw(12) << s.quantileNs(0.5) << std::setw(12)
+          << s.quantileNs(0.99);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+void geo::GeometryQueryMonitor::writeJSON(std::map<std::string, ModuleStats> const& stats) const
+{
+  std::ofstream out{fJSONFile};
+  if (!out) {
+    throw cet::exception("GeometryQueryMonitor")
+      << "Could not open '" << fJSONFile << "' for writing.\n";
+  }
+
+  out << "{\n  \"samplingPeriod\": " << fSamplingPeriod << ",\n  \"threads\": " << fTables.size()
+      << ",\n  \"histogramBinEdgesNs\": \"bin b: [2^(b-1), 2^b)\",\n  \"modules\": {";
+  char const* moduleSep = "\n";
+  for (auto const& [label, moduleStats] : stats) {
+    out << moduleSep << "    \"" << label << "\": {";
+    moduleSep = ",\n";
+    char const* querySep = "\n";
+    for (std::size_t q = 0; q < NQueries; ++q) {
+      QueryStats const& s = moduleStats[q];
+      if (s.calls == 0) continue;
+      out << querySep << "      \"" << queryName(static_cast<GeometryQuery>(q))
+          << "\": {\"calls\": " << s.calls << ", \"timed\": " << s.timed
+          << ", \"meanNs\": " << s.meanNs() << ", \"p50Ns\": " << s.quantileNs(0.5)
+          << ", \"p99Ns\": " << s.quantileNs(0.99) << ", \"histogram\": [";
+      querySep = ",\n";
+      for (std::size_t b = 0; b < NBins; ++b)
+        out << (b ? ", " : "") << s.histogram[b];
+      out << "]}";
+    }
+    out << "\n    }";
+  }
+  out << "\n  }\n}\n";
+  mf::LogInfo("GeometryQueryMonitor") << "Geometry query summary written into '" << fJSONFile
+                                      << "'";
+}
+
+// -----------------------------------------------------------------------------
+DECLARE_ART_SERVICE(geo::GeometryQueryMonitor, SHARED)
+DEFINE_ART_SERVICE(geo::GeometryQueryMonitor)
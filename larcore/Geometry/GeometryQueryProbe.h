@@ -0,0 +1,185 @@
+/**
+ * @file   larcore/Geometry/GeometryQueryProbe.h
+ * @brief  Hooks reporting geometry queries to an optional recorder.
+ * @see    larcore/Geometry/GeometryQueryMonitor_service.cc
+ *
+ * This header has no link dependency: the recorder is installed at run time
+ * (e.g. by the `GeometryQueryMonitor` or `GeometryQueryTracer` service).
+ * Without a recorder, a probe costs a single relaxed atomic load and a branch.
+ *
+ * The probes are in the point and position queries of the `geo::Geometry`
+ * service and in the channel and wire queries of the `geo::WireReadout`
+ * service (see `geo::GeometryQuery` for the list). The service providers
+ * (`geo::GeometryCore`, `geo::WireReadoutGeom`) belong to `larcorealg` and are
+ * not instrumented: the same queries made on them, e.g. through
+ * `geo::Geometry::provider()` or `geo::WireReadout::Get()`, are not reported.
+ */
+
+#ifndef LARCORE_GEOMETRY_GEOMETRYQUERYPROBE_H
+#define LARCORE_GEOMETRY_GEOMETRYQUERYPROBE_H
+
+// C/C++ standard libraries
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint> // std::int64_t
+#include <type_traits>
+
+namespace geo {
+
+  /// Geometry queries reported to `geo::QueryRecorder` (new ones go last).
+  enum class GeometryQuery : unsigned int {
+    FindNode,           ///< `geo::Geometry::FindNode()`
+    VolumeName,         ///< `geo::Geometry::VolumeName()`
+    Material,           ///< `geo::Geometry::Material()`
+    MassBetweenPoints,  ///< `geo::Geometry::MassBetweenPoints()`
+    FindTPCHinted,      ///< `geo::Geometry` hinted TPC queries
+    FindCryostatHinted, ///< `geo::Geometry` hinted cryostat queries
+    FindTPC,            ///< `geo::Geometry` TPC at a position (`FindTPCAtPosition()`...)
+    FindCryostat,       ///< `geo::Geometry` cryostat at a position
+    ChannelToWire,      ///< `geo::WireReadout::ChannelToWire()`
+    PlaneWireToChannel, ///< `geo::WireReadout::PlaneWireToChannel()`
+    NearestWireID,      ///< `geo::WireReadout::NearestWireID()`
+    NearestChannel,     ///< `geo::WireReadout::NearestChannel()`
+    WireCoordinate,     ///< `geo::WireReadout::WireCoordinate()`
+    NQueries            ///< Number of query types.
+  };
+
+  /// Returns the name of the query type `query`.
+  constexpr char const* queryName(GeometryQuery query)
+  {
+    constexpr char const* names[] = {"FindNode",
+                                     "VolumeName",
+                                     "Material",
+                                     "MassBetweenPoints",
+                                     "FindTPCHinted",
+                                     "FindCryostatHinted",
+                                     "FindTPC",
+                                     "FindCryostat",
+                                     "ChannelToWire",
+                                     "PlaneWireToChannel",
+                                     "NearestWireID",
+                                     "NearestChannel",
+                                     "WireCoordinate"};
+    return (query < GeometryQuery::NQueries) ? names[static_cast<unsigned int>(query)] :
+                                               "<unknown>";
+  }
+
+  /**
+   * @brief Interface of a collector of geometry query statistics.
+   *
+   * At most one recorder is installed at a time; it is called concurrently
+   * from all the threads performing queries.
+   */
+  class QueryRecorder {
+  public:
+    virtual ~QueryRecorder() = default;
+
+    /**
+     * @brief Records the start of `query`; returns whether it should be timed.
+     * @param query type of the query
+     * @param args arguments of the query, as numbers (see `geo::QueryProbe`)
+     * @param nArgs number of values in `args`
+     */
+    virtual bool startQuery(GeometryQuery query, double const* args, unsigned int nArgs) = 0;
+
+    /// Records a completed `query`, which took `ns` nanoseconds (`-1` if not timed).
+    virtual void endQuery(GeometryQuery query, std::int64_t ns) = 0;
+
+    /// Returns the installed recorder (`nullptr` if none).
+    static QueryRecorder* current() { return fCurrent.load(std::memory_order_relaxed); }
+
+    /// Installs `recorder` (`nullptr` to uninstall); returns the previous one.
+    static QueryRecorder* install(QueryRecorder* recorder) { return fCurrent.exchange(recorder); }
+
+  private:
+    static inline std::atomic<QueryRecorder*> fCurrent{nullptr};
+  };
+
+  /**
+   * @brief Reports the query `Query` from its construction to its destruction.
+   *
+   * The arguments of the query are passed to the constructor, and converted
+   * into numbers only if a recorder is installed:
+   *
+   * * points (any type with `X()`, `Y()` and `Z()`): x, y and z [cm];
+   * * IDs (`geo::PlaneID`, `geo::WireID`...): their numbers, from `Cryostat`
+   *   to the last one of the ID;
+   * * numbers (e.g. a channel): themselves.
+   */
+  template <GeometryQuery Query>
+  class QueryProbe {
+  public:
+    template <typename... Args>
+    explicit QueryProbe(Args const&... args) : fRecorder{QueryRecorder::current()}
+    {
+      if (!fRecorder) return;
+      std::array<double, (nValues<Args>() + ... + 0)> values;
+      [[maybe_unused]] double* value = values.data();
+      ((value = pack(value, args)), ...);
+      if (fRecorder->startQuery(Query, values.data(), values.size())) fStart = Clock_t::now();
+    }
+
+    ~QueryProbe()
+    {
+      if (!fRecorder) return;
+      std::int64_t const ns =
+        (fStart == Clock_t::time_point{}) ?
+          -1 :
+          std::chrono::duration_cast<std::chrono::nanoseconds>(Clock_t::now() - fStart).count();
+      fRecorder->endQuery(Query, ns);
+    }
+
+    QueryProbe(QueryProbe const&) = delete;
+    QueryProbe& operator=(QueryProbe const&) = delete;
+
+  private:
+    using Clock_t = std::chrono::steady_clock;
+
+    QueryRecorder* const fRecorder;
+    Clock_t::time_point fStart{};
+
+    /// Returns how many numbers an argument of type `T` is packed into.
+    template <typename T>
+    static constexpr unsigned int nValues()
+    {
+      if constexpr (requires(T const& p) { p.X(), p.Y(), p.Z(); })
+        return 3;
+      else if constexpr (requires(T const& id) { id.Wire; })
+        return 4;
+      else if constexpr (requires(T const& id) { id.Plane; })
+        return 3;
+      else if constexpr (requires(T const& id) { id.TPC; })
+        return 2;
+      else if constexpr (requires(T const& id) { id.Cryostat; })
+        return 1;
+      else {
+        static_assert(std::is_arithmetic_v<T>, "Unsupported geometry query argument type.");
+        return 1;
+      }
+    }
+
+    /// Writes the numbers of `arg` starting at `values`; returns the end of them.
+    template <typename T>
+    static double* pack(double* values, T const& arg)
+    {
+      if constexpr (requires(T const& p) { p.X(), p.Y(), p.Z(); }) {
+        *values++ = arg.X();
+        *values++ = arg.Y();
+        *values++ = arg.Z();
+      }
+      else if constexpr (std::is_arithmetic_v<T>)
+        *values++ = static_cast<double>(arg);
+      else {
+        *values++ = arg.Cryostat;
+        if constexpr (nValues<T>() > 1) *values++ = arg.TPC;
+        if constexpr (nValues<T>() > 2) *values++ = arg.Plane;
+        if constexpr (nValues<T>() > 3) *values++ = arg.Wire;
+      }
+      return values;
+    }
+  };
+
+} // namespace geo
+
+#endif // LARCORE_GEOMETRY_GEOMETRYQUERYPROBE_H
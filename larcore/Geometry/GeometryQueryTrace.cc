@@ -0,0 +1,108 @@
+/**
+ * @file   larcore/Geometry/GeometryQueryTrace.cc
+ * @brief  Binary traces of geometry queries, for replaying them offline.
+ * @see    larcore/Geometry/GeometryQueryTrace.h
+ */
+
+// library header
+#include "larcore/Geometry/GeometryQueryTrace.h"
+
+// framework libraries
+#include "cetlib_except/exception.h"
+
+// C/C++ standard libraries
+#include <cstring> // std::memcmp()
+
+namespace {
+
+  constexpr char Magic[8] = {'L', 'A', 'R', 'G', 'E', 'O', 'Q', 'T'};
+  constexpr std::uint32_t FormatVersion = 2;
+
+  template <typename T>
+  void writeValue(std::ostream& out, T const& value)
+  {
+    out.write(reinterpret_cast<char const*>(&value), sizeof(value));
+  }
+
+  template <typename T>
+  bool readValue(std::istream& in, T& value)
+  {
+    return bool(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+geo::QueryTraceWriter::QueryTraceWriter(std::string const& path)
+  : fPath{path}, fOut{path, std::ios::binary | std::ios::trunc}
+{
+  if (!fOut) {
+    throw cet::exception("QueryTraceWriter") << "Could not create trace file '" << path << "'.\n";
+  }
+  fOut.write(Magic, sizeof(Magic));
+  writeValue(fOut, FormatVersion);
+}
+
+//------------------------------------------------------------------------------
+void geo::QueryTraceWriter::write(std::vector<QueryTraceRecord> const& records)
+{
+  std::lock_guard const lock{fMutex};
+  for (QueryTraceRecord const& record : records) {
+    writeValue(fOut, static_cast<std::uint8_t>(record.query));
+    writeValue(fOut, record.nArgs);
+    writeValue(fOut, record.thread);
+    fOut.write(reinterpret_cast<char const*>(record.args.data()), record.nArgs * sizeof(double));
+  }
+  fOut.flush();
+  if (!fOut) {
+    throw cet::exception("QueryTraceWriter") << "Error writing trace file '" << fPath << "'.\n";
+  }
+  fNRecords += records.size();
+}
+
+//------------------------------------------------------------------------------
+std::uint64_t geo::QueryTraceWriter::nRecords() const
+{
+  std::lock_guard const lock{fMutex};
+  return fNRecords;
+}
+
+//------------------------------------------------------------------------------
+std::vector<geo::QueryTraceRecord> geo::readQueryTrace(std::string const& path)
+{
+  std::ifstream in{path, std::ios::binary};
+  if (!in) {
+    throw cet::exception("readQueryTrace") << "Could not open trace file '" << path << "'.\n";
+  }
+
+  char magic[sizeof(Magic)];
+  std::uint32_t version = 0;
+  if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, Magic, sizeof(Magic)) ||
+      !readValue(in, version)) {
+    throw cet::exception("readQueryTrace") << "'" << path << "' is not a query trace file.\n";
+  }
+  if ((version < 1) || (version > FormatVersion)) {
+    throw cet::exception("readQueryTrace")
+      << "Trace file '" << path << "' has format version " << version << ", only 1 to "
+      << FormatVersion << " are supported.\n";
+  }
+  // version 1 stored the number of points, each with 3 coordinates
+  unsigned int const argsPerCount = (version == 1) ? 3 : 1;
+
+  std::vector<QueryTraceRecord> records;
+  std::uint8_t query = 0;
+  while (readValue(in, query)) {
+    QueryTraceRecord record;
+    record.query = static_cast<GeometryQuery>(query);
+    bool const good = readValue(in, record.nArgs) && readValue(in, record.thread);
+    record.nArgs *= argsPerCount;
+    if (!good || (record.query >= GeometryQuery::NQueries) ||
+        (record.nArgs > QueryTraceRecord::MaxArgs) ||
+        !in.read(reinterpret_cast<char*>(record.args.data()), record.nArgs * sizeof(double))) {
+      throw cet::exception("readQueryTrace")
+        << "Trace file '" << path << "' is corrupted after " << records.size() << " records.\n";
+    }
+    records.push_back(record);
+  }
+  return records;
+}
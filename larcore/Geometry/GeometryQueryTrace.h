@@ -0,0 +1,83 @@
+/**
+ * @file   larcore/Geometry/GeometryQueryTrace.h
+ * @brief  Binary traces of geometry queries, for replaying them offline.
+ * @see    larcore/Geometry/GeometryQueryTrace.cc
+ *         larcore/Geometry/GeometryQueryTracer_service.cc
+ *
+ * A trace file starts with the 8 characters `LARGEOQT` and a 32-bit format
+ * version, followed by one record per query:
+ *
+ * * query type (`geo::GeometryQuery`, 8 bits);
+ * * number of arguments `N` (8 bits);
+ * * index of the thread which made the query (16 bits);
+ * * `N` arguments (64-bit floating point), as packed by `geo::QueryProbe`:
+ *   x, y, z of each point [cm], the numbers of each ID, channel numbers.
+ *
+ * All numbers are stored in the byte order of the machine writing the trace.
+ * Version 1 traces, which stored the number of points instead of the number of
+ * arguments, can still be read.
+ *
+ * The traces hold all the queries reported by `geo::QueryProbe`: those of the
+ * `geo::Geometry` service and the channel and wire queries of the
+ * `geo::WireReadout` service.
+ */
+
+#ifndef LARCORE_GEOMETRY_GEOMETRYQUERYTRACE_H
+#define LARCORE_GEOMETRY_GEOMETRYQUERYTRACE_H
+
+// LArSoft libraries
+#include "larcore/Geometry/GeometryQueryProbe.h"
+
+// C/C++ standard libraries
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace geo {
+
+  /// A query recorded in a trace.
+  struct QueryTraceRecord {
+    static constexpr unsigned int MaxArgs = 6; ///< Two points, or a point and an ID.
+
+    GeometryQuery query = GeometryQuery::NQueries;
+    std::uint16_t thread = 0;           ///< Index of the querying thread.
+    std::uint8_t nArgs = 0;             ///< Number of arguments of the query.
+    std::array<double, MaxArgs> args{}; ///< Arguments, as packed by `geo::QueryProbe`.
+  };
+
+  /**
+   * @brief Writes query records into a trace file.
+   *
+   * Records can be written concurrently from different threads; each call of
+   * `write()` is written contiguously.
+   */
+  class QueryTraceWriter {
+  public:
+    /// Creates the trace file `path` and writes its header.
+    explicit QueryTraceWriter(std::string const& path);
+
+    /// Appends all `records` to the trace.
+    void write(std::vector<QueryTraceRecord> const& records);
+
+    /// Returns the number of records written so far.
+    std::uint64_t nRecords() const;
+
+    /// Returns the path of the trace file.
+    std::string const& path() const { return fPath; }
+
+  private:
+    std::string fPath;
+    std::ofstream fOut;
+    std::uint64_t fNRecords = 0;
+    mutable std::mutex fMutex; ///< Protects the output stream and the counter.
+  };
+
+  /// Reads all the records of the trace file `path`; throws `cet::exception` on error.
+  std::vector<QueryTraceRecord> readQueryTrace(std::string const& path);
+
+} // namespace geo
+
+#endif // LARCORE_GEOMETRY_GEOMETRYQUERYTRACE_H
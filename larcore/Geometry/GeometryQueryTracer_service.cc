@@ -0,0 +1,213 @@
+/**
+ * @file   larcore/Geometry/GeometryQueryTracer_service.cc
+ * @brief  Service recording the geometry queries of a job into a binary trace.
+ * @see    larcore/Geometry/GeometryQueryTrace.h
+ */
+
+// LArSoft libraries
+#include "larcore/Geometry/GeometryQueryProbe.h"
+#include "larcore/Geometry/GeometryQueryTrace.h"
+
+// framework libraries
+#include "art/Framework/Services/Registry/ActivityRegistry.h"
+#include "art/Framework/Services/Registry/ServiceDeclarationMacros.h"
+#include "art/Framework/Services/Registry/ServiceDefinitionMacros.h"
+#include "art/Framework/Services/Registry/ServiceTable.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/types/Atom.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+// C/C++ standard libraries
+#include <algorithm> // std::copy_n()
+#include <atomic>
+#include <cstdint>
+#include <memory> // std::unique_ptr
+#include <mutex>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+namespace geo {
+  class GeometryQueryTracer;
+}
+/**
+ * @brief Records the geometry queries of the job into a binary trace file.
+ *
+ * The queries reported by `geo::QueryProbe` (the point and position queries
+ * of the `geo::Geometry` service and the channel and wire queries of the
+ * `geo::WireReadout` service) are recorded with their type, their arguments
+ * and the index of the thread which made them (see `geo::QueryTraceRecord`
+ * for the format). The trace can be replayed on the
+ * same geometry by `replay_geometry_queries` (in `test/Geometry`), to measure
+ * changes of the geometry code against the access pattern of real jobs.
+ *
+ * Each thread collects its queries in a buffer of its own, which is written
+ * into the trace when full; all the buffers are written at the end of the job.
+ * The records of each thread are therefore in the order of the queries, while
+ * the order of the queries of different threads is not preserved.
+ *
+ * @note Only the queries made on the services are recorded. The queries to
+ *       the service providers are not visible to this service: neither the
+ *       ones through `geo::Geometry::provider()`, nor the ones on the
+ *       `geo::WireReadoutGeom` returned by `geo::WireReadout::Get()`.
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * services.GeometryQueryTracer: {
+ *   TraceFile: "GeometryQueries.trace"
+ *   MaxRecords: 0
+ * }
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * Configuration
+ * -------------
+ *
+ * - *TraceFile* (string, default: `GeometryQueries.trace`): path of the trace
+ * - *MaxRecords* (integer, default: `0`): stop recording after this many
+ *   queries (`0`: no limit)
+ * - *BufferSize* (integer, default: `4096`): queries collected by each thread
+ *   before writing them
+ *
+ * This service can't be used together with `GeometryQueryMonitor`.
+ */
+class geo::GeometryQueryTracer : public geo::QueryRecorder {
+public:
+  struct Config {
+    fhicl::Atom<std::string> TraceFile{fhicl::Name("TraceFile"),
+                                       fhicl::Comment("path of the binary trace"),
+                                       "GeometryQueries.trace"};
+    fhicl::Atom<unsigned long long> MaxRecords{
+      fhicl::Name("MaxRecords"),
+      fhicl::Comment("stop recording after this many queries (0: no limit)"),
+      0ULL};
+    fhicl::Atom<unsigned int> BufferSize{
+      fhicl::Name("BufferSize"),
+      fhicl::Comment("queries collected by each thread before writing them"),
+      4096U};
+  };
+  using Parameters = art::ServiceTable<Config>;
+
+  GeometryQueryTracer(Parameters const& config, art::ActivityRegistry& reg);
+
+  ~GeometryQueryTracer() override;
+
+  bool startQuery(GeometryQuery query, double const* args, unsigned int nArgs) override;
+
+  void endQuery(GeometryQuery, std::int64_t) override {}
+
+private:
+  /// Queries of a single thread not yet written.
+  struct ThreadBuffer {
+    std::uint16_t thread;
+    std::vector<QueryTraceRecord> records;
+  };
+
+  std::uint64_t const fMaxRecords;
+  std::size_t const fBufferSize;
+  std::uint64_t const fID; ///< Unique identifier of this object.
+
+  QueryTraceWriter fWriter;
+  std::atomic<std::uint64_t> fNRecorded{0};
+
+  std::vector<std::unique_ptr<ThreadBuffer>> fBuffers; ///< One per thread.
+  std::mutex fBuffersMutex;                            ///< Protects `fBuffers`.
+
+  /// Returns the buffer of the calling thread, creating it if needed.
+  ThreadBuffer& threadBuffer();
+
+  void postEndJob();
+
+}; // geo::GeometryQueryTracer
+
+// -----------------------------------------------------------------------------
+// --- implementation
+// -----------------------------------------------------------------------------
+namespace {
+
+  std::atomic<std::uint64_t> NextTracerID{0};
+
+} // local namespace
+
+// -----------------------------------------------------------------------------
+geo::GeometryQueryTracer::GeometryQueryTracer(Parameters const& config,
+                                              art::ActivityRegistry& reg)
+  : fMaxRecords{config().MaxRecords()}
+  , fBufferSize{std::max(config().BufferSize(), 1U)}
+  , fID{NextTracerID++}
+  , fWriter{config().TraceFile()}
+{
+  if (QueryRecorder::install(this)) {
+    QueryRecorder::install(nullptr);
+    throw cet::exception("GeometryQueryTracer") << "Another geometry query recorder is active.\n";
+  }
+  reg.sPostEndJob.watch(this, &GeometryQueryTracer::postEndJob);
+}
+
+// -----------------------------------------------------------------------------
+geo::GeometryQueryTracer::~GeometryQueryTracer()
+{
+  if (QueryRecorder::current() == this) QueryRecorder::install(nullptr);
+}
+
+// -----------------------------------------------------------------------------
+bool geo::GeometryQueryTracer::startQuery(GeometryQuery query,
+                                          double const* args,
+                                          unsigned int nArgs)
+{
+  if (fMaxRecords && (fNRecorded.fetch_add(1, std::memory_order_relaxed) >= fMaxRecords))
+    return false;
+
+  ThreadBuffer& buffer = threadBuffer();
+  QueryTraceRecord& record = buffer.records.emplace_back();
+  record.query = query;
+  record.thread = buffer.thread;
+  record.nArgs = std::min(nArgs, QueryTraceRecord::MaxArgs);
+  std::copy_n(args, record.nArgs, record.args.begin());
+
+  if (buffer.records.size() >= fBufferSize) {
+    fWriter.write(buffer.records);
+    buffer.records.clear();
+  }
+  return false;
+}
+
+// -----------------------------------------------------------------------------
+auto geo::GeometryQueryTracer::threadBuffer() -> ThreadBuffer&
+{
+  // buffers of the current thread, by tracer; tracers are never many
+  struct OwnedBuffer {
+    std::uint64_t ownerID;
+    ThreadBuffer* buffer;
+  };
+  thread_local std::vector<OwnedBuffer> Buffers;
+
+  for (OwnedBuffer const& entry : Buffers) {
+    if (entry.ownerID == fID) return *entry.buffer;
+  }
+
+  ThreadBuffer* buffer = nullptr;
+  {
+    std::lock_guard const lock{fBuffersMutex};
+    fBuffers.push_back(std::make_unique<ThreadBuffer>());
+    buffer = fBuffers.back().get();
+    buffer->thread = static_cast<std::uint16_t>(fBuffers.size() - 1);
+  }
+  buffer->records.reserve(fBufferSize);
+  Buffers.push_back({fID, buffer});
+  return *buffer;
+}
+
+// -----------------------------------------------------------------------------
+void geo::GeometryQueryTracer::postEndJob()
+{
+  for (auto const& buffer : fBuffers) {
+    fWriter.write(buffer->records);
+    buffer->records.clear();
+  }
+  mf::LogInfo("GeometryQueryTracer")
+    << fWriter.nRecords() << " geometry queries from " << fBuffers.size()
+    << " threads written into '" << fWriter.path() << "'";
+}
+
+// -----------------------------------------------------------------------------
+DECLARE_ART_SERVICE(geo::GeometryQueryTracer, SHARED)
+DEFINE_ART_SERVICE(geo::GeometryQueryTracer)
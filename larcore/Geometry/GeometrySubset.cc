@@ -0,0 +1,104 @@
+/**
+ * @file   larcore/Geometry/GeometrySubset.cc
+ * @brief  Selection of the cryostats and TPCs of the detector served to a job.
+ * @see    larcore/Geometry/GeometrySubset.h
+ */
+
+// library header
+#include "larcore/Geometry/GeometrySubset.h"
+
+// LArSoft libraries
+#include "larcorealg/Geometry/GeometryCore.h"
+
+// framework libraries
+#include "cetlib_except/exception.h"
+
+//------------------------------------------------------------------------------
+geo::GeometrySubset::GeometrySubset(GeometryCore const& geom)
+  : GeometrySubset{geom, {}, {}}
+{}
+
+//------------------------------------------------------------------------------
+geo::GeometrySubset::GeometrySubset(GeometryCore const& geom,
+                                    std::vector<CryostatID> const& cryostats,
+                                    std::vector<TPCID> const& tpcs)
+{
+  fCryostatFirst.push_back(0);
+  for (CryostatID const& cryoid : geom.Iterate<CryostatID>())
+    fCryostatFirst.push_back(fCryostatFirst.back() + geom.NTPC(cryoid));
+
+  // no selection: everything
+  bool const all = cryostats.empty() && tpcs.empty();
+  fSelected.assign(fCryostatFirst.back(), all);
+
+  for (CryostatID const& cryoid : cryostats) {
+    if (!cryoid.isValid || (cryoid.Cryostat + 1 >= fCryostatFirst.size())) {
+      throw cet::exception("GeometrySubset")
+        << "Cryostat " << cryoid << " is not in the detector ("
+        << (fCryostatFirst.size() - 1) << " cryostats).\n";
+    }
+    for (std::size_t i = fCryostatFirst[cryoid.Cryostat]; i < fCryostatFirst[cryoid.Cryostat + 1];
+         ++i)
+      fSelected[i] = true;
+  }
+  for (TPCID const& tpcid : tpcs) {
+    std::size_t const i = index(tpcid);
+    if (i == fSelected.size()) {
+      throw cet::exception("GeometrySubset") << "TPC " << tpcid << " is not in the detector.\n";
+    }
+    fSelected[i] = true;
+  }
+  fillIDs();
+
+  if (!all && fTPCs.empty()) {
+    throw cet::exception("GeometrySubset") << "No TPC selected in the detector.\n";
+  }
+}
+
+//------------------------------------------------------------------------------
+bool geo::GeometrySubset::Contains(CryostatID const& cryoid) const
+{
+  if (!cryoid.isValid || (cryoid.Cryostat + 1 >= fCryostatFirst.size())) return false;
+  for (std::size_t i = fCryostatFirst[cryoid.Cryostat]; i < fCryostatFirst[cryoid.Cryostat + 1];
+       ++i) {
+    if (fSelected[i]) return true;
+  }
+  return false;
+}
+
+//------------------------------------------------------------------------------
+bool geo::GeometrySubset::Contains(TPCID const& tpcid) const
+{
+  std::size_t const i = index(tpcid);
+  return (i < fSelected.size()) && fSelected[i];
+}
+
+//------------------------------------------------------------------------------
+std::size_t geo::GeometrySubset::index(TPCID const& tpcid) const
+{
+  if (!tpcid.isValid || (tpcid.Cryostat + 1 >= fCryostatFirst.size())) return fSelected.size();
+  std::size_t const i = fCryostatFirst[tpcid.Cryostat] + tpcid.TPC;
+  return (i < fCryostatFirst[tpcid.Cryostat + 1]) ? i : fSelected.size();
+}
+
+//------------------------------------------------------------------------------
+void geo::GeometrySubset::fillIDs()
+{
+  for (unsigned int c = 0; c + 1 < fCryostatFirst.size(); ++c) {
+    bool any = false;
+    for (std::size_t i = fCryostatFirst[c]; i < fCryostatFirst[c + 1]; ++i) {
+      if (!fSelected[i]) continue;
+      fTPCs.emplace_back(c, static_cast<unsigned int>(i - fCryostatFirst[c]));
+      any = true;
+    }
+    if (any) fCryostats.emplace_back(c);
+  }
+}
+
+//------------------------------------------------------------------------------
+void geo::GeometrySubset::throwNotInSubset(std::string const& id) const
+{
+  throw cet::exception("GeometrySubset")
+    << id << " is not in the subset of the geometry served to this job (" << fTPCs.size()
+    << " of " << fSelected.size() << " TPCs).\n";
+}
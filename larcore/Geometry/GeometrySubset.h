@@ -0,0 +1,89 @@
+/**
+ * @file   larcore/Geometry/GeometrySubset.h
+ * @brief  Selection of the cryostats and TPCs of the detector served to a job.
+ * @see    larcore/Geometry/GeometrySubset.cc
+ */
+
+#ifndef LARCORE_GEOMETRY_GEOMETRYSUBSET_H
+#define LARCORE_GEOMETRY_GEOMETRYSUBSET_H
+
+// LArSoft libraries
+#include "larcorealg/Geometry/fwd.h"
+#include "larcoreobj/SimpleTypesAndConstants/geo_types.h"
+
+// C/C++ standard libraries
+#include <cstddef> // std::size_t
+#include <string>
+#include <vector>
+
+namespace geo {
+
+  /**
+   * @brief A subset of the TPCs of a detector, with their global IDs.
+   *
+   * Jobs processing only a part of the detector (e.g. one APA per worker)
+   * select the TPCs they need, either one by one or by whole cryostats. IDs
+   * keep the numbering of the whole detector. `Contains()` tells whether an
+   * ID (a TPC, or anything within a TPC like a plane or a wire) is in the
+   * subset in constant time; `Require()` throws if it is not, so that code
+   * reaching outside of the subset fails at the first query.
+   *
+   * A cryostat is in the subset if any of its TPCs is.
+   */
+  class GeometrySubset {
+  public:
+    /// Selects all the TPCs of `geom`.
+    explicit GeometrySubset(GeometryCore const& geom);
+
+    /**
+     * @brief Selects all the TPCs of the `cryostats` and the `tpcs` of `geom`.
+     * @throw cet::exception (category `GeometrySubset`) if an ID is not in `geom`
+     *        or nothing is selected
+     */
+    GeometrySubset(GeometryCore const& geom,
+                   std::vector<CryostatID> const& cryostats,
+                   std::vector<TPCID> const& tpcs);
+
+    /// Returns whether all the TPCs are selected.
+    bool isFull() const { return fTPCs.size() == fSelected.size(); }
+
+    /// Returns whether some TPC of the cryostat is selected.
+    bool Contains(CryostatID const& cryoid) const;
+
+    /// Returns whether the TPC (or the TPC of a plane or wire) is selected.
+    bool Contains(TPCID const& tpcid) const;
+
+    /// Throws `cet::exception` (category `GeometrySubset`) if `id` is not selected.
+    template <typename ID>
+    void Require(ID const& id) const
+    {
+      if (!Contains(id)) throwNotInSubset(std::string(id));
+    }
+
+    /// Returns the selected cryostats, sorted.
+    std::vector<CryostatID> const& CryostatIDs() const { return fCryostats; }
+
+    /// Returns the selected TPCs, sorted.
+    std::vector<TPCID> const& TPCIDs() const { return fTPCs; }
+
+    /// Returns the number of TPCs in the whole detector.
+    std::size_t NAllTPCs() const { return fSelected.size(); }
+
+  private:
+    std::vector<std::size_t> fCryostatFirst; ///< First TPC of each cryostat (and end).
+    std::vector<bool> fSelected;             ///< Whether each TPC is selected.
+    std::vector<CryostatID> fCryostats;      ///< The selected cryostats.
+    std::vector<TPCID> fTPCs;                ///< The selected TPCs.
+
+    /// Returns the index of `tpcid` in the whole detector (`NAllTPCs()` if none).
+    std::size_t index(TPCID const& tpcid) const;
+
+    /// Fills the lists of selected IDs from `fSelected`.
+    void fillIDs();
+
+    [[noreturn]] void throwNotInSubset(std::string const& id) const;
+  };
+
+} // namespace geo
+
+#endif // LARCORE_GEOMETRY_GEOMETRYSUBSET_H
@@ -0,0 +1,161 @@
+/**
+ * @file   larcore/Geometry/GeometrySwitcher.cc
+ * @brief  Service serving the detector geometry recorded in each run.
+ * @see    larcore/Geometry/GeometrySwitcher.h
+ */
+
+// library header
+#include "larcore/Geometry/GeometrySwitcher.h"
+
+// LArSoft libraries
+#include "larcore/Geometry/Geometry.h"
+#include "larcorealg/Geometry/GeoObjectSorter.h"
+#include "larcorealg/Geometry/GeometryBuilder.h"
+#include "larcorealg/Geometry/WireReadoutSorter.h"
+#include "larcorealg/Geometry/WireReadoutStandardGeom.h"
+#include "larcoreobj/SummaryData/GeometryConfigurationInfo.h"
+#include "larcoreobj/SummaryData/RunData.h"
+
+// framework libraries
+#include "art/Framework/Principal/Handle.h"
+#include "art/Framework/Principal/Run.h"
+#include "art/Framework/Services/Registry/ActivityRegistry.h"
+#include "art/Utilities/make_tool.h"
+#include "canvas/Utilities/InputTag.h"
+#include "cetlib_except/exception.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+// ROOT libraries
+#include "TGeoManager.h"
+
+// C/C++ standard libraries
+#include <algorithm> // std::transform()
+#include <cctype>    // std::tolower()
+#include <utility>   // std::move()
+#include <vector>
+
+namespace {
+
+  // GeometryCore stores detector names in lower case
+  std::string toLower(std::string s)
+  {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return std::tolower(c); });
+    return s;
+  }
+
+  // Returns the detector name recorded in the run (empty if none).
+  std::string runDetectorName(art::Run const& run)
+  {
+    if (auto h = run.getHandle<sumdata::GeometryConfigurationInfo>(
+          art::InputTag{"GeometryConfigurationWriter"})) {
+      return h->detectorName;
+    }
+    auto const allRunData = run.getMany<sumdata::RunData>();
+    return allRunData.empty() ? std::string{} : allRunData.front()->DetName();
+  }
+
+  // same default as StandardWireReadout
+  fhicl::ParameterSet defaultWireSorter()
+  {
+    fhicl::ParameterSet result;
+    result.put("tool_type", std::string{"WireReadoutSorterStandard"});
+    return result;
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+geo::GeometrySwitcher::GeometrySwitcher(fhicl::ParameterSet const& pset,
+                                        art::ActivityRegistry& reg)
+  : fCache{pset.get<std::size_t>("CacheSize", 2),
+           [this](std::string const& name) { return build(name); }}
+{
+  std::string firstName;
+  for (auto const& config : pset.get<std::vector<fhicl::ParameterSet>>("Configurations")) {
+    std::string const name =
+      toLower(config.get<fhicl::ParameterSet>("Geometry").get<std::string>("Name"));
+    if (!fConfigurations.emplace(name, config).second) {
+      throw cet::exception("GeometrySwitcher")
+        << "Geometry '" << name << "' is configured more than once.\n";
+    }
+    if (firstName.empty()) firstName = name;
+  }
+  if (fConfigurations.empty()) {
+    throw cet::exception("GeometrySwitcher") << "No geometry configured in 'Configurations'.\n";
+  }
+
+  select(toLower(pset.get<std::string>("Default", firstName)));
+
+  reg.sPreBeginRun.watch(this, &GeometrySwitcher::preBeginRun);
+}
+
+//------------------------------------------------------------------------------
+auto geo::GeometrySwitcher::current() const -> GeometryCache::Entry_t
+{
+  std::lock_guard const lock{fCurrentMutex};
+  return fCurrent;
+}
+
+//------------------------------------------------------------------------------
+void geo::GeometrySwitcher::select(std::string const& detectorName)
+{
+  std::string const name = toLower(detectorName);
+  if (fConfigurations.count(name) == 0) {
+    cet::exception e{"GeometrySwitcher"};
+    e << "No configuration for geometry '" << detectorName << "'; configured:";
+    for (auto const& [known, config] : fConfigurations)
+      e << " '" << known << "'";
+    throw e << "\n";
+  }
+
+  GeometryCache::Entry_t entry = fCache.get(name);
+  entry->activate();
+
+  std::lock_guard const lock{fCurrentMutex};
+  if (fCurrent != entry) {
+    mf::LogInfo("GeometrySwitcher") << "Switching to geometry '" << name << "' (" << fCache.hits()
+                                    << " cache hits, " << fCache.misses() << " misses)";
+  }
+  fCurrent = std::move(entry);
+}
+
+//------------------------------------------------------------------------------
+void geo::GeometrySwitcher::preBeginRun(art::Run const& run)
+{
+  std::string const name = runDetectorName(run);
+  if (name.empty()) {
+    mf::LogWarning("GeometrySwitcher")
+      << "No geometry information in " << run.id() << ": keeping geometry '" << current()->name
+      << "'.";
+    return;
+  }
+  select(name);
+}
+
+//------------------------------------------------------------------------------
+std::unique_ptr<geo::BuiltGeometry> geo::GeometrySwitcher::build(
+  std::string const& detectorName) const
+{
+  fhicl::ParameterSet const& config = fConfigurations.at(detectorName);
+  auto const geoConfig = config.get<fhicl::ParameterSet>("Geometry");
+  auto const readoutConfig = config.get<fhicl::ParameterSet>("WireReadout");
+
+  mf::LogInfo("GeometrySwitcher") << "Building geometry '" << detectorName << "'";
+
+  // the geometries already built are kept alive by the cache
+  BuiltGeometry::detachCurrentManager();
+
+  auto built = std::make_unique<BuiltGeometry>();
+  auto builder = details::prepareGeometry(geoConfig);
+  built->geom = std::make_unique<GeometryCore>(
+    geoConfig,
+    std::move(builder),
+    art::make_tool<GeoObjectSorter>(geoConfig.get<fhicl::ParameterSet>("SortingParameters", {})));
+  built->manager = gGeoManager;
+  built->wires = std::make_unique<WireReadoutStandardGeom>(
+    readoutConfig,
+    built->geom.get(),
+    art::make_tool<WireReadoutSorter>(
+      readoutConfig.get<fhicl::ParameterSet>("SortingParameters", defaultWireSorter())));
+  return built;
+}
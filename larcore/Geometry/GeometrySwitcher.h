@@ -0,0 +1,140 @@
+/**
+ * @file   larcore/Geometry/GeometrySwitcher.h
+ * @brief  Service serving the detector geometry recorded in each run.
+ * @see    larcore/Geometry/GeometrySwitcher.cc
+ */
+
+#ifndef LARCORE_GEOMETRY_GEOMETRYSWITCHER_H
+#define LARCORE_GEOMETRY_GEOMETRYSWITCHER_H
+
+// LArSoft libraries
+#include "larcore/Geometry/GeometryCache.h"
+#include "larcorealg/Geometry/GeometryCore.h"
+#include "larcorealg/Geometry/WireReadoutGeom.h"
+
+// framework libraries
+#include "art/Framework/Services/Registry/ServiceDeclarationMacros.h"
+#include "fhiclcpp/ParameterSet.h"
+
+// C/C++ standard libraries
+#include <map>
+#include <memory> // std::unique_ptr
+#include <mutex>
+#include <string>
+
+namespace art {
+  class ActivityRegistry;
+  class Run;
+}
+
+namespace geo {
+
+  /**
+   * @brief Serves, run by run, the geometry the run was produced with.
+   *
+   * The `Geometry` service describes a single detector for the whole job, and
+   * `GeometryConfigurationWriter` rejects input runs from other geometries.
+   * This service instead knows several geometry configurations, and at the
+   * beginning of each run it selects the one named in the geometry information
+   * of the run (`sumdata::GeometryConfigurationInfo` from
+   * `GeometryConfigurationWriter`, or the legacy `sumdata::RunData`).
+   * A run without geometry information keeps the current geometry.
+   *
+   * Geometries are built when first needed and kept in a cache
+   * (`geo::GeometryCache`) of limited size, so that alternating between a few
+   * configurations does not rebuild them every run.
+   *
+   * The geometry is switched before the modules see the new run, when no event
+   * is being processed. Pointers obtained from `provider()` and
+   * `wireReadout()` are valid until the end of the run, and should not be
+   * kept beyond it. The current ROOT geometry (`gGeoManager`) also follows the
+   * selected geometry.
+   *
+   * Scope
+   * ------
+   *
+   * This is a separate service, not a mode of `geo::Geometry` and
+   * `geo::WireReadout`: the geometry can't change under those, since their
+   * users are allowed to keep their providers, objects and channel maps for
+   * the whole job. Only code written against this service, through
+   * `provider()` and `wireReadout()`, follows the geometry of each run. In
+   * particular:
+   *
+   * - modules, tools and services using `art::ServiceHandle<geo::Geometry>` or
+   *   `geo::WireReadout` (which include most of LArSoft) can't run in a job
+   *   with this service, and the two services should not be configured with it;
+   * - the additions of the `geo::Geometry` service (per-thread navigators,
+   *   hinted queries, query monitoring, subsets) and the optional tables of
+   *   `geo::WireReadout` are not available: `provider()` and `wireReadout()`
+   *   are plain `geo::GeometryCore` and `geo::WireReadoutStandardGeom` objects;
+   * - only the standard wire readout is supported.
+   *
+   * If `GeometryConfigurationWriter` is used, its `SkipConfigurationCheck` must
+   * be set to `true`.
+   *
+   * Configuration
+   * --------------
+   *
+   * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   * GeometrySwitcher: {
+   *   CacheSize: 2
+   *   Default: "a"
+   *   Configurations: [
+   *     { Geometry: @local::geometry_A WireReadout: @local::readout_A },
+   *     { Geometry: @local::geometry_B WireReadout: @local::readout_B }
+   *   ]
+   * }
+   * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   *
+   * - *Configurations* (sequence of tables, mandatory): each table has the
+   *   configuration of a `Geometry` service (`Geometry`) and of a standard
+   *   `WireReadout` service (`WireReadout`); configurations are identified by
+   *   their detector name (`Geometry.Name`, case-insensitive)
+   * - *Default* (string, default: the first configuration): the geometry
+   *   served before the first run
+   * - *CacheSize* (integer, default: `2`): maximum number of geometries kept
+   *   in memory at the same time
+   */
+  class GeometrySwitcher {
+  public:
+    using provider_type = GeometryCore; ///< type of service provider
+
+    GeometrySwitcher(fhicl::ParameterSet const& pset, art::ActivityRegistry& reg);
+
+    /// Returns the current geometry.
+    provider_type const* provider() const { return current()->geom.get(); }
+
+    /// Returns the wire readout of the current geometry.
+    WireReadoutGeom const& wireReadout() const { return *(current()->wires); }
+
+    /// Returns the current geometry, with its ROOT geometry and wire readout.
+    GeometryCache::Entry_t current() const;
+
+    /// Makes the geometry with the specified detector name the current one.
+    /// @throw cet::exception (category: `GeometrySwitcher`) if not configured
+    void select(std::string const& detectorName);
+
+    /// Returns the cache of the geometries.
+    GeometryCache const& cache() const { return fCache; }
+
+  private:
+    /// Configurations of the known geometries, by detector name.
+    std::map<std::string, fhicl::ParameterSet> fConfigurations;
+
+    GeometryCache fCache; ///< Geometries built so far.
+
+    GeometryCache::Entry_t fCurrent; ///< The geometry currently served.
+    mutable std::mutex fCurrentMutex; ///< Protects `fCurrent`.
+
+    /// Selects the geometry recorded in the `run`.
+    void preBeginRun(art::Run const& run);
+
+    /// Builds the geometry for `detectorName` from its configuration.
+    std::unique_ptr<BuiltGeometry> build(std::string const& detectorName) const;
+  };
+
+} // namespace geo
+
+DECLARE_ART_SERVICE(geo::GeometrySwitcher, SHARED)
+
+#endif // LARCORE_GEOMETRY_GEOMETRYSWITCHER_H
@@ -0,0 +1,13 @@
+/**
+ * @file   larcore/Geometry/GeometrySwitcher_service.cc
+ * @brief  Service serving the detector geometry recorded in each run.
+ * @see    larcore/Geometry/GeometrySwitcher.h
+ */
+
+// class header
+#include "larcore/Geometry/GeometrySwitcher.h"
+
+// framework libraries
+#include "art/Framework/Services/Registry/ServiceDefinitionMacros.h"
+
+DEFINE_ART_SERVICE(geo::GeometrySwitcher)
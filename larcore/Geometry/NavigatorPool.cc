@@ -0,0 +1,214 @@
+/**
+ * @file   larcore/Geometry/NavigatorPool.cc
+ * @brief  Per-thread ROOT geometry navigators for concurrent point queries.
+ * @see    larcore/Geometry/NavigatorPool.h
+ */
+
+// library header
+#include "larcore/Geometry/NavigatorPool.h"
+
+// framework libraries
+#include "cetlib_except/exception.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+// ROOT libraries
+#include "TGeoBBox.h"
+#include "TGeoManager.h"
+#include "TGeoMaterial.h"
+#include "TGeoMedium.h"
+#include "TGeoNavigator.h"
+#include "TGeoNode.h"
+#include "TGeoVolume.h"
+
+// C/C++ standard libraries
+#include <cmath>   // std::abs()
+#include <utility> // std::exchange()
+#include <vector>
+
+namespace {
+
+  std::atomic<std::uint64_t> NextPoolID{0};
+
+  // navigators of the current thread, by pool; pools are never many
+  struct ThreadNavigator {
+    std::uint64_t poolID;
+    TGeoNavigator* navigator;
+  };
+  thread_local std::vector<ThreadNavigator> ThreadNavigators;
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+geo::NavigatorPool::NavigatorPool(TGeoManager* manager, unsigned int maxThreads /* = 0 */)
+  : fManager{manager}
+  , fMaxThreads{maxThreads}
+  , fID{NextPoolID++}
+{
+  if (!fManager || !fManager->IsClosed()) {
+    throw cet::exception("NavigatorPool") << "Navigation requires a closed ROOT geometry.\n";
+  }
+  if (!isPerThread()) return;
+  if (fManager->IsMultiThread()) {
+    throw cet::exception("NavigatorPool")
+      << "The ROOT geometry is already in multi-thread mode.\n";
+  }
+  // the current thread keeps its navigator; one more for the helper thread
+  fManager->SetMaxThreads(fMaxThreads + 1);
+}
+
+//------------------------------------------------------------------------------
+geo::NavigatorPool::~NavigatorPool()
+{
+  if (!fHelperThread.joinable()) return;
+  {
+    std::lock_guard const lock{fTaskMutex};
+    fStop = true;
+  }
+  fTaskChanged.notify_all();
+  fHelperThread.join();
+}
+
+//------------------------------------------------------------------------------
+template <typename Query>
+auto geo::NavigatorPool::navigate(Query query) const
+{
+  if (!isPerThread()) {
+    std::lock_guard const lock{fMutex};
+    return query(fManager->GetCurrentNavigator());
+  }
+
+  if (TGeoNavigator* const nav = threadNavigator()) return query(nav);
+
+  decltype(query(nullptr)) result{};
+  runOnHelper([&result, &query](TGeoNavigator* nav) { result = query(nav); });
+  return result;
+}
+
+//------------------------------------------------------------------------------
+TGeoNavigator* geo::NavigatorPool::threadNavigator() const
+{
+  for (ThreadNavigator const& entry : ThreadNavigators) {
+    if (entry.poolID == fID) return entry.navigator;
+  }
+  // threads beyond the limit are remembered too, with no navigator
+  TGeoNavigator* const nav = addNavigator();
+  ThreadNavigators.push_back({fID, nav});
+  return nav;
+}
+
+//------------------------------------------------------------------------------
+TGeoNode const* geo::NavigatorPool::FindNode(Point_t const& point) const
+{
+  return navigate(
+    [&point](TGeoNavigator* nav) { return nav->FindNode(point.X(), point.Y(), point.Z()); });
+}
+
+//------------------------------------------------------------------------------
+std::string geo::NavigatorPool::VolumeName(Point_t const& point) const
+{
+  // check that the given point is in the world volume at least
+  auto const& world = static_cast<TGeoBBox const&>(*fManager->GetTopVolume()->GetShape());
+  if (std::abs(point.X()) > world.GetDX() || std::abs(point.Y()) > world.GetDY() ||
+      std::abs(point.Z()) > world.GetDZ()) {
+    mf::LogWarning("GeometryCoreBadInputPoint")
+      << "point (" << point.X() << "," << point.Y() << "," << point.Z() << ") "
+      << "is not inside the world volume "
+      << " half width = " << world.GetDX() << " half height = " << world.GetDY()
+      << " half length = " << world.GetDZ() << " returning unknown volume name";
+    return "unknownVolume";
+  }
+  return FindNode(point)->GetName();
+}
+
+//------------------------------------------------------------------------------
+TGeoMaterial const* geo::NavigatorPool::Material(Point_t const& point) const
+{
+  TGeoNode const* node = FindNode(point);
+  if (!node) return nullptr;
+  TGeoMedium const* medium = node->GetMedium();
+  return medium ? medium->GetMaterial() : nullptr;
+}
+
+//------------------------------------------------------------------------------
+double geo::NavigatorPool::MassBetweenPoints(Point_t const& p1, Point_t const& p2) const
+{
+  return navigate([&p1, &p2](TGeoNavigator* nav) { return columnDensity(*nav, p1, p2); });
+}
+
+//------------------------------------------------------------------------------
+double geo::NavigatorPool::columnDensity(TGeoNavigator& nav,
+                                         Point_t const& p1,
+                                         Point_t const& p2)
+{
+  // same algorithm as geo::GeometryCore: step from `p1` through the volume
+  // boundaries until reaching the volume of `p2`, then add the last stretch
+  Vector_t const dir = (p2 - p1).Unit();
+  double const dxyz[3] = {dir.X(), dir.Y(), dir.Z()};
+  double const cp1[3] = {p1.X(), p1.Y(), p1.Z()};
+  nav.InitTrack(cp1, dxyz);
+
+  double columnD = 0.;
+  TGeoNode* node = nav.GetCurrentNode();
+  while (!nav.IsSameLocation(p2.X(), p2.Y(), p2.Z())) {
+    nav.FindNextBoundary();
+    columnD += nav.GetStep() * node->GetMedium()->GetMaterial()->GetDensity();
+    node = nav.Step();
+  }
+
+  double const* last = nav.GetCurrentPoint();
+  Point_t const lastPoint{last[0], last[1], last[2]};
+  columnD += (p2 - lastPoint).R() * node->GetMedium()->GetMaterial()->GetDensity();
+  return columnD;
+}
+
+//------------------------------------------------------------------------------
+TGeoNavigator* geo::NavigatorPool::addNavigator(bool helper /* = false */) const
+{
+  std::lock_guard const lock{fMutex};
+
+  // the thread may already have one (e.g. the one which loaded the geometry)
+  if (TGeoNavigator* nav = fManager->GetCurrentNavigator()) return nav;
+
+  if (!helper) {
+    if (fNavigators >= fMaxThreads) return nullptr;
+    ++fNavigators;
+  }
+  return fManager->AddNavigator();
+}
+
+//------------------------------------------------------------------------------
+void geo::NavigatorPool::runOnHelper(Task_t const& task) const
+{
+  std::lock_guard const serial{fHelperMutex};
+  std::unique_lock lock{fTaskMutex};
+  if (!fHelperThread.joinable()) {
+    mf::LogWarning("NavigatorPool")
+      << "More than " << fMaxThreads << " threads are navigating the geometry;"
+      << " the queries of the others are served one at a time.";
+    fHelperThread = std::thread{[this]() { helperLoop(); }};
+  }
+  fTask = &task;
+  fTaskChanged.notify_all();
+  fTaskChanged.wait(lock, [this]() { return fTask == nullptr; });
+  ++fHelperQueries;
+  if (fTaskError) std::rethrow_exception(std::exchange(fTaskError, nullptr));
+}
+
+//------------------------------------------------------------------------------
+void geo::NavigatorPool::helperLoop() const
+{
+  TGeoNavigator* const nav = addNavigator(true);
+  std::unique_lock lock{fTaskMutex};
+  while (true) {
+    fTaskChanged.wait(lock, [this]() { return fStop || fTask; });
+    if (fStop) return;
+    try {
+      (*fTask)(nav);
+    }
+    catch (...) {
+      fTaskError = std::current_exception();
+    }
+    fTask = nullptr;
+    fTaskChanged.notify_all();
+  }
+}
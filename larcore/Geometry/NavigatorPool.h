@@ -0,0 +1,147 @@
+/**
+ * @file   larcore/Geometry/NavigatorPool.h
+ * @brief  Per-thread ROOT geometry navigators for concurrent point queries.
+ * @see    larcore/Geometry/NavigatorPool.cc
+ */
+
+#ifndef LARCORE_GEOMETRY_NAVIGATORPOOL_H
+#define LARCORE_GEOMETRY_NAVIGATORPOOL_H
+
+// LArSoft libraries
+#include "larcoreobj/SimpleTypesAndConstants/geo_vectors.h" // geo::Point_t
+
+// C/C++ standard libraries
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>   // std::size_t
+#include <cstdint>   // std::uint64_t
+#include <exception> // std::exception_ptr
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// ROOT libraries
+class TGeoManager;
+class TGeoMaterial;
+class TGeoNavigator;
+class TGeoNode;
+
+namespace geo {
+
+  /**
+   * @brief Serves each thread its own navigator of a ROOT geometry.
+   *
+   * ROOT navigation (finding the volume at a point, stepping along a line)
+   * keeps its state in a `TGeoNavigator`. `gGeoManager` navigation methods all
+   * use the same one, which makes them unsafe to call from concurrent threads.
+   *
+   * The pool works in one of two modes, chosen on construction:
+   *
+   * - _shared_ (`maxThreads` `0`, the default): the ROOT geometry is left as
+   *   it is, and the point queries provided here use its only navigator one at
+   *   a time. Everything else navigating the geometry (`gGeoManager`,
+   *   `geo::GeometryCore`) keeps working from any thread, as long as it does not
+   *   do so concurrently.
+   * - _per-thread_ (`maxThreads` larger than `0`): the pool switches the ROOT
+   *   geometry into multi-thread mode and creates a navigator for each of the
+   *   first `maxThreads` threads asking for one; afterwards, each of those
+   *   threads finds its navigator without locking, and their queries run
+   *   concurrently. The queries from further threads are run, one at a time, by
+   *   a helper thread of the pool with its own navigator.
+   *
+   * In multi-thread mode ROOT navigates with `gGeoManager` only in the threads
+   * which have a navigator: with per-thread navigators, a thread must be served
+   * by the pool before using `gGeoManager` navigation methods directly, and
+   * the threads beyond `maxThreads` can't use them at all.
+   */
+  class NavigatorPool {
+  public:
+    /**
+     * @brief Constructor: enables navigation of `manager` through the pool.
+     * @param manager the closed ROOT geometry to be navigated
+     * @param maxThreads number of threads with their own navigator (`0`: shared mode)
+     */
+    explicit NavigatorPool(TGeoManager* manager, unsigned int maxThreads = 0);
+
+    NavigatorPool(NavigatorPool const&) = delete;
+    NavigatorPool& operator=(NavigatorPool const&) = delete;
+
+    /// Stops the helper thread, if any.
+    ~NavigatorPool();
+
+    /// Returns whether each thread is served its own navigator.
+    bool isPerThread() const { return fMaxThreads > 0; }
+
+    /// Returns the number of navigators created so far.
+    unsigned int size() const { return fNavigators.load(); }
+
+    /// Returns the number of threads with their own navigator (`0`: shared mode).
+    unsigned int maxThreads() const { return fMaxThreads; }
+
+    /// Returns the number of queries run by the helper thread.
+    std::size_t helperQueries() const { return fHelperQueries.load(); }
+
+    // --- BEGIN -- Point queries ----------------------------------------------
+    /// @name Point queries (same as in `geo::GeometryCore`, thread-safe)
+    /// @{
+
+    /// Returns the deepest ROOT geometry node containing `point`.
+    TGeoNode const* FindNode(Point_t const& point) const;
+
+    /// Returns the name of the deepest volume containing `point`
+    /// (`"unknownVolume"` if outside the world volume).
+    std::string VolumeName(Point_t const& point) const;
+
+    /// Returns the material at `point` (`nullptr` if none).
+    TGeoMaterial const* Material(Point_t const& point) const;
+
+    /// Returns the column density [g/cm^2] along the segment from `p1` to `p2`.
+    double MassBetweenPoints(Point_t const& p1, Point_t const& p2) const;
+
+    /// @}
+    // --- END -- Point queries ------------------------------------------------
+
+  private:
+    using Task_t = std::function<void(TGeoNavigator*)>;
+
+    TGeoManager* fManager;                           ///< The navigated geometry.
+    unsigned int fMaxThreads;                        ///< Navigator limit.
+    std::uint64_t fID;                               ///< Unique identifier of the pool.
+    mutable std::atomic<unsigned int> fNavigators{0}; ///< Navigators created.
+    mutable std::mutex fMutex; ///< Serializes navigator creation and shared queries.
+
+    // --- BEGIN -- Helper thread for the threads beyond the limit -------------
+    mutable std::mutex fHelperMutex;     ///< One query at a time on the helper.
+    mutable std::mutex fTaskMutex;       ///< Protects the task hand-over.
+    mutable std::condition_variable fTaskChanged; ///< Signals task hand-over.
+    mutable Task_t const* fTask = nullptr;        ///< Task for the helper.
+    mutable std::exception_ptr fTaskError;        ///< Exception from the task.
+    mutable bool fStop = false;                   ///< Tells the helper to stop.
+    mutable std::thread fHelperThread;            ///< The helper thread.
+    mutable std::atomic<std::size_t> fHelperQueries{0}; ///< Queries run by the helper.
+    // --- END -- Helper thread for the threads beyond the limit ---------------
+
+    /// Runs `query` with the navigator the calling thread is due.
+    template <typename Query>
+    auto navigate(Query query) const;
+
+    /// Returns the navigator of the calling thread (`nullptr` if beyond the limit).
+    TGeoNavigator* threadNavigator() const;
+
+    /// Creates a navigator for the calling thread (`nullptr` if beyond the limit).
+    TGeoNavigator* addNavigator(bool helper = false) const;
+
+    /// Runs `task` on the helper thread, starting it if needed, and waits for it.
+    void runOnHelper(Task_t const& task) const;
+
+    /// Loop of the helper thread.
+    void helperLoop() const;
+
+    /// Returns the column density between `p1` and `p2` navigating with `nav`.
+    static double columnDensity(TGeoNavigator& nav, Point_t const& p1, Point_t const& p2);
+  };
+
+} // namespace geo
+
+#endif // LARCORE_GEOMETRY_NAVIGATORPOOL_H
@@ -0,0 +1,197 @@
+/**
+ * @file   larcore/Geometry/NumaReplicas.cc
+ * @brief  Copies of read-only tables on each NUMA node of the machine.
+ * @see    larcore/Geometry/NumaReplicas.h
+ *
+ * The memory policy is set with the `set_mempolicy` system call directly, so
+ * that `libnuma` is not needed.
+ */
+
+// library header
+#include "larcore/Geometry/NumaReplicas.h"
+
+// C/C++ standard libraries
+#include <algorithm> // std::max()
+#include <cstdint>   // std::uintptr_t
+#include <exception> // std::exception_ptr, std::rethrow_exception()
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility> // std::move()
+
+// POSIX/Linux libraries
+#include <linux/mempolicy.h> // MPOL_BIND
+#include <linux/mman.h>      // MADV_COLLAPSE (not in <sys/mman.h> before glibc 2.37)
+#include <pthread.h>         // pthread_setaffinity_np()
+#include <sched.h>           // sched_getcpu(), cpu_set_t
+#include <sys/mman.h>        // madvise()
+#include <sys/syscall.h>     // SYS_set_mempolicy
+#include <unistd.h>          // syscall()
+
+namespace {
+
+  // calls served by the CPU cached by a thread before asking again which CPU
+  // it runs on, in case it moved meanwhile
+  constexpr unsigned int CPURefreshCalls = 4096;
+
+  // CPU the calling thread was last found running on (`sched_getcpu()` may cost
+  // a system call, too much for each table lookup)
+  unsigned int currentCPU()
+  {
+    thread_local int cpu = -1;
+    thread_local unsigned int calls = 0;
+    if ((cpu < 0) || (++calls >= CPURefreshCalls)) {
+      cpu = std::max(sched_getcpu(), 0);
+      calls = 0;
+    }
+    return static_cast<unsigned int>(cpu);
+  }
+
+  // parses a CPU list like "0-3,8,10-11"
+  std::vector<unsigned int> parseCPUList(std::string const& list)
+  {
+    std::vector<unsigned int> cpus;
+    std::istringstream in{list};
+    std::string range;
+    while (std::getline(in, range, ',')) {
+      if (range.find_first_of("0123456789") == std::string::npos) continue;
+      std::size_t const dash = range.find('-');
+      unsigned int const first = std::stoul(range.substr(0, dash));
+      unsigned int const last =
+        (dash == std::string::npos) ? first : std::stoul(range.substr(dash + 1));
+      for (unsigned int cpu = first; cpu <= last; ++cpu)
+        cpus.push_back(cpu);
+    }
+    return cpus;
+  }
+
+  // size of the huge pages the kernel can use for anonymous memory [bytes]
+  std::size_t hugePageSize()
+  {
+    static std::size_t const size = []() -> std::size_t {
+      std::ifstream in{"/sys/kernel/mm/transparent_hugepage/hpage_pmd_size"};
+      std::size_t size = 0;
+      return (in >> size) && (size > 0) ? size : (std::size_t{2} << 20);
+    }();
+    return size;
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+geo::NumaTopology::NumaTopology()
+{
+  namespace fs = std::filesystem;
+  std::error_code error;
+  for (fs::directory_entry const& entry :
+       fs::directory_iterator{"/sys/devices/system/node", error}) {
+    std::string const name = entry.path().filename().string();
+    if ((name.size() < 5) || (name.compare(0, 4, "node") != 0) ||
+        (name.find_first_not_of("0123456789", 4) != std::string::npos))
+      continue;
+    unsigned int const node = std::stoul(name.substr(4));
+    std::string cpuList;
+    std::ifstream{entry.path() / "cpulist"} >> cpuList;
+    if (node >= fNodeCPUs.size()) fNodeCPUs.resize(node + 1);
+    fNodeCPUs[node] = parseCPUList(cpuList);
+  }
+
+  if (fNodeCPUs.empty()) {
+    fNodeCPUs.emplace_back();
+    for (unsigned int cpu = 0; cpu < std::max(1U, std::thread::hardware_concurrency()); ++cpu)
+      fNodeCPUs.back().push_back(cpu);
+  }
+  fillCPUNodes();
+}
+
+//------------------------------------------------------------------------------
+geo::NumaTopology::NumaTopology(std::vector<std::vector<unsigned int>> nodeCPUs)
+  : fNodeCPUs{std::move(nodeCPUs)}
+{
+  if (fNodeCPUs.empty()) fNodeCPUs.emplace_back();
+  fillCPUNodes();
+}
+
+//------------------------------------------------------------------------------
+geo::NumaTopology const& geo::NumaTopology::System()
+{
+  static NumaTopology const topology;
+  return topology;
+}
+
+//------------------------------------------------------------------------------
+unsigned int geo::NumaTopology::CurrentNode() const
+{
+  return NodeOf(currentCPU());
+}
+
+//------------------------------------------------------------------------------
+void geo::NumaTopology::fillCPUNodes()
+{
+  for (unsigned int node = 0; node < fNodeCPUs.size(); ++node) {
+    for (unsigned int const cpu : fNodeCPUs[node]) {
+      if (cpu >= fCPUNode.size()) fCPUNode.resize(cpu + 1, 0);
+      fCPUNode[cpu] = node;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+auto geo::details::runOnNode(NumaTopology const& topology,
+                             unsigned int node,
+                             std::function<void(NodePlacement&)> const& make) -> NodePlacement
+{
+  NodePlacement placement;
+  std::exception_ptr error;
+
+  std::thread worker{[&]() {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    bool anyCPU = false;
+    for (unsigned int const cpu : topology.CPUs(node)) {
+      if (cpu >= CPU_SETSIZE) continue;
+      CPU_SET(cpu, &cpus);
+      anyCPU = true;
+    }
+    placement.boundCPUs =
+      anyCPU && (pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0);
+
+    constexpr unsigned int Bits = 8 * sizeof(unsigned long);
+    std::vector<unsigned long> mask(node / Bits + 1, 0UL);
+    mask[node / Bits] |= 1UL << (node % Bits);
+    placement.boundMemory =
+      syscall(SYS_set_mempolicy, MPOL_BIND, mask.data(), mask.size() * Bits + 1) == 0;
+
+    try {
+      make(placement);
+    }
+    catch (...) {
+      error = std::current_exception();
+    }
+  }};
+  worker.join();
+
+  if (error) std::rethrow_exception(error);
+  return placement;
+}
+
+//------------------------------------------------------------------------------
+std::size_t geo::details::adviseHugePages(std::span<std::byte const> block)
+{
+  std::size_t const pageSize = hugePageSize();
+  auto const start = reinterpret_cast<std::uintptr_t>(block.data());
+  std::uintptr_t const begin = (start + pageSize - 1) / pageSize * pageSize;
+  std::uintptr_t const end = (start + block.size()) / pageSize * pageSize;
+  if (begin >= end) return 0; // no whole huge page in the block
+
+  void* const address = reinterpret_cast<void*>(begin);
+  std::size_t const length = end - begin;
+  if (madvise(address, length, MADV_HUGEPAGE) != 0) return 0;
+  // the collapse happens now if supported (Linux 6.1), otherwise later by the kernel
+#ifdef MADV_COLLAPSE
+  madvise(address, length, MADV_COLLAPSE);
+#endif
+  return length;
+}
@@ -0,0 +1,199 @@
+/**
+ * @file   larcore/Geometry/NumaReplicas.h
+ * @brief  Copies of read-only tables on each NUMA node of the machine.
+ * @see    larcore/Geometry/NumaReplicas.cc
+ */
+
+#ifndef LARCORE_GEOMETRY_NUMAREPLICAS_H
+#define LARCORE_GEOMETRY_NUMAREPLICAS_H
+
+// C/C++ standard libraries
+#include <cstddef> // std::size_t, std::byte
+#include <functional>
+#include <memory> // std::unique_ptr
+#include <span>
+#include <utility> // std::move()
+#include <vector>
+
+namespace geo {
+
+  /**
+   * @brief The NUMA nodes of the machine and their CPUs.
+   *
+   * The system topology is read from `/sys/devices/system/node`; without it
+   * (e.g. a kernel without NUMA support) all the CPUs are in node `0`.
+   * A topology can also be specified explicitly, e.g. for tests.
+   */
+  class NumaTopology {
+  public:
+    /// Reads the topology of this machine.
+    NumaTopology();
+
+    /// Uses the CPUs of each node in `nodeCPUs` (a node may have no CPU).
+    explicit NumaTopology(std::vector<std::vector<unsigned int>> nodeCPUs);
+
+    /// Returns the topology of this machine (read once).
+    static NumaTopology const& System();
+
+    /// Returns the number of nodes.
+    unsigned int NNodes() const { return static_cast<unsigned int>(fNodeCPUs.size()); }
+
+    /// Returns the CPUs of `node`.
+    std::span<unsigned int const> CPUs(unsigned int node) const { return fNodeCPUs.at(node); }
+
+    /// Returns the node of `cpu` (`0` if unknown).
+    unsigned int NodeOf(unsigned int cpu) const
+    {
+      return (cpu < fCPUNode.size()) ? fCPUNode[cpu] : 0;
+    }
+
+    /**
+     * @brief Returns the node of the CPU the calling thread is running on.
+     *
+     * The CPU is cached by each thread and asked again only every few
+     * thousand calls: a thread moved to another node may be served the node
+     * it left for a while.
+     */
+    unsigned int CurrentNode() const;
+
+  private:
+    std::vector<std::vector<unsigned int>> fNodeCPUs; ///< CPUs of each node.
+    std::vector<unsigned int> fCPUNode;               ///< Node of each CPU.
+
+    void fillCPUNodes();
+  };
+
+  /// How to replicate read-only tables on the NUMA nodes.
+  struct NumaReplication {
+    bool enabled = false;   ///< Make a copy per node (otherwise, one shared copy).
+    bool hugePages = false; ///< Back the large blocks of the copies with huge pages.
+  };
+
+  namespace details {
+
+    /// What happened placing a copy on a node.
+    struct NodePlacement {
+      bool boundCPUs = false;        ///< The copy was made by a thread on the node CPUs.
+      bool boundMemory = false;      ///< The memory of the copy was bound to the node.
+      std::size_t hugePageBytes = 0; ///< Bytes of the copy now on huge pages.
+    };
+
+    /**
+     * @brief Calls `make()` in a new thread running on `node` and allocating memory there.
+     * @return what could be enforced (the call happens anyway)
+     *
+     * The thread is bound to the CPUs of `node` and its memory policy to the
+     * memory of `node`; failures (e.g. no permission in a container) are
+     * tolerated, leaving the placement to the first-touch policy of the kernel.
+     * Exceptions from `make()` are propagated.
+     */
+    NodePlacement runOnNode(NumaTopology const& topology,
+                            unsigned int node,
+                            std::function<void(NodePlacement&)> const& make);
+
+    /// Asks the kernel to move the whole huge pages within `block` to huge
+    /// pages; returns the number of bytes moved (or at least advised).
+    std::size_t adviseHugePages(std::span<std::byte const> block);
+
+  } // namespace details
+
+  /**
+   * @brief A read-only table, or a copy of it on each NUMA node.
+   * @tparam T type of the table (copy-constructible)
+   *
+   * On machines with several NUMA nodes, threads reading memory attached to
+   * another node pay a larger latency. With replication enabled, the table is
+   * copied once per node, by a thread running on that node with its memory
+   * bound there, and `get()` returns the copy of the node of the calling
+   * thread. Otherwise, the original table is served to all the threads.
+   *
+   * If `T` has a `MemoryBlocks()` method returning its large blocks of memory
+   * (as a range of `std::span<std::byte const>`), the copies can be backed by
+   * huge pages, which also saves TLB misses on random accesses.
+   *
+   * The copies are never modified: `get()` can be called concurrently.
+   *
+   * @note Only tables owned by larcore can be replicated. The objects of
+   *       `geo::GeometryCore` and `geo::WireReadoutGeom` (cryostats, TPCs,
+   *       planes, wires) are built by larcorealg, hold pointers to each other
+   *       and are identified by their position, so they cannot be copied
+   *       from here; the tables replicated by `geo::StandardWireReadout` hold
+   *       the values they need instead.
+   */
+  template <typename T>
+  class NumaReplicas {
+  public:
+    /// No table: `get()` returns `nullptr`.
+    NumaReplicas() = default;
+
+    /**
+     * @brief Serves `table`, or copies of it on each node of `topology`.
+     * @param table the table to serve or to copy (discarded after copying)
+     * @param replication whether to replicate it, and on huge pages
+     * @param topology the NUMA nodes of the machine (must outlive this object)
+     */
+    NumaReplicas(std::unique_ptr<T const> table,
+                 NumaReplication const& replication,
+                 NumaTopology const& topology = NumaTopology::System());
+
+    /// Returns the copy of the table local to the calling thread (`nullptr` if none).
+    T const* get() const
+    {
+      if (fTopology == nullptr) return fCopies.empty() ? nullptr : fCopies.front().get();
+      return fCopies[fTopology->CurrentNode()].get();
+    }
+
+    /// Returns the copy of the table on `node` (`nullptr` if none).
+    T const* replica(unsigned int node) const
+    {
+      if (fCopies.empty()) return nullptr;
+      return fCopies[(fTopology == nullptr) ? 0 : node].get();
+    }
+
+    /// Returns whether there is a copy per node.
+    bool isReplicated() const { return fTopology != nullptr; }
+
+    /// Returns the number of copies.
+    unsigned int NReplicas() const { return static_cast<unsigned int>(fCopies.size()); }
+
+    /// Returns how each copy was placed (empty if not replicated).
+    std::span<details::NodePlacement const> Placements() const { return fPlacements; }
+
+  private:
+    NumaTopology const* fTopology = nullptr; ///< Set only if replicated.
+    std::vector<std::unique_ptr<T const>> fCopies;
+    std::vector<details::NodePlacement> fPlacements;
+  };
+
+} // namespace geo
+
+//------------------------------------------------------------------------------
+//--- template implementation
+//------------------------------------------------------------------------------
+template <typename T>
+geo::NumaReplicas<T>::NumaReplicas(std::unique_ptr<T const> table,
+                                   NumaReplication const& replication,
+                                   NumaTopology const& topology)
+{
+  if (!table) return;
+  if (!replication.enabled) {
+    fCopies.push_back(std::move(table));
+    return;
+  }
+
+  fTopology = &topology;
+  for (unsigned int node = 0; node < topology.NNodes(); ++node) {
+    fCopies.push_back(nullptr);
+    auto make = [this, &table, &replication]([[maybe_unused]] details::NodePlacement& placement) {
+      fCopies.back() = std::make_unique<T const>(*table);
+      if constexpr (requires(T const& t) { t.MemoryBlocks(); }) {
+        if (!replication.hugePages) return;
+        for (std::span<std::byte const> const block : fCopies.back()->MemoryBlocks())
+          placement.hugePageBytes += details::adviseHugePages(block);
+      }
+    };
+    fPlacements.push_back(details::runOnNode(topology, node, make));
+  }
+}
+
+#endif // LARCORE_GEOMETRY_NUMAREPLICAS_H
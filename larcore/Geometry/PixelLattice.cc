@@ -0,0 +1,358 @@
+/**
+ * @file   larcore/Geometry/PixelLattice.cc
+ * @brief  Regular 2D lattices of pixels on the anodes of the TPCs, with a dense channel index.
+ * @see    larcore/Geometry/PixelLattice.h
+ */
+
+// library header
+#include "larcore/Geometry/PixelLattice.h"
+
+// LArSoft libraries
+#include "larcorealg/Geometry/BoxBoundedGeo.h"
+#include "larcorealg/Geometry/GeometryCore.h"
+#include "larcorealg/Geometry/TPCGeo.h"
+
+// framework libraries
+#include "cetlib_except/exception.h"
+
+// C/C++ standard libraries
+#include <algorithm> // std::upper_bound(), std::min(), std::max(), std::fill()
+#include <cmath>     // std::abs(), std::ceil(), std::floor()
+#include <iterator>  // std::prev()
+#include <limits>
+
+namespace {
+
+  // lattice sizes are shrunk by this before rounding up, against rounding errors
+  constexpr double SizeTolerance = 1e-6;
+
+  // the drift must be along an axis within this
+  constexpr double AxisTolerance = 1e-6;
+
+  // the anode grid has at most this many cells along each axis
+  constexpr std::size_t MaxCellsPerAxis = 1024;
+
+  double coordinate(geo::Point_t const& point, unsigned int axis)
+  {
+    switch (axis) {
+    case 0: return point.X();
+    case 1: return point.Y();
+    default: return point.Z();
+    }
+  }
+
+  // range of the active volume of `anode` along `axis`
+  std::array<double, 2> anodeRange(geo::PixelLattice::Anode const& anode, unsigned int axis)
+  {
+    if (axis == anode.driftAxis) return anode.driftRange;
+    std::size_t const i = (axis == anode.axes[0]) ? 0 : 1;
+    return {anode.origin[i], anode.origin[i] + anode.size[i]};
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+geo::PixelLattice::PixelLattice(GeometryCore const& geom,
+                                double pitch,
+                                raw::ChannelID_t firstChannel)
+  : fPitch{pitch}, fFirstChannel{firstChannel}
+{
+  if (!(pitch > 0.0)) {
+    throw cet::exception("PixelLattice")
+      << "Pixel pitch must be positive (" << pitch << " cm requested).\n";
+  }
+
+  std::size_t nChannels = firstChannel;
+  for (TPCGeo const& tpc : geom.Iterate<TPCGeo>()) {
+    auto const drift = tpc.DriftDir();
+    std::array<double, 3> const driftDir{drift.X(), drift.Y(), drift.Z()};
+    unsigned int driftAxis = 0;
+    for (unsigned int i = 1; i < 3; ++i) {
+      if (std::abs(driftDir[i]) > std::abs(driftDir[driftAxis])) driftAxis = i;
+    }
+    if (std::abs(std::abs(driftDir[driftAxis]) - 1.0) > AxisTolerance) {
+      throw cet::exception("PixelLattice")
+        << tpc.ID() << " drifts along (" << driftDir[0] << ", " << driftDir[1] << ", "
+        << driftDir[2] << "), not along a coordinate axis.\n";
+    }
+
+    BoxBoundedGeo const& box = tpc.ActiveBoundingBox();
+    std::array<double, 3> const boxMin{box.MinX(), box.MinY(), box.MinZ()};
+    std::array<double, 3> const boxMax{box.MaxX(), box.MaxY(), box.MaxZ()};
+
+    Anode anode;
+    anode.tpc = tpc.ID();
+    anode.driftAxis = driftAxis;
+    anode.axes = {(driftAxis == 0) ? 1U : 0U, (driftAxis == 2) ? 1U : 2U};
+    anode.anodePosition = (driftDir[driftAxis] > 0.0) ? boxMax[driftAxis] : boxMin[driftAxis];
+    anode.driftRange = {boxMin[driftAxis], boxMax[driftAxis]};
+    std::array<unsigned int, 2> n;
+    for (std::size_t i = 0; i < 2; ++i) {
+      unsigned int const axis = anode.axes[i];
+      anode.origin[i] = boxMin[axis];
+      anode.size[i] = boxMax[axis] - boxMin[axis];
+      n[i] = static_cast<unsigned int>(
+        std::max(1.0, std::ceil(anode.size[i] / pitch - SizeTolerance)));
+    }
+    anode.nRows = n[0];
+    anode.nColumns = n[1];
+    anode.firstChannel = static_cast<raw::ChannelID_t>(nChannels);
+    nChannels += static_cast<std::size_t>(anode.nRows) * anode.nColumns;
+    if (nChannels >= static_cast<std::size_t>(std::numeric_limits<raw::ChannelID_t>::max())) {
+      throw cet::exception("PixelLattice")
+        << "Pixels of " << pitch << " cm from channel " << firstChannel
+        << " make too many channels (up to " << nChannels << " after " << tpc.ID() << ").\n";
+    }
+    fAnodes.push_back(anode);
+  }
+  fNChannels = static_cast<unsigned int>(nChannels - firstChannel);
+
+  // anodes are in cryostat order, TPC after TPC
+  unsigned int const nCryostats = fAnodes.empty() ? 0U : fAnodes.back().tpc.Cryostat + 1;
+  fCryostatFirst.assign(nCryostats + 1, fAnodes.size());
+  for (std::size_t i = fAnodes.size(); i-- > 0;)
+    fCryostatFirst[fAnodes[i].tpc.Cryostat] = i;
+  for (std::size_t c = nCryostats; c-- > 0;)
+    fCryostatFirst[c] = std::min(fCryostatFirst[c], fCryostatFirst[c + 1]);
+
+  buildAnodeGrid();
+}
+
+//------------------------------------------------------------------------------
+void geo::PixelLattice::buildAnodeGrid()
+{
+  fCellFirst.assign(1, 0U);
+  if (fAnodes.empty()) return;
+
+  // the grid covers all the active volumes, with cells no larger than the smallest one
+  for (unsigned int axis = 0; axis < 3; ++axis) {
+    double min = std::numeric_limits<double>::max();
+    double max = std::numeric_limits<double>::lowest();
+    double smallest = std::numeric_limits<double>::max();
+    for (Anode const& anode : fAnodes) {
+      auto const [low, high] = anodeRange(anode, axis);
+      min = std::min(min, low);
+      max = std::max(max, high);
+      if (high > low) smallest = std::min(smallest, high - low);
+    }
+    double const extent = max - min;
+    std::size_t n = 1;
+    if ((extent > 0.0) && (smallest < extent)) {
+      n = std::min(static_cast<std::size_t>(std::ceil(extent / smallest - SizeTolerance)),
+                   MaxCellsPerAxis);
+    }
+    fGridOrigin[axis] = min;
+    fNCells[axis] = n;
+    fCellSize[axis] = (extent > 0.0) ? (extent / n) : 1.0;
+  }
+  std::size_t const nCells = fNCells[0] * fNCells[1] * fNCells[2];
+
+  // the cells overlapping the active volume of an anode (faces included)
+  auto const forEachCell = [this](Anode const& anode, auto&& action) {
+    std::array<std::size_t, 3> first, last;
+    for (unsigned int axis = 0; axis < 3; ++axis) {
+      auto const [low, high] = anodeRange(anode, axis);
+      auto const cell = [this, axis](double x) {
+        return std::min(static_cast<std::size_t>(
+                          std::max(0.0, std::floor((x - fGridOrigin[axis]) / fCellSize[axis]))),
+                        fNCells[axis] - 1);
+      };
+      first[axis] = cell(low);
+      last[axis] = cell(high);
+    }
+    for (std::size_t ix = first[0]; ix <= last[0]; ++ix)
+      for (std::size_t iy = first[1]; iy <= last[1]; ++iy)
+        for (std::size_t iz = first[2]; iz <= last[2]; ++iz)
+          action((ix * fNCells[1] + iy) * fNCells[2] + iz);
+  };
+
+  std::vector<std::uint32_t> counts(nCells, 0U);
+  for (Anode const& anode : fAnodes)
+    forEachCell(anode, [&counts](std::size_t cell) { ++counts[cell]; });
+  fCellFirst.resize(nCells + 1);
+  for (std::size_t cell = 0; cell < nCells; ++cell)
+    fCellFirst[cell + 1] = fCellFirst[cell] + counts[cell];
+
+  // anodes in channel order within each cell, so that the first match is the same as in a scan
+  fCellAnodes.resize(fCellFirst.back());
+  std::fill(counts.begin(), counts.end(), 0U);
+  for (std::uint32_t iAnode = 0; iAnode < fAnodes.size(); ++iAnode) {
+    forEachCell(fAnodes[iAnode], [this, &counts, iAnode](std::size_t cell) {
+      fCellAnodes[fCellFirst[cell] + counts[cell]++] = iAnode;
+    });
+  }
+}
+
+//------------------------------------------------------------------------------
+std::size_t geo::PixelLattice::cellIndex(Point_t const& position) const
+{
+  std::size_t const nCells = fCellFirst.size() - 1;
+  if (nCells == 0) return nCells;
+  std::size_t index = 0;
+  for (unsigned int axis = 0; axis < 3; ++axis) {
+    double const offset = (coordinate(position, axis) - fGridOrigin[axis]) / fCellSize[axis];
+    if (!(offset >= 0.0) || (offset > fNCells[axis])) return nCells;
+    // the upper border belongs to the last cell
+    auto const cell = std::min(static_cast<std::size_t>(offset), fNCells[axis] - 1);
+    index = index * fNCells[axis] + cell;
+  }
+  return index;
+}
+
+//------------------------------------------------------------------------------
+geo::PixelLattice::Anode const* geo::PixelLattice::AnodeOf(TPCID const& tpc) const
+{
+  if (!tpc.isValid || (tpc.Cryostat + 1 >= fCryostatFirst.size())) return nullptr;
+  std::size_t const index = fCryostatFirst[tpc.Cryostat] + tpc.TPC;
+  if (index >= fCryostatFirst[tpc.Cryostat + 1]) return nullptr;
+  return &fAnodes[index];
+}
+
+//------------------------------------------------------------------------------
+geo::PixelLattice::Anode const* geo::PixelLattice::AnodeOfChannel(raw::ChannelID_t channel) const
+{
+  if (!HasChannel(channel)) return nullptr;
+  auto const next = std::upper_bound(
+    fAnodes.begin(), fAnodes.end(), channel, [](raw::ChannelID_t channel, Anode const& anode) {
+      return channel < anode.firstChannel;
+    });
+  return &*std::prev(next);
+}
+
+//------------------------------------------------------------------------------
+raw::ChannelID_t geo::PixelLattice::PositionToChannel(TPCID const& tpc,
+                                                      Point_t const& position) const
+{
+  Anode const* anode = AnodeOf(tpc);
+  return anode ? anodeChannel(*anode, position) : raw::InvalidChannelID;
+}
+
+//------------------------------------------------------------------------------
+raw::ChannelID_t geo::PixelLattice::PositionToChannel(Point_t const& position) const
+{
+  std::size_t const cell = cellIndex(position);
+  if (cell >= fCellFirst.size() - 1) return raw::InvalidChannelID;
+  for (std::uint32_t i = fCellFirst[cell]; i < fCellFirst[cell + 1]; ++i) {
+    Anode const& anode = fAnodes[fCellAnodes[i]];
+    double const drift = coordinate(position, anode.driftAxis);
+    if ((drift < anode.driftRange[0]) || (drift > anode.driftRange[1])) continue;
+    if (raw::ChannelID_t const channel = anodeChannel(anode, position);
+        raw::isValidChannelID(channel))
+      return channel;
+  }
+  return raw::InvalidChannelID;
+}
+
+//------------------------------------------------------------------------------
+geo::PixelLattice::Pixel geo::PixelLattice::ChannelToPixel(raw::ChannelID_t channel) const
+{
+  Anode const* anode = AnodeOfChannel(channel);
+  if (!anode) return {};
+  unsigned int const pixel = channel - anode->firstChannel;
+  return {anode->tpc, pixel / anode->nColumns, pixel % anode->nColumns};
+}
+
+//------------------------------------------------------------------------------
+raw::ChannelID_t geo::PixelLattice::PixelToChannel(Pixel const& pixel) const
+{
+  Anode const* anode = AnodeOf(pixel.tpc);
+  if (!anode || (pixel.row >= anode->nRows) || (pixel.column >= anode->nColumns))
+    return raw::InvalidChannelID;
+  return anode->firstChannel + pixel.row * anode->nColumns + pixel.column;
+}
+
+//------------------------------------------------------------------------------
+geo::Point_t geo::PixelLattice::ChannelToCenter(raw::ChannelID_t channel) const
+{
+  Anode const* anode = AnodeOfChannel(channel);
+  if (!anode) {
+    throw cet::exception("PixelLattice")
+      << "Channel " << channel << " is not a pixel (pixel channels: " << fFirstChannel << " to "
+      << (EndChannel() - 1) << ").\n";
+  }
+  return pixelCenter(*anode, channel - anode->firstChannel);
+}
+
+//------------------------------------------------------------------------------
+void geo::PixelLattice::PositionsToChannels(TPCID const& tpc,
+                                            std::span<Point_t const> positions,
+                                            std::span<raw::ChannelID_t> channels) const
+{
+  if (channels.size() != positions.size()) {
+    throw cet::exception("PixelLattice") << "Room for " << channels.size() << " channels of "
+                                         << positions.size() << " positions.\n";
+  }
+  Anode const* anode = AnodeOf(tpc);
+  for (std::size_t i = 0; i < positions.size(); ++i)
+    channels[i] = anode ? anodeChannel(*anode, positions[i]) : raw::InvalidChannelID;
+}
+
+//------------------------------------------------------------------------------
+void geo::PixelLattice::PositionsToChannels(std::span<Point_t const> positions,
+                                            std::span<raw::ChannelID_t> channels) const
+{
+  if (channels.size() != positions.size()) {
+    throw cet::exception("PixelLattice") << "Room for " << channels.size() << " channels of "
+                                         << positions.size() << " positions.\n";
+  }
+  for (std::size_t i = 0; i < positions.size(); ++i)
+    channels[i] = PositionToChannel(positions[i]);
+}
+
+//------------------------------------------------------------------------------
+void geo::PixelLattice::ChannelsToCenters(std::span<raw::ChannelID_t const> channels,
+                                          std::span<Point_t> centers) const
+{
+  if (centers.size() != channels.size()) {
+    throw cet::exception("PixelLattice")
+      << "Room for " << centers.size() << " centers of " << channels.size() << " channels.\n";
+  }
+  // consecutive channels are usually on the same anode
+  Anode const* anode = nullptr;
+  for (std::size_t i = 0; i < channels.size(); ++i) {
+    raw::ChannelID_t const channel = channels[i];
+    if (!anode || (channel < anode->firstChannel) ||
+        (channel - anode->firstChannel >= anode->Npixels())) {
+      anode = AnodeOfChannel(channel);
+      if (!anode) {
+        throw cet::exception("PixelLattice") << "Channel " << channel << " (#" << i
+                                             << " in the batch) is not a pixel.\n";
+      }
+    }
+    centers[i] = pixelCenter(*anode, channel - anode->firstChannel);
+  }
+}
+
+//------------------------------------------------------------------------------
+std::size_t geo::PixelLattice::MemoryUsage() const
+{
+  return sizeof(*this) + fAnodes.capacity() * sizeof(Anode) +
+         fCryostatFirst.capacity() * sizeof(std::size_t) +
+         (fCellFirst.capacity() + fCellAnodes.capacity()) * sizeof(std::uint32_t);
+}
+
+//------------------------------------------------------------------------------
+raw::ChannelID_t geo::PixelLattice::anodeChannel(Anode const& anode,
+                                                 Point_t const& position) const
+{
+  std::array<unsigned int, 2> index;
+  std::array<unsigned int, 2> const n{anode.nRows, anode.nColumns};
+  for (std::size_t i = 0; i < 2; ++i) {
+    double const offset = coordinate(position, anode.axes[i]) - anode.origin[i];
+    if (!(offset >= 0.0) || (offset > anode.size[i])) return raw::InvalidChannelID;
+    // the upper border belongs to the last pixel
+    index[i] = std::min(static_cast<unsigned int>(offset / fPitch), n[i] - 1);
+  }
+  return anode.firstChannel + index[0] * anode.nColumns + index[1];
+}
+
+//------------------------------------------------------------------------------
+geo::Point_t geo::PixelLattice::pixelCenter(Anode const& anode, unsigned int pixel) const
+{
+  std::array<unsigned int, 2> const index{pixel / anode.nColumns, pixel % anode.nColumns};
+  std::array<double, 3> center;
+  center[anode.driftAxis] = anode.anodePosition;
+  for (std::size_t i = 0; i < 2; ++i)
+    center[anode.axes[i]] = anode.origin[i] + (index[i] + 0.5) * fPitch;
+  return {center[0], center[1], center[2]};
+}
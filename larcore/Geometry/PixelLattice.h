@@ -0,0 +1,205 @@
+/**
+ * @file   larcore/Geometry/PixelLattice.h
+ * @brief  Regular 2D lattices of pixels on the anodes of the TPCs, with a dense channel index.
+ * @see    larcore/Geometry/PixelLattice.cc
+ */
+
+#ifndef LARCORE_GEOMETRY_PIXELLATTICE_H
+#define LARCORE_GEOMETRY_PIXELLATTICE_H
+
+// LArSoft libraries
+#include "larcorealg/Geometry/fwd.h"
+#include "larcoreobj/SimpleTypesAndConstants/RawTypes.h"  // raw::ChannelID_t
+#include "larcoreobj/SimpleTypesAndConstants/geo_types.h"
+#include "larcoreobj/SimpleTypesAndConstants/geo_vectors.h" // geo::Point_t
+
+// C/C++ standard libraries
+#include <array>
+#include <cstddef> // std::size_t
+#include <cstdint> // std::uint32_t
+#include <span>
+#include <vector>
+
+namespace geo {
+
+  /**
+   * @brief Pixel readout of the TPCs: a regular square lattice on each anode.
+   *
+   * The anode of each TPC is the face of its active volume the drift points
+   * to, and it is covered by a lattice of square pixels of side `Pitch()`,
+   * starting from the lowest corner of the face: rows run along the first of
+   * the two axes of the face (in x, y, z order), columns along the second.
+   * If the pitch does not divide the size of the face, the last row and column
+   * stick out of it; only positions on the face are assigned to pixels, each
+   * to the one with the nearest center. Drift is assumed along one of the
+   * coordinate axes.
+   *
+   * Channels are dense: starting from `FirstChannel()`, the pixels of each
+   * anode are numbered row by row, and the anodes follow each other in the
+   * order of the TPCs in the geometry. The first channel leaves room for other
+   * channels of the detector (e.g. the wire channels of the readout geometry),
+   * which then never share a number with a pixel.
+   * All lookups are arithmetic: position to channel and channel to pixel
+   * center need no search once the anode is known. The anode of a channel is
+   * found by a binary search on the few anodes; the anode of a position by a
+   * uniform grid over the active volumes, whose cells are no larger than the
+   * smallest active volume along each axis, so that each cell lists only the
+   * few anodes overlapping it. The batch versions apply the same lookups on
+   * spans, without allocating.
+   *
+   * Only the lattice parameters are stored, a few numbers per anode, and the
+   * anode grid.
+   */
+  class PixelLattice {
+  public:
+    /// A pixel: the TPC of its anode and its position in the lattice.
+    struct Pixel {
+      TPCID tpc;               ///< TPC of the anode (invalid if no pixel).
+      unsigned int row = 0;    ///< Index along the first axis of the anode.
+      unsigned int column = 0; ///< Index along the second axis of the anode.
+
+      bool isValid() const { return tpc.isValid; }
+      explicit operator bool() const { return isValid(); }
+    };
+
+    /// The lattice on the anode of a TPC.
+    struct Anode {
+      TPCID tpc;                        ///< The TPC.
+      unsigned int driftAxis;           ///< Coordinate along the drift (0: x, 1: y, 2: z).
+      std::array<unsigned int, 2> axes; ///< Coordinates of rows and columns.
+      double anodePosition;             ///< Drift coordinate of the anode [cm].
+      std::array<double, 2> origin;     ///< Lowest corner of the lattice [cm].
+      std::array<double, 2> size;       ///< Size of the face along each axis [cm].
+      std::array<double, 2> driftRange; ///< Active volume range along the drift [cm].
+      unsigned int nRows;               ///< Number of pixels along the first axis.
+      unsigned int nColumns;            ///< Number of pixels along the second axis.
+      raw::ChannelID_t firstChannel;    ///< Channel of the first pixel.
+
+      /// Returns the number of pixels of the anode.
+      unsigned int Npixels() const { return nRows * nColumns; }
+    };
+
+    /**
+     * @brief Builds the lattices of all the TPCs of `geom`.
+     * @param geom the geometry with the TPCs
+     * @param pitch side of the pixels [cm]
+     * @param firstChannel channel of the first pixel
+     * @throw cet::exception (category `PixelLattice`) if the pitch is not
+     *        positive, a TPC does not drift along a coordinate axis or the
+     *        channels do not fit `raw::ChannelID_t`
+     */
+    PixelLattice(GeometryCore const& geom, double pitch, raw::ChannelID_t firstChannel = 0);
+
+    /// Returns the side of the pixels [cm].
+    double Pitch() const { return fPitch; }
+
+    /// Returns the total number of channels (pixels).
+    unsigned int Nchannels() const { return fNChannels; }
+
+    /// Returns the channel of the first pixel.
+    raw::ChannelID_t FirstChannel() const { return fFirstChannel; }
+
+    /// Returns the channel after the last pixel.
+    raw::ChannelID_t EndChannel() const { return fFirstChannel + fNChannels; }
+
+    /// Returns whether `channel` is a pixel channel.
+    bool HasChannel(raw::ChannelID_t channel) const
+    {
+      return raw::isValidChannelID(channel) && (channel >= fFirstChannel) &&
+             (channel < EndChannel());
+    }
+
+    /// Returns the lattices of all the anodes, in channel order.
+    std::span<Anode const> Anodes() const { return fAnodes; }
+
+    /// Returns the lattice on the anode of `tpc` (`nullptr` if none).
+    Anode const* AnodeOf(TPCID const& tpc) const;
+
+    /// Returns the lattice with the pixel of `channel` (`nullptr` if none).
+    Anode const* AnodeOfChannel(raw::ChannelID_t channel) const;
+
+    /// @{
+    /// @name Single lookups
+
+    /**
+     * @brief Returns the channel of the pixel of `tpc` facing `position`.
+     * @return the channel, `raw::InvalidChannelID` if out of the anode
+     *
+     * The position is projected on the anode along the drift: its drift
+     * coordinate is not checked.
+     */
+    raw::ChannelID_t PositionToChannel(TPCID const& tpc, Point_t const& position) const;
+
+    /// Returns the channel of the pixel facing `position` in the active volume
+    /// containing it (`raw::InvalidChannelID` if none).
+    raw::ChannelID_t PositionToChannel(Point_t const& position) const;
+
+    /// Returns the pixel of `channel` (invalid if not a pixel channel).
+    Pixel ChannelToPixel(raw::ChannelID_t channel) const;
+
+    /// Returns the channel of `pixel` (`raw::InvalidChannelID` if not in the lattice).
+    raw::ChannelID_t PixelToChannel(Pixel const& pixel) const;
+
+    /**
+     * @brief Returns the center of the pixel of `channel`, on the anode plane.
+     * @throw cet::exception (category `PixelLattice`) if not a pixel channel
+     */
+    Point_t ChannelToCenter(raw::ChannelID_t channel) const;
+
+    /// @}
+
+    /// @{
+    /**
+     * @name Batch lookups
+     *
+     * The results are written in the output span, which must have the same
+     * size as the input one (`cet::exception` is thrown otherwise).
+     */
+
+    /// Channels of the pixels of `tpc` facing each of the `positions`.
+    void PositionsToChannels(TPCID const& tpc,
+                             std::span<Point_t const> positions,
+                             std::span<raw::ChannelID_t> channels) const;
+
+    /// Channels of the pixels facing each of the `positions`, in any active volume.
+    void PositionsToChannels(std::span<Point_t const> positions,
+                             std::span<raw::ChannelID_t> channels) const;
+
+    /// Centers of the pixels of each of the `channels` (all must be pixel channels).
+    void ChannelsToCenters(std::span<raw::ChannelID_t const> channels,
+                           std::span<Point_t> centers) const;
+
+    /// @}
+
+    /// Returns the memory taken by the lattices [bytes].
+    std::size_t MemoryUsage() const;
+
+  private:
+    double fPitch;
+    raw::ChannelID_t fFirstChannel; ///< Channel of the first pixel.
+    unsigned int fNChannels = 0;
+    std::vector<Anode> fAnodes;              ///< The anodes, in channel order.
+    std::vector<std::size_t> fCryostatFirst; ///< First anode of each cryostat (and end).
+
+    std::array<double, 3> fGridOrigin{};       ///< Lower corner of the anode grid [cm].
+    std::array<double, 3> fCellSize{};         ///< Size of the grid cells [cm].
+    std::array<std::size_t, 3> fNCells{};      ///< Number of cells along _x_, _y_ and _z_.
+    std::vector<std::uint32_t> fCellFirst;     ///< First anode of each cell (and end).
+    std::vector<std::uint32_t> fCellAnodes;    ///< Anodes overlapping each cell, in order.
+
+    /// Fills the grid of the anodes overlapping each cell.
+    void buildAnodeGrid();
+
+    /// Returns the cell containing `position`, or the number of cells if none.
+    std::size_t cellIndex(Point_t const& position) const;
+
+    /// Returns the channel of the pixel of `anode` facing `position` (invalid if none).
+    raw::ChannelID_t anodeChannel(Anode const& anode, Point_t const& position) const;
+
+    /// Returns the center of `pixel` of `anode` (the index in the lattice).
+    Point_t pixelCenter(Anode const& anode, unsigned int pixel) const;
+  };
+
+} // namespace geo
+
+#endif // LARCORE_GEOMETRY_PIXELLATTICE_H
@@ -0,0 +1,45 @@
+// larsoft libraries
+#include "larcore/Geometry/PixelWireReadout.h"
+#include "larcore/Geometry/Geometry.h"
+#include "larcorealg/Geometry/WireReadoutSorter.h"
+
+// framework libraries
+#include "art/Framework/Services/Registry/ServiceHandle.h"
+#include "art/Utilities/make_tool.h"
+#include "fhiclcpp/ParameterSet.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+namespace {
+  auto default_wire_sorter()
+  {
+    fhicl::ParameterSet result;
+    result.put("tool_type", std::string{"WireReadoutSorterStandard"});
+    return result;
+  }
+}
+
+namespace geo {
+  PixelWireReadout::PixelWireReadout(fhicl::ParameterSet const& pset)
+    : alg_{pset,
+           art::ServiceHandle<Geometry>{}.get(),
+           art::make_tool<WireReadoutSorter>(
+             pset.get<fhicl::ParameterSet>("SortingParameters", default_wire_sorter()))}
+    , pixels_{*art::ServiceHandle<Geometry>{}, pset.get<double>("PixelPitch"), alg_.Nchannels()}
+  {
+    mf::LogInfo("PixelWireReadout")
+      << "Loading pixel readout: " << pixels_.Anodes().size() << " anodes, "
+      << pixels_.Nchannels() << " pixels of " << pixels_.Pitch() << " cm (channels "
+      << pixels_.FirstChannel() << " to " << (pixels_.EndChannel() - 1) << ", after the "
+      << alg_.Nchannels() << " wire channels), " << (pixels_.MemoryUsage() / 1024) << " KiB";
+  }
+
+  WireReadoutGeom const& PixelWireReadout::wireReadoutGeom() const
+  {
+    return alg_;
+  }
+
+  PixelLattice const* PixelWireReadout::pixelLattice() const
+  {
+    return &pixels_;
+  }
+}
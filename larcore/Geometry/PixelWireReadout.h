@@ -0,0 +1,58 @@
+/**
+ * @file   PixelWireReadout.h
+ * @brief  Wire readout service for detectors with pixel anodes.
+ *
+ * Handles the pixel readout information for the generic Geometry service
+ * within LArSoft. Derived from the WireReadout class.
+ */
+
+#ifndef GEO_PixelWireReadout_h
+#define GEO_PixelWireReadout_h
+
+// LArSoft libraries
+#include "larcore/Geometry/PixelLattice.h"
+#include "larcore/Geometry/WireReadout.h"
+#include "larcorealg/Geometry/WireReadoutStandardGeom.h"
+
+// framework libraries
+#include "art/Framework/Services/Registry/ServiceDeclarationMacros.h"
+
+namespace geo {
+  /**
+   * @brief Pixel readout of the anodes, with a regular lattice on each one
+   *
+   * This WireReadout implementation serves the pixels of the anode of each
+   * TPC (`geo::PixelLattice`) through `Pixels()`: square pixels of side
+   * `PixelPitch` (in centimeters, required) cover the face of the active
+   * volume the drift points to, with a dense channel number. No per-pixel
+   * object is built, and position and channel lookups are arithmetic.
+   *
+   * `Get()` serves a `WireReadoutStandardGeom` of the planes in the geometry
+   * description, for the code that needs the TPC and plane structure, so the
+   * GDML must still describe at least one wire plane in each TPC. The sorting
+   * of the planes is configured as in `StandardWireReadout`
+   * (`SortingParameters`).
+   *
+   * The channels of `Get()` number the wires of those planes, from `0`; the
+   * pixel channels of `Pixels()` follow them (`Pixels()->FirstChannel()` is
+   * `Get().Nchannels()`), so the two never share a number and the channel
+   * queries of `Get()`, and the tools built on it (channel map dumps, ID
+   * tables, partitions), keep working on the wire channels. The wire channels
+   * are not read out: the readout channels are the pixel ones.
+   */
+  class PixelWireReadout : public WireReadout {
+  public:
+    explicit PixelWireReadout(fhicl::ParameterSet const& pset);
+
+  private:
+    WireReadoutGeom const& wireReadoutGeom() const override;
+    PixelLattice const* pixelLattice() const override;
+    WireReadoutStandardGeom alg_;
+    PixelLattice pixels_;
+  };
+
+}
+
+DECLARE_ART_SERVICE_INTERFACE_IMPL(geo::PixelWireReadout, geo::WireReadout, SHARED)
+
+#endif // GEO_PixelWireReadout_h
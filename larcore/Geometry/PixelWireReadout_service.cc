@@ -0,0 +1,11 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file PixelWireReadout_service.cc
+////////////////////////////////////////////////////////////////////////////////
+
+// class header
+#include "larcore/Geometry/PixelWireReadout.h"
+
+// framework libraries
+#include "art/Framework/Services/Registry/ServiceDefinitionMacros.h"
+
+DEFINE_ART_SERVICE_INTERFACE_IMPL(geo::PixelWireReadout, geo::WireReadout)
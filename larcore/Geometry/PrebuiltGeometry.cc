@@ -0,0 +1,126 @@
+/**
+ * @file   larcore/Geometry/PrebuiltGeometry.cc
+ * @brief  Utilities to store and load ROOT geometries converted from GDML.
+ * @see    larcore/Geometry/PrebuiltGeometry.h
+ */
+
+// library header
+#include "larcore/Geometry/PrebuiltGeometry.h"
+
+// framework libraries
+#include "cetlib_except/exception.h"
+
+// ROOT libraries
+#include "TFile.h"
+#include "TGeoManager.h"
+#include "TMD5.h"
+#include "TNamed.h"
+
+// C/C++ standard libraries
+#include <memory> // std::unique_ptr<>
+
+namespace {
+
+  // names of the objects holding the metadata in the prebuilt geometry file
+  constexpr auto ChecksumKey = "GDMLChecksum";
+  constexpr auto SourceKey = "GDMLSource";
+
+  // same unit setting as in geo::GeometryCore, so that lengths are in
+  // centimeters; units may be set only before the first geometry is loaded
+  void setDefaultUnits()
+  {
+    if (gGeoManager) return;
+    TGeoManager::LockDefaultUnits(false);
+    TGeoManager::SetDefaultUnits(TGeoManager::kRootUnits);
+    TGeoManager::LockDefaultUnits(true);
+  }
+
+  std::string readMetadata(TFile& file, char const* key)
+  {
+    std::unique_ptr<TNamed> const entry{file.Get<TNamed>(key)};
+    if (!entry) {
+      throw cet::exception("PrebuiltGeometry")
+        << "File '" << file.GetName() << "' does not contain '" << key
+        << "' information: it was not created by gdml_to_root.\n";
+    }
+    return entry->GetTitle();
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+std::string geo::GDMLChecksum(std::string const& path)
+{
+  std::unique_ptr<TMD5> const md5{TMD5::FileChecksum(path.c_str())};
+  if (!md5) {
+    throw cet::exception("PrebuiltGeometry")
+      << "Could not compute the checksum of '" << path << "'.\n";
+  }
+  return md5->AsString();
+}
+
+//------------------------------------------------------------------------------
+geo::PrebuiltGeometryInfo geo::WritePrebuiltGeometry(std::string const& gdmlPath,
+                                                     std::string const& rootPath)
+{
+  PrebuiltGeometryInfo const info{GDMLChecksum(gdmlPath), gdmlPath};
+
+  setDefaultUnits();
+  if (gGeoManager) TGeoManager::UnlockGeometry();
+  delete gGeoManager;
+  TGeoManager::Import(gdmlPath.c_str());
+  if (!gGeoManager) {
+    throw cet::exception("PrebuiltGeometry")
+      << "ROOT failed to import the geometry from '" << gdmlPath << "'.\n";
+  }
+
+  TFile file{rootPath.c_str(), "RECREATE"};
+  if (file.IsZombie()) {
+    throw cet::exception("PrebuiltGeometry") << "Can't create '" << rootPath << "'.\n";
+  }
+  gGeoManager->Write();
+  TNamed{ChecksumKey, info.gdmlChecksum.c_str()}.Write();
+  TNamed{SourceKey, info.gdmlSource.c_str()}.Write();
+  file.Close();
+
+  return info;
+}
+
+//------------------------------------------------------------------------------
+geo::PrebuiltGeometryInfo geo::ReadPrebuiltGeometryInfo(std::string const& rootPath)
+{
+  TFile file{rootPath.c_str(), "READ"};
+  if (file.IsZombie()) {
+    throw cet::exception("PrebuiltGeometry") << "Can't open '" << rootPath << "'.\n";
+  }
+  return {readMetadata(file, ChecksumKey), readMetadata(file, SourceKey)};
+}
+
+//------------------------------------------------------------------------------
+void geo::CheckPrebuiltGeometry(std::string const& rootPath, std::string const& gdmlPath)
+{
+  PrebuiltGeometryInfo const info = ReadPrebuiltGeometryInfo(rootPath);
+  std::string const checksum = GDMLChecksum(gdmlPath);
+  if (info.gdmlChecksum == checksum) return;
+
+  throw cet::exception("PrebuiltGeometry")
+    << "Prebuilt geometry '" << rootPath << "' is stale:\n"
+    << " - converted from '" << info.gdmlSource << "' (checksum " << info.gdmlChecksum << ")\n"
+    << " - configured GDML '" << gdmlPath << "' has checksum " << checksum << "\n"
+    << "Regenerate it with: gdml_to_root " << gdmlPath << " " << rootPath << "\n";
+}
+
+//------------------------------------------------------------------------------
+void geo::LoadPrebuiltGeometry(std::string const& rootPath)
+{
+  setDefaultUnits();
+  if (gGeoManager) TGeoManager::UnlockGeometry();
+
+  // with a ROOT file, no GDML parsing happens here
+  TGeoManager::Import(rootPath.c_str());
+  if (!gGeoManager) {
+    throw cet::exception("PrebuiltGeometry")
+      << "ROOT failed to import the geometry from '" << rootPath << "'.\n";
+  }
+  gGeoManager->LockGeometry();
+}
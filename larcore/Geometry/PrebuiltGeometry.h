@@ -0,0 +1,70 @@
+/**
+ * @file   larcore/Geometry/PrebuiltGeometry.h
+ * @brief  Utilities to store and load ROOT geometries converted from GDML.
+ * @see    larcore/Geometry/PrebuiltGeometry.cc
+ *
+ * Parsing GDML through ROOT is one of the most expensive steps of the geometry
+ * service initialization. A ROOT file with the `TGeoManager` object converted
+ * from the GDML description can be loaded instead, skipping XML parsing.
+ * These utilities write such a file, together with the checksum of the GDML
+ * file it was converted from, and verify that checksum when loading.
+ */
+
+#ifndef LARCORE_GEOMETRY_PREBUILTGEOMETRY_H
+#define LARCORE_GEOMETRY_PREBUILTGEOMETRY_H
+
+// C/C++ standard libraries
+#include <string>
+
+namespace geo {
+
+  /// Information stored next to a prebuilt geometry in its ROOT file.
+  struct PrebuiltGeometryInfo {
+    std::string gdmlChecksum; ///< MD5 checksum of the source GDML file.
+    std::string gdmlSource;   ///< Path of the source GDML file at conversion time.
+  };
+
+  /// Returns the MD5 checksum (hexadecimal string) of the file at `path`.
+  /// @throw cet::exception (category: `PrebuiltGeometry`) if file is not readable
+  std::string GDMLChecksum(std::string const& path);
+
+  /**
+   * @brief Converts a GDML file into a ROOT file with the `TGeoManager`.
+   * @param gdmlPath path of the GDML file to convert
+   * @param rootPath path of the ROOT file to be (re)created
+   * @return the information recorded into the output file
+   * @throw cet::exception (category: `PrebuiltGeometry`) on any failure
+   *
+   * The geometry is imported with ROOT default units (centimeters), which is
+   * the same setting used by `geo::GeometryCore` when loading a GDML file.
+   * This function replaces the current `gGeoManager`.
+   */
+  PrebuiltGeometryInfo WritePrebuiltGeometry(std::string const& gdmlPath,
+                                             std::string const& rootPath);
+
+  /// Reads the information recorded in the prebuilt geometry file `rootPath`.
+  /// @throw cet::exception (category: `PrebuiltGeometry`) if the information is missing
+  PrebuiltGeometryInfo ReadPrebuiltGeometryInfo(std::string const& rootPath);
+
+  /**
+   * @brief Verifies that a prebuilt geometry was converted from `gdmlPath`.
+   * @param rootPath path of the prebuilt geometry ROOT file
+   * @param gdmlPath path of the GDML file the geometry must match
+   * @throw cet::exception (category: `PrebuiltGeometry`) on checksum mismatch
+   */
+  void CheckPrebuiltGeometry(std::string const& rootPath, std::string const& gdmlPath);
+
+  /**
+   * @brief Makes the prebuilt geometry in `rootPath` the current ROOT geometry.
+   * @param rootPath path of the prebuilt geometry ROOT file
+   * @throw cet::exception (category: `PrebuiltGeometry`) if loading fails
+   *
+   * The geometry is imported into `gGeoManager`, which is then locked. As with
+   * the GDML import performed by `geo::GeometryCore`, later attempts to load a
+   * geometry find it already in place and reuse it.
+   */
+  void LoadPrebuiltGeometry(std::string const& rootPath);
+
+} // namespace geo
+
+#endif // LARCORE_GEOMETRY_PREBUILTGEOMETRY_H
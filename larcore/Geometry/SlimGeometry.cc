@@ -0,0 +1,183 @@
+/**
+ * @file   larcore/Geometry/SlimGeometry.cc
+ * @brief  Loads a GDML geometry keeping only the volumes needed by the readout.
+ * @see    larcore/Geometry/SlimGeometry.h
+ */
+
+// library header
+#include "larcore/Geometry/SlimGeometry.h"
+
+// framework libraries
+#include "cetlib_except/exception.h"
+
+// ROOT libraries
+#include "TGDMLParse.h"
+#include "TGeoManager.h"
+#include "TGeoMaterial.h"
+#include "TGeoMedium.h"
+#include "TGeoNode.h"
+#include "TGeoVolume.h"
+
+// C/C++ standard libraries
+#include <chrono>
+#include <cstring> // std::strcmp()
+#include <fstream>
+#include <limits>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <unistd.h> // sysconf()
+#include <vector>
+
+namespace {
+
+  // resident memory of this process [KiB] (0 if not available)
+  long residentMemoryKiB()
+  {
+    std::ifstream statm{"/proc/self/statm"};
+    long pages = 0, residentPages = 0;
+    if (!(statm >> pages >> residentPages)) return 0;
+    return residentPages * (sysconf(_SC_PAGESIZE) / 1024);
+  }
+
+  // decides which volumes of the tree are kept
+  class VolumePruner {
+  public:
+    VolumePruner(bool keepAuxDets, TGeoMedium* placeholder)
+      : fKeepAuxDets{keepAuxDets}, fPlaceholder{placeholder}
+    {}
+
+    // returns whether `volume` is a readout volume, kept with all its content
+    bool isReadout(TGeoVolume const& volume) const
+    {
+      std::string_view const name{volume.GetName()};
+      return name.starts_with("volTPC") || name.starts_with("volOpDetSensitive") ||
+             (fKeepAuxDets && name.starts_with("volAuxDet"));
+    }
+
+    // returns whether `volume` is or contains a readout volume
+    bool isNeeded(TGeoVolume const& volume)
+    {
+      if (auto const it = fNeeded.find(&volume); it != fNeeded.end()) return it->second;
+      bool needed = isReadout(volume);
+      for (int iNode = 0; !needed && (iNode < volume.GetNdaughters()); ++iNode)
+        needed = isNeeded(*volume.GetNode(iNode)->GetVolume());
+      fNeeded[&volume] = needed;
+      return needed;
+    }
+
+    // removes from `volume` and its descendents all the unneeded placements,
+    // giving the placeholder medium to the volumes losing placements;
+    // returns the number of removed placements
+    unsigned int prune(TGeoVolume& volume)
+    {
+      if (isReadout(volume) || !fPruned.insert(&volume).second) return 0;
+
+      unsigned int nRemoved = 0;
+      std::vector<TGeoNode*> unneeded;
+      for (int iNode = 0; iNode < volume.GetNdaughters(); ++iNode) {
+        TGeoNode* node = volume.GetNode(iNode);
+        if (isNeeded(*node->GetVolume()))
+          nRemoved += prune(*node->GetVolume());
+        else
+          unneeded.push_back(node);
+      }
+      for (TGeoNode* node : unneeded) {
+        volume.RemoveNode(node);
+        delete node;
+      }
+      if (!unneeded.empty()) {
+        volume.SetMedium(fPlaceholder);
+        ++fNPlaceholders;
+      }
+      return nRemoved + static_cast<unsigned int>(unneeded.size());
+    }
+
+    // returns the number of volumes given the placeholder medium
+    unsigned int nPlaceholders() const { return fNPlaceholders; }
+
+  private:
+    bool const fKeepAuxDets;
+    TGeoMedium* const fPlaceholder;
+    unsigned int fNPlaceholders = 0;
+    std::unordered_map<TGeoVolume const*, bool> fNeeded;
+    std::unordered_set<TGeoVolume const*> fPruned;
+  };
+
+  // returns the number of physical placements below `volume`
+  std::uint64_t countPlacements(TGeoVolume const& volume,
+                                std::unordered_map<TGeoVolume const*, std::uint64_t>& counts)
+  {
+    if (auto const it = counts.find(&volume); it != counts.end()) return it->second;
+    std::uint64_t count = 0;
+    for (int iNode = 0; iNode < volume.GetNdaughters(); ++iNode)
+      count += 1 + countPlacements(*volume.GetNode(iNode)->GetVolume(), counts);
+    counts[&volume] = count;
+    return count;
+  }
+
+  std::uint64_t countPlacements(TGeoVolume const& volume)
+  {
+    std::unordered_map<TGeoVolume const*, std::uint64_t> counts;
+    return countPlacements(volume, counts);
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+geo::SlimGeometryStats geo::LoadSlimGeometry(std::string const& gdmlPath, bool keepAuxDets)
+{
+  SlimGeometryStats stats;
+  auto const start = std::chrono::steady_clock::now();
+  long const residentBefore = residentMemoryKiB();
+
+  // same unit setting as in geo::GeometryCore (see PrebuiltGeometry.cc)
+  if (!gGeoManager) {
+    TGeoManager::LockDefaultUnits(false);
+    TGeoManager::SetDefaultUnits(TGeoManager::kRootUnits);
+    TGeoManager::LockDefaultUnits(true);
+  }
+  else
+    TGeoManager::UnlockGeometry();
+
+  // this is what TGeoManager::Import() does, with pruning before closing
+  new TGeoManager("SlimGDMLImport", ("Slim geometry from " + gdmlPath).c_str());
+  TGDMLParse parser;
+  TGeoVolume* world = parser.GDMLReadFile(gdmlPath.c_str());
+  if (!world) {
+    throw cet::exception("SlimGeometry")
+      << "ROOT failed to import the geometry from '" << gdmlPath << "'.\n";
+  }
+
+  // vacuum-like, with a density which is not a number; owned by gGeoManager
+  auto* placeholderMaterial = new TGeoMaterial(
+    geo::SlimPlaceholderMaterial, 0.0, 0.0, std::numeric_limits<double>::quiet_NaN());
+  auto* placeholder = new TGeoMedium(geo::SlimPlaceholderMaterial,
+                                     gGeoManager->GetListOfMedia()->GetSize() + 1,
+                                     placeholderMaterial);
+
+  VolumePruner pruner{keepAuxDets, placeholder};
+  if (!pruner.isNeeded(*world)) {
+    throw cet::exception("SlimGeometry")
+      << "No readout volume (volTPC..., volOpDetSensitive...) found in '" << gdmlPath << "'.\n";
+  }
+  stats.fullNodes = countPlacements(*world);
+  stats.removedNodes = pruner.prune(*world);
+  stats.placeholderVolumes = pruner.nPlaceholders();
+  stats.slimNodes = countPlacements(*world);
+
+  gGeoManager->SetTopVolume(world);
+  gGeoManager->CloseGeometry();
+  gGeoManager->LockGeometry();
+
+  stats.loadSeconds =
+    std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  stats.residentKiB = residentMemoryKiB() - residentBefore;
+  return stats;
+}
+
+//------------------------------------------------------------------------------
+bool geo::isSlimPlaceholder(TGeoMaterial const* material)
+{
+  return material && (std::strcmp(material->GetName(), SlimPlaceholderMaterial) == 0);
+}
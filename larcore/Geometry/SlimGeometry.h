@@ -0,0 +1,68 @@
+/**
+ * @file   larcore/Geometry/SlimGeometry.h
+ * @brief  Loads a GDML geometry keeping only the volumes needed by the readout.
+ * @see    larcore/Geometry/SlimGeometry.cc
+ *
+ * Reconstruction does not need the passive volumes of the detector (shielding,
+ * cryostat walls, enclosure hall and so on), which are often most of the ROOT
+ * geometry. The slim loading parses the GDML file, then removes from the
+ * volume tree all the placements which do not lead to a readout volume, before
+ * ROOT closes (voxelizes) the geometry. The readout volumes are recognized by
+ * the names used by `geo::GeometryBuilderStandard`:
+ *
+ * * `volTPC...` (TPC, active volume, planes and wires), kept whole;
+ * * `volOpDetSensitive...`, kept whole;
+ * * `volAuxDet...`, kept whole, optionally.
+ *
+ * The ancestors of these volumes (e.g. world, enclosure, cryostat) are kept.
+ * Those which lost some of their daughters get the placeholder material
+ * `geo::SlimPlaceholderMaterial` instead of their own, whose density is not a
+ * number: the material found at a point where a removed volume was is never
+ * silently the one of its ancestor, also when queried directly from ROOT or
+ * from `geo::GeometryCore`, and column densities across it are NaN.
+ */
+
+#ifndef LARCORE_GEOMETRY_SLIMGEOMETRY_H
+#define LARCORE_GEOMETRY_SLIMGEOMETRY_H
+
+// C/C++ standard libraries
+#include <cstdint> // std::uint64_t
+#include <string>
+
+class TGeoMaterial;
+
+namespace geo {
+
+  /// Name of the material of the volumes which lost daughters in the slim loading.
+  inline constexpr char const* SlimPlaceholderMaterial = "SlimPlaceholder";
+
+  /// Size of a geometry before and after the slim loading.
+  struct SlimGeometryStats {
+    std::uint64_t fullNodes = 0;         ///< Physical placements in the full geometry.
+    std::uint64_t slimNodes = 0;         ///< Physical placements kept.
+    unsigned int removedNodes = 0;       ///< Daughter placements removed from volumes.
+    unsigned int placeholderVolumes = 0; ///< Volumes given the placeholder material.
+    double loadSeconds = 0.0;            ///< Time taken to load the geometry.
+    long residentKiB = 0;                ///< Growth of the resident memory during loading.
+  };
+
+  /**
+   * @brief Makes the slim version of the GDML geometry the current ROOT one.
+   * @param gdmlPath path of the GDML file
+   * @param keepAuxDets whether to keep the auxiliary detectors too
+   * @return the size of the full and slim geometries
+   * @throw cet::exception (category: `SlimGeometry`) if loading fails or no
+   *        readout volume is found
+   *
+   * As with `geo::LoadPrebuiltGeometry()`, the geometry is loaded into
+   * `gGeoManager`, which is then locked, and `geo::GeometryCore` reuses it.
+   */
+  SlimGeometryStats LoadSlimGeometry(std::string const& gdmlPath, bool keepAuxDets = true);
+
+  /// Returns whether `material` is the placeholder of the slim loading
+  /// (`geo::SlimPlaceholderMaterial`).
+  bool isSlimPlaceholder(TGeoMaterial const* material);
+
+} // namespace geo
+
+#endif // LARCORE_GEOMETRY_SLIMGEOMETRY_H
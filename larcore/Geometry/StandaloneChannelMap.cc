@@ -0,0 +1,237 @@
+/**
+ * @file   larcore/Geometry/StandaloneChannelMap.cc
+ * @brief  Compact channel map for online code, without the geometry stack.
+ * @see    larcore/Geometry/StandaloneChannelMap.h
+ */
+
+// library header
+#include "larcore/Geometry/StandaloneChannelMap.h"
+
+// framework libraries
+#include "cetlib_except/exception.h"
+
+// C/C++ standard libraries
+#include <algorithm> // std::min()
+#include <cstring>   // std::memcmp()
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <utility> // std::move()
+
+namespace {
+
+  constexpr char Magic[8] = {'L', 'A', 'R', 'C', 'H', 'M', 'A', 'P'};
+  constexpr std::uint32_t FormatVersion = 1;
+  constexpr std::uint32_t ByteOrderMark = 0x01020304;
+
+  static_assert(sizeof(geo::StandaloneChannelMap::Plane) == 7 * sizeof(std::uint32_t));
+
+  // 64-bit FNV-1a hash, updated a block of bytes at a time
+  class FNV1a {
+  public:
+    void add(void const* data, std::size_t size)
+    {
+      auto const* bytes = static_cast<unsigned char const*>(data);
+      for (std::size_t i = 0; i < size; ++i)
+        fHash = (fHash ^ bytes[i]) * 0x100000001b3ULL;
+    }
+    std::uint64_t value() const { return fHash; }
+
+  private:
+    std::uint64_t fHash = 0xcbf29ce484222325ULL;
+  };
+
+  // writes `size` bytes into `out`, adding them to `hash`
+  void writeBlock(std::ostream& out, FNV1a& hash, void const* data, std::size_t size)
+  {
+    hash.add(data, size);
+    out.write(static_cast<char const*>(data), size);
+  }
+
+  // reads `size` bytes from `in`, adding them to `hash`; returns whether successful
+  bool readBlock(std::istream& in, FNV1a& hash, void* data, std::size_t size)
+  {
+    if (!in.read(static_cast<char*>(data), size)) return false;
+    hash.add(data, size);
+    return true;
+  }
+
+  // reads `n` elements into `data`, a bounded chunk at a time, so that a
+  // corrupted count fails at the end of the stream instead of allocating it all
+  template <typename T>
+  bool readTable(std::istream& in, FNV1a& hash, std::vector<T>& data, std::size_t n)
+  {
+    constexpr std::size_t Chunk = 65536;
+    data.clear();
+    while (data.size() < n) {
+      std::size_t const start = data.size();
+      data.resize(std::min(n, start + Chunk));
+      if (!readBlock(in, hash, data.data() + start, (data.size() - start) * sizeof(T)))
+        return false;
+    }
+    return true;
+  }
+
+  cet::exception invalid()
+  {
+    return cet::exception("StandaloneChannelMap") << "Invalid channel map: ";
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+geo::StandaloneChannelMap::StandaloneChannelMap(Tables tables) : fTables{std::move(tables)}
+{
+  // planes: sorted and densely numbered; the wires of each plane follow the
+  // ones of the previous plane
+  std::uint32_t nextWire = 0;
+  for (PlaneIndex_t i = 0; i < fTables.planes.size(); ++i) {
+    Plane const& plane = fTables.planes[i];
+    if (plane.firstWire != nextWire) {
+      throw invalid() << "plane C:" << plane.cryostat << " T:" << plane.tpc
+                      << " P:" << plane.plane << " starts at wire " << plane.firstWire << ", "
+                      << nextWire << " expected.\n";
+    }
+    nextWire += plane.nWires;
+
+    bool const newCryostat = fNTPCs.empty() || (plane.cryostat != fNTPCs.size() - 1);
+    bool const newTPC = newCryostat || (plane.tpc != fNTPCs.back() - 1);
+    bool const dense = newCryostat ? (plane.cryostat == fNTPCs.size()) && (plane.tpc == 0) &&
+                                       (plane.plane == 0) :
+                       newTPC ? (plane.tpc == fNTPCs.back()) && (plane.plane == 0) :
+                                (plane.plane == i - fFirstPlane.back());
+    if (!dense) {
+      throw invalid() << "plane C:" << plane.cryostat << " T:" << plane.tpc
+                      << " P:" << plane.plane
+                      << " is out of order or leaves a gap in the numbering.\n";
+    }
+    if (newCryostat) {
+      fFirstTPC.push_back(fFirstPlane.size());
+      fNTPCs.push_back(0);
+    }
+    if (newTPC) {
+      ++fNTPCs.back();
+      fFirstPlane.push_back(i);
+    }
+  }
+  fFirstPlane.push_back(fTables.planes.size());
+  if (nextWire != fTables.wireChannels.size()) {
+    throw invalid() << "the planes have " << nextWire << " wires, the wire table "
+                    << fTables.wireChannels.size() << ".\n";
+  }
+
+  // the wires of each channel, by counting sort
+  fChannelFirstWire.assign(fTables.nChannels + std::size_t{1}, 0);
+  for (ChannelID_t const channel : fTables.wireChannels) {
+    if (channel == InvalidChannel) continue; // wire not read out
+    if (channel >= fTables.nChannels) {
+      throw invalid() << "wire with channel " << channel << " of " << fTables.nChannels
+                      << ".\n";
+    }
+    ++fChannelFirstWire[channel + 1];
+  }
+  for (std::size_t c = 0; c < fTables.nChannels; ++c)
+    fChannelFirstWire[c + 1] += fChannelFirstWire[c];
+
+  fChannelWires.resize(fChannelFirstWire.back());
+  std::vector<std::uint32_t> next{fChannelFirstWire.begin(), fChannelFirstWire.end() - 1};
+  for (PlaneIndex_t i = 0; i < fTables.planes.size(); ++i) {
+    Plane const& plane = fTables.planes[i];
+    for (std::uint32_t w = 0; w < plane.nWires; ++w) {
+      ChannelID_t const channel = fTables.wireChannels[plane.firstWire + w];
+      if (channel != InvalidChannel) fChannelWires[next[channel]++] = Wire{i, w};
+    }
+  }
+  // planes and wires were visited in order: the wires of each channel are sorted
+}
+
+//------------------------------------------------------------------------------
+geo::StandaloneChannelMap geo::StandaloneChannelMap::Read(std::istream& in)
+{
+  char magic[sizeof(Magic)];
+  std::uint32_t version = 0, byteOrder = 0;
+  if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, Magic, sizeof(Magic)))
+    throw invalid() << "not a channel map file.\n";
+  if (!in.read(reinterpret_cast<char*>(&version), sizeof(version)) ||
+      (version != FormatVersion)) {
+    throw invalid() << "format version " << version << ", " << FormatVersion
+                    << " supported.\n";
+  }
+  if (!in.read(reinterpret_cast<char*>(&byteOrder), sizeof(byteOrder)) ||
+      (byteOrder != ByteOrderMark))
+    throw invalid() << "written with a different byte order.\n";
+
+  FNV1a hash;
+  Tables tables;
+  std::uint32_t nPlanes = 0, nWires = 0;
+  if (!readBlock(in, hash, &tables.nChannels, sizeof(tables.nChannels)) ||
+      !readBlock(in, hash, &nPlanes, sizeof(nPlanes)) ||
+      !readBlock(in, hash, &nWires, sizeof(nWires)))
+    throw invalid() << "truncated header.\n";
+
+  std::uint64_t checksum = 0;
+  if (!readTable(in, hash, tables.planes, nPlanes) ||
+      !readTable(in, hash, tables.wireChannels, nWires) ||
+      !in.read(reinterpret_cast<char*>(&checksum), sizeof(checksum)))
+    throw invalid() << "truncated tables.\n";
+  if (checksum != hash.value()) throw invalid() << "checksum mismatch (corrupted file).\n";
+
+  return StandaloneChannelMap{std::move(tables)};
+}
+
+//------------------------------------------------------------------------------
+geo::StandaloneChannelMap geo::StandaloneChannelMap::Load(std::string const& path)
+{
+  std::ifstream in{path, std::ios::binary};
+  if (!in) {
+    throw cet::exception("StandaloneChannelMap")
+      << "Can't open the channel map file '" << path << "'.\n";
+  }
+  try {
+    return Read(in);
+  }
+  catch (cet::exception& e) {
+    throw e << "(reading '" << path << "')\n";
+  }
+}
+
+//------------------------------------------------------------------------------
+void geo::StandaloneChannelMap::Write(std::ostream& out) const
+{
+  out.write(Magic, sizeof(Magic));
+  out.write(reinterpret_cast<char const*>(&FormatVersion), sizeof(FormatVersion));
+  out.write(reinterpret_cast<char const*>(&ByteOrderMark), sizeof(ByteOrderMark));
+
+  FNV1a hash;
+  std::uint32_t const nPlanes = fTables.planes.size(), nWires = fTables.wireChannels.size();
+  writeBlock(out, hash, &fTables.nChannels, sizeof(fTables.nChannels));
+  writeBlock(out, hash, &nPlanes, sizeof(nPlanes));
+  writeBlock(out, hash, &nWires, sizeof(nWires));
+  writeBlock(out, hash, fTables.planes.data(), nPlanes * sizeof(Plane));
+  writeBlock(out, hash, fTables.wireChannels.data(), nWires * sizeof(ChannelID_t));
+  std::uint64_t const checksum = hash.value();
+  out.write(reinterpret_cast<char const*>(&checksum), sizeof(checksum));
+  if (!out) throw cet::exception("StandaloneChannelMap") << "Error writing the channel map.\n";
+}
+
+//------------------------------------------------------------------------------
+void geo::StandaloneChannelMap::Save(std::string const& path) const
+{
+  std::ofstream out{path, std::ios::binary | std::ios::trunc};
+  Write(out);
+  out.close();
+  if (!out) {
+    throw cet::exception("StandaloneChannelMap")
+      << "Error writing the channel map file '" << path << "'.\n";
+  }
+}
+
+//------------------------------------------------------------------------------
+std::size_t geo::StandaloneChannelMap::MemoryUsage() const
+{
+  return sizeof(*this) + fTables.planes.capacity() * sizeof(Plane) +
+         fTables.wireChannels.capacity() * sizeof(ChannelID_t) +
+         (fNTPCs.capacity() + fFirstTPC.capacity() + fChannelFirstWire.capacity()) *
+           sizeof(std::uint32_t) +
+         fFirstPlane.capacity() * sizeof(PlaneIndex_t) + fChannelWires.capacity() * sizeof(Wire);
+}
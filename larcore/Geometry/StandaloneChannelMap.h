@@ -0,0 +1,190 @@
+/**
+ * @file   larcore/Geometry/StandaloneChannelMap.h
+ * @brief  Compact channel map for online code, without the geometry stack.
+ * @see    larcore/Geometry/StandaloneChannelMap.cc
+ *
+ * This header and its library depend only on the C++ standard library and on
+ * `cetlib_except`: trigger and DAQ decoders can use them without linking art,
+ * ROOT or `larcorealg`. The map is written by `ExportChannelMap` module from
+ * the `geo::WireReadout` service (see `StandaloneChannelMapExport.h`).
+ */
+
+#ifndef LARCORE_GEOMETRY_STANDALONECHANNELMAP_H
+#define LARCORE_GEOMETRY_STANDALONECHANNELMAP_H
+
+// C/C++ standard libraries
+#include <cstddef> // std::size_t
+#include <cstdint> // std::uint32_t, std::int32_t
+#include <iosfwd>
+#include <limits>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace geo {
+
+  /**
+   * @brief Read-only map between channels and plane wires.
+   *
+   * The map holds the planes of the detector, sorted by cryostat, TPC and
+   * plane number, and the channel of each of their wires. On construction it
+   * also builds the reverse table, with the wires of each channel.
+   *
+   * The numbering must be dense, as it is in LArSoft: cryostats, TPCs of each
+   * cryostat and planes of each TPC are numbered from `0` with no gap. This
+   * allows a plane to be found with two array lookups.
+   *
+   * Once built, the map is never modified: any number of threads may query it
+   * at the same time without any lock. The queries do not allocate memory and
+   * do not throw; invalid IDs yield `InvalidChannel` or no wires.
+   *
+   * The values of the channels, views and signal types are the ones of
+   * `raw::ChannelID_t`, `geo::View_t` and `geo::SigType_t`.
+   *
+   * File format
+   * ------------
+   *
+   * The file starts with the 8 characters `LARCHMAP`, a 32-bit format version
+   * and a 32-bit byte order marker. Three 32-bit counts follow (channels,
+   * planes, wires), then the planes (7 32-bit numbers each, as in `Plane`) and
+   * the channel of each wire (32 bits each). The file ends with the 64-bit
+   * FNV-1a hash of everything after the byte order marker. All numbers are in
+   * the byte order of the writing machine: a file from a machine of different
+   * byte order is rejected.
+   */
+  class StandaloneChannelMap {
+  public:
+    /// Type of channel ID (as `raw::ChannelID_t`).
+    using ChannelID_t = std::uint32_t;
+
+    /// Value of an invalid channel (as `raw::InvalidChannelID`).
+    static constexpr ChannelID_t InvalidChannel = std::numeric_limits<ChannelID_t>::max();
+
+    /// Index of a plane in `Planes()`.
+    using PlaneIndex_t = std::uint32_t;
+
+    /// Value of `PlaneIndex()` for a plane not in the map.
+    static constexpr PlaneIndex_t NoPlane = std::numeric_limits<PlaneIndex_t>::max();
+
+    /// A readout plane.
+    struct Plane {
+      std::uint32_t cryostat;  ///< Cryostat number.
+      std::uint32_t tpc;       ///< TPC number in the cryostat.
+      std::uint32_t plane;     ///< Plane number in the TPC.
+      std::int32_t view;       ///< View (value of `geo::View_t`).
+      std::int32_t signalType; ///< Signal type (value of `geo::SigType_t`).
+      std::uint32_t nWires;    ///< Number of wires.
+      std::uint32_t firstWire; ///< Position of the first wire in the wire table.
+    };
+
+    /// A wire: its plane (index in `Planes()`) and its number in the plane.
+    struct Wire {
+      PlaneIndex_t plane;
+      std::uint32_t wire;
+
+      bool operator==(Wire const&) const = default;
+    };
+
+    /// The content of the map: the planes and the channel of each wire.
+    struct Tables {
+      ChannelID_t nChannels = 0;             ///< Channels are `0` to `nChannels - 1`.
+      std::vector<Plane> planes;             ///< All planes, sorted by ID.
+      std::vector<ChannelID_t> wireChannels; ///< Channel of each wire, plane after plane.
+    };
+
+    /**
+     * @brief Builds the map from its `tables`.
+     * @throw cet::exception (category `StandaloneChannelMap`) if the planes are
+     *        not sorted and densely numbered, their wires are not consecutive
+     *        in the wire table, or a wire has an out of range channel
+     */
+    explicit StandaloneChannelMap(Tables tables);
+
+    /// Reads the map from a stream; throws `cet::exception` if not a valid map.
+    static StandaloneChannelMap Read(std::istream& in);
+
+    /// Reads the map from the file at `path`; throws `cet::exception` on failure.
+    static StandaloneChannelMap Load(std::string const& path);
+
+    /// Writes the map into a stream; throws `cet::exception` on failure.
+    void Write(std::ostream& out) const;
+
+    /// Writes the map into the file at `path`; throws `cet::exception` on failure.
+    void Save(std::string const& path) const;
+
+    /// Returns the number of channels.
+    ChannelID_t Nchannels() const { return fTables.nChannels; }
+
+    /// Returns the number of wires.
+    std::size_t NWires() const { return fTables.wireChannels.size(); }
+
+    /// Returns all the planes, sorted by ID.
+    std::span<Plane const> Planes() const { return fTables.planes; }
+
+    /// Returns the index of the plane `p` of TPC `t` in cryostat `c` (`NoPlane` if none).
+    PlaneIndex_t PlaneIndex(unsigned int c, unsigned int t, unsigned int p) const
+    {
+      if (c >= fNTPCs.size() || t >= fNTPCs[c]) return NoPlane;
+      std::size_t const tpc = fFirstTPC[c] + t;
+      return (p < fFirstPlane[tpc + 1] - fFirstPlane[tpc]) ? fFirstPlane[tpc] + p : NoPlane;
+    }
+
+    /// Returns the plane `p` of TPC `t` in cryostat `c` (`nullptr` if none).
+    Plane const* FindPlane(unsigned int c, unsigned int t, unsigned int p) const
+    {
+      PlaneIndex_t const index = PlaneIndex(c, t, p);
+      return (index == NoPlane) ? nullptr : &fTables.planes[index];
+    }
+
+    /// Returns the channel of wire `w` of plane `p`, TPC `t`, cryostat `c`
+    /// (`InvalidChannel` if no such wire).
+    ChannelID_t PlaneWireToChannel(unsigned int c,
+                                   unsigned int t,
+                                   unsigned int p,
+                                   unsigned int w) const
+    {
+      Plane const* plane = FindPlane(c, t, p);
+      return (plane && w < plane->nWires) ? fTables.wireChannels[plane->firstWire + w] :
+                                            InvalidChannel;
+    }
+
+    /// Returns the channel of `wire` (`InvalidChannel` if no such wire).
+    ChannelID_t WireToChannel(Wire const& wire) const
+    {
+      if (wire.plane >= fTables.planes.size()) return InvalidChannel;
+      Plane const& plane = fTables.planes[wire.plane];
+      return (wire.wire < plane.nWires) ? fTables.wireChannels[plane.firstWire + wire.wire] :
+                                          InvalidChannel;
+    }
+
+    /// Returns the wires read by `channel`, sorted (empty if invalid channel).
+    std::span<Wire const> ChannelToWires(ChannelID_t channel) const
+    {
+      if (channel >= fTables.nChannels) return {};
+      return std::span<Wire const>{fChannelWires}.subspan(
+        fChannelFirstWire[channel], fChannelFirstWire[channel + 1] - fChannelFirstWire[channel]);
+    }
+
+    /// Returns the plane of the first wire of `channel` (`nullptr` if none).
+    Plane const* ChannelPlane(ChannelID_t channel) const
+    {
+      std::span<Wire const> const wires = ChannelToWires(channel);
+      return wires.empty() ? nullptr : &fTables.planes[wires.front().plane];
+    }
+
+    /// Returns the memory taken by the map [bytes].
+    std::size_t MemoryUsage() const;
+
+  private:
+    Tables fTables;
+
+    std::vector<std::uint32_t> fNTPCs;            ///< Number of TPCs in each cryostat.
+    std::vector<std::uint32_t> fFirstTPC;         ///< Index of the first TPC of each cryostat.
+    std::vector<PlaneIndex_t> fFirstPlane;        ///< First plane of each TPC (and end).
+    std::vector<std::uint32_t> fChannelFirstWire; ///< First wire of each channel (and end).
+    std::vector<Wire> fChannelWires;              ///< Wires of all channels, in channel order.
+  };
+
+} // namespace geo
+
+#endif // LARCORE_GEOMETRY_STANDALONECHANNELMAP_H
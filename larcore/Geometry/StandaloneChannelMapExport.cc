@@ -0,0 +1,45 @@
+/**
+ * @file   larcore/Geometry/StandaloneChannelMapExport.cc
+ * @brief  Export of the wire readout geometry into a standalone channel map.
+ * @see    larcore/Geometry/StandaloneChannelMapExport.h
+ */
+
+// library header
+#include "larcore/Geometry/StandaloneChannelMapExport.h"
+
+// LArSoft libraries
+#include "larcorealg/Geometry/PlaneGeo.h"
+#include "larcorealg/Geometry/WireReadoutGeom.h"
+#include "larcoreobj/SimpleTypesAndConstants/RawTypes.h"  // raw::ChannelID_t
+#include "larcoreobj/SimpleTypesAndConstants/geo_types.h" // geo::WireID
+
+// C/C++ standard libraries
+#include <utility> // std::move()
+
+//------------------------------------------------------------------------------
+geo::StandaloneChannelMap::Tables geo::exportChannelMapTables(WireReadoutGeom const& wireReadout)
+{
+  static_assert(StandaloneChannelMap::InvalidChannel == raw::InvalidChannelID);
+
+  StandaloneChannelMap::Tables tables;
+  tables.nChannels = wireReadout.Nchannels();
+  for (PlaneGeo const& plane : wireReadout.Iterate<PlaneGeo>()) {
+    PlaneID const& planeID = plane.ID();
+    tables.planes.push_back({planeID.Cryostat,
+                             planeID.TPC,
+                             planeID.Plane,
+                             static_cast<std::int32_t>(plane.View()),
+                             static_cast<std::int32_t>(wireReadout.SignalType(planeID)),
+                             plane.Nwires(),
+                             static_cast<std::uint32_t>(tables.wireChannels.size())});
+    for (unsigned int w = 0; w < plane.Nwires(); ++w)
+      tables.wireChannels.push_back(wireReadout.PlaneWireToChannel(WireID{planeID, w}));
+  }
+  return tables;
+}
+
+//------------------------------------------------------------------------------
+geo::StandaloneChannelMap geo::exportChannelMap(WireReadoutGeom const& wireReadout)
+{
+  return StandaloneChannelMap{exportChannelMapTables(wireReadout)};
+}
@@ -0,0 +1,29 @@
+/**
+ * @file   larcore/Geometry/StandaloneChannelMapExport.h
+ * @brief  Export of the wire readout geometry into a standalone channel map.
+ * @see    larcore/Geometry/StandaloneChannelMapExport.cc
+ */
+
+#ifndef LARCORE_GEOMETRY_STANDALONECHANNELMAPEXPORT_H
+#define LARCORE_GEOMETRY_STANDALONECHANNELMAPEXPORT_H
+
+// LArSoft libraries
+#include "larcore/Geometry/StandaloneChannelMap.h"
+#include "larcorealg/Geometry/fwd.h"
+
+namespace geo {
+
+  /**
+   * @brief Returns the tables of the channel map of `wireReadout`.
+   *
+   * All the planes are exported, in their ID order, with the channel of each
+   * wire from `WireReadoutGeom::PlaneWireToChannel()`.
+   */
+  StandaloneChannelMap::Tables exportChannelMapTables(WireReadoutGeom const& wireReadout);
+
+  /// Returns the standalone channel map of `wireReadout`.
+  StandaloneChannelMap exportChannelMap(WireReadoutGeom const& wireReadout);
+
+} // namespace geo
+
+#endif // LARCORE_GEOMETRY_STANDALONECHANNELMAPEXPORT_H
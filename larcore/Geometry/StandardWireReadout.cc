@@ -9,6 +9,11 @@
 #include "fhiclcpp/ParameterSet.h"
 #include "messagefacility/MessageLogger/MessageLogger.h"
 
+// C/C++ standard libraries
+#include <memory>
+#include <string>
+#include <utility> // std::move()
+
 namespace {
   auto default_wire_sorter()
   {
@@ -16,20 +21,102 @@ namespace {
     result.put("tool_type", std::string{"WireReadoutSorterStandard"});
     return result;
   }
+
+  template <typename T>
+  void reportReplicas(std::string const& name, geo::NumaReplicas<T> const& replicas)
+  {
+    if (!replicas.isReplicated()) return;
+    unsigned int nBound = 0;
+    std::size_t hugePageBytes = 0;
+    for (geo::details::NodePlacement const& placement : replicas.Placements()) {
+      if (placement.boundMemory) ++nBound;
+      hugePageBytes += placement.hugePageBytes;
+    }
+    mf::LogInfo("StandardWireReadout")
+      << "Replicated the " << name << " on " << replicas.NReplicas() << " NUMA nodes ("
+      << nBound << " with bound memory), " << (hugePageBytes >> 20) << " MiB on huge pages";
+    if (nBound < replicas.NReplicas()) {
+      mf::LogWarning("StandardWireReadout")
+        << "The memory of " << (replicas.NReplicas() - nBound) << " copies of the " << name
+        << " could not be bound to their NUMA node.";
+    }
+  }
 }
 
 namespace geo {
   StandardWireReadout::StandardWireReadout(fhicl::ParameterSet const& pset)
+    : StandardWireReadout{pset, *art::ServiceHandle<Geometry>{}}
+  {}
+
+  StandardWireReadout::StandardWireReadout(fhicl::ParameterSet const& pset, Geometry const& geom)
     : alg_{pset,
-           art::ServiceHandle<Geometry>{}.get(),
+           &geom,
            art::make_tool<WireReadoutSorter>(
              pset.get<fhicl::ParameterSet>("SortingParameters", default_wire_sorter()))}
   {
     mf::LogInfo("StandardWireReadout") << "Loading wire readout: WireReadoutStandardGeom";
+    if (GeometrySubset const& subset = geom.Subset(); !subset.isFull()) {
+      subset_ = &subset;
+      mf::LogInfo("StandardWireReadout")
+        << "Readout tables restricted to " << subset.TPCIDs().size() << " of "
+        << subset.NAllTPCs() << " TPCs";
+    }
+    NumaReplication const replication{pset.get<bool>("NumaReplication", false),
+                                      pset.get<bool>("NumaHugePages", false)};
+    if (pset.get<bool>("ContiguousWires", false)) {
+      auto arena = std::make_unique<WireArena const>(alg_, subset_);
+      mf::LogInfo("StandardWireReadout")
+        << "Copied " << arena->NWires() << " wires into a contiguous arena, "
+        << (arena->MemoryUsage() / 1024) << " KiB in addition to the wires of the geometry";
+      arena_ = NumaReplicas<WireArena>{std::move(arena), replication};
+      reportReplicas("wire arena", arena_);
+    }
+    if (auto const voxelSize = pset.get<double>("ReadoutVoxelSize", 0.0); voxelSize > 0.0) {
+      auto voxelMap = std::make_unique<VoxelReadoutMap const>(
+        geom, alg_, voxelSize, subset_);
+      auto const [nx, ny, nz] = voxelMap->Nvoxels();
+      mf::LogInfo("StandardWireReadout")
+        << "Built a readout voxel map of " << nx << " x " << ny << " x " << nz << " voxels of "
+        << voxelSize << " cm (" << voxelMap->NEntries() << " TPC entries), "
+        << (voxelMap->MemoryUsage() / 1024) << " KiB";
+      voxelMap_ = NumaReplicas<VoxelReadoutMap>{std::move(voxelMap), replication};
+      reportReplicas("readout voxel map", voxelMap_);
+    }
+    if (pset.get<bool>("ChannelAdjacency", false)) {
+      auto adjacency = std::make_unique<ChannelAdjacency const>(
+        alg_, pset.get<double>("ContinuationDistance", 1.0), subset_);
+      mf::LogInfo("StandardWireReadout")
+        << "Built channel adjacency tables: " << adjacency->NeighbourTable().NEntries()
+        << " neighbours, " << adjacency->CrossingTable().NEntries() << " crossing, "
+        << adjacency->ContinuationTable().NEntries() << " continuations, "
+        << (adjacency->MemoryUsage() / 1024) << " KiB";
+      adjacency_ = NumaReplicas<ChannelAdjacency>{std::move(adjacency), replication};
+      reportReplicas("channel adjacency tables", adjacency_);
+    }
   }
 
   WireReadoutGeom const& StandardWireReadout::wireReadoutGeom() const
   {
     return alg_;
   }
+
+  WireArena const* StandardWireReadout::wireArena() const
+  {
+    return arena_.get();
+  }
+
+  VoxelReadoutMap const* StandardWireReadout::voxelReadoutMap() const
+  {
+    return voxelMap_.get();
+  }
+
+  ChannelAdjacency const* StandardWireReadout::channelAdjacency() const
+  {
+    return adjacency_.get();
+  }
+
+  GeometrySubset const* StandardWireReadout::geometrySubset() const
+  {
+    return subset_;
+  }
 }
@@ -12,6 +12,10 @@
 #define GEO_StandardWireReadout_h
 
 // LArSoft libraries
+#include "larcore/Geometry/ChannelAdjacency.h"
+#include "larcore/Geometry/NumaReplicas.h"
+#include "larcore/Geometry/VoxelReadoutMap.h"
+#include "larcore/Geometry/WireArena.h"
 #include "larcore/Geometry/WireReadout.h"
 #include "larcorealg/Geometry/WireReadoutStandardGeom.h"
 
@@ -19,19 +23,64 @@
 #include "art/Framework/Services/Registry/ServiceDeclarationMacros.h"
 
 namespace geo {
+  class Geometry;
+
   /**
    * @brief Simple implementation of channel mapping
    *
    * This WireReadout implementation serves a WireReadoutStandardGeom
    * for experiments that are known to work well with it.
+   *
+   * With `ContiguousWires` set to `true` (opt-in), a copy of all the wires in a
+   * single contiguous block (`geo::WireArena`) is also built, and served by
+   * `Arena()`; its memory, which adds to the one of the wires of the geometry,
+   * is reported on construction. Only the users of `Arena()` read the copy.
+   *
+   * With a positive `ReadoutVoxelSize` (in centimeters), a voxel map of the
+   * active volumes to TPCs and nearest channels (`geo::VoxelReadoutMap`) is
+   * also built, and served by `VoxelMap()`; its memory is reported on
+   * construction.
+   *
+   * With `ChannelAdjacency` set to `true`, the tables of the neighbouring,
+   * crossing and continuation channels of each channel
+   * (`geo::ChannelAdjacency`) are also built, and served by `Adjacency()`;
+   * wire ends closer than `ContinuationDistance` (in centimeters, `1` by
+   * default) make continuations.
+   *
+   * If the `Geometry` service is configured with a `Subset` of the detector,
+   * the arena, the voxel map and the adjacency tables cover only that subset,
+   * which is served by `Subset()`. The wire readout geometry itself still
+   * describes the whole detector.
+   *
+   * With `NumaReplication` set to `true`, the arena, the voxel map and the
+   * adjacency tables are copied on each NUMA node of the machine, and each
+   * thread is served the copy of its node (see `geo::NumaReplicas`); with
+   * `NumaHugePages` also `true`, the copies are moved to huge pages. The wire
+   * readout geometry itself is not replicated, but the lookups of the copies
+   * do not read it: they hold the wire, box and wire coordinate values they
+   * need.
+   *
+   * Besides the service constructor, which uses the `Geometry` service, the
+   * provider can be built on an explicit `geo::Geometry` object (as
+   * `GeometryStartupBenchmark` does), which must outlive it.
    */
   class StandardWireReadout : public WireReadout {
   public:
     explicit StandardWireReadout(fhicl::ParameterSet const& pset);
 
+    StandardWireReadout(fhicl::ParameterSet const& pset, Geometry const& geom);
+
   private:
     WireReadoutGeom const& wireReadoutGeom() const override;
+    WireArena const* wireArena() const override;
+    VoxelReadoutMap const* voxelReadoutMap() const override;
+    ChannelAdjacency const* channelAdjacency() const override;
+    GeometrySubset const* geometrySubset() const override;
     WireReadoutStandardGeom alg_;
+    GeometrySubset const* subset_ = nullptr; ///< Owned by the `Geometry` service.
+    NumaReplicas<WireArena> arena_;
+    NumaReplicas<VoxelReadoutMap> voxelMap_;
+    NumaReplicas<ChannelAdjacency> adjacency_;
   };
 
 }
@@ -0,0 +1,418 @@
+/**
+ * @file   larcore/Geometry/SyntheticGDML.cc
+ * @brief  Writes GDML descriptions of synthetic LArTPC detectors of any size.
+ * @see    larcore/Geometry/SyntheticGDML.h
+ */
+
+// library header
+#include "larcore/Geometry/SyntheticGDML.h"
+
+// framework libraries
+#include "cetlib_except/exception.h"
+
+// C/C++ standard libraries
+#include <algorithm> // std::clamp(), std::max(), std::min()
+#include <cmath>     // std::sin(), std::cos(), std::floor(), std::lround(), ...
+#include <fstream>
+#include <map>
+#include <ostream>
+#include <vector>
+
+namespace {
+
+  constexpr double Pi = 3.14159265358979323846;
+
+  constexpr double PlaneThickness = 0.1;   ///< Thickness of the plane volumes.
+  constexpr double MinPlaneSpacing = 0.3;  ///< Smallest distance between planes.
+  constexpr double PlaneMargin = 0.1;      ///< Plane border inside the TPC, on _y_ and _z_.
+  constexpr double WireDiameter = 0.015;
+  constexpr double MinWireLength = 0.1;    ///< Shorter wires at the corners are dropped.
+  constexpr double CryostatPadding = 5.0;  ///< Space between TPCs and cryostat walls.
+  constexpr double OpDetGap = 10.0;        ///< Space for optical detectors, anode side.
+  constexpr double OpDetThickness = 1.0;
+  constexpr double CryostatGap = 50.0;     ///< Space between cryostats.
+
+  // ---------------------------------------------------------------------------
+  struct Wire {
+    double y, z;        ///< Center in the plane.
+    std::size_t volume; ///< Index of the volume of its length.
+  };
+
+  struct Plane {
+    double angle; ///< Wire angle from vertical [degrees].
+    double x;     ///< Position in the TPC.
+    std::vector<Wire> wires;
+  };
+
+  /// Distinct wire lengths, each with its own volume.
+  class WireVolumes {
+  public:
+    std::size_t volumeFor(double length)
+    {
+      auto const [it, added] = fIndices.try_emplace(std::lround(length * 1000.0), fLengths.size());
+      if (added) fLengths.push_back(length);
+      return it->second;
+    }
+    std::vector<double> const& lengths() const { return fLengths; }
+
+  private:
+    std::map<long, std::size_t> fIndices; ///< Volume of each length (in 10 um units).
+    std::vector<double> fLengths;
+  };
+
+  // ---------------------------------------------------------------------------
+  // Wires with direction (y, z) = (cos(angle), sin(angle)), `pitch` apart,
+  // clipped to the `height` x `length` rectangle centered on the origin.
+  std::vector<Wire> planeWires(double height,
+                               double length,
+                               double pitch,
+                               double angle,
+                               WireVolumes& volumes)
+  {
+    double const cosA = std::cos(angle * Pi / 180.0);
+    double const sinA = std::sin(angle * Pi / 180.0);
+    bool const vertical = std::abs(sinA) < 1e-12;
+
+    // wires are the lines n.r = c, with normal n = (-sin(angle), cos(angle))
+    double const cMax = 0.5 * (height * std::abs(sinA) + length * cosA);
+    auto const nWires = static_cast<std::size_t>(std::floor(2.0 * cMax / pitch));
+
+    std::vector<Wire> wires;
+    wires.reserve(nWires);
+    for (std::size_t iWire = 0; iWire < nWires; ++iWire) {
+      double const c = (iWire - 0.5 * (nWires - 1)) * pitch;
+      // points: (y, z) = c n + t (cos(angle), sin(angle))
+      double tMin = (-0.5 * height + c * sinA) / cosA;
+      double tMax = (+0.5 * height + c * sinA) / cosA;
+      if (!vertical) {
+        double const t1 = (-0.5 * length - c * cosA) / sinA;
+        double const t2 = (+0.5 * length - c * cosA) / sinA;
+        tMin = std::max(tMin, std::min(t1, t2));
+        tMax = std::min(tMax, std::max(t1, t2));
+      }
+      if (tMax - tMin < MinWireLength) continue;
+      double const t = 0.5 * (tMin + tMax);
+      wires.push_back({-c * sinA + t * cosA, c * cosA + t * sinA, volumes.volumeFor(tMax - tMin)});
+    }
+    return wires;
+  }
+
+  // ---------------------------------------------------------------------------
+  void checkConfig(geo::SyntheticDetectorConfig const& config, double planeSpacing)
+  {
+    auto error = []() -> cet::exception {
+      return cet::exception("SyntheticGDML") << "Invalid synthetic detector: ";
+    };
+    if (!config.nCryostats || !config.nTPCsPerCryostat || !config.nTPCColumns ||
+        !config.nPlanes)
+      throw error() << "at least one cryostat, TPC, TPC column and plane is needed.\n";
+    if ((config.wirePitch <= 0.0) || (config.tpcHeight <= 2.0 * PlaneMargin) ||
+        (config.tpcLength <= 2.0 * PlaneMargin))
+      throw error() << "wire pitch and TPC sizes must be positive.\n";
+    if (std::abs(config.wireAngle) >= 90.0)
+      throw error() << "wire angle " << config.wireAngle << " is not within (-90, 90) degrees.\n";
+    if (config.tpcWidth <= (config.nPlanes + 1) * planeSpacing) {
+      throw error() << "TPC width " << config.tpcWidth << " cm leaves no active volume after "
+                    << config.nPlanes << " planes " << planeSpacing << " cm apart.\n";
+    }
+  }
+
+  // ---------------------------------------------------------------------------
+  void writeHeader(std::ostream& out)
+  {
+    out << R"(<?xml version="1.0" encoding="UTF-8" ?>
+<gdml xmlns:gdml="http://cern.ch/2001/Schemas/GDML"
+      xmlns:xsi="http://www.w3.org/2001/XMLSchema-instance"
+      xsi:noNamespaceSchemaLocation="GDMLSchema/gdml.xsd">
+)";
+  }
+
+  void writeMaterials(std::ostream& out)
+  {
+    out << R"(  <materials>
+    <element name="nitrogen" formula="N" Z="7"> <atom value="14.0067"/> </element>
+    <element name="oxygen" formula="O" Z="8"> <atom value="15.999"/> </element>
+    <element name="carbon" formula="C" Z="6"> <atom value="12.0107"/> </element>
+    <element name="chromium" formula="Cr" Z="24"> <atom value="51.9961"/> </element>
+    <element name="iron" formula="Fe" Z="26"> <atom value="55.8450"/> </element>
+    <element name="nickel" formula="Ni" Z="28"> <atom value="58.6934"/> </element>
+    <element name="argon" formula="Ar" Z="18"> <atom value="39.9480"/> </element>
+    <material name="STEEL_STAINLESS_Fe7Cr2Ni" formula="STEEL_STAINLESS_Fe7Cr2Ni">
+      <D value="7.9300" unit="g/cm3"/>
+      <fraction n="0.0010" ref="carbon"/>
+      <fraction n="0.1800" ref="chromium"/>
+      <fraction n="0.7298" ref="iron"/>
+      <fraction n="0.0900" ref="nickel"/>
+    </material>
+    <material name="LAr" formula="LAr">
+      <D value="1.40" unit="g/cm3"/>
+      <fraction n="1.0000" ref="argon"/>
+    </material>
+    <material name="Air">
+      <D value="0.001205" unit="g/cm3"/>
+      <fraction n="0.781154" ref="nitrogen"/>
+      <fraction n="0.209476" ref="oxygen"/>
+      <fraction n="0.00937" ref="argon"/>
+    </material>
+  </materials>
+)";
+  }
+
+  void writeBox(std::ostream& out, char const* name, double x, double y, double z)
+  {
+    out << "    <box name=\"" << name << "\" lunit=\"cm\" x=\"" << x << "\" y=\"" << y
+        << "\" z=\"" << z << "\"/>\n";
+  }
+
+  void writePhysVol(std::ostream& out,
+                    std::string const& volume,
+                    std::string const& position,
+                    double x,
+                    double y,
+                    double z)
+  {
+    out << "      <physvol>\n"
+        << "        <volumeref ref=\"" << volume << "\"/>\n"
+        << "        <position name=\"" << position << "\" unit=\"cm\" x=\"" << x << "\" y=\""
+        << y << "\" z=\"" << z << "\"/>\n"
+        << "      </physvol>\n";
+  }
+
+  // ---------------------------------------------------------------------------
+  // Writes the volumes of a TPC (planes, active volume and TPC) named after `suffix`.
+  void writeTPCVolumes(std::ostream& out,
+                       std::string const& suffix,
+                       std::vector<Plane> const& planes,
+                       geo::SyntheticDetectorConfig const& config,
+                       double planeSpacing)
+  {
+    for (std::size_t iPlane = 0; iPlane < planes.size(); ++iPlane) {
+      Plane const& plane = planes[iPlane];
+      std::string const tag = suffix + "_" + std::to_string(iPlane);
+      out << "    <volume name=\"volTPCPlane" << tag << "\">\n"
+          << "      <materialref ref=\"LAr\"/>\n"
+          << "      <solidref ref=\"TPCPlane\"/>\n";
+      for (std::size_t iWire = 0; iWire < plane.wires.size(); ++iWire) {
+        Wire const& wire = plane.wires[iWire];
+        out << "      <physvol>\n"
+            << "        <volumeref ref=\"volTPCWire" << wire.volume << "\"/>\n"
+            << "        <position name=\"posW" << tag << "_" << iWire
+            << "\" unit=\"cm\" x=\"0\" y=\"" << wire.y << "\" z=\"" << wire.z << "\"/>\n"
+            << "        <rotationref ref=\"rWire" << iPlane << "\"/>\n"
+            << "      </physvol>\n";
+      }
+      out << "    </volume>\n";
+    }
+
+    out << "    <volume name=\"volTPCActive" << suffix << "\">\n"
+        << "      <materialref ref=\"LAr\"/>\n"
+        << "      <solidref ref=\"TPCActive\"/>\n"
+        << "    </volume>\n";
+
+    out << "    <volume name=\"volTPC" << suffix << "\">\n"
+        << "      <materialref ref=\"LAr\"/>\n"
+        << "      <solidref ref=\"TPC\"/>\n";
+    writePhysVol(out,
+                 "volTPCActive" + suffix,
+                 "posTPCActive" + suffix,
+                 0.5 * (config.nPlanes + 1) * planeSpacing,
+                 0.0,
+                 0.0);
+    for (std::size_t iPlane = 0; iPlane < planes.size(); ++iPlane) {
+      std::string const tag = suffix + "_" + std::to_string(iPlane);
+      writePhysVol(out, "volTPCPlane" + tag, "posTPCPlane" + tag, planes[iPlane].x, 0.0, 0.0);
+    }
+    out << "    </volume>\n";
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+geo::SyntheticDetectorStats geo::WriteSyntheticGDML(SyntheticDetectorConfig const& config,
+                                                    std::ostream& out)
+{
+  double const planeSpacing = std::max(config.wirePitch, MinPlaneSpacing);
+  checkConfig(config, planeSpacing);
+
+  // --- planes and wires (the same in all TPCs) -------------------------------
+  double const planeHeight = config.tpcHeight - 2.0 * PlaneMargin;
+  double const planeLength = config.tpcLength - 2.0 * PlaneMargin;
+  WireVolumes wireVolumes;
+  std::vector<Plane> planes;
+  std::size_t nWiresPerTPC = 0;
+  for (unsigned int iPlane = 0; iPlane < config.nPlanes; ++iPlane) {
+    bool const collection = (iPlane + 1 == config.nPlanes);
+    double const angle =
+      collection ? 0.0 : ((iPlane % 2 == 0) ? config.wireAngle : -config.wireAngle);
+    // the collection plane is the closest to the anode side (smaller x)
+    double const x = -0.5 * config.tpcWidth + (config.nPlanes - iPlane) * planeSpacing;
+    planes.push_back(
+      {angle, x, planeWires(planeHeight, planeLength, config.wirePitch, angle, wireVolumes)});
+    nWiresPerTPC += planes.back().wires.size();
+  }
+
+  // --- layout -----------------------------------------------------------------
+  unsigned int const nColumns = std::min(config.nTPCColumns, config.nTPCsPerCryostat);
+  unsigned int const nRows = (config.nTPCsPerCryostat + nColumns - 1) / nColumns; // along z
+  double const cryoWidth = OpDetGap + 2.0 * CryostatPadding + nColumns * config.tpcWidth;
+  double const cryoHeight = config.tpcHeight + 2.0 * CryostatPadding;
+  double const cryoLength = nRows * config.tpcLength + 2.0 * CryostatPadding;
+  double const enclWidth =
+    config.nCryostats * cryoWidth + (config.nCryostats + 1) * CryostatGap;
+  double const enclHeight = cryoHeight + 2.0 * CryostatGap;
+  double const enclLength = cryoLength + 2.0 * CryostatGap;
+
+  // optical detectors: a grid of squares covering the anode side of the TPCs
+  unsigned int const nOpDets = config.nOpDetsPerCryostat;
+  double const opDetAreaLength = nRows * config.tpcLength;
+  unsigned int const nOpDetRows =
+    nOpDets ? std::clamp(static_cast<unsigned int>(std::lround(std::sqrt(
+                           nOpDets * config.tpcHeight / opDetAreaLength))),
+                         1U,
+                         nOpDets) :
+              1U;
+  unsigned int const nOpDetColumns = (nOpDets + nOpDetRows - 1) / nOpDetRows;
+  double const opDetCellY = config.tpcHeight / nOpDetRows;
+  double const opDetCellZ = opDetAreaLength / std::max(nOpDetColumns, 1U);
+  double const opDetSide = 0.8 * std::min(opDetCellY, opDetCellZ);
+
+  auto const tpcSuffix = [&config](unsigned int iCryo, unsigned int iTPC) {
+    return config.uniqueTPCVolumes ?
+             "_C" + std::to_string(iCryo) + "_T" + std::to_string(iTPC) :
+             std::string{};
+  };
+  auto const cryoSuffix = [&config](unsigned int iCryo) {
+    return config.uniqueTPCVolumes ? "_C" + std::to_string(iCryo) : std::string{};
+  };
+
+  auto const oldPrecision = out.precision(10);
+
+  // --- GDML ------------------------------------------------------------------
+  writeHeader(out);
+
+  out << "  <define>\n";
+  for (std::size_t iPlane = 0; iPlane < planes.size(); ++iPlane) {
+    // GDML rotates the wire axis (z) to (y, z) = (sin(x), cos(x))
+    out << "    <rotation name=\"rWire" << iPlane << "\" unit=\"deg\" x=\""
+        << (90.0 - planes[iPlane].angle) << "\" y=\"0\" z=\"0\"/>\n";
+  }
+  out << "  </define>\n";
+
+  writeMaterials(out);
+
+  out << "  <solids>\n";
+  writeBox(out, "World", 2.0 * enclWidth, 2.0 * enclHeight, 2.0 * enclLength);
+  writeBox(out, "DetEnclosure", enclWidth, enclHeight, enclLength);
+  writeBox(out, "Cryostat", cryoWidth, cryoHeight, cryoLength);
+  writeBox(out, "TPC", config.tpcWidth, config.tpcHeight, config.tpcLength);
+  writeBox(out,
+           "TPCActive",
+           config.tpcWidth - (config.nPlanes + 1) * planeSpacing,
+           config.tpcHeight,
+           config.tpcLength);
+  writeBox(out, "TPCPlane", PlaneThickness, planeHeight, planeLength);
+  writeBox(out, "OpDetSensitive", OpDetThickness, opDetSide, opDetSide);
+  std::vector<double> const& wireLengths = wireVolumes.lengths();
+  for (std::size_t iVolume = 0; iVolume < wireLengths.size(); ++iVolume) {
+    out << "    <tube name=\"TPCWire" << iVolume << "\" rmax=\"" << (0.5 * WireDiameter)
+        << "\" z=\"" << wireLengths[iVolume]
+        << "\" deltaphi=\"360\" aunit=\"deg\" lunit=\"cm\"/>\n";
+  }
+  out << "  </solids>\n";
+
+  out << "  <structure>\n";
+  for (std::size_t iVolume = 0; iVolume < wireLengths.size(); ++iVolume) {
+    out << "    <volume name=\"volTPCWire" << iVolume << "\">\n"
+        << "      <materialref ref=\"STEEL_STAINLESS_Fe7Cr2Ni\"/>\n"
+        << "      <solidref ref=\"TPCWire" << iVolume << "\"/>\n"
+        << "    </volume>\n";
+  }
+  out << "    <volume name=\"volOpDetSensitive\">\n"
+      << "      <materialref ref=\"LAr\"/>\n"
+      << "      <solidref ref=\"OpDetSensitive\"/>\n"
+      << "    </volume>\n";
+
+  unsigned int const nCryoVolumes = config.uniqueTPCVolumes ? config.nCryostats : 1U;
+  for (unsigned int iCryo = 0; iCryo < nCryoVolumes; ++iCryo) {
+    unsigned int const nTPCVolumes = config.uniqueTPCVolumes ? config.nTPCsPerCryostat : 1U;
+    for (unsigned int iTPC = 0; iTPC < nTPCVolumes; ++iTPC)
+      writeTPCVolumes(out, tpcSuffix(iCryo, iTPC), planes, config, planeSpacing);
+
+    std::string const suffix = cryoSuffix(iCryo);
+    out << "    <volume name=\"volCryostat" << suffix << "\">\n"
+        << "      <materialref ref=\"LAr\"/>\n"
+        << "      <solidref ref=\"Cryostat\"/>\n";
+    for (unsigned int iTPC = 0; iTPC < config.nTPCsPerCryostat; ++iTPC) {
+      unsigned int const column = iTPC % nColumns;
+      unsigned int const row = iTPC / nColumns;
+      double const x = -0.5 * cryoWidth + OpDetGap + CryostatPadding;
+      double const z = -0.5 * cryoLength + CryostatPadding;
+      writePhysVol(out,
+                   "volTPC" + tpcSuffix(iCryo, iTPC),
+                   "posTPC" + suffix + "_" + std::to_string(iTPC),
+                   x + (column + 0.5) * config.tpcWidth,
+                   0.0,
+                   z + (row + 0.5) * config.tpcLength);
+    }
+    for (unsigned int iOpDet = 0; iOpDet < nOpDets; ++iOpDet) {
+      writePhysVol(out,
+                   "volOpDetSensitive",
+                   "posOpDet" + suffix + "_" + std::to_string(iOpDet),
+                   -0.5 * cryoWidth + 0.5 * OpDetGap,
+                   -0.5 * config.tpcHeight + (iOpDet % nOpDetRows + 0.5) * opDetCellY,
+                   -0.5 * opDetAreaLength + (iOpDet / nOpDetRows + 0.5) * opDetCellZ);
+    }
+    out << "    </volume>\n";
+  }
+
+  out << "    <volume name=\"volDetEnclosure\">\n"
+      << "      <materialref ref=\"Air\"/>\n"
+      << "      <solidref ref=\"DetEnclosure\"/>\n";
+  for (unsigned int iCryo = 0; iCryo < config.nCryostats; ++iCryo) {
+    writePhysVol(out,
+                 "volCryostat" + cryoSuffix(iCryo),
+                 "posCryostat" + std::to_string(iCryo),
+                 -0.5 * enclWidth + (iCryo + 1) * CryostatGap + (iCryo + 0.5) * cryoWidth,
+                 0.0,
+                 0.0);
+  }
+  out << "    </volume>\n";
+
+  out << "    <volume name=\"volWorld\">\n"
+      << "      <materialref ref=\"Air\"/>\n"
+      << "      <solidref ref=\"World\"/>\n";
+  writePhysVol(out, "volDetEnclosure", "posDetEnclosure", 0.0, 0.0, 0.0);
+  out << "    </volume>\n"
+      << "  </structure>\n"
+      << "  <setup name=\"Default\" version=\"1.0\">\n"
+      << "    <world ref=\"volWorld\"/>\n"
+      << "  </setup>\n"
+      << "</gdml>\n";
+
+  out.precision(oldPrecision);
+
+  SyntheticDetectorStats stats;
+  stats.nCryostats = config.nCryostats;
+  stats.nTPCs = config.nCryostats * config.nTPCsPerCryostat;
+  stats.nPlanes = stats.nTPCs * config.nPlanes;
+  stats.nWires = stats.nTPCs * nWiresPerTPC;
+  stats.nOpDets = config.nCryostats * nOpDets;
+  stats.nWireVolumes = wireLengths.size();
+  return stats;
+}
+
+//------------------------------------------------------------------------------
+geo::SyntheticDetectorStats geo::WriteSyntheticGDML(SyntheticDetectorConfig const& config,
+                                                    std::string const& path)
+{
+  std::ofstream out{path};
+  if (!out) {
+    throw cet::exception("SyntheticGDML") << "Could not open '" << path << "' for write.\n";
+  }
+  SyntheticDetectorStats const stats = WriteSyntheticGDML(config, out);
+  out.close();
+  if (!out) {
+    throw cet::exception("SyntheticGDML") << "Error writing '" << path << "'.\n";
+  }
+  return stats;
+}
@@ -0,0 +1,78 @@
+/**
+ * @file   larcore/Geometry/SyntheticGDML.h
+ * @brief  Writes GDML descriptions of synthetic LArTPC detectors of any size.
+ * @see    larcore/Geometry/SyntheticGDML.cc
+ *
+ * The detectors shipped with the GDML files are small: these generated ones
+ * scale up to hundreds of TPCs and millions of wires, to measure how the
+ * geometry services behave with large detectors. The compiled
+ * `generate_synthetic_gdml` in `larcore/Geometry/gdml` exposes this function.
+ */
+
+#ifndef LARCORE_GEOMETRY_SYNTHETICGDML_H
+#define LARCORE_GEOMETRY_SYNTHETICGDML_H
+
+// C/C++ standard libraries
+#include <cstddef> // std::size_t
+#include <iosfwd>
+#include <string>
+
+namespace geo {
+
+  /// Parameters of a synthetic detector (lengths in centimeters, angles in degrees).
+  struct SyntheticDetectorConfig {
+    unsigned int nCryostats = 1;        ///< Cryostats, side by side along _x_.
+    unsigned int nTPCsPerCryostat = 2;  ///< TPCs in each cryostat.
+    unsigned int nTPCColumns = 1;       ///< TPCs along _x_ in a cryostat (rest along _z_).
+    unsigned int nPlanes = 3;           ///< Wire planes in each TPC.
+    double wirePitch = 0.3;             ///< Distance between wires of a plane.
+    double wireAngle = 35.7;            ///< Angle of induction wires from the vertical.
+    unsigned int nOpDetsPerCryostat = 10; ///< Optical detectors in each cryostat.
+    double tpcWidth = 100.0;            ///< Size of a TPC along _x_ (drift direction).
+    double tpcHeight = 100.0;           ///< Size of a TPC along _y_.
+    double tpcLength = 200.0;           ///< Size of a TPC along _z_.
+    bool uniqueTPCVolumes = false;      ///< Describe each TPC (and its planes) separately.
+  };
+
+  /// Number of the objects in a synthetic detector.
+  struct SyntheticDetectorStats {
+    unsigned int nCryostats = 0;
+    unsigned int nTPCs = 0;
+    unsigned int nPlanes = 0;     ///< Planes in the whole detector.
+    std::size_t nWires = 0;       ///< Wires in the whole detector.
+    unsigned int nOpDets = 0;
+    std::size_t nWireVolumes = 0; ///< Distinct wire volumes (one per wire length).
+  };
+
+  /**
+   * @brief Writes the GDML description of a synthetic detector.
+   * @param config the parameters of the detector
+   * @param out the stream to write the GDML document into
+   * @return the number of objects in the detector
+   * @throw cet::exception (category: `SyntheticGDML`) on invalid parameters
+   *
+   * The volume names are the ones `geo::GeometryBuilderStandard` looks for.
+   * All TPCs are identical, with the wire planes on the _x_ side of smaller _x_
+   * (anode), and drift along _x_. Planes are `wirePitch` apart from each other
+   * (but at least `3 mm`); the last one (collection) has vertical wires,
+   * the others (induction) have wires alternately at `+wireAngle` and
+   * `-wireAngle` from the vertical, all with `wirePitch` between wires, and
+   * wires crossing the corners of the plane are shortened.
+   * The optical detectors are boxes on a grid on the anode side of each
+   * cryostat.
+   *
+   * Unless `uniqueTPCVolumes` is set, all the TPCs are placements of the same
+   * volume, which keeps the GDML document small (the objects of LArSoft
+   * geometry are still one per placement).
+   */
+  SyntheticDetectorStats WriteSyntheticGDML(SyntheticDetectorConfig const& config,
+                                            std::ostream& out);
+
+  /// Writes the GDML description of a synthetic detector into the file `path`.
+  /// @throw cet::exception (category: `SyntheticGDML`) if the file can't be written
+  SyntheticDetectorStats WriteSyntheticGDML(SyntheticDetectorConfig const& config,
+                                            std::string const& path);
+
+} // namespace geo
+
+#endif // LARCORE_GEOMETRY_SYNTHETICGDML_H
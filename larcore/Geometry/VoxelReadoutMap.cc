@@ -0,0 +1,295 @@
+/**
+ * @file   larcore/Geometry/VoxelReadoutMap.cc
+ * @brief  Voxel grid mapping points to their TPC and to the candidate wires of each plane.
+ * @see    larcore/Geometry/VoxelReadoutMap.h
+ */
+
+// library header
+#include "larcore/Geometry/VoxelReadoutMap.h"
+
+// LArSoft libraries
+#include "larcore/Geometry/GeometrySubset.h"
+#include "larcorealg/Geometry/BoxBoundedGeo.h"
+#include "larcorealg/Geometry/GeometryCore.h"
+#include "larcorealg/Geometry/PlaneGeo.h"
+#include "larcorealg/Geometry/TPCGeo.h"
+#include "larcorealg/Geometry/WireReadoutGeom.h"
+
+// framework libraries
+#include "cetlib_except/exception.h"
+
+// C/C++ standard libraries
+#include <algorithm> // std::min(), std::max(), std::clamp(), std::fill()
+#include <cmath>     // std::ceil(), std::floor(), std::lround()
+#include <limits>
+#include <utility> // std::pair
+
+namespace {
+
+  // wire coordinates are widened by this before rounding, against rounding errors
+  constexpr double CoordinateTolerance = 1e-6;
+
+  // at most this many voxel and TPC pairs (indices are 32-bit)
+  constexpr std::size_t MaxEntries = std::numeric_limits<std::uint32_t>::max();
+
+  std::array<double, 3> toArray(geo::Point_t const& point)
+  {
+    return {point.X(), point.Y(), point.Z()};
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+geo::VoxelReadoutMap::VoxelReadoutMap(GeometryCore const& geom,
+                                      WireReadoutGeom const& wireReadout,
+                                      double voxelSize,
+                                      GeometrySubset const* subset)
+  : fVoxelSize{voxelSize}
+{
+  if (!(voxelSize > 0.0)) {
+    throw cet::exception("VoxelReadoutMap")
+      << "Voxel size must be positive (" << voxelSize << " cm requested).\n";
+  }
+
+  // TPCs, planes and channel table; grid covering all the active volumes
+  constexpr double huge = std::numeric_limits<double>::max();
+  std::array<double, 3> min{huge, huge, huge}, max{-huge, -huge, -huge};
+  for (TPCGeo const& tpc : geom.Iterate<TPCGeo>()) {
+    if (subset && !subset->Contains(tpc.ID())) continue;
+    BoxBoundedGeo const& box = tpc.ActiveBoundingBox();
+    std::array<double, 3> const boxMin{box.MinX(), box.MinY(), box.MinZ()};
+    std::array<double, 3> const boxMax{box.MaxX(), box.MaxY(), box.MaxZ()};
+    unsigned int const nPlanes = wireReadout.Nplanes(tpc.ID());
+    fTPCs.push_back(
+      {tpc.ID(), boxMin, boxMax, static_cast<unsigned int>(fPlanes.size()), nPlanes});
+    for (unsigned int p = 0; p < nPlanes; ++p) {
+      PlaneGeo const& plane = wireReadout.Plane(PlaneID{tpc.ID(), p});
+      // the wire coordinate is linear: its value at the center and its change along each axis
+      Point_t const center = plane.GetCenter();
+      double const centerCoordinate = plane.WireCoordinate(center);
+      std::array<double, 3> gradient;
+      for (std::size_t i = 0; i < 3; ++i) {
+        std::array<double, 3> shifted = toArray(center);
+        shifted[i] += 1.0;
+        gradient[i] =
+          plane.WireCoordinate(Point_t{shifted[0], shifted[1], shifted[2]}) - centerCoordinate;
+      }
+      fPlanes.push_back(
+        {toArray(center), centerCoordinate, gradient, plane.Nwires(), fChannels.size()});
+      for (unsigned int w = 0; w < plane.Nwires(); ++w)
+        fChannels.push_back(wireReadout.PlaneWireToChannel(WireID{plane.ID(), w}));
+    }
+    for (std::size_t i = 0; i < 3; ++i) {
+      min[i] = std::min(min[i], boxMin[i]);
+      max[i] = std::max(max[i], boxMax[i]);
+    }
+  }
+
+  double gridSize = 1.0; // in voxels, as a real number not to overflow
+  for (std::size_t i = 0; i < 3; ++i) {
+    fOrigin[i] = fTPCs.empty() ? 0.0 : min[i];
+    double const n = fTPCs.empty() ? 0.0 : std::max(1.0, std::ceil((max[i] - min[i]) / voxelSize));
+    fNVoxels[i] = static_cast<std::size_t>(std::min<double>(n, MaxEntries));
+    gridSize *= n;
+  }
+  if (gridSize >= MaxEntries) {
+    throw cet::exception("VoxelReadoutMap")
+      << "Voxels of " << voxelSize << " cm would make a grid of " << fNVoxels[0] << " x "
+      << fNVoxels[1] << " x " << fNVoxels[2] << " voxels, too many.\n";
+  }
+  std::size_t const nVoxels = fNVoxels[0] * fNVoxels[1] * fNVoxels[2];
+
+  // the voxels overlapping the active volume of a TPC (faces included)
+  auto const voxelRange = [this](TPCEntry const& tpc) {
+    std::array<std::size_t, 3> first, last;
+    for (std::size_t i = 0; i < 3; ++i) {
+      first[i] =
+        static_cast<std::size_t>(std::floor((tpc.activeMin[i] - fOrigin[i]) / fVoxelSize));
+      last[i] = std::min(
+        static_cast<std::size_t>(std::floor((tpc.activeMax[i] - fOrigin[i]) / fVoxelSize)),
+        fNVoxels[i] - 1);
+      first[i] = std::min(first[i], last[i]);
+    }
+    return std::pair{first, last};
+  };
+  auto const forEachVoxel = [this, &voxelRange](TPCEntry const& tpc, auto&& action) {
+    auto const [first, last] = voxelRange(tpc);
+    for (std::size_t ix = first[0]; ix <= last[0]; ++ix)
+      for (std::size_t iy = first[1]; iy <= last[1]; ++iy)
+        for (std::size_t iz = first[2]; iz <= last[2]; ++iz)
+          action((ix * fNVoxels[1] + iy) * fNVoxels[2] + iz, std::array{ix, iy, iz});
+  };
+
+  // first pass: how many TPCs overlap each voxel
+  std::vector<std::uint32_t> counts(nVoxels, 0U);
+  std::size_t nEntries = 0;
+  for (TPCEntry const& tpc : fTPCs) {
+    forEachVoxel(tpc, [&counts, &nEntries](std::size_t voxel, auto const&) {
+      ++counts[voxel];
+      ++nEntries;
+    });
+  }
+  if (nEntries >= MaxEntries) {
+    throw cet::exception("VoxelReadoutMap")
+      << "Voxels of " << voxelSize << " cm make too many voxel entries (" << nEntries
+      << ").\n";
+  }
+  fCellFirst.resize(nVoxels + 1);
+  fCellFirst[0] = 0;
+  for (std::size_t voxel = 0; voxel < nVoxels; ++voxel)
+    fCellFirst[voxel + 1] = fCellFirst[voxel] + counts[voxel];
+
+  // second pass: the entries, in TPC order within each voxel, with their candidate wires
+  fEntries.resize(nEntries);
+  std::fill(counts.begin(), counts.end(), 0U);
+  for (std::uint32_t iTPC = 0; iTPC < fTPCs.size(); ++iTPC) {
+    TPCEntry const& tpc = fTPCs[iTPC];
+
+    forEachVoxel(tpc, [&](std::size_t voxel, std::array<std::size_t, 3> const& index) {
+      // overlap of the voxel with the active volume
+      std::array<double, 3> from, to;
+      bool contained = true;
+      for (std::size_t i = 0; i < 3; ++i) {
+        double const low = fOrigin[i] + index[i] * fVoxelSize;
+        double const high = low + fVoxelSize;
+        from[i] = std::max(low, tpc.activeMin[i]);
+        to[i] = std::min(high, tpc.activeMax[i]);
+        contained = contained && (from[i] == low) && (to[i] == high);
+      }
+
+      fEntries[fCellFirst[voxel] + counts[voxel]++] = {
+        iTPC, static_cast<std::uint32_t>(fWireRanges.size()), contained};
+
+      for (unsigned int p = 0; p < tpc.nPlanes; ++p) {
+        PlaneEntry const& plane = fPlanes[tpc.firstPlane + p];
+        double minCoord = std::numeric_limits<double>::max();
+        double maxCoord = std::numeric_limits<double>::lowest();
+        for (unsigned int corner = 0; corner < 8; ++corner) {
+          double const coord = plane.wireCoordinate(Point_t{(corner & 1) ? to[0] : from[0],
+                                                            (corner & 2) ? to[1] : from[1],
+                                                            (corner & 4) ? to[2] : from[2]});
+          minCoord = std::min(minCoord, coord);
+          maxCoord = std::max(maxCoord, coord);
+        }
+        long const lastWire = static_cast<long>(plane.nWires) - 1;
+        long const first = std::clamp(std::lround(minCoord - CoordinateTolerance), 0L, lastWire);
+        long const last = std::clamp(std::lround(maxCoord + CoordinateTolerance), 0L, lastWire);
+        fWireRanges.push_back(
+          {static_cast<WireID::WireID_t>(first), static_cast<WireID::WireID_t>(last)});
+      }
+    });
+  }
+}
+
+//------------------------------------------------------------------------------
+auto geo::VoxelReadoutMap::Locate(Point_t const& point) const -> Location
+{
+  std::size_t const voxel = voxelIndex(point);
+  if (voxel >= fCellFirst.size() - 1) return {};
+
+  std::uint32_t const end = fCellFirst[voxel + 1];
+  for (std::uint32_t i = fCellFirst[voxel]; i < end; ++i) {
+    CellEntry const& entry = fEntries[i];
+    if (entry.contained || fTPCs[entry.tpc].contains(point))
+      return {*this, entry, point};
+  }
+  return {};
+}
+
+//------------------------------------------------------------------------------
+std::size_t geo::VoxelReadoutMap::MemoryUsage() const
+{
+  return sizeof(*this) + fTPCs.capacity() * sizeof(TPCEntry) +
+         fPlanes.capacity() * sizeof(PlaneEntry) +
+         fChannels.capacity() * sizeof(raw::ChannelID_t) +
+         fCellFirst.capacity() * sizeof(std::uint32_t) +
+         fEntries.capacity() * sizeof(CellEntry) + fWireRanges.capacity() * sizeof(WireRange);
+}
+
+//------------------------------------------------------------------------------
+std::vector<std::span<std::byte const>> geo::VoxelReadoutMap::MemoryBlocks() const
+{
+  return {std::as_bytes(std::span{fTPCs}),
+          std::as_bytes(std::span{fPlanes}),
+          std::as_bytes(std::span{fChannels}),
+          std::as_bytes(std::span{fCellFirst}),
+          std::as_bytes(std::span{fEntries}),
+          std::as_bytes(std::span{fWireRanges})};
+}
+
+//------------------------------------------------------------------------------
+std::size_t geo::VoxelReadoutMap::voxelIndex(Point_t const& point) const
+{
+  std::size_t const nVoxels = fCellFirst.size() - 1;
+  double const coords[3] = {point.X(), point.Y(), point.Z()};
+  std::size_t index[3];
+  for (std::size_t i = 0; i < 3; ++i) {
+    double const cell = std::floor((coords[i] - fOrigin[i]) / fVoxelSize);
+    if (!(cell >= 0.0)) return nVoxels; // also NaN
+    if (cell < fNVoxels[i])
+      index[i] = static_cast<std::size_t>(cell);
+    else if ((fNVoxels[i] > 0) && (coords[i] <= fOrigin[i] + fNVoxels[i] * fVoxelSize))
+      index[i] = fNVoxels[i] - 1; // the upper border of the grid belongs to the last voxel
+    else
+      return nVoxels;
+  }
+  return (index[0] * fNVoxels[1] + index[1]) * fNVoxels[2] + index[2];
+}
+
+//------------------------------------------------------------------------------
+bool geo::VoxelReadoutMap::TPCEntry::contains(Point_t const& point) const
+{
+  std::array<double, 3> const coords = toArray(point);
+  for (std::size_t i = 0; i < 3; ++i) {
+    if ((coords[i] < activeMin[i]) || (coords[i] > activeMax[i])) return false;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+double geo::VoxelReadoutMap::PlaneEntry::wireCoordinate(Point_t const& point) const
+{
+  return referenceCoordinate + gradient[0] * (point.X() - reference[0]) +
+         gradient[1] * (point.Y() - reference[1]) + gradient[2] * (point.Z() - reference[2]);
+}
+
+//------------------------------------------------------------------------------
+// ---  geo::VoxelReadoutMap::Location
+//------------------------------------------------------------------------------
+geo::TPCID geo::VoxelReadoutMap::Location::TPC() const
+{
+  return fEntry ? fMap->fTPCs[fEntry->tpc].ID : TPCID{};
+}
+
+//------------------------------------------------------------------------------
+unsigned int geo::VoxelReadoutMap::Location::Nplanes() const
+{
+  return fEntry ? fMap->fTPCs[fEntry->tpc].nPlanes : 0U;
+}
+
+//------------------------------------------------------------------------------
+geo::WireID geo::VoxelReadoutMap::Location::NearestWire(unsigned int plane) const
+{
+  if (!fEntry) return {};
+  return {PlaneID{fMap->fTPCs[fEntry->tpc].ID, plane}, nearestWireNo(plane)};
+}
+
+//------------------------------------------------------------------------------
+raw::ChannelID_t geo::VoxelReadoutMap::Location::NearestChannel(unsigned int plane) const
+{
+  if (!fEntry) return raw::InvalidChannelID;
+  PlaneEntry const& planeEntry = fMap->fPlanes[fMap->fTPCs[fEntry->tpc].firstPlane + plane];
+  return fMap->fChannels[planeEntry.firstChannel + nearestWireNo(plane)];
+}
+
+//------------------------------------------------------------------------------
+geo::WireID::WireID_t geo::VoxelReadoutMap::Location::nearestWireNo(unsigned int plane) const
+{
+  WireRange const& range = fMap->fWireRanges[fEntry->firstRange + plane];
+  if (range.first == range.last) return range.first;
+
+  PlaneEntry const& planeEntry = fMap->fPlanes[fMap->fTPCs[fEntry->tpc].firstPlane + plane];
+  long const wire = std::lround(planeEntry.wireCoordinate(fPoint));
+  return static_cast<WireID::WireID_t>(
+    std::clamp(wire, static_cast<long>(range.first), static_cast<long>(range.last)));
+}
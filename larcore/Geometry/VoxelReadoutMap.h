@@ -0,0 +1,190 @@
+/**
+ * @file   larcore/Geometry/VoxelReadoutMap.h
+ * @brief  Voxel grid mapping points to their TPC and to the candidate wires of each plane.
+ * @see    larcore/Geometry/VoxelReadoutMap.cc
+ */
+
+#ifndef LARCORE_GEOMETRY_VOXELREADOUTMAP_H
+#define LARCORE_GEOMETRY_VOXELREADOUTMAP_H
+
+// LArSoft libraries
+#include "larcorealg/Geometry/fwd.h"
+#include "larcoreobj/SimpleTypesAndConstants/RawTypes.h"  // raw::ChannelID_t
+#include "larcoreobj/SimpleTypesAndConstants/geo_types.h"
+#include "larcoreobj/SimpleTypesAndConstants/geo_vectors.h" // geo::Point_t
+
+// C/C++ standard libraries
+#include <array>
+#include <cstddef> // std::size_t, std::byte
+#include <cstdint> // std::uint32_t
+#include <span>
+#include <vector>
+
+namespace geo {
+
+  class GeometrySubset;
+
+  /**
+   * @brief Coarse voxel grid over the TPC active volumes, for fast readout lookups.
+   *
+   * Converting a point (like an energy deposition) into its TPC and the
+   * nearest channel on each plane usually takes `PositionToTPCID()`, then
+   * `NearestWireID()` and `PlaneWireToChannel()` for each plane. This map
+   * precomputes the answer on a grid of cubic voxels covering all the active
+   * volumes: each voxel records the TPCs overlapping it and, for each of their
+   * planes, the range of wires that may be the nearest one to a point of the
+   * voxel (the wire coordinate is linear in the position, so the extremes are
+   * at the corners of the voxel). `Locate()` finds the voxel with a single
+   * index computation; the nearest wire is then the only candidate, or the
+   * rounded wire coordinate of the point clamped to the candidates, and its
+   * channel comes from a table.
+   *
+   * The results are the same as the direct path's for all points in an active
+   * volume, except that points beyond the first or last wire of a plane are
+   * assigned to that wire (where `NearestWireID()` throws). Points out of all
+   * active volumes are not located. Memory grows with the inverse cube of the
+   * voxel size; `MemoryUsage()` reports it.
+   *
+   * With a `geo::GeometrySubset`, the grid covers only the active volumes of
+   * its TPCs, and only those are located.
+   *
+   * The map keeps its own copy of what the lookups need (the bounds of the
+   * active volumes and the wire coordinate of each plane, as a linear function
+   * of the position), so that they read only the map's memory: it does not
+   * refer to the geometry objects after construction, and a copy of it (e.g.
+   * on another NUMA node) is self-contained. The wire coordinates are the
+   * ones of `geo::PlaneGeo::WireCoordinate()` up to rounding errors.
+   */
+  class VoxelReadoutMap {
+    struct TPCEntry;
+    struct CellEntry;
+
+  public:
+    /// A point located in the map: its TPC and the candidate wires of its planes.
+    class Location {
+    public:
+      /// Returns whether the point is in an active volume.
+      bool isValid() const { return fEntry != nullptr; }
+      explicit operator bool() const { return isValid(); }
+
+      /// Returns the TPC containing the point (invalid if none).
+      TPCID TPC() const;
+
+      /// Returns the number of planes of the TPC (`0` if none).
+      unsigned int Nplanes() const;
+
+      /// Returns the wire of plane number `plane` nearest to the point.
+      WireID NearestWire(unsigned int plane) const;
+
+      /// Returns the channel of the wire of plane number `plane` nearest to the point.
+      raw::ChannelID_t NearestChannel(unsigned int plane) const;
+
+    private:
+      friend class VoxelReadoutMap;
+
+      VoxelReadoutMap const* fMap = nullptr;
+      CellEntry const* fEntry = nullptr;
+      Point_t fPoint;
+
+      Location() = default;
+      Location(VoxelReadoutMap const& map, CellEntry const& entry, Point_t const& point)
+        : fMap{&map}, fEntry{&entry}, fPoint{point}
+      {}
+
+      /// Returns the number (within its plane) of the wire of `plane` nearest to the point.
+      WireID::WireID_t nearestWireNo(unsigned int plane) const;
+    };
+
+    /**
+     * @brief Builds the map of all the TPCs of `geom`.
+     * @param geom the geometry with the TPCs
+     * @param wireReadout the wire readout geometry with the planes and channels
+     * @param voxelSize side of the voxels [cm]
+     * @param subset if not `nullptr`, only its TPCs are mapped
+     * @throw cet::exception (category: `VoxelReadoutMap`) if the size is not
+     *        positive or the grid would be too large
+     */
+    VoxelReadoutMap(GeometryCore const& geom,
+                    WireReadoutGeom const& wireReadout,
+                    double voxelSize,
+                    GeometrySubset const* subset = nullptr);
+
+    /// Returns the location of `point` (invalid if not in any active volume).
+    Location Locate(Point_t const& point) const;
+
+    /// Returns the TPC whose active volume contains `point` (invalid if none).
+    TPCID FindTPC(Point_t const& point) const { return Locate(point).TPC(); }
+
+    /// Returns the side of the voxels [cm].
+    double VoxelSize() const { return fVoxelSize; }
+
+    /// Returns the number of voxels along _x_, _y_ and _z_.
+    std::array<std::size_t, 3> Nvoxels() const { return fNVoxels; }
+
+    /// Returns the number of voxel and TPC pairs in the map.
+    std::size_t NEntries() const { return fEntries.size(); }
+
+    /// Returns the memory taken by the map [bytes].
+    std::size_t MemoryUsage() const;
+
+    /// Returns the blocks of memory of the map (e.g. to move them to huge pages).
+    std::vector<std::span<std::byte const>> MemoryBlocks() const;
+
+  private:
+    /// A TPC, with the position of its planes and of its channels in the tables.
+    struct TPCEntry {
+      TPCID ID;
+      std::array<double, 3> activeMin; ///< Lower corner of the active volume [cm].
+      std::array<double, 3> activeMax; ///< Upper corner of the active volume [cm].
+      unsigned int firstPlane;         ///< Index of its first plane in `fPlanes`.
+      unsigned int nPlanes;
+
+      /// Returns whether `point` is in the active volume (borders included).
+      bool contains(Point_t const& point) const;
+    };
+
+    /// A plane, with its wire coordinate and the position of the channels of
+    /// its wires in `fChannels`.
+    struct PlaneEntry {
+      std::array<double, 3> reference; ///< A point of the plane [cm].
+      double referenceCoordinate;      ///< Wire coordinate of `reference`.
+      std::array<double, 3> gradient;  ///< Wire coordinate change per cm along each axis.
+      unsigned int nWires;
+      std::size_t firstChannel;
+
+      /// Returns the wire coordinate of `point`.
+      double wireCoordinate(Point_t const& point) const;
+    };
+
+    /// A TPC overlapping a voxel, with its candidate wires in `fWireRanges`.
+    struct CellEntry {
+      std::uint32_t tpc;        ///< Index of the TPC in `fTPCs`.
+      std::uint32_t firstRange; ///< Index of the range of its first plane.
+      bool contained;           ///< Whether the voxel is all in the active volume.
+    };
+
+    /// Candidate nearest wires of a plane in a voxel.
+    struct WireRange {
+      WireID::WireID_t first;
+      WireID::WireID_t last;
+    };
+
+    double fVoxelSize;
+    std::array<double, 3> fOrigin;          ///< Lower corner of the grid.
+    std::array<std::size_t, 3> fNVoxels;
+
+    std::vector<TPCEntry> fTPCs;
+    std::vector<PlaneEntry> fPlanes;
+    std::vector<raw::ChannelID_t> fChannels; ///< Channel of each wire, plane by plane.
+
+    std::vector<std::uint32_t> fCellFirst; ///< First entry of each voxel (and end of the last).
+    std::vector<CellEntry> fEntries;
+    std::vector<WireRange> fWireRanges;
+
+    /// Returns the index of the voxel containing `point`, or the number of voxels if none.
+    std::size_t voxelIndex(Point_t const& point) const;
+  };
+
+} // namespace geo
+
+#endif // LARCORE_GEOMETRY_VOXELREADOUTMAP_H
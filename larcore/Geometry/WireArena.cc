@@ -0,0 +1,108 @@
+/**
+ * @file   larcore/Geometry/WireArena.cc
+ * @brief  Contiguous, sorted copy of all the wires of a wire readout geometry.
+ * @see    larcore/Geometry/WireArena.h
+ */
+
+// library header
+#include "larcore/Geometry/WireArena.h"
+
+// LArSoft libraries
+#include "larcore/Geometry/GeometrySubset.h"
+#include "larcorealg/Geometry/PlaneGeo.h"
+#include "larcorealg/Geometry/WireReadoutGeom.h"
+
+// framework libraries
+#include "cetlib_except/exception.h"
+
+// C/C++ standard libraries
+#include <algorithm> // std::lower_bound(), std::upper_bound(), std::sort()
+#include <iterator>  // std::prev()
+
+//------------------------------------------------------------------------------
+geo::WireArena::WireArena(WireReadoutGeom const& wireReadout, GeometrySubset const* subset)
+{
+  std::vector<PlaneGeo const*> planes;
+  std::size_t nWires = 0;
+  for (PlaneGeo const& plane : wireReadout.Iterate<PlaneGeo>()) {
+    if (subset && !subset->Contains(plane.ID())) continue;
+    planes.push_back(&plane);
+    nWires += plane.Nwires();
+  }
+  std::sort(planes.begin(), planes.end(), [](PlaneGeo const* a, PlaneGeo const* b) {
+    return a->ID() < b->ID();
+  });
+
+  // one allocation, filled plane by plane in ID order
+  fPlanes.reserve(planes.size());
+  fWires.reserve(nWires);
+  for (PlaneGeo const* plane : planes) {
+    fPlanes.push_back({plane->ID(), fWires.size(), plane->Nwires()});
+    for (unsigned int iWire = 0; iWire < plane->Nwires(); ++iWire)
+      fWires.push_back(plane->Wire(iWire));
+  }
+}
+
+//------------------------------------------------------------------------------
+std::span<geo::WireGeo const> geo::WireArena::Wires(PlaneID const& planeID) const
+{
+  PlaneEntry const* entry = findPlane(planeID);
+  if (!entry) return {};
+  return std::span<WireGeo const>{fWires}.subspan(entry->firstWire, entry->nWires);
+}
+
+//------------------------------------------------------------------------------
+geo::WireGeo const& geo::WireArena::Wire(WireID const& wireID) const
+{
+  PlaneEntry const* entry = findPlane(wireID.asPlaneID());
+  if (!entry || (wireID.Wire >= entry->nWires)) {
+    throw cet::exception("WireArena") << "Wire " << wireID << " is not in the arena.\n";
+  }
+  return fWires[entry->firstWire + wireID.Wire];
+}
+
+//------------------------------------------------------------------------------
+auto geo::WireArena::Planes(TPCID const& tpcID) const -> std::span<PlaneEntry const>
+{
+  auto const first = std::lower_bound(
+    fPlanes.begin(), fPlanes.end(), tpcID, [](PlaneEntry const& entry, TPCID const& id) {
+      return entry.ID.asTPCID() < id;
+    });
+  auto const last =
+    std::upper_bound(first, fPlanes.end(), tpcID, [](TPCID const& id, PlaneEntry const& entry) {
+      return id < entry.ID.asTPCID();
+    });
+  return {first, last};
+}
+
+//------------------------------------------------------------------------------
+geo::WireID geo::WireArena::WireIDAt(std::size_t index) const
+{
+  auto const next = std::upper_bound(
+    fPlanes.begin(), fPlanes.end(), index, [](std::size_t index, PlaneEntry const& entry) {
+      return index < entry.firstWire;
+    });
+  if ((next == fPlanes.begin()) || (index >= fWires.size())) {
+    throw cet::exception("WireArena")
+      << "Wire index " << index << " out of range (" << fWires.size() << " wires).\n";
+  }
+  PlaneEntry const& entry = *std::prev(next);
+  return {entry.ID, static_cast<WireID::WireID_t>(index - entry.firstWire)};
+}
+
+//------------------------------------------------------------------------------
+std::size_t geo::WireArena::MemoryUsage() const
+{
+  return sizeof(*this) + fWires.capacity() * sizeof(WireGeo) +
+         fPlanes.capacity() * sizeof(PlaneEntry);
+}
+
+//------------------------------------------------------------------------------
+auto geo::WireArena::findPlane(PlaneID const& planeID) const -> PlaneEntry const*
+{
+  auto const it = std::lower_bound(
+    fPlanes.begin(), fPlanes.end(), planeID, [](PlaneEntry const& entry, PlaneID const& id) {
+      return entry.ID < id;
+    });
+  return ((it != fPlanes.end()) && (it->ID == planeID)) ? &*it : nullptr;
+}
@@ -0,0 +1,98 @@
+/**
+ * @file   larcore/Geometry/WireArena.h
+ * @brief  Contiguous, sorted copy of all the wires of a wire readout geometry.
+ * @see    larcore/Geometry/WireArena.cc
+ */
+
+#ifndef LARCORE_GEOMETRY_WIREARENA_H
+#define LARCORE_GEOMETRY_WIREARENA_H
+
+// LArSoft libraries
+#include "larcorealg/Geometry/WireGeo.h"
+#include "larcorealg/Geometry/fwd.h"
+#include "larcoreobj/SimpleTypesAndConstants/geo_types.h"
+
+// C/C++ standard libraries
+#include <cstddef> // std::size_t, std::byte
+#include <span>
+#include <vector>
+
+namespace geo {
+
+  class GeometrySubset;
+
+  /**
+   * @brief All the wires of a detector in a single contiguous block.
+   *
+   * The wire objects of `geo::WireReadoutGeom` are allocated plane by plane as
+   * the geometry is built. This arena copies them, once, into a single block
+   * in the order of their IDs: the wires of each plane are contiguous, and so
+   * are the planes of each TPC and the TPCs of each cryostat. Loops on all the
+   * wires of a plane, of a TPC or of the detector then read memory
+   * sequentially.
+   *
+   * The arena does not refer to the planes of the original geometry, so a
+   * copy of it (e.g. on another NUMA node) is read without touching them. With
+   * a `geo::GeometrySubset`, only the planes of its TPCs are copied.
+   *
+   * @note The arena is an opt-in structure, in addition to the geometry: the
+   *       wires are held twice (`MemoryUsage()` reports the cost of the copy),
+   *       and only the code reading the arena gains from it. The wire queries
+   *       of `geo::WireReadoutGeom` (`Iterate<geo::WireID>()`, `Wire()`...)
+   *       still read the original wires, which belong to larcorealg.
+   */
+  class WireArena {
+  public:
+    /// A plane and the range of its wires in the arena.
+    struct PlaneEntry {
+      PlaneID ID;
+      std::size_t firstWire; ///< Index of the first wire of the plane in the arena.
+      std::size_t nWires;
+    };
+
+    /// Copies all the wires of `wireReadout` (only the ones in `subset`, if any).
+    explicit WireArena(WireReadoutGeom const& wireReadout,
+                       GeometrySubset const* subset = nullptr);
+
+    /// Returns the number of wires in the arena.
+    std::size_t NWires() const { return fWires.size(); }
+
+    /// Returns all the wires, sorted by ID.
+    std::span<WireGeo const> Wires() const { return fWires; }
+
+    /// Returns the wires of the plane `planeID` (empty if not present).
+    std::span<WireGeo const> Wires(PlaneID const& planeID) const;
+
+    /// Returns the wire with the specified ID.
+    /// @throw cet::exception (category: `WireArena`) if not present
+    WireGeo const& Wire(WireID const& wireID) const;
+
+    /// Returns all the planes, sorted by ID.
+    std::span<PlaneEntry const> Planes() const { return fPlanes; }
+
+    /// Returns the planes of the TPC `tpcID` (empty if not present).
+    std::span<PlaneEntry const> Planes(TPCID const& tpcID) const;
+
+    /// Returns the ID of the wire at `index` in `Wires()`.
+    WireID WireIDAt(std::size_t index) const;
+
+    /// Returns the memory taken by the arena [bytes].
+    std::size_t MemoryUsage() const;
+
+    /// Returns the blocks of memory of the arena (e.g. to move them to huge pages).
+    std::vector<std::span<std::byte const>> MemoryBlocks() const
+    {
+      return {std::as_bytes(std::span{fWires}), std::as_bytes(std::span{fPlanes})};
+    }
+
+  private:
+    std::vector<WireGeo> fWires;     ///< All wires, sorted.
+    std::vector<PlaneEntry> fPlanes; ///< All planes, sorted.
+
+    /// Returns the entry of `planeID` (`nullptr` if not present).
+    PlaneEntry const* findPlane(PlaneID const& planeID) const;
+  };
+
+} // namespace geo
+
+#endif // LARCORE_GEOMETRY_WIREARENA_H
@@ -2,6 +2,7 @@
 #define GEO_WireReadout_h
 
 // LArSoft libraries
+#include "larcore/Geometry/GeometryQueryProbe.h"
 #include "larcorealg/Geometry/WireReadoutGeom.h"
 #include "larcorealg/Geometry/fwd.h"
 
@@ -13,9 +14,16 @@
 // C/C++ standard libraries
 #include <memory> // std::unique_ptr<>
 #include <string>
+#include <vector>
 
 namespace geo {
 
+  class ChannelAdjacency;
+  class GeometrySubset;
+  class PixelLattice;
+  class VoxelReadoutMap;
+  class WireArena;
+
   /**
    * @brief Interface to a service with a detector-specific, wire-readout geometry
    *
@@ -28,15 +36,114 @@ namespace geo {
    * @note The public interface for this service cannot be overriden.  The
    * experiment-specific sub-classes should implement only the private methods without
    * promoting their visibility.
+   *
+   * The optional tables an implementation may build (`Arena()`, `VoxelMap()`,
+   * `Adjacency()`, `Pixels()`) are only declared here: users include their
+   * headers. The helpers working on the readout geometry take `Get()` (and
+   * `Subset()`) themselves: the splittable ID ranges (`geo::ReadoutIDTables`
+   * and `geo::IDRange`), the wire traversal (`geo::TraverseWires()`) and the
+   * channel partition (`geo::ChannelPartition`).
+   *
+   * If the implementation serves only a subset of the detector (see
+   * `geo::GeometrySubset`), `Subset()` returns it: the optional tables cover
+   * only its TPCs, with the channel numbers of the whole detector, and the
+   * adjacency queries throw for channels out of it. `Get()` still describes the
+   * whole detector, and is not checked against the subset.
+   *
+   * Detectors with a pixel readout serve the pixels of their anodes through
+   * `Pixels()` (see `geo::PixelLattice`), while `Get()` keeps serving the
+   * planes of the geometry description. The channels of `Get()`, and so those
+   * of the tables built on it, are then not readout channels; the pixel
+   * channels are numbered after them, so that the two never overlap.
    */
   class WireReadout {
   public:
     virtual ~WireReadout() = default;
 
+    /**
+     * @brief Returns the wire readout geometry.
+     *
+     * If the detector has a pixel readout (`Pixels()` is not `nullptr`), this
+     * describes only the wire planes of the geometry description: its channels
+     * (`PlaneWireToChannel()`, `ChannelToWire()`, `Nchannels()`...) are not
+     * read out, and the pixel channels start after them.
+     *
+     * If the implementation serves a `Subset()`, this still describes the
+     * whole detector: its queries are not checked against the subset.
+     */
     WireReadoutGeom const& Get() const { return wireReadoutGeom(); }
 
+    // --- BEGIN -- Monitored queries ------------------------------------------
+    /// @name Monitored queries
+    /// Same as the ones of `Get()`, and reported to the `GeometryQueryMonitor`
+    /// and `GeometryQueryTracer` services if configured (see `geo::QueryProbe`).
+    /// @{
+
+    /// Returns the wires connected to `channel`.
+    std::vector<WireID> ChannelToWire(raw::ChannelID_t channel) const
+    {
+      QueryProbe<GeometryQuery::ChannelToWire> const probe{channel};
+      return wireReadoutGeom().ChannelToWire(channel);
+    }
+
+    /// Returns the channel the wire `wireID` is connected to.
+    raw::ChannelID_t PlaneWireToChannel(WireID const& wireID) const
+    {
+      QueryProbe<GeometryQuery::PlaneWireToChannel> const probe{wireID};
+      return wireReadoutGeom().PlaneWireToChannel(wireID);
+    }
+
+    /// Returns the wire of the plane `planeID` closest to `point`.
+    WireID NearestWireID(Point_t const& point, PlaneID const& planeID) const
+    {
+      QueryProbe<GeometryQuery::NearestWireID> const probe{point, planeID};
+      return wireReadoutGeom().NearestWireID(point, planeID);
+    }
+
+    /// Returns the channel of the wire of the plane `planeID` closest to `point`.
+    raw::ChannelID_t NearestChannel(Point_t const& point, PlaneID const& planeID) const
+    {
+      QueryProbe<GeometryQuery::NearestChannel> const probe{point, planeID};
+      return wireReadoutGeom().NearestChannel(point, planeID);
+    }
+
+    /// Returns the coordinate of `point` on the plane `planeID`, in wire pitch units.
+    double WireCoordinate(Point_t const& point, PlaneID const& planeID) const
+    {
+      QueryProbe<GeometryQuery::WireCoordinate> const probe{point, planeID};
+      return wireReadoutGeom().WireCoordinate(point, planeID);
+    }
+
+    /// @}
+    // --- END -- Monitored queries --------------------------------------------
+
+    /// Returns the contiguous copy of the wires, if the implementation builds
+    /// one (`nullptr` otherwise).
+    WireArena const* Arena() const { return wireArena(); }
+
+    /// Returns the voxel map from positions to TPCs and nearest channels, if the
+    /// implementation builds one (`nullptr` otherwise).
+    VoxelReadoutMap const* VoxelMap() const { return voxelReadoutMap(); }
+
+    /// Returns the tables of neighbouring, crossing and continuation channels,
+    /// if the implementation builds them (`nullptr` otherwise).
+    ChannelAdjacency const* Adjacency() const { return channelAdjacency(); }
+
+    /// Returns the part of the detector the tables are restricted to, if the
+    /// implementation serves only a part (`nullptr` otherwise).
+    GeometrySubset const* Subset() const { return geometrySubset(); }
+
+    /// Returns the pixel lattices of the anodes, if the detector has a pixel
+    /// readout (`nullptr` otherwise).
+    PixelLattice const* Pixels() const { return pixelLattice(); }
+
   private:
     virtual WireReadoutGeom const& wireReadoutGeom() const = 0;
+    virtual WireArena const* wireArena() const { return nullptr; }
+    virtual VoxelReadoutMap const* voxelReadoutMap() const { return nullptr; }
+    virtual ChannelAdjacency const* channelAdjacency() const { return nullptr; }
+    virtual PixelLattice const* pixelLattice() const { return nullptr; }
+    virtual GeometrySubset const* geometrySubset() const { return nullptr; }
   };
 
 }
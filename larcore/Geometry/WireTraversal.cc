@@ -0,0 +1,128 @@
+/**
+ * @file   larcore/Geometry/WireTraversal.cc
+ * @brief  Ordered list of the wires of a plane crossed by a straight segment.
+ * @see    larcore/Geometry/WireTraversal.h
+ */
+
+// library header
+#include "larcore/Geometry/WireTraversal.h"
+
+// LArSoft libraries
+#include "larcorealg/Geometry/BoxBoundedGeo.h"
+#include "larcorealg/Geometry/PlaneGeo.h"
+#include "larcorealg/Geometry/TPCGeo.h"
+
+// framework libraries
+#include "cetlib_except/exception.h"
+
+// C/C++ standard libraries
+#include <algorithm> // std::max(), std::min(), std::swap()
+#include <cmath>     // std::abs(), std::lround()
+
+namespace {
+
+  // segments changing the wire coordinate by less than this are parallel to the wires
+  constexpr double ParallelTolerance = 1e-9;
+
+  // clips the parameter range [t0, t1] of `segment` to `box`; returns false if nothing is left
+  bool clip(geo::Segment const& segment, geo::BoxBoundedGeo const& box, double& t0, double& t1)
+  {
+    double const start[3] = {segment.start.X(), segment.start.Y(), segment.start.Z()};
+    double const end[3] = {segment.end.X(), segment.end.Y(), segment.end.Z()};
+    double const min[3] = {box.MinX(), box.MinY(), box.MinZ()};
+    double const max[3] = {box.MaxX(), box.MaxY(), box.MaxZ()};
+
+    t0 = 0.0;
+    t1 = 1.0;
+    for (int i = 0; i < 3; ++i) {
+      double const d = end[i] - start[i];
+      if (d == 0.0) {
+        if ((start[i] < min[i]) || (start[i] > max[i])) return false;
+        continue;
+      }
+      double tMin = (min[i] - start[i]) / d;
+      double tMax = (max[i] - start[i]) / d;
+      if (tMin > tMax) std::swap(tMin, tMax);
+      t0 = std::max(t0, tMin);
+      t1 = std::min(t1, tMax);
+      if (t0 > t1) return false;
+    }
+    return true;
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+geo::WireTraversal geo::TraverseWires(TPCGeo const& tpc,
+                                      PlaneGeo const& plane,
+                                      Segment const& segment)
+{
+  PlaneID const& planeID = plane.ID();
+  if (planeID.asTPCID() != tpc.ID()) {
+    throw cet::exception("WireTraversal")
+      << "Plane " << planeID << " does not belong to " << tpc.ID() << ".\n";
+  }
+
+  WireTraversal traversal;
+  traversal.plane = planeID;
+  double t0 = 0.0, t1 = 1.0;
+  if (!clip(segment, tpc.ActiveBoundingBox(), t0, t1)) return traversal;
+  traversal.crossesTPC = true;
+  traversal.tpcEntry = t0;
+  traversal.tpcExit = t1;
+
+  long const nWires = plane.Nwires();
+
+  // the wire coordinate is `startCoord + t * deltaCoord`; wire `w` covers [w - 0.5, w + 0.5)
+  double const startCoord = plane.WireCoordinate(segment.start);
+  double const deltaCoord = plane.WireCoordinate(segment.end) - startCoord;
+
+  if (std::abs(deltaCoord) < ParallelTolerance) {
+    long const wire = std::lround(startCoord);
+    if ((wire >= 0) && (wire < nWires))
+      traversal.wires.push_back({WireID{planeID, static_cast<WireID::WireID_t>(wire)}, t0, t1});
+    return traversal;
+  }
+
+  long const step = (deltaCoord > 0.0) ? 1 : -1;
+  long first = std::lround(startCoord + t0 * deltaCoord);
+  long last = std::lround(startCoord + t1 * deltaCoord);
+
+  // keep only the wires of the plane
+  if (step > 0) {
+    first = std::max(first, 0L);
+    last = std::min(last, nWires - 1);
+  }
+  else {
+    first = std::min(first, nWires - 1);
+    last = std::max(last, 0L);
+  }
+  if ((last - first) * step < 0) return traversal;
+
+  // each cell takes `1 / |deltaCoord|` of the segment; the parameters are computed
+  // from the cell borders rather than accumulated, so that rounding errors don't add up
+  auto const paramAt = [startCoord, deltaCoord](double coord) {
+    return (coord - startCoord) / deltaCoord;
+  };
+  traversal.wires.reserve((last - first) * step + 1);
+  for (long wire = first; wire != last + step; wire += step) {
+    double const entry = std::max(t0, paramAt(wire - 0.5 * step));
+    double const exit = std::min(t1, paramAt(wire + 0.5 * step));
+    if ((exit <= entry) && (first != last)) continue; // only touched at a border
+    traversal.wires.push_back(
+      {WireID{planeID, static_cast<WireID::WireID_t>(wire)}, entry, std::max(entry, exit)});
+  }
+  return traversal;
+}
+
+//------------------------------------------------------------------------------
+std::vector<geo::WireTraversal> geo::TraverseWires(TPCGeo const& tpc,
+                                                   PlaneGeo const& plane,
+                                                   std::span<Segment const> segments)
+{
+  std::vector<WireTraversal> traversals;
+  traversals.reserve(segments.size());
+  for (Segment const& segment : segments)
+    traversals.push_back(TraverseWires(tpc, plane, segment));
+  return traversals;
+}
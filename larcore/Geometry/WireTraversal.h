@@ -0,0 +1,77 @@
+/**
+ * @file   larcore/Geometry/WireTraversal.h
+ * @brief  Ordered list of the wires of a plane crossed by a straight segment.
+ * @see    larcore/Geometry/WireTraversal.cc
+ */
+
+#ifndef LARCORE_GEOMETRY_WIRETRAVERSAL_H
+#define LARCORE_GEOMETRY_WIRETRAVERSAL_H
+
+// LArSoft libraries
+#include "larcorealg/Geometry/fwd.h"
+#include "larcoreobj/SimpleTypesAndConstants/geo_types.h"
+#include "larcoreobj/SimpleTypesAndConstants/geo_vectors.h" // geo::Point_t
+
+// C/C++ standard libraries
+#include <span>
+#include <vector>
+
+namespace geo {
+
+  /// A straight segment from `start` to `end`, with parameter `0` at `start` and `1` at `end`.
+  struct Segment {
+    Point_t start;
+    Point_t end;
+
+    /// Returns the point of the segment at parameter `t`.
+    Point_t at(double t) const { return start + t * (end - start); }
+  };
+
+  /// A wire crossed by a segment, with the parameters where the segment enters
+  /// and leaves the cell of the wire (the region closer to it than to its neighbours).
+  struct WireCrossing {
+    WireID wire;
+    double entry = 0.0;
+    double exit = 0.0;
+
+    /// Returns the fraction of the length of the segment within the cell of the wire.
+    double fraction() const { return exit - entry; }
+  };
+
+  /// The wires of a plane crossed by a segment, in the order they are crossed.
+  struct WireTraversal {
+    PlaneID plane;
+    bool crossesTPC = false; ///< Whether the segment crosses the active volume of the TPC.
+    double tpcEntry = 0.0;   ///< Parameter where the segment enters the active volume.
+    double tpcExit = 0.0;    ///< Parameter where the segment leaves the active volume.
+    std::vector<WireCrossing> wires;
+  };
+
+  /**
+   * @brief Returns the wires of `plane` crossed by `segment` in the active volume of `tpc`.
+   * @param tpc the TPC the plane belongs to
+   * @param plane the plane to project the segment on
+   * @param segment the segment to project
+   * @return the ordered wire crossings, and where the segment crosses the TPC
+   * @throw cet::exception (category: `WireTraversal`) if `plane` is not in `tpc`
+   *
+   * The segment is first clipped to the active volume of the TPC. The wire
+   * coordinate is linear along the segment, so the parameters where it crosses
+   * the borders between the cells of consecutive wires are computed directly,
+   * one wire after the other from the entry point (a DDA walk), without
+   * stepping along the segment. Only the wires of the plane are reported: the
+   * parts of the segment beyond the first or last wire are skipped.
+   *
+   * A segment parallel to the wires crosses a single cell; a segment of zero
+   * length in the active volume crosses the cell it lies in, with a null fraction.
+   */
+  WireTraversal TraverseWires(TPCGeo const& tpc, PlaneGeo const& plane, Segment const& segment);
+
+  /// Returns the traversal of each of the `segments` (see `TraverseWires()` above).
+  std::vector<WireTraversal> TraverseWires(TPCGeo const& tpc,
+                                           PlaneGeo const& plane,
+                                           std::span<Segment const> segments);
+
+} // namespace geo
+
+#endif // LARCORE_GEOMETRY_WIRETRAVERSAL_H
@@ -0,0 +1,112 @@
+/**
+ * @file   larcore/Geometry/gdml/assemble_gdml.cc
+ * @brief  Builds a GDML file (and optionally a prebuilt ROOT geometry) from fragments.
+ * @see    larcore/Geometry/GDMLAssembler.h
+ *
+ * This is a compiled replacement of `make_gdml.pl`, with the same options,
+ * and in addition:
+ *
+ * * `-r|--root <file.root>`: also converts the assembled GDML into a ROOT file
+ *   to be used as `PrebuiltROOT` in the `Geometry` service configuration
+ *   (requires `--output`);
+ * * `-d|--depfile <file.d>`: writes the list of files the output depends on,
+ *   as a Makefile rule usable as `DEPFILE` of a CMake custom command.
+ */
+
+// LArSoft libraries
+#include "larcore/Geometry/GDMLAssembler.h"
+#include "larcore/Geometry/PrebuiltGeometry.h"
+
+// framework libraries
+#include "cetlib_except/exception.h"
+
+// C/C++ standard libraries
+#include <cstdlib> // EXIT_SUCCESS, EXIT_FAILURE
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+  void printUsage(char const* program)
+  {
+    std::cout
+      << "Usage: " << program
+      << " [-h|--help] [-i|--input <xml-fragments-file>] [-o|--output <output-file>]"
+      << "\n         [-r|--root <output-ROOT-file>] [-d|--depfile <dependency-file>]"
+      << "\n       -i/--input can be omitted, giving the fragment list as first argument"
+      << "\n       if -o is omitted, output goes to STDOUT"
+      << "\n       -r also writes the geometry as prebuilt ROOT file (requires -o)"
+      << "\n       -d writes a Makefile rule with the dependencies of the output"
+      << "\n       -h prints this message, then quits" << std::endl;
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  std::string input, output, rootOutput, depFile;
+
+  for (int iArg = 1; iArg < argc; ++iArg) {
+    std::string const arg{argv[iArg]};
+    if ((arg == "-h") || (arg == "--help")) {
+      printUsage(argv[0]);
+      return EXIT_SUCCESS;
+    }
+    std::string* value = nullptr;
+    if ((arg == "-i") || (arg == "--input"))
+      value = &input;
+    else if ((arg == "-o") || (arg == "--output"))
+      value = &output;
+    else if ((arg == "-r") || (arg == "--root"))
+      value = &rootOutput;
+    else if ((arg == "-d") || (arg == "--depfile"))
+      value = &depFile;
+    else if (input.empty() && (arg.front() != '-')) {
+      input = arg;
+      continue;
+    }
+    if (!value || (++iArg == argc)) {
+      std::cerr << "Invalid command line argument: '" << arg << "'" << std::endl;
+      printUsage(argv[0]);
+      return EXIT_FAILURE;
+    }
+    *value = argv[iArg];
+  }
+
+  if (input.empty()) {
+    std::cerr << "No fragment list specified." << std::endl;
+    printUsage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  if (!rootOutput.empty() && output.empty()) {
+    std::cerr << "A ROOT output requires a GDML output file (-o)." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  try {
+    geo::GDMLAssembler const assembler{input};
+
+    if (output.empty())
+      std::cout << assembler.assemble();
+    else
+      assembler.writeGDML(output);
+
+    if (!rootOutput.empty()) geo::WritePrebuiltGeometry(output, rootOutput);
+
+    if (!depFile.empty()) {
+      std::vector<std::string> targets;
+      if (!output.empty()) targets.push_back(output);
+      if (!rootOutput.empty()) targets.push_back(rootOutput);
+      std::ofstream deps{depFile};
+      assembler.writeDependencies(deps, targets);
+    }
+  }
+  catch (cet::exception const& e) {
+    std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
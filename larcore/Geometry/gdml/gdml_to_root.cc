@@ -0,0 +1,59 @@
+/**
+ * @file   larcore/Geometry/gdml/gdml_to_root.cc
+ * @brief  Converts a GDML geometry into a ROOT file loadable by `geo::Geometry`.
+ * @see    larcore/Geometry/PrebuiltGeometry.h
+ *
+ * Usage:
+ *
+ *     gdml_to_root input.gdml output.root
+ *
+ * The output file can be used as `PrebuiltROOT` in the configuration of the
+ * `Geometry` service, together with the same `input.gdml` as `GDML` parameter.
+ */
+
+// LArSoft libraries
+#include "larcore/Geometry/PrebuiltGeometry.h"
+
+// framework libraries
+#include "cetlib_except/exception.h"
+
+// C/C++ standard libraries
+#include <cstdlib> // EXIT_SUCCESS, EXIT_FAILURE
+#include <iostream>
+#include <string>
+
+namespace {
+
+  void printUsage(char const* program)
+  {
+    std::cout << "Usage:  " << program << " input.gdml output.root"
+              << "\n\nConverts the geometry in the GDML file into a ROOT file,"
+              << "\nrecording the GDML checksum to detect stale conversions."
+              << std::endl;
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  if ((argc > 1) && ((std::string{argv[1]} == "-h") || (std::string{argv[1]} == "--help"))) {
+    printUsage(argv[0]);
+    return EXIT_SUCCESS;
+  }
+  if (argc != 3) {
+    printUsage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  try {
+    geo::PrebuiltGeometryInfo const info = geo::WritePrebuiltGeometry(argv[1], argv[2]);
+    std::cout << "Geometry from '" << info.gdmlSource << "' (checksum " << info.gdmlChecksum
+              << ") written into '" << argv[2] << "'." << std::endl;
+  }
+  catch (cet::exception const& e) {
+    std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
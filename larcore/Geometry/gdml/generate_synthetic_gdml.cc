@@ -0,0 +1,149 @@
+/**
+ * @file   larcore/Geometry/gdml/generate_synthetic_gdml.cc
+ * @brief  Writes the GDML file (and optionally the prebuilt ROOT file) of a synthetic detector.
+ * @see    larcore/Geometry/SyntheticGDML.h
+ *
+ * All sizes are in centimeters, angles in degrees. A summary of the detector
+ * (TPCs, planes, wires...) is printed on the standard output, or on the
+ * standard error if the GDML document is written on the standard output.
+ */
+
+// LArSoft libraries
+#include "larcore/Geometry/PrebuiltGeometry.h"
+#include "larcore/Geometry/SyntheticGDML.h"
+
+// framework libraries
+#include "cetlib_except/exception.h"
+
+// C/C++ standard libraries
+#include <cstdlib> // EXIT_SUCCESS, EXIT_FAILURE
+#include <iostream>
+#include <stdexcept> // std::logic_error
+#include <string>
+#include <type_traits> // std::is_floating_point_v
+
+namespace {
+
+  void printUsage(char const* program)
+  {
+    geo::SyntheticDetectorConfig const defaults;
+    std::cout
+      << "Usage: " << program << " [options]"
+      << "\n  -o, --output <file.gdml>  GDML output file (default: STDOUT)"
+      << "\n  -r, --root <file.root>    also writes the prebuilt ROOT geometry (requires -o)"
+      << "\n  --cryostats <N>           number of cryostats (default: " << defaults.nCryostats
+      << ")"
+      << "\n  --tpcs <N>                TPCs in each cryostat (default: "
+      << defaults.nTPCsPerCryostat << ")"
+      << "\n  --tpc-columns <N>         TPCs along x in each cryostat (default: "
+      << defaults.nTPCColumns << ")"
+      << "\n  --planes <N>              wire planes in each TPC (default: " << defaults.nPlanes
+      << ")"
+      << "\n  --pitch <cm>              wire pitch (default: " << defaults.wirePitch << ")"
+      << "\n  --angle <degrees>         induction wire angle from vertical (default: "
+      << defaults.wireAngle << ")"
+      << "\n  --opdets <N>              optical detectors in each cryostat (default: "
+      << defaults.nOpDetsPerCryostat << ")"
+      << "\n  --tpc-size <W> <H> <L>    TPC width (drift), height and length (default: "
+      << defaults.tpcWidth << " " << defaults.tpcHeight << " " << defaults.tpcLength << ")"
+      << "\n  --unique-tpcs             describes each TPC with its own volumes"
+      << "\n  -h, --help                prints this message, then quits" << std::endl;
+  }
+
+  // parses `value` as a number of type `T`, throwing std::logic_error on failure
+  template <typename T>
+  T parse(std::string const& value)
+  {
+    std::size_t end = 0;
+    double number = -1.0;
+    try {
+      number = std::is_floating_point_v<T> ? std::stod(value, &end) : std::stol(value, &end);
+    }
+    catch (std::logic_error const&) {
+    }
+    if ((end != value.length()) || (!std::is_floating_point_v<T> && (number < 0.0)))
+      throw std::invalid_argument{"'" + value + "' is not a valid value"};
+    return static_cast<T>(number);
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  geo::SyntheticDetectorConfig config;
+  std::string output, rootOutput;
+
+  int iArg = 1;
+  auto nextValue = [&]() -> std::string {
+    if (++iArg == argc)
+      throw std::invalid_argument{std::string{"missing value after "} + argv[iArg - 1]};
+    return argv[iArg];
+  };
+
+  try {
+    for (; iArg < argc; ++iArg) {
+      std::string const arg{argv[iArg]};
+      if ((arg == "-h") || (arg == "--help")) {
+        printUsage(argv[0]);
+        return EXIT_SUCCESS;
+      }
+      if ((arg == "-o") || (arg == "--output"))
+        output = nextValue();
+      else if ((arg == "-r") || (arg == "--root"))
+        rootOutput = nextValue();
+      else if (arg == "--cryostats")
+        config.nCryostats = parse<unsigned int>(nextValue());
+      else if (arg == "--tpcs")
+        config.nTPCsPerCryostat = parse<unsigned int>(nextValue());
+      else if (arg == "--tpc-columns")
+        config.nTPCColumns = parse<unsigned int>(nextValue());
+      else if (arg == "--planes")
+        config.nPlanes = parse<unsigned int>(nextValue());
+      else if (arg == "--pitch")
+        config.wirePitch = parse<double>(nextValue());
+      else if (arg == "--angle")
+        config.wireAngle = parse<double>(nextValue());
+      else if (arg == "--opdets")
+        config.nOpDetsPerCryostat = parse<unsigned int>(nextValue());
+      else if (arg == "--tpc-size") {
+        config.tpcWidth = parse<double>(nextValue());
+        config.tpcHeight = parse<double>(nextValue());
+        config.tpcLength = parse<double>(nextValue());
+      }
+      else if (arg == "--unique-tpcs")
+        config.uniqueTPCVolumes = true;
+      else
+        throw std::invalid_argument{"unknown option '" + arg + "'"};
+    }
+  }
+  catch (std::logic_error const& e) {
+    std::cerr << "Invalid command line: " << e.what() << std::endl;
+    printUsage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  if (!rootOutput.empty() && output.empty()) {
+    std::cerr << "A ROOT output requires a GDML output file (-o)." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  try {
+    geo::SyntheticDetectorStats const stats = output.empty() ?
+                                                geo::WriteSyntheticGDML(config, std::cout) :
+                                                geo::WriteSyntheticGDML(config, output);
+
+    if (!rootOutput.empty()) geo::WritePrebuiltGeometry(output, rootOutput);
+
+    (output.empty() ? std::cerr : std::cout)
+      << "Synthetic detector: " << stats.nCryostats << " cryostats, " << stats.nTPCs
+      << " TPCs, " << stats.nPlanes << " planes, " << stats.nWires << " wires ("
+      << stats.nWireVolumes << " wire volumes), " << stats.nOpDets << " optical detectors"
+      << std::endl;
+  }
+  catch (cet::exception const& e) {
+    std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,235 @@
+/**
+ * @file   ChannelAdjacencyTest_module.cc
+ * @brief  Checks the channel adjacency tables against brute-force geometry.
+ * @see    larcore/Geometry/ChannelAdjacency.h
+ */
+
+// LArSoft libraries
+#include "larcore/Geometry/ChannelAdjacency.h"
+#include "larcore/Geometry/WireReadout.h"
+#include "larcorealg/Geometry/PlaneGeo.h"
+#include "larcorealg/Geometry/WireGeo.h"
+#include "larcorealg/Geometry/WireReadoutGeom.h"
+#include "larcoreobj/SimpleTypesAndConstants/RawTypes.h"
+#include "larcoreobj/SimpleTypesAndConstants/geo_types.h"
+
+// framework libraries
+#include "art/Framework/Core/EDAnalyzer.h"
+#include "art/Framework/Core/ModuleMacros.h"
+#include "art/Framework/Services/Registry/ServiceHandle.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/types/Atom.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+// C/C++ standard libraries
+#include <algorithm> // std::is_sorted(), std::adjacent_find()
+#include <cmath>     // std::abs()
+#include <set>
+#include <span>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+namespace geo {
+  class ChannelAdjacencyTest;
+}
+/**
+ * @brief Compares the channel adjacency tables with brute-force geometry.
+ *
+ * The `geo::WireReadout` service must be configured to build the tables
+ * (e.g. `StandardWireReadout` with `ChannelAdjacency: true`). At the beginning
+ * of the job, the relations of each wire are computed looking at all the other
+ * wires:
+ *
+ * * neighbours: the wires before and after it in its plane;
+ * * crossing: the wires of the previous and next planes of its TPC whose
+ *   line, projected along the plane normal, meets it within both lengths;
+ *   pairs within *Tolerance* of the end of either wire are not checked;
+ * * continuations: the wires of the same view in the other TPCs of the
+ *   cryostat with an end closer than the continuation distance to one of its
+ *   ends.
+ *
+ * The lists of each channel, collected from all its wires, must be the ones
+ * in the tables, which must be sorted and without duplicates.
+ * The job fails at the first difference.
+ *
+ * Configuration parameters
+ * =========================
+ *
+ * * *Tolerance* (real, default: `0.001`): crossings within this distance of a
+ *   wire end are ambiguous and not checked [cm]
+ */
+class geo::ChannelAdjacencyTest : public art::EDAnalyzer {
+public:
+  struct Config {
+
+    fhicl::Atom<double> Tolerance{
+      fhicl::Name{"Tolerance"},
+      fhicl::Comment{"Crossings this close to a wire end [cm] are not checked"},
+      0.001};
+
+  }; // struct Config
+
+  using Parameters = art::EDAnalyzer::Table<Config>;
+
+  explicit ChannelAdjacencyTest(Parameters const& config);
+
+  void analyze(art::Event const&) override {}
+
+  void beginJob() override;
+
+private:
+  double const fTolerance;
+
+}; // class geo::ChannelAdjacencyTest
+
+// -----------------------------------------------------------------------------
+// ---  geo::ChannelAdjacencyTest implementation
+// -----------------------------------------------------------------------------
+namespace {
+
+  enum class Crossing { No, Yes, Ambiguous };
+
+  // whether the lines of the two wires, projected along their common normal, meet on both
+  Crossing wiresCross(geo::WireGeo const& a, geo::WireGeo const& b, double tolerance)
+  {
+    auto const u = a.Direction(), v = b.Direction();
+    double const cosine = u.Dot(v);
+    if (std::abs(cosine) > 1.0 - 1e-9) return Crossing::No; // parallel
+
+    // closest approach of the two lines: a.center + sA u, b.center + sB v
+    auto const w = a.GetCenter() - b.GetCenter();
+    double const denom = 1.0 - cosine * cosine;
+    double const sA = (cosine * v.Dot(w) - u.Dot(w)) / denom;
+    double const sB = (v.Dot(w) - cosine * u.Dot(w)) / denom;
+
+    double const marginA = a.HalfL() - std::abs(sA), marginB = b.HalfL() - std::abs(sB);
+    if ((marginA < -tolerance) || (marginB < -tolerance)) return Crossing::No;
+    if ((marginA < tolerance) || (marginB < tolerance)) return Crossing::Ambiguous;
+    return Crossing::Yes;
+  }
+
+  // the channels of a relation, collected from all the wires of each channel
+  struct Expected {
+    std::vector<std::set<raw::ChannelID_t>> sure;
+    std::vector<std::set<raw::ChannelID_t>> ambiguous;
+
+    explicit Expected(std::size_t nChannels) : sure(nChannels), ambiguous(nChannels) {}
+
+    void add(raw::ChannelID_t channel, raw::ChannelID_t other, bool isAmbiguous = false)
+    {
+      if ((channel == other) || (channel >= sure.size()) || (other >= sure.size())) return;
+      (isAmbiguous ? ambiguous : sure)[channel].insert(other);
+    }
+  };
+
+  void checkTable(std::string const& name,
+                  geo::ChannelAdjacency::Table const& table,
+                  Expected const& expected)
+  {
+    for (raw::ChannelID_t channel = 0; channel < expected.sure.size(); ++channel) {
+      std::span<raw::ChannelID_t const> const channels = table(channel);
+      if (!std::is_sorted(channels.begin(), channels.end()) ||
+          (std::adjacent_find(channels.begin(), channels.end()) != channels.end())) {
+        throw cet::exception("ChannelAdjacencyTest")
+          << name << " of channel " << channel << " are not sorted and unique.\n";
+      }
+      for (raw::ChannelID_t other : expected.sure[channel]) {
+        if (!std::binary_search(channels.begin(), channels.end(), other)) {
+          throw cet::exception("ChannelAdjacencyTest")
+            << name << " of channel " << channel << " miss channel " << other << ".\n";
+        }
+      }
+      for (raw::ChannelID_t other : channels) {
+        if ((expected.sure[channel].count(other) == 0) &&
+            (expected.ambiguous[channel].count(other) == 0)) {
+          throw cet::exception("ChannelAdjacencyTest")
+            << name << " of channel " << channel << " include channel " << other
+            << " unexpectedly.\n";
+        }
+      }
+    }
+  }
+
+} // local namespace
+
+// -----------------------------------------------------------------------------
+geo::ChannelAdjacencyTest::ChannelAdjacencyTest(Parameters const& config)
+  : art::EDAnalyzer{config}, fTolerance{config().Tolerance()}
+{}
+
+// -----------------------------------------------------------------------------
+void geo::ChannelAdjacencyTest::beginJob()
+{
+  geo::WireReadout const& wireReadout = *art::ServiceHandle<geo::WireReadout const>();
+  geo::WireReadoutGeom const& wireReadoutGeom = wireReadout.Get();
+  geo::ChannelAdjacency const* adjacency = wireReadout.Adjacency();
+  if (!adjacency) {
+    throw cet::exception("ChannelAdjacencyTest")
+      << "The WireReadout service does not provide channel adjacency tables"
+         " (set ChannelAdjacency).\n";
+  }
+
+  std::size_t const nChannels = wireReadoutGeom.Nchannels();
+  std::vector<geo::PlaneGeo const*> planes;
+  for (geo::PlaneGeo const& plane : wireReadoutGeom.Iterate<geo::PlaneGeo>())
+    planes.push_back(&plane);
+  auto channelOf = [&wireReadoutGeom](geo::PlaneGeo const& plane, unsigned int wire) {
+    return wireReadoutGeom.PlaneWireToChannel(geo::WireID{plane.ID(), wire});
+  };
+
+  Expected neighbours{nChannels}, crossing{nChannels}, continuations{nChannels};
+  double const continuationDistance = adjacency->ContinuationDistance();
+  for (geo::PlaneGeo const* planeA : planes) {
+    for (unsigned int wa = 0; wa < planeA->Nwires(); ++wa) {
+      raw::ChannelID_t const channel = channelOf(*planeA, wa);
+      geo::WireGeo const& wireA = planeA->Wire(wa);
+      if (wa > 0) neighbours.add(channel, channelOf(*planeA, wa - 1));
+      if (wa + 1 < planeA->Nwires()) neighbours.add(channel, channelOf(*planeA, wa + 1));
+
+      for (geo::PlaneGeo const* planeB : planes) {
+        geo::PlaneID const& idA = planeA->ID();
+        geo::PlaneID const& idB = planeB->ID();
+        bool const adjacent = (idA.asTPCID() == idB.asTPCID()) &&
+                              ((idA.Plane + 1 == idB.Plane) || (idB.Plane + 1 == idA.Plane));
+        bool const continuing = (idA.asCryostatID() == idB.asCryostatID()) &&
+                                (idA.asTPCID() != idB.asTPCID()) &&
+                                (planeA->View() == planeB->View());
+        if (!adjacent && !continuing) continue;
+
+        for (unsigned int wb = 0; wb < planeB->Nwires(); ++wb) {
+          geo::WireGeo const& wireB = planeB->Wire(wb);
+          if (adjacent) {
+            Crossing const crosses = wiresCross(wireA, wireB, fTolerance);
+            if (crosses != Crossing::No)
+              crossing.add(channel, channelOf(*planeB, wb), crosses == Crossing::Ambiguous);
+          }
+          if (continuing) {
+            for (geo::Point_t const& endA : {wireA.GetStart(), wireA.GetEnd()}) {
+              for (geo::Point_t const& endB : {wireB.GetStart(), wireB.GetEnd()}) {
+                double const distance = (endA - endB).R();
+                if (std::abs(distance - continuationDistance) < fTolerance)
+                  continuations.add(channel, channelOf(*planeB, wb), true);
+                else if (distance < continuationDistance)
+                  continuations.add(channel, channelOf(*planeB, wb));
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  checkTable("Neighbours", adjacency->NeighbourTable(), neighbours);
+  checkTable("Crossing channels", adjacency->CrossingTable(), crossing);
+  checkTable("Continuations", adjacency->ContinuationTable(), continuations);
+
+  mf::LogInfo("ChannelAdjacencyTest")
+    << nChannels << " channels checked: " << adjacency->NeighbourTable().NEntries()
+    << " neighbours, " << adjacency->CrossingTable().NEntries() << " crossing, "
+    << adjacency->ContinuationTable().NEntries() << " continuations; "
+    << (adjacency->MemoryUsage() / 1024) << " KiB";
+}
+
+// -----------------------------------------------------------------------------
+DEFINE_ART_MODULE(geo::ChannelAdjacencyTest)
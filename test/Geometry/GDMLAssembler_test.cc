@@ -0,0 +1,151 @@
+/**
+ * @file   GDMLAssembler_test.cc
+ * @brief  Cross-checks a GDML file from `assemble_gdml` against `make_gdml.pl`.
+ * @see    larcore/Geometry/GDMLAssembler.h
+ *
+ * The ROOT geometries imported from the two GDML files must have the same
+ * materials, and the same volumes, shapes and placements.
+ *
+ * Usage: `GDMLAssembler_test -- <assembled GDML> <make_gdml.pl GDML>`
+ */
+
+#define BOOST_TEST_MODULE (GDMLAssembler_test)
+
+// ROOT libraries
+#include "TGeoBBox.h"
+#include "TGeoManager.h"
+#include "TGeoMaterial.h"
+#include "TGeoMatrix.h"
+#include "TGeoNode.h"
+#include "TGeoVolume.h"
+#include "TList.h"
+
+// Boost libraries
+#include <boost/test/unit_test.hpp>
+
+// C/C++ standard libraries
+#include <algorithm> // std::copy_n()
+#include <array>
+#include <string>
+#include <utility> // std::move()
+#include <vector>
+
+namespace {
+
+  /// Summary of a node of the geometry, in world coordinates.
+  struct NodeInfo {
+    unsigned int depth;
+    std::string volume;
+    std::string material;
+    std::string shape;
+    double capacity;
+    std::array<double, 3> halfSizes;
+    std::array<double, 3> translation;
+    std::array<double, 9> rotation;
+  };
+
+  /// Summary of a material.
+  struct MaterialInfo {
+    std::string name;
+    double density;
+    double A;
+    double Z;
+  };
+
+  /// Summary of a whole geometry.
+  struct GeometryInfo {
+    std::vector<MaterialInfo> materials;
+    std::vector<NodeInfo> nodes;
+  };
+
+  void collectNodes(TGeoNode const& node,
+                    TGeoHMatrix const& motherToWorld,
+                    unsigned int depth,
+                    std::vector<NodeInfo>& nodes)
+  {
+    TGeoHMatrix toWorld{motherToWorld};
+    toWorld.Multiply(node.GetMatrix());
+
+    TGeoVolume const& volume = *node.GetVolume();
+    auto const& shape = dynamic_cast<TGeoBBox const&>(*volume.GetShape());
+    NodeInfo info{depth,
+                  volume.GetName(),
+                  volume.GetMaterial()->GetName(),
+                  shape.ClassName(),
+                  shape.Capacity(),
+                  {shape.GetDX(), shape.GetDY(), shape.GetDZ()},
+                  {},
+                  {}};
+    std::copy_n(toWorld.GetTranslation(), 3, info.translation.begin());
+    std::copy_n(toWorld.GetRotationMatrix(), 9, info.rotation.begin());
+    nodes.push_back(std::move(info));
+
+    for (int iDaughter = 0; iDaughter < node.GetNdaughters(); ++iDaughter)
+      collectNodes(*node.GetDaughter(iDaughter), toWorld, depth + 1, nodes);
+  }
+
+  GeometryInfo importGDML(std::string const& path)
+  {
+    TGeoManager::LockDefaultUnits(false);
+    TGeoManager::SetDefaultUnits(TGeoManager::kRootUnits);
+    TGeoManager::LockDefaultUnits(true);
+    TGeoManager::Import(path.c_str());
+    BOOST_TEST_REQUIRE(gGeoManager);
+
+    GeometryInfo info;
+    for (TObject const* obj : *gGeoManager->GetListOfMaterials()) {
+      auto const& material = dynamic_cast<TGeoMaterial const&>(*obj);
+      info.materials.push_back(
+        {material.GetName(), material.GetDensity(), material.GetA(), material.GetZ()});
+    }
+    collectNodes(*gGeoManager->GetTopNode(), TGeoHMatrix{}, 0U, info.nodes);
+    delete gGeoManager;
+    return info;
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(AssembledVsMakeGDML_test)
+{
+  auto const& suite = boost::unit_test::framework::master_test_suite();
+  BOOST_TEST_REQUIRE(suite.argc == 3);
+
+  GeometryInfo const actual = importGDML(suite.argv[1]);
+  GeometryInfo const expected = importGDML(suite.argv[2]);
+
+  double const tol = 1e-6; // cm, and relative for the other quantities
+
+  BOOST_TEST_REQUIRE(actual.materials.size() == expected.materials.size());
+  for (std::size_t i = 0; i < expected.materials.size(); ++i) {
+    BOOST_TEST_CONTEXT("material #" << i << " (" << expected.materials[i].name << ")")
+    {
+      BOOST_TEST(actual.materials[i].name == expected.materials[i].name);
+      BOOST_TEST(actual.materials[i].density == expected.materials[i].density,
+                 boost::test_tools::tolerance(tol));
+      BOOST_TEST(actual.materials[i].A == expected.materials[i].A,
+                 boost::test_tools::tolerance(tol));
+      BOOST_TEST(actual.materials[i].Z == expected.materials[i].Z,
+                 boost::test_tools::tolerance(tol));
+    }
+  }
+
+  BOOST_TEST_REQUIRE(actual.nodes.size() == expected.nodes.size());
+  for (std::size_t i = 0; i < expected.nodes.size(); ++i) {
+    BOOST_TEST_CONTEXT("node #" << i << " (" << expected.nodes[i].volume << ")")
+    {
+      BOOST_TEST(actual.nodes[i].depth == expected.nodes[i].depth);
+      BOOST_TEST(actual.nodes[i].volume == expected.nodes[i].volume);
+      BOOST_TEST(actual.nodes[i].material == expected.nodes[i].material);
+      BOOST_TEST(actual.nodes[i].shape == expected.nodes[i].shape);
+      BOOST_TEST(actual.nodes[i].capacity == expected.nodes[i].capacity,
+                 boost::test_tools::tolerance(tol));
+      for (std::size_t k = 0; k < 3; ++k) {
+        BOOST_CHECK_SMALL(actual.nodes[i].halfSizes[k] - expected.nodes[i].halfSizes[k], tol);
+        BOOST_CHECK_SMALL(actual.nodes[i].translation[k] - expected.nodes[i].translation[k], tol);
+      }
+      for (std::size_t k = 0; k < 9; ++k)
+        BOOST_CHECK_SMALL(actual.nodes[i].rotation[k] - expected.nodes[i].rotation[k], tol);
+    }
+  }
+}
@@ -0,0 +1,128 @@
+/**
+ * @file   GeometryBuilderParametric_test.cc
+ * @brief  Cross-checks the parametric "voltpc" geometry against `voltpc.gdml`.
+ * @see    larcore/Geometry/GeometryBuilderParametric.h
+ *
+ * The ROOT geometry built from the parameters in `test_voltpc_parametric.fcl`
+ * must have the same volumes, shapes, materials and placements as the one
+ * imported from the GDML file written by `generate_voltpc.pl`.
+ *
+ * This test takes no command line argument.
+ */
+
+#define BOOST_TEST_MODULE (GeometryBuilderParametric_test)
+
+// LArSoft libraries
+#include "larcore/Geometry/GeometryBuilderParametric.h"
+
+// framework libraries
+#include "cetlib/filepath_maker.h"
+#include "cetlib/search_path.h"
+#include "fhiclcpp/ParameterSet.h"
+
+// ROOT libraries
+#include "TGeoBBox.h"
+#include "TGeoManager.h"
+#include "TGeoMaterial.h"
+#include "TGeoMatrix.h"
+#include "TGeoNode.h"
+#include "TGeoVolume.h"
+
+// Boost libraries
+#include <boost/test/unit_test.hpp>
+
+// C/C++ standard libraries
+#include <algorithm> // std::copy_n()
+#include <array>
+#include <string>
+#include <utility> // std::move()
+#include <vector>
+
+namespace {
+
+  /// Summary of a node of the geometry, in world coordinates.
+  struct NodeInfo {
+    unsigned int depth;
+    std::string volume;
+    std::string material;
+    std::array<double, 3> halfSizes;
+    double density;
+    std::array<double, 3> translation;
+    std::array<double, 9> rotation;
+  };
+
+  void collectNodes(TGeoNode const& node,
+                    TGeoHMatrix const& motherToWorld,
+                    unsigned int depth,
+                    std::vector<NodeInfo>& nodes)
+  {
+    TGeoHMatrix toWorld{motherToWorld};
+    toWorld.Multiply(node.GetMatrix());
+
+    TGeoVolume const& volume = *node.GetVolume();
+    auto const& shape = dynamic_cast<TGeoBBox const&>(*volume.GetShape());
+    NodeInfo info{depth,
+                  volume.GetName(),
+                  volume.GetMaterial()->GetName(),
+                  {shape.GetDX(), shape.GetDY(), shape.GetDZ()},
+                  volume.GetMaterial()->GetDensity(),
+                  {},
+                  {}};
+    std::copy_n(toWorld.GetTranslation(), 3, info.translation.begin());
+    std::copy_n(toWorld.GetRotationMatrix(), 9, info.rotation.begin());
+    nodes.push_back(std::move(info));
+
+    for (int iDaughter = 0; iDaughter < node.GetNdaughters(); ++iDaughter)
+      collectNodes(*node.GetDaughter(iDaughter), toWorld, depth + 1, nodes);
+  }
+
+  std::vector<NodeInfo> collectNodes(TGeoManager const& manager)
+  {
+    std::vector<NodeInfo> nodes;
+    collectNodes(*manager.GetTopNode(), TGeoHMatrix{}, 0U, nodes);
+    return nodes;
+  }
+
+  std::vector<NodeInfo> importGDML(std::string const& path)
+  {
+    TGeoManager::LockDefaultUnits(false);
+    TGeoManager::SetDefaultUnits(TGeoManager::kRootUnits);
+    TGeoManager::LockDefaultUnits(true);
+    TGeoManager::Import(path.c_str());
+    BOOST_TEST_REQUIRE(gGeoManager);
+    auto nodes = collectNodes(*gGeoManager);
+    delete gGeoManager;
+    return nodes;
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(VolTPCParametricVsGDML_test)
+{
+  cet::filepath_lookup policy{"FHICL_FILE_PATH"};
+  auto const config = fhicl::ParameterSet::make("test_voltpc_parametric.fcl", policy);
+
+  std::vector<NodeInfo> const expected = importGDML(
+    cet::search_path{"FW_SEARCH_PATH"}.find_file(config.get<std::string>("gdml")));
+  std::vector<NodeInfo> const actual =
+    collectNodes(*geo::BuildParametricGeometry(config.get<fhicl::ParameterSet>("builder")));
+
+  double const tol = 1e-6; // cm, and relative for density
+  BOOST_TEST_REQUIRE(actual.size() == expected.size());
+  for (std::size_t i = 0; i < expected.size(); ++i) {
+    BOOST_TEST_CONTEXT("node #" << i << " (" << expected[i].volume << ")")
+    {
+      BOOST_TEST(actual[i].depth == expected[i].depth);
+      BOOST_TEST(actual[i].volume == expected[i].volume);
+      BOOST_TEST(actual[i].material == expected[i].material);
+      BOOST_TEST(actual[i].density == expected[i].density, boost::test_tools::tolerance(tol));
+      for (std::size_t k = 0; k < 3; ++k) {
+        BOOST_CHECK_SMALL(actual[i].halfSizes[k] - expected[i].halfSizes[k], tol);
+        BOOST_CHECK_SMALL(actual[i].translation[k] - expected[i].translation[k], tol);
+      }
+      for (std::size_t k = 0; k < 9; ++k)
+        BOOST_CHECK_SMALL(actual[i].rotation[k] - expected[i].rotation[k], tol);
+    }
+  }
+}
@@ -0,0 +1,74 @@
+/**
+ * @file   GeometryCache_test.cc
+ * @brief  Tests the least-recently-used policy of `geo::GeometryCache`.
+ * @see    larcore/Geometry/GeometryCache.h
+ *
+ * The cached geometries are empty: only the bookkeeping is tested here.
+ * This test takes no command line argument.
+ */
+
+#define BOOST_TEST_MODULE (GeometryCache_test)
+
+// LArSoft libraries
+#include "larcore/Geometry/GeometryCache.h"
+
+// Boost libraries
+#include <boost/test/unit_test.hpp>
+
+// C/C++ standard libraries
+#include <memory> // std::make_unique()
+#include <string>
+#include <vector>
+
+namespace {
+
+  /// Builder recording which geometries it was asked for.
+  struct FakeBuilder {
+    std::vector<std::string>* built;
+
+    std::unique_ptr<geo::BuiltGeometry> operator()(std::string const& name) const
+    {
+      built->push_back(name);
+      return std::make_unique<geo::BuiltGeometry>();
+    }
+  };
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(LeastRecentlyUsedEviction_test)
+{
+  std::vector<std::string> built;
+  geo::GeometryCache cache{2, FakeBuilder{&built}};
+  BOOST_TEST(cache.capacity() == 2U);
+
+  auto const a = cache.get("a");
+  BOOST_TEST(a->name == "a");
+  cache.get("b");
+  BOOST_TEST(cache.get("a") == a); // hit: "a" becomes the most recent
+  cache.get("c");                  // evicts "b"
+
+  BOOST_TEST(cache.names() == (std::vector<std::string>{"c", "a"}));
+  BOOST_TEST(!cache.contains("b"));
+  BOOST_TEST(cache.get("a") == a);
+  cache.get("b"); // rebuilt, evicts "c"
+
+  BOOST_TEST(built == (std::vector<std::string>{"a", "b", "c", "b"}));
+  BOOST_TEST(cache.size() == 2U);
+  BOOST_TEST(cache.hits() == 2U);
+  BOOST_TEST(cache.misses() == 4U);
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(EvictedEntryStaysAlive_test)
+{
+  std::vector<std::string> built;
+  geo::GeometryCache cache{0, FakeBuilder{&built}}; // capacity is raised to 1
+  BOOST_TEST(cache.capacity() == 1U);
+
+  auto const a = cache.get("a");
+  cache.get("b");
+  BOOST_TEST(!cache.contains("a"));
+  BOOST_TEST(a.use_count() == 1L); // only our copy is left
+  BOOST_TEST(a->name == "a");
+}
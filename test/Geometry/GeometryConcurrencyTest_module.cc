@@ -0,0 +1,271 @@
+/**
+ * @file   GeometryConcurrencyTest_module.cc
+ * @brief  Queries the geometry services concurrently from all the schedules.
+ * @see    test_geometry_concurrency.fcl
+ */
+
+// LArSoft libraries
+#include "larcore/Geometry/AuxDetGeometry.h"
+#include "larcore/Geometry/Geometry.h"
+#include "larcore/Geometry/WireReadout.h"
+#include "larcorealg/Geometry/AuxDetGeometryCore.h"
+#include "larcorealg/Geometry/TPCGeo.h"
+#include "larcoreobj/SimpleTypesAndConstants/RawTypes.h"
+#include "larcoreobj/SimpleTypesAndConstants/geo_types.h"
+
+// framework libraries
+#include "art/Framework/Core/ModuleMacros.h"
+#include "art/Framework/Core/SharedAnalyzer.h"
+#include "art/Framework/Principal/Event.h"
+#include "art/Framework/Services/Registry/ServiceHandle.h"
+#include "art/Utilities/Globals.h"
+#include "canvas/Persistency/Provenance/EventID.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/types/Atom.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+// C/C++ standard libraries
+#include <algorithm> // std::min(), std::max()
+#include <atomic>
+#include <chrono>
+#include <cstdint> // std::uint64_t
+#include <functional> // std::hash
+#include <limits>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+
+// -----------------------------------------------------------------------------
+namespace geo {
+  class GeometryConcurrencyTest;
+}
+/**
+ * @brief Stresses the geometry services from concurrent events.
+ *
+ * Each event performs a fixed number of queries at random points, seeded by
+ * the event number, inside the box containing all the TPCs:
+ *
+ * * volume name and TPC and cryostat containing the point (`geo::Geometry`);
+ * * TPC containing each point of a straight track between two random points,
+ *   found with the hinted query and checked against the full search;
+ * * nearest wire on the first plane of the TPC, its channel and the wires of
+ *   that channel (`geo::WireReadout`);
+ * * auxiliary detector at the center of a random auxiliary detector
+ *   (`geo::AuxDetGeometry`), if any.
+ *
+ * The results of each event are summarized in a digest. At the end of the job,
+ * the queries of all events are repeated in a single thread, and the job fails
+ * if any digest differs. The throughput of the whole job (queries per second,
+ * from the start of the first event to the end of the last one) is printed
+ * together with the number of schedules and threads.
+ *
+ * Configuration parameters
+ * =========================
+ *
+ * * *QueriesPerEvent* (integer, default: `1000`): random points per event
+ */
+class geo::GeometryConcurrencyTest : public art::SharedAnalyzer {
+public:
+  struct Config {
+
+    fhicl::Atom<unsigned int> QueriesPerEvent{fhicl::Name{"QueriesPerEvent"},
+                                              fhicl::Comment{"Random points per event"},
+                                              1000U};
+
+  }; // struct Config
+
+  using Parameters = art::SharedAnalyzer::Table<Config>;
+
+  GeometryConcurrencyTest(Parameters const& config, art::ProcessingFrame const&);
+
+  void analyze(art::Event const& event, art::ProcessingFrame const&) override;
+
+  void endJob(art::ProcessingFrame const&) override;
+
+private:
+  using Clock_t = std::chrono::steady_clock;
+
+  unsigned int const fQueriesPerEvent;
+
+  geo::Geometry const* fGeom;
+  geo::WireReadout const* fWireReadout; ///< Service, so that its queries are probed.
+  geo::AuxDetGeometryCore const* fAuxDetGeom;
+
+  geo::Point_t fMin, fMax; ///< Corners of the box containing all TPCs.
+
+  std::map<art::EventID, std::uint64_t> fDigests; ///< Results of each event.
+  std::mutex fDigestMutex;                        ///< Protects `fDigests`.
+
+  std::atomic<Clock_t::rep> fFirstStart{std::numeric_limits<Clock_t::rep>::max()};
+  std::atomic<Clock_t::rep> fLastEnd{std::numeric_limits<Clock_t::rep>::min()};
+
+  /// Performs all the queries for `event`, and returns their digest.
+  std::uint64_t runQueries(art::EventID const& event) const;
+
+}; // class geo::GeometryConcurrencyTest
+
+// -----------------------------------------------------------------------------
+// ---  geo::GeometryConcurrencyTest implementation
+// -----------------------------------------------------------------------------
+namespace {
+
+  // combines `value` into `digest` (FNV-1a style)
+  void mix(std::uint64_t& digest, std::uint64_t value)
+  {
+    digest ^= value;
+    digest *= 0x100000001b3ULL;
+  }
+
+  template <typename T>
+  void updateMin(std::atomic<T>& target, T value)
+  {
+    T current = target.load();
+    while (value < current && !target.compare_exchange_weak(current, value)) {}
+  }
+
+  template <typename T>
+  void updateMax(std::atomic<T>& target, T value)
+  {
+    T current = target.load();
+    while (value > current && !target.compare_exchange_weak(current, value)) {}
+  }
+
+} // local namespace
+
+// -----------------------------------------------------------------------------
+geo::GeometryConcurrencyTest::GeometryConcurrencyTest(Parameters const& config,
+                                                      art::ProcessingFrame const&)
+  : art::SharedAnalyzer{config}
+  , fQueriesPerEvent{config().QueriesPerEvent()}
+  , fGeom{art::ServiceHandle<geo::Geometry const>{}.get()}
+  , fWireReadout{art::ServiceHandle<geo::WireReadout const>{}.get()}
+  , fAuxDetGeom{art::ServiceHandle<geo::AuxDetGeometry const>{}->GetProviderPtr()}
+{
+  async<art::InEvent>();
+
+  double const inf = std::numeric_limits<double>::max();
+  double min[3] = {inf, inf, inf}, max[3] = {-inf, -inf, -inf};
+  for (geo::TPCGeo const& tpc : fGeom->Iterate<geo::TPCGeo>()) {
+    auto const& box = tpc.BoundingBox();
+    min[0] = std::min(min[0], box.MinX());
+    min[1] = std::min(min[1], box.MinY());
+    min[2] = std::min(min[2], box.MinZ());
+    max[0] = std::max(max[0], box.MaxX());
+    max[1] = std::max(max[1], box.MaxY());
+    max[2] = std::max(max[2], box.MaxZ());
+  }
+  fMin = {min[0], min[1], min[2]};
+  fMax = {max[0], max[1], max[2]};
+}
+
+// -----------------------------------------------------------------------------
+void geo::GeometryConcurrencyTest::analyze(art::Event const& event, art::ProcessingFrame const&)
+{
+  auto const start = Clock_t::now().time_since_epoch().count();
+  std::uint64_t const digest = runQueries(event.id());
+  auto const end = Clock_t::now().time_since_epoch().count();
+
+  updateMin(fFirstStart, start);
+  updateMax(fLastEnd, end);
+
+  std::lock_guard const lock{fDigestMutex};
+  fDigests[event.id()] = digest;
+}
+
+// -----------------------------------------------------------------------------
+void geo::GeometryConcurrencyTest::endJob(art::ProcessingFrame const&)
+{
+  double const elapsed =
+    std::chrono::duration<double>(Clock_t::duration{fLastEnd - fFirstStart}).count();
+  art::Globals const& globals = *art::Globals::instance();
+  mf::LogInfo("GeometryConcurrencyTest")
+    << "Schedules: " << globals.nschedules() << ", threads: " << globals.nthreads() << ", events: "
+    << fDigests.size() << ", throughput: " << (fDigests.size() * fQueriesPerEvent / elapsed)
+    << " queries/s";
+
+  geo::GeometryCursor::Stats const hints = fGeom->hintStatistics();
+  mf::LogInfo("GeometryConcurrencyTest")
+    << "Hinted TPC queries: " << hints.hits << " hits, " << hints.misses << " misses ("
+    << (100.0 * hints.hitRate()) << "% hit rate)";
+
+  // single-threaded reference
+  unsigned int nMismatches = 0;
+  for (auto const& [id, digest] : fDigests) {
+    if (runQueries(id) == digest) continue;
+    mf::LogError("GeometryConcurrencyTest") << "Results for " << id << " differ from reference.";
+    ++nMismatches;
+  }
+  if (nMismatches > 0) {
+    throw cet::exception("GeometryConcurrencyTest")
+      << nMismatches << "/" << fDigests.size()
+      << " events have results different from the single-thread reference.\n";
+  }
+}
+
+// -----------------------------------------------------------------------------
+std::uint64_t geo::GeometryConcurrencyTest::runQueries(art::EventID const& event) const
+{
+  std::mt19937_64 engine{(std::uint64_t{event.run()} << 32) | event.event()};
+  std::uniform_real_distribution<double> x{fMin.X(), fMax.X()}, y{fMin.Y(), fMax.Y()},
+    z{fMin.Z(), fMax.Z()};
+  std::hash<std::string> const hashString;
+
+  std::uint64_t digest = 0xcbf29ce484222325ULL;
+  for (unsigned int iQuery = 0; iQuery < fQueriesPerEvent; ++iQuery) {
+    geo::Point_t const point{x(engine), y(engine), z(engine)};
+
+    // geometry
+    mix(digest, hashString(fGeom->VolumeName(point)));
+    geo::CryostatID const cryoID = fGeom->PositionToCryostatID(point);
+    mix(digest, cryoID.isValid ? cryoID.Cryostat : 0xFFFF);
+    geo::TPCID const tpcID = fGeom->FindTPCAtPosition(point);
+    if (!tpcID.isValid) continue;
+    mix(digest, (std::uint64_t{tpcID.Cryostat} << 16) | tpcID.TPC);
+
+    // wire readout
+    geo::WireID wireID;
+    try {
+      wireID = fWireReadout->NearestWireID(point, geo::PlaneID{tpcID, 0});
+    }
+    catch (cet::exception const&) {
+      mix(digest, 0xFFFFFFFF);
+      continue;
+    }
+    mix(digest, wireID.Wire);
+    raw::ChannelID_t const channel = fWireReadout->PlaneWireToChannel(wireID);
+    mix(digest, channel);
+    mix(digest, fWireReadout->ChannelToWire(channel).size());
+  }
+
+  // hinted TPC queries along a track
+  geo::Point_t const start{x(engine), y(engine), z(engine)};
+  geo::Vector_t const step = (geo::Point_t{x(engine), y(engine), z(engine)} - start) /
+                             std::max(fQueriesPerEvent, 1U);
+  for (unsigned int iStep = 0; iStep < fQueriesPerEvent; ++iStep) {
+    geo::Point_t const point = start + iStep * step;
+    geo::TPCID const tpcID = fGeom->FindTPCAtPositionHinted(point);
+    if (tpcID != fGeom->FindTPCAtPosition(point)) {
+      throw cet::exception("GeometryConcurrencyTest")
+        << "Hinted query found " << tpcID << " at " << point << ", full search "
+        << fGeom->FindTPCAtPosition(point) << ".\n";
+    }
+    mix(digest, tpcID.isValid ? ((std::uint64_t{tpcID.Cryostat} << 16) | tpcID.TPC) : 0xFFFF);
+  }
+
+  // auxiliary detectors
+  if (std::size_t const nAuxDets = fAuxDetGeom->NAuxDets(); nAuxDets > 0) {
+    std::uniform_int_distribution<std::size_t> pickAuxDet{0, nAuxDets - 1};
+    for (unsigned int iQuery = 0; iQuery < fQueriesPerEvent; ++iQuery) {
+      std::size_t const iAuxDet = pickAuxDet(engine);
+      mix(digest, fAuxDetGeom->FindAuxDetAtPosition(fAuxDetGeom->AuxDet(iAuxDet).GetCenter()));
+    }
+  }
+
+  return digest;
+}
+
+// -----------------------------------------------------------------------------
+DEFINE_ART_MODULE(geo::GeometryConcurrencyTest)
+
+// -----------------------------------------------------------------------------
@@ -0,0 +1,191 @@
+/**
+ * @file   GeometryIDRangesTest_module.cc
+ * @brief  Checks the splittable ID ranges against the sequential ID iterators.
+ * @see    larcore/Geometry/GeometryIDRanges.h
+ */
+
+// LArSoft libraries
+#include "larcore/Geometry/Geometry.h"
+#include "larcore/Geometry/GeometryIDRanges.h"
+#include "larcore/Geometry/WireReadout.h"
+#include "larcorealg/Geometry/WireReadoutGeom.h"
+#include "larcoreobj/SimpleTypesAndConstants/RawTypes.h"
+#include "larcoreobj/SimpleTypesAndConstants/geo_types.h"
+
+// framework libraries
+#include "art/Framework/Core/EDAnalyzer.h"
+#include "art/Framework/Core/ModuleMacros.h"
+#include "art/Framework/Services/Registry/ServiceHandle.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/types/Atom.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+// TBB libraries
+#include "tbb/parallel_for.h"
+
+// C/C++ standard libraries
+#include <algorithm> // std::transform()
+#include <atomic>
+#include <execution>
+#include <iterator> // std::next()
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+namespace geo {
+  class GeometryIDRangesTest;
+}
+/**
+ * @brief Compares the ID ranges for parallel loops with the ID iterators.
+ *
+ * At the beginning of the job, the ranges of cryostats and TPCs of
+ * `geo::Geometry` and of planes, wires and channels of `geo::WireReadout`
+ * are checked against `Iterate<ID>()` (against all the numbers up to
+ * `Nchannels()` for channels):
+ *
+ * * as sequential ranges and with random access (`range[i]`, `begin() + i`);
+ * * visited by `tbb::parallel_for()`, which must visit each ID exactly once;
+ * * copied by `std::transform()` with the parallel execution policy.
+ *
+ * The job fails at the first difference.
+ *
+ * Configuration parameters
+ * =========================
+ *
+ * * *GrainSize* (integer, default: `16`): smallest range `tbb::parallel_for()`
+ *   is allowed to run on a single thread
+ */
+class geo::GeometryIDRangesTest : public art::EDAnalyzer {
+public:
+  struct Config {
+
+    fhicl::Atom<unsigned int> GrainSize{
+      fhicl::Name{"GrainSize"},
+      fhicl::Comment{"Smallest range tbb::parallel_for() runs on a single thread"},
+      16U};
+
+  }; // struct Config
+
+  using Parameters = art::EDAnalyzer::Table<Config>;
+
+  explicit GeometryIDRangesTest(Parameters const& config);
+
+  void analyze(art::Event const&) override {}
+
+  void beginJob() override;
+
+private:
+  unsigned int const fGrainSize;
+
+  /// Checks `range` against the IDs in `expected`.
+  template <typename Range, typename ID>
+  void checkRange(std::string const& name, Range const& range, std::vector<ID> const& expected)
+    const;
+
+}; // class geo::GeometryIDRangesTest
+
+// -----------------------------------------------------------------------------
+// ---  geo::GeometryIDRangesTest implementation
+// -----------------------------------------------------------------------------
+namespace {
+
+  template <typename ID, typename Geometry>
+  std::vector<ID> iterateIDs(Geometry const& geom)
+  {
+    std::vector<ID> IDs;
+    for (ID const& id : geom.template Iterate<ID>())
+      IDs.push_back(id);
+    return IDs;
+  }
+
+} // local namespace
+
+// -----------------------------------------------------------------------------
+geo::GeometryIDRangesTest::GeometryIDRangesTest(Parameters const& config)
+  : art::EDAnalyzer{config}, fGrainSize{config().GrainSize()}
+{}
+
+// -----------------------------------------------------------------------------
+void geo::GeometryIDRangesTest::beginJob()
+{
+  geo::Geometry const& geom = *art::ServiceHandle<geo::Geometry const>();
+  geo::WireReadout const& wireReadout = *art::ServiceHandle<geo::WireReadout const>();
+  geo::WireReadoutGeom const& wireReadoutGeom = wireReadout.Get();
+
+  checkRange("cryostats", geom.CryostatIDs(fGrainSize), iterateIDs<geo::CryostatID>(geom));
+  checkRange("TPCs", geom.TPCIDs(fGrainSize), iterateIDs<geo::TPCID>(geom));
+  geo::ReadoutIDTables const tables{wireReadoutGeom};
+  checkRange("planes",
+             geo::IDRange{tables.planes(), fGrainSize},
+             iterateIDs<geo::PlaneID>(wireReadoutGeom));
+  checkRange(
+    "wires", geo::IDRange{tables.wires(), fGrainSize}, iterateIDs<geo::WireID>(wireReadoutGeom));
+
+  std::vector<raw::ChannelID_t> channels;
+  for (raw::ChannelID_t channel = 0; channel < wireReadoutGeom.Nchannels(); ++channel)
+    channels.push_back(channel);
+  checkRange("channels", geo::IDRange{tables.channels(), fGrainSize}, channels);
+}
+
+// -----------------------------------------------------------------------------
+template <typename Range, typename ID>
+void geo::GeometryIDRangesTest::checkRange(std::string const& name,
+                                           Range const& range,
+                                           std::vector<ID> const& expected) const
+{
+  auto fail = [&name]() -> cet::exception {
+    return cet::exception("GeometryIDRangesTest") << "Range of " << name << ": ";
+  };
+
+  if (range.size() != expected.size()) {
+    throw fail() << range.size() << " IDs, " << expected.size() << " expected.\n";
+  }
+  if (static_cast<std::size_t>(range.end() - range.begin()) != expected.size()) {
+    throw fail() << "end() - begin() is " << (range.end() - range.begin()) << ", "
+                 << expected.size() << " expected.\n";
+  }
+
+  // sequential and random access
+  std::size_t index = 0;
+  for (ID const id : range) {
+    if (id != expected[index]) {
+      throw fail() << "ID #" << index << " is " << id << ", " << expected[index]
+                   << " expected.\n";
+    }
+    if ((range[index] != id) || (*std::next(range.begin(), index) != id)) {
+      throw fail() << "random access to ID #" << index << " gives a different ID.\n";
+    }
+    ++index;
+  }
+
+  // TBB: each ID visited once, at its place
+  std::vector<ID> visited(expected.size());
+  std::vector<std::atomic<unsigned int>> visits(expected.size());
+  std::atomic<unsigned int> nChunks{0};
+  tbb::parallel_for(range, [&](Range const& chunk) {
+    ++nChunks;
+    for (auto it = chunk.begin(); it != chunk.end(); ++it) {
+      visited[it.index()] = *it;
+      ++visits[it.index()];
+    }
+  });
+  for (std::size_t i = 0; i < expected.size(); ++i) {
+    if (visits[i] != 1U) {
+      throw fail() << "tbb::parallel_for() visited ID #" << i << " " << visits[i] << " times.\n";
+    }
+  }
+  if (visited != expected) throw fail() << "tbb::parallel_for() visits different IDs.\n";
+
+  // C++17 parallel algorithms
+  std::vector<ID> copied(expected.size());
+  std::transform(
+    std::execution::par, range.begin(), range.end(), copied.begin(), [](ID id) { return id; });
+  if (copied != expected) throw fail() << "parallel std::transform() copies different IDs.\n";
+
+  mf::LogInfo("GeometryIDRangesTest")
+    << name << ": " << expected.size() << " IDs match, split into " << nChunks
+    << " chunks by tbb::parallel_for()";
+}
+
+// -----------------------------------------------------------------------------
+DEFINE_ART_MODULE(geo::GeometryIDRangesTest)
@@ -0,0 +1,351 @@
+/**
+ * @file   GeometryStartupBenchmark_module.cc
+ * @brief  Measures the construction of a bundle of geometry services against a baseline.
+ * @see    test/Geometry/test_geometry_startup_regression.fcl
+ */
+
+// LArSoft libraries
+#include "larcore/Geometry/AuxDetGeometry.h"
+#include "larcore/Geometry/Geometry.h"
+#include "larcore/Geometry/StandardWireReadout.h"
+
+// framework libraries
+#include "art/Framework/Core/EDAnalyzer.h"
+#include "art/Framework/Core/ModuleMacros.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/types/Atom.h"
+#include "fhiclcpp/types/DelegatedParameter.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+// C/C++ standard libraries
+#include <algorithm> // std::find_if()
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <type_traits> // std::invoke_result_t
+#include <utility> // std::move()
+#include <vector>
+#include <unistd.h> // sysconf()
+
+// -----------------------------------------------------------------------------
+namespace geo {
+  class GeometryStartupBenchmark;
+}
+/**
+ * @brief Times the construction of the geometry service providers of a configuration.
+ *
+ * The providers of the services in the *Services* table (a
+ * `*_geometry_services` bundle) are constructed one after the other when the
+ * module is constructed: `geo::Geometry`, then the `WireReadout`
+ * (only `geo::StandardWireReadout` is supported, including the arena, voxel
+ * map, adjacency tables and NUMA replicas its configuration enables) and, if
+ * configured, `geo::AuxDetGeometry`. The job itself should not configure any geometry
+ * service (art does not report the construction of single services, and the
+ * geometry of a job can't be loaded twice), and needs no events.
+ *
+ * For each service, the wall-clock time of its construction, the resident
+ * memory it added and the peak resident memory of the process after it (from
+ * `VmHWM` in `/proc/self/status`, so including the services constructed
+ * before) are printed and compared with the ones in *BaselineFile*.
+ * The job fails if for any service the time or the peak memory exceeds the
+ * baseline by more than the allowed fraction and by more than the allowed
+ * absolute amount, or if a service is not in the baseline. A missing baseline
+ * file is an error too; with *UpdateBaseline* set, the measurements are written
+ * into the baseline file instead of being compared, and the job succeeds.
+ *
+ * Baseline files are plain text, with a line per service:
+ * `<service> <seconds> <resident KiB> <peak resident KiB>`; lines starting with
+ * `#` are comments.
+ *
+ * Configuration parameters
+ * =========================
+ *
+ * * *Configuration* (string, mandatory): name of the geometry configuration,
+ *   used in the messages and in the baseline file
+ * * *Services* (table, mandatory): configuration of the geometry services,
+ *   with `Geometry`, `WireReadout` and optionally `AuxDetGeometry` tables
+ * * *BaselineFile* (string, mandatory): path of the baseline file
+ * * *UpdateBaseline* (flag, default: `false`): overwrites the baseline with
+ *   the new measurements instead of comparing with it
+ * * *MaxTimeRegression* (real, default: `0.5`): allowed relative increase of
+ *   the construction time of each service
+ * * *MinTimeRegression* (real, default: `0.1`): increases of construction
+ *   time smaller than this (in seconds) are always accepted
+ * * *MaxMemoryRegression* (real, default: `0.2`): allowed relative increase
+ *   of the peak resident memory after each service
+ * * *MinMemoryRegression* (integer, default: `20480`): increases of peak
+ *   memory smaller than this (in KiB) are always accepted
+ */
+class geo::GeometryStartupBenchmark : public art::EDAnalyzer {
+public:
+  struct Config {
+
+    fhicl::Atom<std::string> Configuration{
+      fhicl::Name{"Configuration"},
+      fhicl::Comment{"Name of the geometry configuration"}};
+
+    fhicl::DelegatedParameter Services{
+      fhicl::Name{"Services"},
+      fhicl::Comment{"Geometry service bundle (Geometry, WireReadout, AuxDetGeometry)"}};
+
+    fhicl::Atom<std::string> BaselineFile{
+      fhicl::Name{"BaselineFile"},
+      fhicl::Comment{"Baseline to compare with"}};
+
+    fhicl::Atom<bool> UpdateBaseline{
+      fhicl::Name{"UpdateBaseline"},
+      fhicl::Comment{"Overwrites the baseline instead of comparing with it"},
+      false};
+
+    fhicl::Atom<double> MaxTimeRegression{
+      fhicl::Name{"MaxTimeRegression"},
+      fhicl::Comment{"Allowed relative increase of the construction time"},
+      0.5};
+
+    fhicl::Atom<double> MinTimeRegression{
+      fhicl::Name{"MinTimeRegression"},
+      fhicl::Comment{"Time increases up to this many seconds are always accepted"},
+      0.1};
+
+    fhicl::Atom<double> MaxMemoryRegression{
+      fhicl::Name{"MaxMemoryRegression"},
+      fhicl::Comment{"Allowed relative increase of the peak resident memory"},
+      0.2};
+
+    fhicl::Atom<long> MinMemoryRegression{
+      fhicl::Name{"MinMemoryRegression"},
+      fhicl::Comment{"Memory increases up to this many KiB are always accepted"},
+      20480L};
+
+  }; // struct Config
+
+  using Parameters = art::EDAnalyzer::Table<Config>;
+
+  explicit GeometryStartupBenchmark(Parameters const& config);
+
+  void analyze(art::Event const&) override {}
+
+  void beginJob() override;
+
+private:
+  /// Cost of the construction of one service.
+  struct Measurement {
+    std::string service;
+    double seconds = 0.0;
+    long residentKiB = 0; ///< Resident memory added by the construction.
+    long peakKiB = 0;     ///< Peak resident memory of the process after it.
+  };
+
+  std::string const fConfiguration;
+  std::string const fBaselineFile;
+  bool const fUpdateBaseline;
+  double const fMaxTimeRegression;
+  double const fMinTimeRegression;
+  double const fMaxMemoryRegression;
+  long const fMinMemoryRegression;
+
+  std::vector<Measurement> fMeasurements;
+
+  // the providers are kept until the end of the job, so that their destruction is not measured
+  std::unique_ptr<geo::Geometry> fGeom;
+  std::unique_ptr<geo::WireReadout> fWireReadout;
+  std::unique_ptr<geo::AuxDetGeometry> fAuxDetGeom;
+
+  /// Constructs an object with `make`, recording the cost as `service`.
+  template <typename Make>
+  std::invoke_result_t<Make> measure(std::string const& service, Make make);
+
+  /// Reads the baseline file; throws if the file can't be read.
+  std::vector<Measurement> readBaseline() const;
+
+  /// Writes the current measurements into the baseline file.
+  void writeBaseline() const;
+
+}; // class geo::GeometryStartupBenchmark
+
+// -----------------------------------------------------------------------------
+// ---  geo::GeometryStartupBenchmark implementation
+// -----------------------------------------------------------------------------
+namespace {
+
+  // resident memory of this process, in KiB
+  long residentMemoryKiB()
+  {
+    std::ifstream statm{"/proc/self/statm"};
+    long pages = 0, residentPages = 0;
+    if (!(statm >> pages >> residentPages)) return 0;
+    return residentPages * (sysconf(_SC_PAGESIZE) / 1024);
+  }
+
+  // peak resident memory of this process, in KiB
+  long peakResidentMemoryKiB()
+  {
+    std::ifstream status{"/proc/self/status"};
+    std::string key;
+    while (status >> key) {
+      if (key == "VmHWM:") {
+        long peak = 0;
+        status >> peak;
+        return peak;
+      }
+      status.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    }
+    return 0;
+  }
+
+} // local namespace
+
+// -----------------------------------------------------------------------------
+geo::GeometryStartupBenchmark::GeometryStartupBenchmark(Parameters const& config)
+  : art::EDAnalyzer{config}
+  , fConfiguration{config().Configuration()}
+  , fBaselineFile{config().BaselineFile()}
+  , fUpdateBaseline{config().UpdateBaseline()}
+  , fMaxTimeRegression{config().MaxTimeRegression()}
+  , fMinTimeRegression{config().MinTimeRegression()}
+  , fMaxMemoryRegression{config().MaxMemoryRegression()}
+  , fMinMemoryRegression{config().MinMemoryRegression()}
+{
+  auto const services = config().Services.get<fhicl::ParameterSet>();
+
+  fGeom = measure("Geometry", [&services]() {
+    return std::make_unique<geo::Geometry>(services.get<fhicl::ParameterSet>("Geometry"));
+  });
+
+  auto const readoutConfig = services.get<fhicl::ParameterSet>("WireReadout");
+  auto const provider = readoutConfig.get<std::string>("service_provider", "");
+  if (provider != "StandardWireReadout") {
+    throw cet::exception("GeometryStartupBenchmark")
+      << "Configuration '" << fConfiguration << "': WireReadout service provider '"
+      << provider << "' is not supported (only StandardWireReadout is).\n";
+  }
+  fWireReadout = measure("WireReadout", [this, &readoutConfig]() {
+    return std::make_unique<geo::StandardWireReadout>(readoutConfig, *fGeom);
+  });
+
+  if (fhicl::ParameterSet auxDetConfig; services.get_if_present("AuxDetGeometry", auxDetConfig)) {
+    fAuxDetGeom = measure("AuxDetGeometry", [&auxDetConfig]() {
+      return std::make_unique<geo::AuxDetGeometry>(auxDetConfig);
+    });
+  }
+}
+
+// -----------------------------------------------------------------------------
+void geo::GeometryStartupBenchmark::beginJob()
+{
+  {
+    mf::LogInfo log("GeometryStartupBenchmark");
+    log << "Construction of the geometry services of '" << fConfiguration << "':";
+    for (Measurement const& m : fMeasurements) {
+      log << "\n  " << std::left << std::setw(16) << m.service << std::right << std::fixed
+          << std::setprecision(3) << std::setw(9) << m.seconds << " s, " << std::setw(8)
+          << m.residentKiB << " KiB resident, " << std::setw(8) << m.peakKiB << " KiB peak";
+    }
+  }
+
+  if (fUpdateBaseline) {
+    writeBaseline();
+    mf::LogWarning("GeometryStartupBenchmark")
+      << "Baseline for '" << fConfiguration << "' written into '" << fBaselineFile
+      << "'; no comparison performed.";
+    return;
+  }
+
+  std::vector<Measurement> const baseline = readBaseline();
+
+  std::ostringstream regressions;
+  for (Measurement const& m : fMeasurements) {
+    auto const ref = std::find_if(baseline.begin(), baseline.end(), [&m](Measurement const& b) {
+      return b.service == m.service;
+    });
+    if (ref == baseline.end()) {
+      regressions << "\n  " << m.service << ": not in the baseline";
+      continue;
+    }
+
+    double const timeDiff = m.seconds - ref->seconds;
+    if ((timeDiff > fMinTimeRegression) && (timeDiff > fMaxTimeRegression * ref->seconds)) {
+      regressions << "\n  " << m.service << ": " << m.seconds << " s, baseline " << ref->seconds
+                  << " s (+" << (100.0 * timeDiff / ref->seconds) << "%)";
+    }
+    long const memoryDiff = m.peakKiB - ref->peakKiB;
+    if ((memoryDiff > fMinMemoryRegression) &&
+        (memoryDiff > fMaxMemoryRegression * ref->peakKiB)) {
+      regressions << "\n  " << m.service << ": " << m.peakKiB << " KiB peak, baseline "
+                  << ref->peakKiB << " KiB (+" << (100.0 * memoryDiff / ref->peakKiB) << "%)";
+    }
+  }
+
+  if (!regressions.str().empty()) {
+    throw cet::exception("GeometryStartupBenchmark")
+      << "Start-up regressions of '" << fConfiguration << "' against '" << fBaselineFile
+      << "':" << regressions.str() << "\n";
+  }
+  mf::LogInfo("GeometryStartupBenchmark")
+    << "'" << fConfiguration << "' is within the thresholds of the baseline '" << fBaselineFile
+    << "'.";
+}
+
+// -----------------------------------------------------------------------------
+template <typename Make>
+std::invoke_result_t<Make> geo::GeometryStartupBenchmark::measure(std::string const& service,
+                                                                  Make make)
+{
+  using Clock_t = std::chrono::steady_clock;
+
+  long const residentBefore = residentMemoryKiB();
+  auto const start = Clock_t::now();
+  auto object = make();
+  std::chrono::duration<double> const elapsed = Clock_t::now() - start;
+
+  fMeasurements.push_back(
+    {service, elapsed.count(), residentMemoryKiB() - residentBefore, peakResidentMemoryKiB()});
+  return object;
+}
+
+// -----------------------------------------------------------------------------
+auto geo::GeometryStartupBenchmark::readBaseline() const -> std::vector<Measurement>
+{
+  std::vector<Measurement> baseline;
+  std::ifstream in{fBaselineFile};
+  if (!in) {
+    throw cet::exception("GeometryStartupBenchmark")
+      << "Can't read the baseline file '" << fBaselineFile << "' of '" << fConfiguration
+      << "' (set UpdateBaseline to create it).\n";
+  }
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty() || (line[0] == '#')) continue;
+    std::istringstream fields{line};
+    Measurement m;
+    if (!(fields >> m.service >> m.seconds >> m.residentKiB >> m.peakKiB)) {
+      throw cet::exception("GeometryStartupBenchmark")
+        << "Baseline file '" << fBaselineFile << "': malformed line '" << line << "'.\n";
+    }
+    baseline.push_back(std::move(m));
+  }
+  return baseline;
+}
+
+// -----------------------------------------------------------------------------
+void geo::GeometryStartupBenchmark::writeBaseline() const
+{
+  std::ofstream out{fBaselineFile};
+  out << "# geometry service start-up baseline for '" << fConfiguration << "'"
+      << "\n# service seconds resident_KiB peak_resident_KiB\n";
+  for (Measurement const& m : fMeasurements) {
+    out << m.service << " " << m.seconds << " " << m.residentKiB << " " << m.peakKiB << "\n";
+  }
+  if (!out) {
+    throw cet::exception("GeometryStartupBenchmark")
+      << "Can't write the baseline file '" << fBaselineFile << "'.\n";
+  }
+}
+
+// -----------------------------------------------------------------------------
+DEFINE_ART_MODULE(geo::GeometryStartupBenchmark)
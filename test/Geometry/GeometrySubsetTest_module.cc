@@ -0,0 +1,292 @@
+/**
+ * @file   GeometrySubsetTest_module.cc
+ * @brief  Checks that the geometry services serve only the configured subset.
+ * @see    larcore/Geometry/GeometrySubset.h
+ */
+
+// LArSoft libraries
+#include "larcore/Geometry/ChannelAdjacency.h"
+#include "larcore/Geometry/Geometry.h"
+#include "larcore/Geometry/GeometryIDRanges.h"
+#include "larcore/Geometry/GeometrySubset.h"
+#include "larcore/Geometry/VoxelReadoutMap.h"
+#include "larcore/Geometry/WireArena.h"
+#include "larcore/Geometry/WireReadout.h"
+#include "larcorealg/Geometry/PlaneGeo.h"
+#include "larcorealg/Geometry/TPCGeo.h"
+#include "larcorealg/Geometry/WireReadoutGeom.h"
+#include "larcoreobj/SimpleTypesAndConstants/RawTypes.h"
+#include "larcoreobj/SimpleTypesAndConstants/geo_types.h"
+
+// framework libraries
+#include "art/Framework/Core/EDAnalyzer.h"
+#include "art/Framework/Core/ModuleMacros.h"
+#include "art/Framework/Services/Registry/ServiceHandle.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/types/Atom.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+// C/C++ standard libraries
+#include <algorithm> // std::sort(), std::unique(), std::binary_search()
+#include <cstddef>   // std::size_t, std::byte
+#include <span>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+namespace geo {
+  class GeometrySubsetTest;
+}
+/**
+ * @brief Checks the services configured with a `Subset` of the detector.
+ *
+ * At the beginning of the job:
+ *
+ * * the TPC IDs of `geo::Geometry` must be the ones of `Subset()`, which must
+ *   have the configured number of them;
+ * * the plane, wire and channel tables (`geo::ReadoutIDTables`) built on the
+ *   `Subset()` of `geo::WireReadout` must list the planes, wires and channels
+ *   (from `PlaneWireToChannel()`) of the subset TPCs only, in order;
+ * * the wire arena, if any, must hold the planes of the subset only;
+ * * `Subset().Require()` must throw on a plane out of the subset;
+ * * the voxel map, if any, must locate the center of each subset TPC in it,
+ *   with the nearest channels of the direct queries, and not locate the
+ *   centers of the other TPCs;
+ * * the adjacency tables, if any, must relate only channels of the subset,
+ *   and throw for a channel out of their range and for a channel in their
+ *   range not read by the subset.
+ *
+ * The job fails at the first difference. The memory of the arena, voxel map
+ * and adjacency tables is then compared with the one of the same tables built
+ * on the whole detector, and the saving is reported (the geometry objects
+ * themselves are of the whole detector, and not reduced by the subset).
+ *
+ * Configuration parameters
+ * =========================
+ *
+ * * *ExpectedTPCs* (integer, mandatory): number of TPCs in the subset
+ */
+class geo::GeometrySubsetTest : public art::EDAnalyzer {
+public:
+  struct Config {
+
+    fhicl::Atom<unsigned int> ExpectedTPCs{fhicl::Name{"ExpectedTPCs"},
+                                           fhicl::Comment{"Number of TPCs in the subset"}};
+
+  }; // struct Config
+
+  using Parameters = art::EDAnalyzer::Table<Config>;
+
+  explicit GeometrySubsetTest(Parameters const& config);
+
+  void analyze(art::Event const&) override {}
+
+  void beginJob() override;
+
+private:
+  unsigned int const fExpectedTPCs;
+
+}; // class geo::GeometrySubsetTest
+
+// -----------------------------------------------------------------------------
+// ---  geo::GeometrySubsetTest implementation
+// -----------------------------------------------------------------------------
+namespace {
+
+  // returns whether `f()` throws `cet::exception`
+  template <typename F>
+  bool throws(F f)
+  {
+    try {
+      f();
+    }
+    catch (cet::exception const&) {
+      return true;
+    }
+    return false;
+  }
+
+  // returns the bytes in the memory `blocks` of a table
+  std::size_t totalSize(std::vector<std::span<std::byte const>> const& blocks)
+  {
+    std::size_t size = 0;
+    for (std::span<std::byte const> block : blocks)
+      size += block.size();
+    return size;
+  }
+
+} // local namespace
+
+// -----------------------------------------------------------------------------
+geo::GeometrySubsetTest::GeometrySubsetTest(Parameters const& config)
+  : art::EDAnalyzer{config}, fExpectedTPCs{config().ExpectedTPCs()}
+{}
+
+// -----------------------------------------------------------------------------
+void geo::GeometrySubsetTest::beginJob()
+{
+  geo::Geometry const& geom = *art::ServiceHandle<geo::Geometry const>();
+  geo::WireReadout const& wireReadout = *art::ServiceHandle<geo::WireReadout const>();
+  geo::WireReadoutGeom const& wireReadoutGeom = wireReadout.Get();
+  geo::GeometrySubset const& subset = geom.Subset();
+
+  auto fail = []() -> cet::exception { return cet::exception("GeometrySubsetTest"); };
+
+  // TPCs
+  if (subset.TPCIDs().size() != fExpectedTPCs) {
+    throw fail() << "Subset of " << subset.TPCIDs().size() << " TPCs, " << fExpectedTPCs
+                 << " expected.\n";
+  }
+  if (wireReadout.Subset() != &subset) {
+    throw fail() << "WireReadout service does not serve the subset of Geometry service.\n";
+  }
+  std::vector<geo::TPCID> const tpcs{geom.TPCIDs().begin(), geom.TPCIDs().end()};
+  if (tpcs != subset.TPCIDs()) throw fail() << "Geometry::TPCIDs() are not the subset TPCs.\n";
+
+  // planes, wires and channels
+  std::vector<geo::PlaneID> planes;
+  std::vector<geo::WireID> wires;
+  std::vector<raw::ChannelID_t> channels;
+  for (geo::PlaneGeo const& plane : wireReadoutGeom.Iterate<geo::PlaneGeo>()) {
+    if (!subset.Contains(plane.ID())) continue;
+    planes.push_back(plane.ID());
+    for (unsigned int w = 0; w < plane.Nwires(); ++w) {
+      wires.emplace_back(plane.ID(), w);
+      channels.push_back(wireReadoutGeom.PlaneWireToChannel(wires.back()));
+    }
+  }
+  std::sort(channels.begin(), channels.end());
+  channels.erase(std::unique(channels.begin(), channels.end()), channels.end());
+
+  geo::ReadoutIDTables const tables{wireReadoutGeom, wireReadout.Subset()};
+  geo::IDRange const planeIDs{tables.planes()};
+  geo::IDRange const wireIDs{tables.wires()};
+  geo::IDRange const channelIDs{tables.channels()};
+  if (std::vector<geo::PlaneID>{planeIDs.begin(), planeIDs.end()} != planes)
+    throw fail() << "ReadoutIDTables planes are not the planes of the subset.\n";
+  if (std::vector<geo::WireID>{wireIDs.begin(), wireIDs.end()} != wires)
+    throw fail() << "ReadoutIDTables wires are not the wires of the subset.\n";
+  if (std::vector<raw::ChannelID_t>{channelIDs.begin(), channelIDs.end()} != channels)
+    throw fail() << "ReadoutIDTables channels are not the channels of the subset.\n";
+
+  // a plane out of the subset
+  geo::PlaneID outside;
+  for (geo::PlaneGeo const& plane : wireReadoutGeom.Iterate<geo::PlaneGeo>()) {
+    if (subset.Contains(plane.ID())) continue;
+    outside = plane.ID();
+    break;
+  }
+  if (outside.isValid) {
+    if (!throws([&] { subset.Require(outside); }))
+      throw fail() << "Subset().Require(" << outside << ") does not throw.\n";
+  }
+
+  // arena
+  if (geo::WireArena const* arena = wireReadout.Arena()) {
+    if (arena->Planes().size() != planes.size() || arena->NWires() != wires.size()) {
+      throw fail() << "Wire arena has " << arena->Planes().size() << " planes and "
+                   << arena->NWires() << " wires, " << planes.size() << " and " << wires.size()
+                   << " expected.\n";
+    }
+    for (geo::WireArena::PlaneEntry const& entry : arena->Planes()) {
+      if (!subset.Contains(entry.ID))
+        throw fail() << "Wire arena includes " << entry.ID << " out of the subset.\n";
+    }
+  }
+
+  // voxel map
+  if (geo::VoxelReadoutMap const* voxelMap = wireReadout.VoxelMap()) {
+    for (geo::TPCGeo const& tpc : geom.Iterate<geo::TPCGeo>()) {
+      geo::Point_t const center = tpc.GetCenter();
+      geo::VoxelReadoutMap::Location const location = voxelMap->Locate(center);
+      if (!subset.Contains(tpc.ID())) {
+        if (location) {
+          throw fail() << "Voxel map locates the center of " << tpc.ID()
+                       << " out of the subset.\n";
+        }
+        continue;
+      }
+      if (location.TPC() != tpc.ID()) {
+        throw fail() << "Voxel map locates the center of " << tpc.ID() << " in "
+                     << location.TPC() << ".\n";
+      }
+      for (unsigned int p = 0; p < location.Nplanes(); ++p) {
+        geo::PlaneGeo const& plane = wireReadoutGeom.Plane(geo::PlaneID{tpc.ID(), p});
+        raw::ChannelID_t const expected =
+          wireReadoutGeom.PlaneWireToChannel(plane.NearestWireID(center));
+        if (location.NearestChannel(p) != expected) {
+          throw fail() << "Voxel map gives channel " << location.NearestChannel(p) << " for "
+                       << plane.ID() << " at the center of the TPC, " << expected
+                       << " expected.\n";
+        }
+      }
+    }
+  }
+
+  // adjacency
+  if (geo::ChannelAdjacency const* adjacency = wireReadout.Adjacency()) {
+    for (raw::ChannelID_t channel : channels) {
+      for (auto const relation :
+           {adjacency->Neighbours(channel), adjacency->Crossing(channel),
+            adjacency->Continuations(channel)}) {
+        for (raw::ChannelID_t other : relation) {
+          if (!std::binary_search(channels.begin(), channels.end(), other)) {
+            throw fail() << "Channel " << channel << " is related to channel " << other
+                         << " out of the subset.\n";
+          }
+        }
+      }
+    }
+    geo::ChannelAdjacency::Table const& table = adjacency->NeighbourTable();
+    raw::ChannelID_t const out = (table.FirstChannel() > 0) ? 0 : table.EndChannel();
+    if ((out < wireReadoutGeom.Nchannels()) && !throws([&] { adjacency->Neighbours(out); }))
+      throw fail() << "Adjacency of channel " << out << " out of the subset does not throw.\n";
+    for (raw::ChannelID_t gap = table.FirstChannel(); gap < table.EndChannel(); ++gap) {
+      if (std::binary_search(channels.begin(), channels.end(), gap)) continue;
+      if (!throws([&] { adjacency->Neighbours(gap); })) {
+        throw fail() << "Adjacency of channel " << gap
+                     << " in the range of the subset but not in it does not throw.\n";
+      }
+      break;
+    }
+  }
+
+  // memory of the tables, against the ones of the whole detector
+  {
+    mf::LogInfo log("GeometrySubsetTest");
+    log << "Memory of the readout tables of the subset and of the whole detector:";
+    auto const report = [&log](char const* name, std::size_t subsetSize, std::size_t fullSize) {
+      log << "\n  " << name << ": " << (subsetSize / 1024) << " KiB, " << (fullSize / 1024)
+          << " KiB for the whole detector";
+      if (fullSize > 0) log << " (" << (100.0 * subsetSize / fullSize) << "%)";
+      if (subsetSize > fullSize) {
+        throw cet::exception("GeometrySubsetTest")
+          << name << " of the subset takes more memory than the one of the whole detector.\n";
+      }
+    };
+    if (geo::WireArena const* arena = wireReadout.Arena()) {
+      report("wire arena",
+             totalSize(arena->MemoryBlocks()),
+             totalSize(geo::WireArena{wireReadoutGeom}.MemoryBlocks()));
+    }
+    if (geo::VoxelReadoutMap const* voxelMap = wireReadout.VoxelMap()) {
+      report("voxel map",
+             voxelMap->MemoryUsage(),
+             geo::VoxelReadoutMap{geom, wireReadoutGeom, voxelMap->VoxelSize()}.MemoryUsage());
+    }
+    if (geo::ChannelAdjacency const* adjacency = wireReadout.Adjacency()) {
+      report("adjacency tables",
+             adjacency->MemoryUsage(),
+             geo::ChannelAdjacency{wireReadoutGeom, adjacency->ContinuationDistance()}
+               .MemoryUsage());
+    }
+  }
+
+  mf::LogInfo("GeometrySubsetTest")
+    << "Subset of " << tpcs.size() << " of " << subset.NAllTPCs() << " TPCs: " << planes.size()
+    << " planes, " << wires.size() << " wires, " << channels.size() << " of "
+    << wireReadoutGeom.Nchannels() << " channels checked";
+}
+
+// -----------------------------------------------------------------------------
+DEFINE_ART_MODULE(geo::GeometrySubsetTest)
@@ -0,0 +1,210 @@
+/**
+ * @file   NavigatorPool_test.cc
+ * @brief  Stress test of concurrent point queries through `geo::NavigatorPool`.
+ * @see    larcore/Geometry/NavigatorPool.h
+ *
+ * The "voltpc" geometry is built from `test_voltpc_parametric.fcl`, and the
+ * volume and column density are queried at random points. A pool in shared
+ * mode is queried first from 4 threads, and it must leave `gGeoManager` usable.
+ * A pool with per-thread navigators is then queried from 1, 2, 4 and 8
+ * threads, and a pool with only 2 navigators from 6 threads, 4 of which are
+ * served by its helper thread. All threads must reproduce the
+ * single-thread results, which must in turn match the ones of the `gGeoManager`
+ * navigator. The throughput for each number of threads is printed, and with
+ * more than one thread it must be larger than the single-thread one (if the
+ * machine has at least as many cores).
+ *
+ * This test takes no command line argument.
+ */
+
+#define BOOST_TEST_MODULE (NavigatorPool_test)
+
+// LArSoft libraries
+#include "larcore/Geometry/GeometryBuilderParametric.h"
+#include "larcore/Geometry/NavigatorPool.h"
+
+// framework libraries
+#include "cetlib/filepath_maker.h"
+#include "fhiclcpp/ParameterSet.h"
+
+// ROOT libraries
+#include "TGeoBBox.h"
+#include "TGeoManager.h"
+#include "TGeoNode.h"
+#include "TGeoVolume.h"
+
+// Boost libraries
+#include <boost/test/unit_test.hpp>
+
+// C/C++ standard libraries
+#include <chrono>
+#include <condition_variable>
+#include <cstddef> // std::size_t
+#include <iomanip>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+  constexpr std::size_t NPoints = 20000;
+  constexpr unsigned int NRepetitions = 5;
+  constexpr unsigned int ThreadCounts[] = {1, 2, 4, 8};
+  constexpr unsigned int NOverflowThreads = 4;
+
+  struct QueryResult {
+    std::string volume;
+    double columnDensity; // from the previous point
+  };
+
+  std::vector<geo::Point_t> randomPoints(TGeoManager const& manager)
+  {
+    auto const& world = static_cast<TGeoBBox const&>(*manager.GetTopVolume()->GetShape());
+    std::mt19937 engine{12345};
+    std::uniform_real_distribution<double> uniform{-0.9, 0.9};
+    std::vector<geo::Point_t> points;
+    for (std::size_t i = 0; i < NPoints; ++i) {
+      double const x = uniform(engine) * world.GetDX();
+      double const y = uniform(engine) * world.GetDY();
+      double const z = uniform(engine) * world.GetDZ();
+      points.emplace_back(x, y, z);
+    }
+    return points;
+  }
+
+  std::vector<QueryResult> query(geo::NavigatorPool const& pool,
+                                 std::vector<geo::Point_t> const& points)
+  {
+    std::vector<QueryResult> results;
+    results.reserve(points.size());
+    for (std::size_t i = 0; i < points.size(); ++i) {
+      results.push_back(
+        {pool.VolumeName(points[i]), i ? pool.MassBetweenPoints(points[i - 1], points[i]) : 0.});
+    }
+    return results;
+  }
+
+  // runs `query()` from `nThreads` threads at the same time; no thread ends
+  // before all are done, so that they are distinct threads for ROOT
+  // (which tells them apart by `std::thread::id`, reused after a thread ends)
+  std::vector<std::vector<QueryResult>> queryConcurrently(geo::NavigatorPool const& pool,
+                                                          std::vector<geo::Point_t> const& points,
+                                                          unsigned int nThreads)
+  {
+    std::vector<std::vector<QueryResult>> results(nThreads);
+    std::mutex mutex;
+    std::condition_variable allDone;
+    unsigned int running = nThreads;
+    std::vector<std::thread> threads;
+    for (unsigned int iThread = 0; iThread < nThreads; ++iThread) {
+      threads.emplace_back([&, &result = results[iThread]]() {
+        for (unsigned int iRep = 0; iRep < NRepetitions; ++iRep)
+          result = query(pool, points);
+        std::unique_lock lock{mutex};
+        if (--running == 0) allDone.notify_all();
+        allDone.wait(lock, [&running]() { return running == 0; });
+      });
+    }
+    for (std::thread& thread : threads)
+      thread.join();
+    return results;
+  }
+
+  void checkResults(std::vector<std::vector<QueryResult>> const& results,
+                    std::vector<QueryResult> const& expected)
+  {
+    for (std::size_t iThread = 0; iThread < results.size(); ++iThread) {
+      BOOST_TEST_CONTEXT(results.size() << " threads, thread #" << iThread)
+      {
+        BOOST_TEST_REQUIRE(results[iThread].size() == expected.size());
+        for (std::size_t i = 0; i < expected.size(); ++i) {
+          BOOST_TEST(results[iThread][i].volume == expected[i].volume);
+          BOOST_TEST(results[iThread][i].columnDensity == expected[i].columnDensity);
+        }
+      }
+    }
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(ConcurrentPointQueries_test)
+{
+  cet::filepath_lookup policy{"FHICL_FILE_PATH"};
+  auto const config = fhicl::ParameterSet::make("test_voltpc_parametric.fcl", policy);
+  TGeoManager* manager = geo::BuildParametricGeometry(config.get<fhicl::ParameterSet>("builder"));
+  std::vector<geo::Point_t> const points = randomPoints(*manager);
+
+  // reference from the shared navigator, before enabling multi-thread mode
+  std::vector<std::string> sharedNavigatorVolumes;
+  for (geo::Point_t const& point : points)
+    sharedNavigatorVolumes.push_back(manager->FindNode(point.X(), point.Y(), point.Z())->GetName());
+
+  // shared mode: queries take turns on the navigator of gGeoManager
+  {
+    geo::NavigatorPool const sharedPool{manager};
+    BOOST_TEST(!sharedPool.isPerThread());
+    std::vector<QueryResult> const expected = query(sharedPool, points);
+    BOOST_TEST_REQUIRE(expected.size() == sharedNavigatorVolumes.size());
+    for (std::size_t i = 0; i < expected.size(); ++i)
+      BOOST_TEST(expected[i].volume == sharedNavigatorVolumes[i]);
+    checkResults(queryConcurrently(sharedPool, points, 4), expected);
+    BOOST_TEST(!manager->IsMultiThread());
+    BOOST_TEST(sharedPool.size() == 0U);
+  }
+
+  // every thread of every round gets its own navigator
+  {
+    unsigned int maxThreads = 0;
+    for (unsigned int nThreads : ThreadCounts)
+      maxThreads += nThreads;
+    geo::NavigatorPool const pool{manager, maxThreads};
+    BOOST_TEST(pool.isPerThread());
+
+    std::vector<QueryResult> const expected = query(pool, points);
+    BOOST_TEST_REQUIRE(expected.size() == sharedNavigatorVolumes.size());
+    for (std::size_t i = 0; i < expected.size(); ++i)
+      BOOST_TEST(expected[i].volume == sharedNavigatorVolumes[i]);
+
+    double singleThreadRate = 0.0;
+    for (unsigned int nThreads : ThreadCounts) {
+      auto const start = std::chrono::steady_clock::now();
+      auto const results = queryConcurrently(pool, points, nThreads);
+      std::chrono::duration<double> const elapsed = std::chrono::steady_clock::now() - start;
+
+      double const rate = nThreads * NRepetitions * NPoints / elapsed.count();
+      if (nThreads == 1) singleThreadRate = rate;
+      BOOST_TEST_MESSAGE(std::setw(2) << nThreads << " threads: " << std::fixed
+                                      << std::setprecision(0) << rate << " queries/s, speedup "
+                                      << std::setprecision(2) << (rate / singleThreadRate));
+
+      // loose check: the threads must not be serialized on a shared navigator
+      if ((nThreads > 1) && (nThreads <= std::thread::hardware_concurrency())) {
+        BOOST_TEST_CONTEXT(nThreads << " threads")
+        {
+          BOOST_TEST(rate > singleThreadRate);
+        }
+      }
+
+      checkResults(results, expected);
+    }
+    BOOST_TEST(pool.size() <= pool.maxThreads());
+    BOOST_TEST(pool.helperQueries() == 0U);
+  }
+
+  // more threads than navigators: the others are served by the helper thread;
+  // a new geometry is needed, since ROOT can't leave multi-thread mode
+  {
+    manager = geo::BuildParametricGeometry(config.get<fhicl::ParameterSet>("builder"));
+    constexpr unsigned int MaxThreads = 2;
+    geo::NavigatorPool const pool{manager, MaxThreads};
+
+    std::vector<QueryResult> const expected = query(pool, points);
+    checkResults(queryConcurrently(pool, points, MaxThreads + NOverflowThreads), expected);
+    BOOST_TEST(pool.size() == MaxThreads);
+    // each `query()` makes a volume query per point and a mass query per pair
+    BOOST_TEST(pool.helperQueries() == NOverflowThreads * NRepetitions * (2 * NPoints - 1));
+  }
+}
@@ -0,0 +1,191 @@
+/**
+ * @file   NumaReplicas_test.cc
+ * @brief  Checks the copies of tables on NUMA nodes, and times local and remote reads.
+ * @see    larcore/Geometry/NumaReplicas.h
+ *
+ * The replicas are checked on explicit topologies, which work also on
+ * machines with a single node. Then a large table, a random cycle through all
+ * its entries, is copied on each node of this machine, and each node reads the
+ * copy of every node by following the cycle: the average latency of a read is
+ * printed for each pair (local copies on the diagonal), with and without huge
+ * pages. On a single node machine only the local reads are timed.
+ *
+ * This test takes no command line argument.
+ */
+
+#define BOOST_TEST_MODULE (NumaReplicas_test)
+
+// LArSoft libraries
+#include "larcore/Geometry/NumaReplicas.h"
+
+// Boost libraries
+#include <boost/test/unit_test.hpp>
+
+// C/C++ standard libraries
+#include <chrono>
+#include <cstddef> // std::byte
+#include <cstdint> // std::uint32_t
+#include <memory>  // std::make_unique()
+#include <numeric> // std::iota()
+#include <random>
+#include <span>
+#include <sstream>
+#include <stdexcept> // std::runtime_error
+#include <utility>   // std::swap()
+#include <vector>
+
+namespace {
+
+  // a table with a large block of memory
+  struct FakeTable {
+    std::vector<std::uint32_t> next;
+
+    std::vector<std::span<std::byte const>> MemoryBlocks() const
+    {
+      return {std::as_bytes(std::span{next})};
+    }
+  };
+
+  // a table which can't be copied
+  struct UncopiableTable {
+    UncopiableTable() = default;
+    UncopiableTable(UncopiableTable const&) { throw std::runtime_error{"no copy"}; }
+  };
+
+  // a random cycle through all the `n` entries (Sattolo's algorithm)
+  FakeTable randomCycle(std::size_t n, unsigned int seed)
+  {
+    std::vector<std::uint32_t> order(n);
+    std::iota(order.begin(), order.end(), 0U);
+    std::mt19937 engine{seed};
+    for (std::size_t i = n - 1; i > 0; --i)
+      std::swap(order[i], order[std::uniform_int_distribution<std::size_t>{0, i - 1}(engine)]);
+    FakeTable table;
+    table.next.resize(n);
+    for (std::size_t i = 0; i < n; ++i)
+      table.next[order[i]] = order[(i + 1) % n];
+    return table;
+  }
+
+  // follows the cycle of `table` for `nSteps` from a thread on `node`;
+  // returns the average time of a step [ns], and the last entry in `last`
+  double timeReads(geo::NumaTopology const& topology,
+                   unsigned int node,
+                   FakeTable const& table,
+                   std::size_t nSteps,
+                   std::uint32_t& last)
+  {
+    double time = 0.0;
+    geo::details::runOnNode(topology, node, [&](geo::details::NodePlacement&) {
+      std::uint32_t entry = 0;
+      for (std::size_t i = 0; i < nSteps / 10; ++i) // warm up
+        entry = table.next[entry];
+      entry = 0;
+      auto const start = std::chrono::steady_clock::now();
+      for (std::size_t i = 0; i < nSteps; ++i)
+        entry = table.next[entry];
+      std::chrono::duration<double, std::nano> const elapsed =
+        std::chrono::steady_clock::now() - start;
+      time = elapsed.count() / nSteps;
+      last = entry;
+    });
+    return time;
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(Topology_test)
+{
+  geo::NumaTopology const& system = geo::NumaTopology::System();
+  BOOST_TEST(system.NNodes() >= 1U);
+  BOOST_TEST(system.CurrentNode() < system.NNodes());
+
+  geo::NumaTopology const topology{{{0, 1, 4}, {2, 3}, {}}};
+  BOOST_TEST(topology.NNodes() == 3U);
+  BOOST_TEST(topology.NodeOf(0) == 0U);
+  BOOST_TEST(topology.NodeOf(3) == 1U);
+  BOOST_TEST(topology.NodeOf(4) == 0U);
+  BOOST_TEST(topology.NodeOf(100) == 0U); // unknown
+  BOOST_TEST(topology.CPUs(2).empty());
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(Replicas_test)
+{
+  BOOST_TEST(!geo::NumaReplicas<FakeTable>{}.get());
+
+  // not replicated: the original table is served
+  auto original = std::make_unique<FakeTable const>(randomCycle(1000, 1));
+  FakeTable const* const originalPtr = original.get();
+  geo::NumaReplicas<FakeTable> const shared{std::move(original), {}};
+  BOOST_TEST(!shared.isReplicated());
+  BOOST_TEST(shared.NReplicas() == 1U);
+  BOOST_TEST(shared.get() == originalPtr);
+  BOOST_TEST(shared.replica(1) == originalPtr);
+
+  // two nodes, the second one with all the CPUs: its copy is the local one
+  std::vector<unsigned int> allCPUs;
+  for (unsigned int node = 0; node < geo::NumaTopology::System().NNodes(); ++node) {
+    for (unsigned int const cpu : geo::NumaTopology::System().CPUs(node))
+      allCPUs.push_back(cpu);
+  }
+  geo::NumaTopology const topology{{{}, allCPUs}};
+  FakeTable const expected = randomCycle(1000, 1);
+  geo::NumaReplicas<FakeTable> const replicas{
+    std::make_unique<FakeTable const>(expected), {true, true}, topology};
+  BOOST_TEST(replicas.isReplicated());
+  BOOST_TEST_REQUIRE(replicas.NReplicas() == 2U);
+  BOOST_TEST(replicas.Placements().size() == 2U);
+  BOOST_TEST(replicas.replica(0) != replicas.replica(1));
+  BOOST_TEST(replicas.get() == replicas.replica(1));
+  for (unsigned int node = 0; node < 2; ++node)
+    BOOST_TEST(replicas.replica(node)->next == expected.next, boost::test_tools::per_element());
+  BOOST_TEST(!replicas.Placements()[0].boundCPUs);
+
+  // the errors of the copies reach the caller
+  BOOST_CHECK_THROW(
+    (geo::NumaReplicas<UncopiableTable>{
+      std::make_unique<UncopiableTable const>(), {true, false}, topology}),
+    std::runtime_error);
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(RemoteVsLocal_test)
+{
+  constexpr std::size_t NEntries = 16 << 20; // 64 MiB, larger than the caches
+  constexpr std::size_t NSteps = 4 << 20;
+
+  geo::NumaTopology const& topology = geo::NumaTopology::System();
+  FakeTable const table = randomCycle(NEntries, 2);
+
+  // reference: the entry reached after `NSteps` steps
+  std::uint32_t expected = 0;
+  for (std::size_t i = 0; i < NSteps; ++i)
+    expected = table.next[expected];
+
+  for (bool const hugePages : {false, true}) {
+    geo::NumaReplicas<FakeTable> const replicas{
+      std::make_unique<FakeTable const>(table), {true, hugePages}, topology};
+
+    std::ostringstream report;
+    report << "Read latency [ns] on " << topology.NNodes() << " NUMA nodes, "
+           << (hugePages ? "with" : "without") << " huge pages (rows: reading node, columns: "
+           << "node of the copy):";
+    for (unsigned int reader = 0; reader < topology.NNodes(); ++reader) {
+      if (topology.CPUs(reader).empty()) continue;
+      report << "\n  node " << reader << ":";
+      for (unsigned int node = 0; node < topology.NNodes(); ++node) {
+        std::uint32_t last = 0;
+        double const time = timeReads(topology, reader, *replicas.replica(node), NSteps, last);
+        BOOST_TEST(last == expected);
+        report << " " << time << (node == reader ? " (local)" : "");
+      }
+    }
+    geo::details::NodePlacement const& placement = replicas.Placements().front();
+    report << "\n  copy on node 0: CPUs " << (placement.boundCPUs ? "" : "not ")
+           << "bound, memory " << (placement.boundMemory ? "" : "not ") << "bound, "
+           << (placement.hugePageBytes >> 20) << " MiB on huge pages";
+    BOOST_TEST_MESSAGE(report.str());
+  }
+}
@@ -0,0 +1,301 @@
+/**
+ * @file   PixelLatticeTest_module.cc
+ * @brief  Checks the pixel lattices of the anodes against the TPC geometry.
+ * @see    larcore/Geometry/PixelLattice.h
+ */
+
+// LArSoft libraries
+#include "larcore/Geometry/Geometry.h"
+#include "larcore/Geometry/PixelLattice.h"
+#include "larcore/Geometry/WireReadout.h"
+#include "larcorealg/Geometry/BoxBoundedGeo.h"
+#include "larcorealg/Geometry/TPCGeo.h"
+#include "larcorealg/Geometry/WireReadoutGeom.h"
+#include "larcoreobj/SimpleTypesAndConstants/RawTypes.h"
+#include "larcoreobj/SimpleTypesAndConstants/geo_types.h"
+
+// framework libraries
+#include "art/Framework/Core/EDAnalyzer.h"
+#include "art/Framework/Core/ModuleMacros.h"
+#include "art/Framework/Services/Registry/ServiceHandle.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/types/Atom.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+// C/C++ standard libraries
+#include <algorithm> // std::min(), std::max()
+#include <array>
+#include <chrono>
+#include <cmath> // std::abs()
+#include <limits>
+#include <random>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+namespace geo {
+  class PixelLatticeTest;
+}
+/**
+ * @brief Checks the pixel lattices of the anodes against the TPC geometry.
+ *
+ * The `geo::WireReadout` service must have a pixel readout (e.g.
+ * `PixelWireReadout`). At the beginning of the job:
+ *
+ * * the anodes must follow the TPCs of the geometry, with consecutive channel
+ *   ranges covering all the channels, which must follow the channels of the
+ *   readout geometry (`Get()`) without sharing any of them;
+ * * each channel must map to a pixel mapping back to it, whose center is on
+ *   the anode plane and whose channel is the one of its center;
+ * * random points are generated in a box 20% larger than all the TPC active
+ *   volumes: the pixel of the points in an active volume must have its center
+ *   closer than half a pitch to them along both axes of the anode, and the
+ *   points out of all active volumes must have no pixel;
+ * * the batch lookups must return the same as the single ones.
+ *
+ * The time taken by the single and by the batch lookups is also reported.
+ * The job fails at the first difference.
+ *
+ * Configuration parameters
+ * =========================
+ *
+ * * *Points* (integer, default: `1000000`): number of random points
+ * * *Seed* (integer, default: `12345`): seed of the random generator
+ */
+class geo::PixelLatticeTest : public art::EDAnalyzer {
+public:
+  struct Config {
+
+    fhicl::Atom<unsigned int> Points{fhicl::Name{"Points"},
+                                     fhicl::Comment{"Number of random points"},
+                                     1000000U};
+
+    fhicl::Atom<unsigned int> Seed{fhicl::Name{"Seed"},
+                                   fhicl::Comment{"Seed of the random generator"},
+                                   12345U};
+
+  }; // struct Config
+
+  using Parameters = art::EDAnalyzer::Table<Config>;
+
+  explicit PixelLatticeTest(Parameters const& config);
+
+  void analyze(art::Event const&) override {}
+
+  void beginJob() override;
+
+private:
+  unsigned int const fNPoints;
+  unsigned int const fSeed;
+
+}; // class geo::PixelLatticeTest
+
+// -----------------------------------------------------------------------------
+// ---  geo::PixelLatticeTest implementation
+// -----------------------------------------------------------------------------
+namespace {
+
+  // positions agree with the lattice within this [cm]
+  constexpr double Tolerance = 1e-6;
+
+  double coordinate(geo::Point_t const& point, unsigned int axis)
+  {
+    switch (axis) {
+    case 0: return point.X();
+    case 1: return point.Y();
+    default: return point.Z();
+    }
+  }
+
+} // local namespace
+
+// -----------------------------------------------------------------------------
+geo::PixelLatticeTest::PixelLatticeTest(Parameters const& config)
+  : art::EDAnalyzer{config}, fNPoints{config().Points()}, fSeed{config().Seed()}
+{}
+
+// -----------------------------------------------------------------------------
+void geo::PixelLatticeTest::beginJob()
+{
+  using Clock_t = std::chrono::steady_clock;
+
+  geo::Geometry const& geom = *art::ServiceHandle<geo::Geometry const>();
+  geo::WireReadout const& wireReadout = *art::ServiceHandle<geo::WireReadout const>();
+  geo::PixelLattice const* pixels = wireReadout.Pixels();
+  if (!pixels) {
+    throw cet::exception("PixelLatticeTest")
+      << "The WireReadout service has no pixel readout (use PixelWireReadout).\n";
+  }
+  double const pitch = pixels->Pitch();
+
+  // the pixel channels follow the wire channels of the readout geometry
+  if (pixels->FirstChannel() != wireReadout.Get().Nchannels()) {
+    throw cet::exception("PixelLatticeTest")
+      << "Pixel channels start from " << pixels->FirstChannel() << ", the readout geometry has "
+      << wireReadout.Get().Nchannels() << " channels.\n";
+  }
+  if ((pixels->FirstChannel() > 0) && pixels->HasChannel(pixels->FirstChannel() - 1)) {
+    throw cet::exception("PixelLatticeTest")
+      << "Channel " << (pixels->FirstChannel() - 1) << " is a wire channel, but has a pixel.\n";
+  }
+
+  // anodes follow the TPCs, with consecutive channels
+  std::vector<geo::TPCGeo const*> tpcs;
+  for (geo::TPCGeo const& tpc : geom.Iterate<geo::TPCGeo>())
+    tpcs.push_back(&tpc);
+  auto const anodes = pixels->Anodes();
+  if (anodes.size() != tpcs.size()) {
+    throw cet::exception("PixelLatticeTest")
+      << anodes.size() << " anodes for " << tpcs.size() << " TPCs.\n";
+  }
+  raw::ChannelID_t nextChannel = pixels->FirstChannel();
+  for (std::size_t i = 0; i < anodes.size(); ++i) {
+    if ((anodes[i].tpc != tpcs[i]->ID()) || (pixels->AnodeOf(tpcs[i]->ID()) != &anodes[i])) {
+      throw cet::exception("PixelLatticeTest")
+        << "Anode #" << i << " is on " << anodes[i].tpc << " instead of " << tpcs[i]->ID()
+        << ".\n";
+    }
+    if (anodes[i].firstChannel != nextChannel) {
+      throw cet::exception("PixelLatticeTest")
+        << "Anode of " << anodes[i].tpc << " starts from channel " << anodes[i].firstChannel
+        << " instead of " << nextChannel << ".\n";
+    }
+    nextChannel += anodes[i].Npixels();
+  }
+  if (nextChannel != pixels->EndChannel()) {
+    throw cet::exception("PixelLatticeTest")
+      << "Anodes have " << (nextChannel - pixels->FirstChannel()) << " pixels, but "
+      << pixels->Nchannels() << " channels.\n";
+  }
+
+  // each channel: pixel, back to channel; center, back to channel
+  for (raw::ChannelID_t channel = pixels->FirstChannel(); channel < pixels->EndChannel();
+       ++channel) {
+    geo::PixelLattice::Pixel const pixel = pixels->ChannelToPixel(channel);
+    if (pixels->PixelToChannel(pixel) != channel) {
+      throw cet::exception("PixelLatticeTest")
+        << "Channel " << channel << " -> { " << pixel.tpc << " row " << pixel.row << " column "
+        << pixel.column << " } -> channel " << pixels->PixelToChannel(pixel) << ".\n";
+    }
+    geo::PixelLattice::Anode const& anode = *pixels->AnodeOf(pixel.tpc);
+    geo::Point_t const center = pixels->ChannelToCenter(channel);
+    if (std::abs(coordinate(center, anode.driftAxis) - anode.anodePosition) > Tolerance) {
+      throw cet::exception("PixelLatticeTest")
+        << "Center " << center << " of channel " << channel << " is not on the anode of "
+        << anode.tpc << ".\n";
+    }
+    // centers sticking out of the anode (last row and column) have no channel
+    bool onAnode = true;
+    for (std::size_t i = 0; i < 2; ++i) {
+      double const offset = coordinate(center, anode.axes[i]) - anode.origin[i];
+      onAnode = onAnode && (offset <= anode.size[i]);
+    }
+    if (onAnode && (pixels->PositionToChannel(pixel.tpc, center) != channel)) {
+      throw cet::exception("PixelLatticeTest")
+        << "Center " << center << " of channel " << channel << " is in channel "
+        << pixels->PositionToChannel(pixel.tpc, center) << ".\n";
+    }
+  }
+  if (pixels->HasChannel(pixels->EndChannel()) ||
+      pixels->ChannelToPixel(pixels->EndChannel()).isValid()) {
+    throw cet::exception("PixelLatticeTest")
+      << "Channel " << pixels->EndChannel() << " is beyond the last pixel, but has one.\n";
+  }
+
+  // random points around all the active volumes
+  double const inf = std::numeric_limits<double>::max();
+  double min[3] = {inf, inf, inf}, max[3] = {-inf, -inf, -inf};
+  for (geo::TPCGeo const* tpc : tpcs) {
+    auto const& box = tpc->ActiveBoundingBox();
+    min[0] = std::min(min[0], box.MinX());
+    min[1] = std::min(min[1], box.MinY());
+    min[2] = std::min(min[2], box.MinZ());
+    max[0] = std::max(max[0], box.MaxX());
+    max[1] = std::max(max[1], box.MaxY());
+    max[2] = std::max(max[2], box.MaxZ());
+  }
+  std::mt19937 rng{fSeed};
+  std::uniform_real_distribution<double> uniform{-0.1, 1.1};
+  std::vector<geo::Point_t> points;
+  points.reserve(fNPoints);
+  for (unsigned int i = 0; i < fNPoints; ++i) {
+    points.emplace_back(min[0] + uniform(rng) * (max[0] - min[0]),
+                        min[1] + uniform(rng) * (max[1] - min[1]),
+                        min[2] + uniform(rng) * (max[2] - min[2]));
+  }
+
+  // single and batch lookups
+  std::vector<raw::ChannelID_t> channels(points.size());
+  auto const singleStart = Clock_t::now();
+  for (std::size_t i = 0; i < points.size(); ++i)
+    channels[i] = pixels->PositionToChannel(points[i]);
+  std::chrono::duration<double> const singleTime = Clock_t::now() - singleStart;
+
+  std::vector<raw::ChannelID_t> batchChannels(points.size());
+  auto const batchStart = Clock_t::now();
+  pixels->PositionsToChannels(points, batchChannels);
+  std::chrono::duration<double> const batchTime = Clock_t::now() - batchStart;
+
+  std::vector<raw::ChannelID_t> pixelChannels;
+  for (raw::ChannelID_t channel : channels)
+    if (raw::isValidChannelID(channel)) pixelChannels.push_back(channel);
+  std::vector<geo::Point_t> centers(pixelChannels.size());
+  pixels->ChannelsToCenters(pixelChannels, centers);
+
+  // comparison with the active volumes
+  std::size_t nInside = 0;
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    if (batchChannels[i] != channels[i]) {
+      throw cet::exception("PixelLatticeTest")
+        << "Point #" << i << " " << points[i] << " is in channel " << batchChannels[i]
+        << " for the batch lookup, " << channels[i] << " for the single one.\n";
+    }
+    geo::TPCGeo const* tpc = nullptr;
+    for (geo::TPCGeo const* candidate : tpcs) {
+      if (!candidate->ActiveBoundingBox().ContainsPosition(points[i])) continue;
+      tpc = candidate;
+      break;
+    }
+    if (!tpc) {
+      if (raw::isValidChannelID(channels[i])) {
+        throw cet::exception("PixelLatticeTest")
+          << "Point #" << i << " " << points[i] << " is out of all active volumes, but in channel "
+          << channels[i] << ".\n";
+      }
+      continue;
+    }
+
+    geo::PixelLattice::Anode const& anode = *pixels->AnodeOf(tpc->ID());
+    if (pixels->PositionToChannel(tpc->ID(), points[i]) != channels[i]) {
+      throw cet::exception("PixelLatticeTest")
+        << "Point #" << i << " " << points[i] << " is in channel " << channels[i]
+        << ", but in channel " << pixels->PositionToChannel(tpc->ID(), points[i]) << " of "
+        << tpc->ID() << ".\n";
+    }
+    geo::Point_t const& center = centers[nInside++];
+    if (center != pixels->ChannelToCenter(channels[i])) {
+      throw cet::exception("PixelLatticeTest")
+        << "Channel " << channels[i] << " has center " << pixels->ChannelToCenter(channels[i])
+        << ", but " << center << " from the batch lookup.\n";
+    }
+    for (std::size_t a = 0; a < 2; ++a) {
+      double const distance =
+        coordinate(points[i], anode.axes[a]) - coordinate(center, anode.axes[a]);
+      if (std::abs(distance) > pitch / 2.0 + Tolerance) {
+        throw cet::exception("PixelLatticeTest")
+          << "Point #" << i << " " << points[i] << " in " << tpc->ID() << " is in channel "
+          << channels[i] << ", whose center " << center << " is " << distance
+          << " cm away along the axis #" << anode.axes[a] << ".\n";
+      }
+    }
+  }
+
+  mf::LogInfo("PixelLatticeTest")
+    << pixels->Nchannels() << " channels on " << anodes.size() << " anodes checked; "
+    << points.size() << " points (" << nInside << " in active volumes) match; pixels of "
+    << pitch << " cm, " << (pixels->MemoryUsage() / 1024) << " KiB"
+    << "\n  single lookups: " << singleTime.count() << " s"
+    << "\n  batch lookup:   " << batchTime.count() << " s";
+}
+
+// -----------------------------------------------------------------------------
+DEFINE_ART_MODULE(geo::PixelLatticeTest)
@@ -0,0 +1,247 @@
+/**
+ * @file   StandaloneChannelMapTest_module.cc
+ * @brief  Checks the standalone channel map against the wire readout service.
+ * @see    larcore/Geometry/StandaloneChannelMap.h
+ */
+
+// LArSoft libraries
+#include "larcore/Geometry/StandaloneChannelMap.h"
+#include "larcore/Geometry/StandaloneChannelMapExport.h"
+#include "larcore/Geometry/WireReadout.h"
+#include "larcorealg/Geometry/PlaneGeo.h"
+#include "larcorealg/Geometry/WireReadoutGeom.h"
+#include "larcoreobj/SimpleTypesAndConstants/RawTypes.h"
+#include "larcoreobj/SimpleTypesAndConstants/geo_types.h"
+
+// framework libraries
+#include "art/Framework/Core/EDAnalyzer.h"
+#include "art/Framework/Core/ModuleMacros.h"
+#include "art/Framework/Services/Registry/ServiceHandle.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/types/Atom.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+// C/C++ standard libraries
+#include <algorithm> // std::sort()
+#include <chrono>
+#include <cstdint> // std::uint64_t
+#include <span>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+namespace geo {
+  class StandaloneChannelMapTest;
+}
+/**
+ * @brief Checks a channel map file against the `WireReadout` service.
+ *
+ * At the beginning of the job, the channel map of the service is exported and
+ * written into *FileName*, then read back. The map read from the file must
+ * have, compared with the service:
+ *
+ * * the same number of channels;
+ * * the same planes, in the same order, with the same view, signal type and
+ *   number of wires;
+ * * the same channel for each wire, and no channel past the last wire;
+ * * the same wires for each channel, with the view and signal type of the
+ *   service, and no wire for channels past the last one.
+ *
+ * The job fails at the first difference. Then the average time of a lookup of
+ * the channel of a wire and of the wires of a channel is measured and printed;
+ * the job fails if any of them is larger than *MaxLookupTime*.
+ *
+ * Configuration parameters
+ * =========================
+ *
+ * * *FileName* (string, mandatory): path of the channel map file to write and
+ *   read
+ * * *MaxLookupTime* (real, default: `1000`): largest average lookup time
+ *   allowed [ns]
+ */
+class geo::StandaloneChannelMapTest : public art::EDAnalyzer {
+public:
+  struct Config {
+
+    fhicl::Atom<std::string> FileName{fhicl::Name{"FileName"},
+                                      fhicl::Comment{"path of the channel map file"}};
+
+    fhicl::Atom<double> MaxLookupTime{fhicl::Name{"MaxLookupTime"},
+                                      fhicl::Comment{"largest average lookup time [ns]"},
+                                      1000.0};
+
+  }; // struct Config
+
+  using Parameters = art::EDAnalyzer::Table<Config>;
+
+  explicit StandaloneChannelMapTest(Parameters const& config);
+
+  void analyze(art::Event const&) override {}
+
+  void beginJob() override;
+
+private:
+  std::string const fFileName;
+  double const fMaxLookupTime; ///< [ns]
+
+  /// Checks `map` against `wireReadout`; throws `cet::exception` on difference.
+  void checkMap(geo::StandaloneChannelMap const& map,
+                geo::WireReadoutGeom const& wireReadout) const;
+
+  /// Measures the lookup times of `map` and checks them against the limit.
+  void timeLookups(geo::StandaloneChannelMap const& map) const;
+
+}; // class geo::StandaloneChannelMapTest
+
+// -----------------------------------------------------------------------------
+// ---  geo::StandaloneChannelMapTest implementation
+// -----------------------------------------------------------------------------
+namespace {
+
+  cet::exception fail()
+  {
+    return cet::exception("StandaloneChannelMapTest");
+  }
+
+} // local namespace
+
+// -----------------------------------------------------------------------------
+geo::StandaloneChannelMapTest::StandaloneChannelMapTest(Parameters const& config)
+  : art::EDAnalyzer{config}
+  , fFileName{config().FileName()}
+  , fMaxLookupTime{config().MaxLookupTime()}
+{}
+
+// -----------------------------------------------------------------------------
+void geo::StandaloneChannelMapTest::beginJob()
+{
+  geo::WireReadoutGeom const& wireReadout = art::ServiceHandle<geo::WireReadout const>()->Get();
+
+  geo::exportChannelMap(wireReadout).Save(fFileName);
+  geo::StandaloneChannelMap const map = geo::StandaloneChannelMap::Load(fFileName);
+
+  checkMap(map, wireReadout);
+  timeLookups(map);
+}
+
+// -----------------------------------------------------------------------------
+void geo::StandaloneChannelMapTest::checkMap(geo::StandaloneChannelMap const& map,
+                                             geo::WireReadoutGeom const& wireReadout) const
+{
+  using Map = geo::StandaloneChannelMap;
+
+  if (map.Nchannels() != wireReadout.Nchannels()) {
+    throw fail() << "Map has " << map.Nchannels() << " channels, the service "
+                 << wireReadout.Nchannels() << ".\n";
+  }
+
+  // planes and channel of each wire
+  std::vector<geo::PlaneID> planeIDs;
+  for (geo::PlaneGeo const& plane : wireReadout.Iterate<geo::PlaneGeo>()) {
+    geo::PlaneID const& id = plane.ID();
+    Map::PlaneIndex_t const index = map.PlaneIndex(id.Cryostat, id.TPC, id.Plane);
+    if (index != planeIDs.size()) {
+      throw fail() << id << " has index " << index << " in the map, " << planeIDs.size()
+                   << " expected.\n";
+    }
+    planeIDs.push_back(id);
+
+    Map::Plane const& mapPlane = map.Planes()[index];
+    if ((mapPlane.view != plane.View()) ||
+        (mapPlane.signalType != wireReadout.SignalType(id)) ||
+        (mapPlane.nWires != plane.Nwires())) {
+      throw fail() << id << " has view " << mapPlane.view << ", signal type "
+                   << mapPlane.signalType << " and " << mapPlane.nWires
+                   << " wires in the map, " << plane.View() << ", "
+                   << wireReadout.SignalType(id) << " and " << plane.Nwires()
+                   << " in the service.\n";
+    }
+
+    for (unsigned int w = 0; w < plane.Nwires(); ++w) {
+      raw::ChannelID_t const expected = wireReadout.PlaneWireToChannel(geo::WireID{id, w});
+      Map::ChannelID_t const channel = map.PlaneWireToChannel(id.Cryostat, id.TPC, id.Plane, w);
+      if (channel != expected) {
+        throw fail() << geo::WireID{id, w} << " has channel " << channel << " in the map, "
+                     << expected << " in the service.\n";
+      }
+    }
+    if (map.PlaneWireToChannel(id.Cryostat, id.TPC, id.Plane, plane.Nwires()) !=
+        Map::InvalidChannel)
+      throw fail() << "Map has a channel for wire " << plane.Nwires() << " of " << id << ".\n";
+  }
+  if (planeIDs.size() != map.Planes().size()) {
+    throw fail() << "Map has " << map.Planes().size() << " planes, the service "
+                 << planeIDs.size() << ".\n";
+  }
+
+  // wires of each channel
+  for (raw::ChannelID_t channel = 0; channel < wireReadout.Nchannels(); ++channel) {
+    std::vector<geo::WireID> expected = wireReadout.ChannelToWire(channel);
+    std::sort(expected.begin(), expected.end());
+    std::vector<geo::WireID> wires;
+    for (Map::Wire const& wire : map.ChannelToWires(channel))
+      wires.emplace_back(planeIDs[wire.plane], wire.wire);
+    if (wires != expected) {
+      throw fail() << "Channel " << channel << " has " << wires.size() << " wires in the map, "
+                   << expected.size() << " in the service.\n";
+    }
+    if (expected.empty()) continue;
+    Map::Plane const* plane = map.ChannelPlane(channel);
+    if ((plane->view != wireReadout.View(channel)) ||
+        (plane->signalType != wireReadout.SignalType(channel))) {
+      throw fail() << "Channel " << channel << " has view " << plane->view
+                   << " and signal type " << plane->signalType << " in the map, "
+                   << wireReadout.View(channel) << " and " << wireReadout.SignalType(channel)
+                   << " in the service.\n";
+    }
+  }
+  if (!map.ChannelToWires(wireReadout.Nchannels()).empty())
+    throw fail() << "Map has wires for channel " << wireReadout.Nchannels() << ".\n";
+
+  mf::LogInfo("StandaloneChannelMapTest")
+    << "Channel map '" << fFileName << "': " << map.Nchannels() << " channels, "
+    << map.Planes().size() << " planes and " << map.NWires()
+    << " wires consistent with the service";
+}
+
+// -----------------------------------------------------------------------------
+void geo::StandaloneChannelMapTest::timeLookups(geo::StandaloneChannelMap const& map) const
+{
+  using Map = geo::StandaloneChannelMap;
+  using Clock = std::chrono::steady_clock;
+  constexpr unsigned int NPasses = 10;
+
+  if ((map.NWires() == 0) || (map.Nchannels() == 0)) return;
+
+  std::uint64_t digest = 0; // keeps the lookups from being optimized away
+
+  auto const wireStart = Clock::now();
+  for (unsigned int pass = 0; pass < NPasses; ++pass) {
+    for (Map::Plane const& plane : map.Planes()) {
+      for (unsigned int w = 0; w < plane.nWires; ++w)
+        digest += map.PlaneWireToChannel(plane.cryostat, plane.tpc, plane.plane, w);
+    }
+  }
+  std::chrono::duration<double, std::nano> const wireTime = Clock::now() - wireStart;
+
+  auto const channelStart = Clock::now();
+  for (unsigned int pass = 0; pass < NPasses; ++pass) {
+    for (Map::ChannelID_t channel = 0; channel < map.Nchannels(); ++channel)
+      digest += map.ChannelToWires(channel).size();
+  }
+  std::chrono::duration<double, std::nano> const channelTime = Clock::now() - channelStart;
+
+  double const wireLookup = wireTime.count() / (double(NPasses) * map.NWires());
+  double const channelLookup = channelTime.count() / (double(NPasses) * map.Nchannels());
+  mf::LogInfo("StandaloneChannelMapTest")
+    << "Average lookup time: wire to channel " << wireLookup << " ns, channel to wires "
+    << channelLookup << " ns (digest " << digest << ")";
+
+  if ((wireLookup > fMaxLookupTime) || (channelLookup > fMaxLookupTime)) {
+    throw fail() << "Lookups take " << wireLookup << " and " << channelLookup
+                 << " ns on average, more than " << fMaxLookupTime << " ns.\n";
+  }
+}
+
+// -----------------------------------------------------------------------------
+DEFINE_ART_MODULE(geo::StandaloneChannelMapTest)
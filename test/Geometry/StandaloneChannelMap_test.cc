@@ -0,0 +1,229 @@
+/**
+ * @file   StandaloneChannelMap_test.cc
+ * @brief  Checks the lookups and the file format of the standalone channel map.
+ * @see    larcore/Geometry/StandaloneChannelMap.h
+ *
+ * A fake detector with channels shared between the induction planes of two
+ * TPCs is checked against a brute force search on its tables, before and
+ * after a round trip through a file. Invalid tables, truncated and corrupted
+ * files must be rejected.
+ *
+ * This test takes no command line argument.
+ */
+
+#define BOOST_TEST_MODULE (StandaloneChannelMap_test)
+
+// LArSoft libraries
+#include "larcore/Geometry/StandaloneChannelMap.h"
+
+// framework libraries
+#include "cetlib_except/exception.h"
+
+// Boost libraries
+#include <boost/test/unit_test.hpp>
+
+// C/C++ standard libraries
+#include <cstdio> // std::remove()
+#include <span>
+#include <sstream>
+#include <string>
+#include <utility> // std::move(), std::swap()
+#include <vector>
+
+namespace {
+
+  using Map = geo::StandaloneChannelMap;
+
+  /*
+   * Cryostat 0 has two TPCs of three planes; their induction planes (0 and 1)
+   * share the channels, and the last wire of each collection plane is not read
+   * out. Cryostat 1 has a single TPC with two planes.
+   */
+  Map::Tables fakeTables()
+  {
+    Map::Tables tables;
+    auto addPlane = [&tables](std::uint32_t c, std::uint32_t t, std::uint32_t p, int view,
+                              int sigType, std::uint32_t nWires) {
+      tables.planes.push_back({c,
+                               t,
+                               p,
+                               view,
+                               sigType,
+                               nWires,
+                               static_cast<std::uint32_t>(tables.wireChannels.size())});
+    };
+
+    Map::ChannelID_t const collection[2] = {300, 340};
+    for (std::uint32_t t = 0; t < 2; ++t) {
+      addPlane(0, t, 0, 0, 0, 100);
+      for (std::uint32_t w = 0; w < 100; ++w)
+        tables.wireChannels.push_back(w);
+      addPlane(0, t, 1, 1, 0, 200);
+      for (std::uint32_t w = 0; w < 200; ++w)
+        tables.wireChannels.push_back(100 + (w + 50 * t) % 200);
+      addPlane(0, t, 2, 2, 1, 41);
+      for (std::uint32_t w = 0; w < 40; ++w)
+        tables.wireChannels.push_back(collection[t] + w);
+      tables.wireChannels.push_back(Map::InvalidChannel);
+    }
+    addPlane(1, 0, 0, 0, 0, 20);
+    for (std::uint32_t w = 0; w < 20; ++w)
+      tables.wireChannels.push_back(380 + w);
+    addPlane(1, 0, 1, 2, 1, 20);
+    for (std::uint32_t w = 0; w < 20; ++w)
+      tables.wireChannels.push_back(400 + w);
+
+    tables.nChannels = 420;
+    return tables;
+  }
+
+  // checks all the lookups of `map` against a brute force search on `tables`
+  void checkMap(Map const& map, Map::Tables const& tables)
+  {
+    BOOST_TEST(map.Nchannels() == tables.nChannels);
+    BOOST_TEST(map.Planes().size() == tables.planes.size());
+    BOOST_TEST(map.NWires() == tables.wireChannels.size());
+
+    std::vector<std::vector<Map::Wire>> expected(tables.nChannels);
+    for (Map::PlaneIndex_t i = 0; i < tables.planes.size(); ++i) {
+      Map::Plane const& plane = tables.planes[i];
+      BOOST_TEST(map.PlaneIndex(plane.cryostat, plane.tpc, plane.plane) == i);
+      Map::Plane const* found = map.FindPlane(plane.cryostat, plane.tpc, plane.plane);
+      BOOST_TEST_REQUIRE(found);
+      BOOST_TEST(found->view == plane.view);
+      BOOST_TEST(found->signalType == plane.signalType);
+      BOOST_TEST(found->nWires == plane.nWires);
+      for (std::uint32_t w = 0; w < plane.nWires; ++w) {
+        Map::ChannelID_t const channel = tables.wireChannels[plane.firstWire + w];
+        BOOST_TEST(map.PlaneWireToChannel(plane.cryostat, plane.tpc, plane.plane, w) == channel);
+        BOOST_TEST(map.WireToChannel({i, w}) == channel);
+        if (channel != Map::InvalidChannel) expected[channel].push_back({i, w});
+      }
+      BOOST_TEST(map.PlaneWireToChannel(plane.cryostat, plane.tpc, plane.plane, plane.nWires) ==
+                 Map::InvalidChannel);
+    }
+
+    for (Map::ChannelID_t channel = 0; channel < tables.nChannels; ++channel) {
+      std::span<Map::Wire const> const wires = map.ChannelToWires(channel);
+      BOOST_TEST(std::vector<Map::Wire>(wires.begin(), wires.end()) == expected[channel]);
+      Map::Plane const* plane = map.ChannelPlane(channel);
+      BOOST_TEST(plane == (expected[channel].empty() ?
+                             nullptr :
+                             &map.Planes()[expected[channel].front().plane]));
+    }
+
+    BOOST_TEST(map.ChannelToWires(tables.nChannels).empty());
+    BOOST_TEST(map.ChannelToWires(Map::InvalidChannel).empty());
+    BOOST_TEST(!map.ChannelPlane(tables.nChannels));
+    BOOST_TEST(!map.FindPlane(2, 0, 0));
+    BOOST_TEST(!map.FindPlane(0, 2, 0));
+    BOOST_TEST(!map.FindPlane(1, 0, 2));
+    BOOST_TEST(map.PlaneIndex(1, 1, 0) == Map::NoPlane);
+    BOOST_TEST(map.WireToChannel({Map::PlaneIndex_t(tables.planes.size()), 0}) ==
+               Map::InvalidChannel);
+  }
+
+  // returns whether reading `data` throws `cet::exception`
+  bool rejected(std::string const& data)
+  {
+    std::istringstream in{data};
+    try {
+      Map::Read(in);
+    }
+    catch (cet::exception const&) {
+      return true;
+    }
+    return false;
+  }
+
+  // returns whether building a map from `tables` throws `cet::exception`
+  bool rejected(Map::Tables tables)
+  {
+    try {
+      Map{std::move(tables)};
+    }
+    catch (cet::exception const&) {
+      return true;
+    }
+    return false;
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(Lookup_test)
+{
+  Map::Tables const tables = fakeTables();
+  Map const map{tables};
+  checkMap(map, tables);
+
+  // wrapped induction wires: channel 100 is read by wire 0 of TPC 0 and wire
+  // 150 of TPC 1 (planes 1 and 4)
+  std::span<Map::Wire const> const wires = map.ChannelToWires(100);
+  BOOST_TEST_REQUIRE(wires.size() == 2U);
+  BOOST_TEST((wires[0] == Map::Wire{1, 0}));
+  BOOST_TEST((wires[1] == Map::Wire{4, 150}));
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(RoundTrip_test)
+{
+  std::string const path = "StandaloneChannelMap_test.bin";
+  std::remove(path.c_str());
+
+  Map::Tables const tables = fakeTables();
+  Map{tables}.Save(path);
+  checkMap(Map::Load(path), tables);
+
+  BOOST_CHECK_THROW(Map::Load("StandaloneChannelMap_test_missing.bin"), cet::exception);
+  std::remove(path.c_str());
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(CorruptedFile_test)
+{
+  std::ostringstream out;
+  Map{fakeTables()}.Write(out);
+  std::string const data = out.str();
+  BOOST_TEST(!rejected(data));
+
+  BOOST_TEST(rejected(""));
+  BOOST_TEST(rejected("LARSORTP" + data.substr(8)));   // wrong magic
+  BOOST_TEST(rejected(data.substr(0, data.size() - 1))); // truncated checksum
+  BOOST_TEST(rejected(data.substr(0, 30)));              // truncated tables
+
+  std::string flipped = data;
+  flipped[flipped.size() / 2] ^= 0x10; // corrupted table
+  BOOST_TEST(rejected(flipped));
+
+  std::string huge = data;
+  huge[24] = huge[25] = huge[26] = huge[27] = '\xff'; // wire count
+  BOOST_TEST(rejected(huge));
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(InvalidTables_test)
+{
+  BOOST_TEST(!rejected(Map::Tables{}));
+
+  Map::Tables tables = fakeTables();
+  tables.nChannels = 400; // channels of cryostat 1 out of range
+  BOOST_TEST(rejected(tables));
+
+  tables = fakeTables();
+  std::swap(tables.planes[0], tables.planes[1]); // not sorted
+  BOOST_TEST(rejected(tables));
+
+  tables = fakeTables();
+  tables.planes.back().plane = 2; // gap in the plane numbers
+  BOOST_TEST(rejected(tables));
+
+  tables = fakeTables();
+  for (Map::Plane& plane : tables.planes)
+    if (plane.cryostat == 1) plane.cryostat = 2; // gap in the cryostat numbers
+  BOOST_TEST(rejected(tables));
+
+  tables = fakeTables();
+  tables.wireChannels.pop_back(); // wire table too short
+  BOOST_TEST(rejected(tables));
+}
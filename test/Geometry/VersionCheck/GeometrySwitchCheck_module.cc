@@ -0,0 +1,134 @@
+/**
+ * @file   GeometrySwitchCheck_module.cc
+ * @brief  Verifies that `GeometrySwitcher` serves the geometry of each run.
+ * @see    larcore/Geometry/GeometrySwitcher.h
+ */
+
+// LArSoft libraries
+#include "larcore/Geometry/GeometrySwitcher.h"
+#include "larcoreobj/SummaryData/GeometryConfigurationInfo.h"
+
+// framework libraries
+#include "art/Framework/Core/EDAnalyzer.h"
+#include "art/Framework/Core/ModuleMacros.h"
+#include "art/Framework/Principal/Event.h"
+#include "art/Framework/Principal/Handle.h"
+#include "art/Framework/Principal/Run.h"
+#include "art/Framework/Services/Registry/ServiceHandle.h"
+#include "canvas/Utilities/InputTag.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/types/Atom.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+// ROOT libraries
+#include "TGeoManager.h"
+
+// C/C++ standard library
+#include <string>
+
+// -----------------------------------------------------------------------------
+namespace geo {
+  class GeometrySwitchCheck;
+}
+/**
+ * @brief Checks at each run and event that the served geometry is the run one.
+ *
+ * The name of the detector served by `GeometrySwitcher` is compared with the
+ * one in the geometry information of the run. At the end of the job, the
+ * number of geometries built by the service is compared with the expected one.
+ *
+ * Configuration parameters
+ * =========================
+ *
+ * * *ExpectedBuilds* (integer, mandatory): number of geometries the service
+ *   is expected to have built by the end of the job
+ */
+class geo::GeometrySwitchCheck : public art::EDAnalyzer {
+public:
+  struct Config {
+
+    fhicl::Atom<unsigned int> ExpectedBuilds{
+      fhicl::Name{"ExpectedBuilds"},
+      fhicl::Comment{"Number of geometries expected to be built in the job"}};
+
+  }; // struct Config
+
+  using Parameters = art::EDAnalyzer::Table<Config>;
+
+  explicit GeometrySwitchCheck(Parameters const& config);
+
+  void beginRun(art::Run const& run) override;
+
+  void analyze(art::Event const& event) override;
+
+  void endJob() override;
+
+private:
+  unsigned int const fExpectedBuilds; ///< Geometries expected to be built.
+
+  std::string fRunDetectorName; ///< Detector name from the current run.
+
+  /// Throws if the served geometry is not `fRunDetectorName`.
+  void checkCurrentGeometry(std::string const& where) const;
+
+}; // class geo::GeometrySwitchCheck
+
+// -----------------------------------------------------------------------------
+// ---  geo::GeometrySwitchCheck implementation
+// -----------------------------------------------------------------------------
+geo::GeometrySwitchCheck::GeometrySwitchCheck(Parameters const& config)
+  : art::EDAnalyzer(config), fExpectedBuilds(config().ExpectedBuilds())
+{
+  consumes<sumdata::GeometryConfigurationInfo, art::InRun>(
+    art::InputTag{"GeometryConfigurationWriter"});
+}
+
+// -----------------------------------------------------------------------------
+void geo::GeometrySwitchCheck::beginRun(art::Run const& run)
+{
+  fRunDetectorName =
+    run.getProduct<sumdata::GeometryConfigurationInfo>(art::InputTag{"GeometryConfigurationWriter"})
+      .detectorName;
+  mf::LogInfo("GeometrySwitchCheck")
+    << run.id() << " recorded with geometry '" << fRunDetectorName << "'";
+  checkCurrentGeometry("beginning of run " + std::to_string(run.run()));
+}
+
+// -----------------------------------------------------------------------------
+void geo::GeometrySwitchCheck::analyze(art::Event const& event)
+{
+  checkCurrentGeometry("event " + std::to_string(event.event()));
+}
+
+// -----------------------------------------------------------------------------
+void geo::GeometrySwitchCheck::endJob()
+{
+  auto const& cache = art::ServiceHandle<geo::GeometrySwitcher const>()->cache();
+  mf::LogInfo("GeometrySwitchCheck")
+    << "Geometries built: " << cache.misses() << ", reused: " << cache.hits();
+  if (cache.misses() != fExpectedBuilds) {
+    throw cet::exception("GeometrySwitchCheck")
+      << cache.misses() << " geometries built, " << fExpectedBuilds << " expected.\n";
+  }
+}
+
+// -----------------------------------------------------------------------------
+void geo::GeometrySwitchCheck::checkCurrentGeometry(std::string const& where) const
+{
+  art::ServiceHandle<geo::GeometrySwitcher const> switcher;
+  auto const current = switcher->current();
+  if (current->geom->DetectorName() != fRunDetectorName) {
+    throw cet::exception("GeometrySwitchCheck")
+      << "Geometry '" << current->geom->DetectorName() << "' served at " << where << ", '"
+      << fRunDetectorName << "' expected.\n";
+  }
+  if (current->manager != gGeoManager) {
+    throw cet::exception("GeometrySwitchCheck")
+      << "ROOT geometry at " << where << " is not the one of '" << fRunDetectorName << "'.\n";
+  }
+}
+
+// -----------------------------------------------------------------------------
+DEFINE_ART_MODULE(geo::GeometrySwitchCheck)
+
+// -----------------------------------------------------------------------------
@@ -0,0 +1,204 @@
+/**
+ * @file   VoxelReadoutMapTest_module.cc
+ * @brief  Checks the readout voxel map against the direct geometry queries.
+ * @see    larcore/Geometry/VoxelReadoutMap.h
+ */
+
+// LArSoft libraries
+#include "larcore/Geometry/Geometry.h"
+#include "larcore/Geometry/VoxelReadoutMap.h"
+#include "larcore/Geometry/WireReadout.h"
+#include "larcorealg/Geometry/BoxBoundedGeo.h"
+#include "larcorealg/Geometry/TPCGeo.h"
+#include "larcorealg/Geometry/WireReadoutGeom.h"
+#include "larcoreobj/SimpleTypesAndConstants/RawTypes.h"
+#include "larcoreobj/SimpleTypesAndConstants/geo_types.h"
+
+// framework libraries
+#include "art/Framework/Core/EDAnalyzer.h"
+#include "art/Framework/Core/ModuleMacros.h"
+#include "art/Framework/Services/Registry/ServiceHandle.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/types/Atom.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+// C/C++ standard libraries
+#include <algorithm> // std::min(), std::max()
+#include <chrono>
+#include <limits>
+#include <random>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+namespace geo {
+  class VoxelReadoutMapTest;
+}
+/**
+ * @brief Compares the readout voxel map with the direct geometry queries.
+ *
+ * The `geo::WireReadout` service must be configured to build the voxel map
+ * (e.g. `StandardWireReadout` with `ReadoutVoxelSize`). At the beginning of
+ * the job, random points are generated in a box 20% larger than all the TPC
+ * active volumes, and for each of them:
+ *
+ * * the TPC from the map must be the one from `PositionToTPCID()` if its
+ *   active volume contains the point, and invalid otherwise;
+ * * the nearest wire and channel of each plane must be the ones from
+ *   `NearestWireID()` and `PlaneWireToChannel()` (points beyond the wires of
+ *   a plane, where `NearestWireID()` throws, are skipped).
+ *
+ * The time taken by the map and by the direct queries is also reported.
+ * The job fails at the first difference.
+ *
+ * Configuration parameters
+ * =========================
+ *
+ * * *Points* (integer, default: `1000000`): number of random points
+ * * *Seed* (integer, default: `12345`): seed of the random generator
+ */
+class geo::VoxelReadoutMapTest : public art::EDAnalyzer {
+public:
+  struct Config {
+
+    fhicl::Atom<unsigned int> Points{fhicl::Name{"Points"},
+                                     fhicl::Comment{"Number of random points"},
+                                     1000000U};
+
+    fhicl::Atom<unsigned int> Seed{fhicl::Name{"Seed"},
+                                   fhicl::Comment{"Seed of the random generator"},
+                                   12345U};
+
+  }; // struct Config
+
+  using Parameters = art::EDAnalyzer::Table<Config>;
+
+  explicit VoxelReadoutMapTest(Parameters const& config);
+
+  void analyze(art::Event const&) override {}
+
+  void beginJob() override;
+
+private:
+  unsigned int const fNPoints;
+  unsigned int const fSeed;
+
+}; // class geo::VoxelReadoutMapTest
+
+// -----------------------------------------------------------------------------
+// ---  geo::VoxelReadoutMapTest implementation
+// -----------------------------------------------------------------------------
+namespace {
+
+  /// Readout of a point: its TPC and the nearest channel of each plane.
+  struct PointReadout {
+    geo::TPCID tpc;
+    std::vector<raw::ChannelID_t> channels;
+  };
+
+} // local namespace
+
+// -----------------------------------------------------------------------------
+geo::VoxelReadoutMapTest::VoxelReadoutMapTest(Parameters const& config)
+  : art::EDAnalyzer{config}, fNPoints{config().Points()}, fSeed{config().Seed()}
+{}
+
+// -----------------------------------------------------------------------------
+void geo::VoxelReadoutMapTest::beginJob()
+{
+  using Clock_t = std::chrono::steady_clock;
+
+  geo::Geometry const& geom = *art::ServiceHandle<geo::Geometry const>();
+  geo::WireReadout const& wireReadout = *art::ServiceHandle<geo::WireReadout const>();
+  geo::WireReadoutGeom const& wireReadoutGeom = wireReadout.Get();
+  geo::VoxelReadoutMap const* voxelMap = wireReadout.VoxelMap();
+  if (!voxelMap) {
+    throw cet::exception("VoxelReadoutMapTest")
+      << "The WireReadout service does not provide a voxel map (set ReadoutVoxelSize).\n";
+  }
+
+  // random points around all the active volumes
+  double const inf = std::numeric_limits<double>::max();
+  double min[3] = {inf, inf, inf}, max[3] = {-inf, -inf, -inf};
+  for (geo::TPCGeo const& tpc : geom.Iterate<geo::TPCGeo>()) {
+    auto const& box = tpc.ActiveBoundingBox();
+    min[0] = std::min(min[0], box.MinX());
+    min[1] = std::min(min[1], box.MinY());
+    min[2] = std::min(min[2], box.MinZ());
+    max[0] = std::max(max[0], box.MaxX());
+    max[1] = std::max(max[1], box.MaxY());
+    max[2] = std::max(max[2], box.MaxZ());
+  }
+  std::mt19937 rng{fSeed};
+  std::uniform_real_distribution<double> uniform{-0.1, 1.1};
+  std::vector<geo::Point_t> points;
+  points.reserve(fNPoints);
+  for (unsigned int i = 0; i < fNPoints; ++i) {
+    points.emplace_back(min[0] + uniform(rng) * (max[0] - min[0]),
+                        min[1] + uniform(rng) * (max[1] - min[1]),
+                        min[2] + uniform(rng) * (max[2] - min[2]));
+  }
+
+  // direct path; raw::InvalidChannelID where NearestWireID() throws
+  std::vector<PointReadout> direct(points.size());
+  auto const directStart = Clock_t::now();
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    geo::TPCID const tpcID = geom.PositionToTPCID(points[i]);
+    if (!tpcID || !geom.TPC(tpcID).ActiveBoundingBox().ContainsPosition(points[i])) continue;
+    direct[i].tpc = tpcID;
+    for (unsigned int p = 0; p < wireReadoutGeom.Nplanes(tpcID); ++p) {
+      raw::ChannelID_t channel = raw::InvalidChannelID;
+      try {
+        channel = wireReadoutGeom.PlaneWireToChannel(
+          wireReadoutGeom.NearestWireID(points[i], geo::PlaneID{tpcID, p}));
+      }
+      catch (cet::exception const&) {
+      }
+      direct[i].channels.push_back(channel);
+    }
+  }
+  std::chrono::duration<double> const directTime = Clock_t::now() - directStart;
+
+  // voxel map
+  std::vector<PointReadout> mapped(points.size());
+  auto const mapStart = Clock_t::now();
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    geo::VoxelReadoutMap::Location const location = voxelMap->Locate(points[i]);
+    if (!location) continue;
+    mapped[i].tpc = location.TPC();
+    for (unsigned int p = 0; p < location.Nplanes(); ++p)
+      mapped[i].channels.push_back(location.NearestChannel(p));
+  }
+  std::chrono::duration<double> const mapTime = Clock_t::now() - mapStart;
+
+  // comparison
+  std::size_t nInside = 0, nChannels = 0;
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    if (mapped[i].tpc != direct[i].tpc) {
+      throw cet::exception("VoxelReadoutMapTest")
+        << "Point #" << i << " " << points[i] << " is in " << mapped[i].tpc << " for the map, in "
+        << direct[i].tpc << " for the direct queries.\n";
+    }
+    if (!direct[i].tpc) continue;
+    ++nInside;
+    for (unsigned int p = 0; p < direct[i].channels.size(); ++p) {
+      if (direct[i].channels[p] == raw::InvalidChannelID) continue; // beyond the wires
+      if (mapped[i].channels[p] != direct[i].channels[p]) {
+        throw cet::exception("VoxelReadoutMapTest")
+          << "Point #" << i << " " << points[i] << " on " << geo::PlaneID{direct[i].tpc, p}
+          << ": channel " << mapped[i].channels[p] << " from the map, "
+          << direct[i].channels[p] << " from the direct queries.\n";
+      }
+      ++nChannels;
+    }
+  }
+
+  mf::LogInfo("VoxelReadoutMapTest")
+    << points.size() << " points (" << nInside << " in active volumes), " << nChannels
+    << " channels match; voxels of " << voxelMap->VoxelSize() << " cm, "
+    << (voxelMap->MemoryUsage() / 1024) << " KiB"
+    << "\n  direct queries: " << directTime.count() << " s"
+    << "\n  voxel map:      " << mapTime.count() << " s";
+}
+
+// -----------------------------------------------------------------------------
+DEFINE_ART_MODULE(geo::VoxelReadoutMapTest)
@@ -0,0 +1,168 @@
+/**
+ * @file   WireArenaBenchmark_module.cc
+ * @brief  Times loops on all wires, with and without the contiguous wire arena.
+ * @see    larcore/Geometry/WireArena.h
+ */
+
+// LArSoft libraries
+#include "larcore/Geometry/WireArena.h"
+#include "larcore/Geometry/WireReadout.h"
+#include "larcorealg/Geometry/WireGeo.h"
+#include "larcorealg/Geometry/WireReadoutGeom.h"
+#include "larcoreobj/SimpleTypesAndConstants/geo_types.h"
+
+// framework libraries
+#include "art/Framework/Core/EDAnalyzer.h"
+#include "art/Framework/Core/ModuleMacros.h"
+#include "art/Framework/Services/Registry/ServiceHandle.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/types/Atom.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+// C/C++ standard libraries
+#include <chrono>
+#include <string>
+
+// -----------------------------------------------------------------------------
+namespace geo {
+  class WireArenaBenchmark;
+}
+/**
+ * @brief Compares loops on all wires with and without `geo::WireArena`.
+ *
+ * At the beginning of the job, the same sum of wire coordinates is computed
+ * `Repetitions` times with each of the following loops:
+ *
+ * * `Iterate<geo::WireGeo>()` of `geo::WireReadoutGeom`;
+ * * `Iterate<geo::WireID>()`, then `Wire(wireID)` (as in
+ *   `GeometryIteratorLoopTest`);
+ * * all the wires of the arena;
+ * * the wires of the arena, plane by plane.
+ *
+ * The time per wire of each loop is printed (`WireArenaBenchmark` category),
+ * and the job fails if the sums differ. The wire readout service must build
+ * the arena (e.g. `ContiguousWires: true` for `StandardWireReadout`).
+ *
+ * Configuration parameters
+ * =========================
+ *
+ * * *Repetitions* (integer, default: `20`): times each loop is run
+ */
+class geo::WireArenaBenchmark : public art::EDAnalyzer {
+public:
+  struct Config {
+
+    fhicl::Atom<unsigned int> Repetitions{fhicl::Name{"Repetitions"},
+                                          fhicl::Comment{"Times each loop is run"},
+                                          20U};
+
+  }; // struct Config
+
+  using Parameters = art::EDAnalyzer::Table<Config>;
+
+  explicit WireArenaBenchmark(Parameters const& config);
+
+  void analyze(art::Event const&) override {}
+
+  void beginJob() override;
+
+private:
+  unsigned int const fRepetitions;
+
+  /// Runs `loop` `fRepetitions` times, prints its timing and returns its result.
+  template <typename Loop>
+  double timeLoop(std::string const& name, std::size_t nWires, Loop loop) const;
+
+}; // class geo::WireArenaBenchmark
+
+// -----------------------------------------------------------------------------
+// ---  geo::WireArenaBenchmark implementation
+// -----------------------------------------------------------------------------
+namespace {
+
+  double wireValue(geo::WireGeo const& wire)
+  {
+    auto const center = wire.GetCenter();
+    return center.X() + center.Y() + center.Z() + wire.HalfL();
+  }
+
+} // local namespace
+
+// -----------------------------------------------------------------------------
+geo::WireArenaBenchmark::WireArenaBenchmark(Parameters const& config)
+  : art::EDAnalyzer{config}, fRepetitions{config().Repetitions()}
+{}
+
+// -----------------------------------------------------------------------------
+void geo::WireArenaBenchmark::beginJob()
+{
+  geo::WireReadout const& service = *art::ServiceHandle<geo::WireReadout const>();
+  geo::WireReadoutGeom const& wireReadout = service.Get();
+  geo::WireArena const* arena = service.Arena();
+  if (!arena) {
+    throw cet::exception("WireArenaBenchmark")
+      << "The wire readout service does not provide a wire arena"
+         " (is `ContiguousWires` enabled?).\n";
+  }
+  std::size_t const nWires = arena->NWires();
+
+  double const iterateWires = timeLoop("Iterate<WireGeo>", nWires, [&wireReadout]() {
+    double sum = 0.0;
+    for (geo::WireGeo const& wire : wireReadout.Iterate<geo::WireGeo>())
+      sum += wireValue(wire);
+    return sum;
+  });
+
+  double const iterateIDs = timeLoop("Iterate<WireID> + Wire()", nWires, [&wireReadout]() {
+    double sum = 0.0;
+    for (geo::WireID const& wireID : wireReadout.Iterate<geo::WireID>())
+      sum += wireValue(wireReadout.Wire(wireID));
+    return sum;
+  });
+
+  double const arenaWires = timeLoop("arena", nWires, [arena]() {
+    double sum = 0.0;
+    for (geo::WireGeo const& wire : arena->Wires())
+      sum += wireValue(wire);
+    return sum;
+  });
+
+  double const arenaPlanes = timeLoop("arena by plane", nWires, [arena]() {
+    double sum = 0.0;
+    for (geo::WireArena::PlaneEntry const& plane : arena->Planes()) {
+      for (geo::WireGeo const& wire : arena->Wires(plane.ID))
+        sum += wireValue(wire);
+    }
+    return sum;
+  });
+
+  if ((iterateIDs != iterateWires) || (arenaWires != iterateWires) ||
+      (arenaPlanes != iterateWires)) {
+    throw cet::exception("WireArenaBenchmark")
+      << "Loops on the same wires give different results: " << iterateWires
+      << " (Iterate<WireGeo>), " << iterateIDs << " (Iterate<WireID>), " << arenaWires
+      << " (arena), " << arenaPlanes << " (arena by plane).\n";
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <typename Loop>
+double geo::WireArenaBenchmark::timeLoop(std::string const& name,
+                                         std::size_t nWires,
+                                         Loop loop) const
+{
+  double result = loop(); // warm up
+  auto const start = std::chrono::steady_clock::now();
+  for (unsigned int iRep = 0; iRep < fRepetitions; ++iRep)
+    result = loop();
+  std::chrono::duration<double, std::nano> const elapsed =
+    std::chrono::steady_clock::now() - start;
+
+  mf::LogInfo("WireArenaBenchmark")
+    << name << ": " << (elapsed.count() / (double(fRepetitions) * nWires)) << " ns/wire ("
+    << nWires << " wires, " << fRepetitions << " repetitions)";
+  return result;
+}
+
+// -----------------------------------------------------------------------------
+DEFINE_ART_MODULE(geo::WireArenaBenchmark)
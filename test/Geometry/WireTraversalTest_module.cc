@@ -0,0 +1,227 @@
+/**
+ * @file   WireTraversalTest_module.cc
+ * @brief  Checks the wire traversal of segments against stepping along them.
+ * @see    larcore/Geometry/WireTraversal.h
+ */
+
+// LArSoft libraries
+#include "larcore/Geometry/Geometry.h"
+#include "larcore/Geometry/WireReadout.h"
+#include "larcore/Geometry/WireTraversal.h"
+#include "larcorealg/Geometry/BoxBoundedGeo.h"
+#include "larcorealg/Geometry/PlaneGeo.h"
+#include "larcorealg/Geometry/TPCGeo.h"
+#include "larcorealg/Geometry/WireReadoutGeom.h"
+#include "larcoreobj/SimpleTypesAndConstants/geo_types.h"
+
+// framework libraries
+#include "art/Framework/Core/EDAnalyzer.h"
+#include "art/Framework/Core/ModuleMacros.h"
+#include "art/Framework/Services/Registry/ServiceHandle.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/types/Atom.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+// C/C++ standard libraries
+#include <cmath> // std::abs(), std::lround()
+#include <random>
+#include <set>
+#include <span>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+namespace geo {
+  class WireTraversalTest;
+}
+/**
+ * @brief Compares the wire traversal of random segments with stepping along them.
+ *
+ * At the beginning of the job, random segments are generated in a box 40%
+ * larger than the active volume of each TPC (so that many cross its borders),
+ * and traversed on each plane of the TPC with `geo::TraverseWires()`.
+ * For each segment:
+ *
+ * * the crossed wires must be consecutive, in the order of the segment, with
+ *   each cell starting where the previous one ends, all within the TPC;
+ * * the middle of each crossing must be closest to its wire;
+ * * every wire found stepping along the segment (in *Steps* steps) in the
+ *   active volume must be in the traversal;
+ * * the batched traversal of all the segments must give the same result.
+ *
+ * Some segments are parallel to the drift direction, and some have zero length.
+ * The job fails at the first difference.
+ *
+ * Configuration parameters
+ * =========================
+ *
+ * * *Segments* (integer, default: `200`): random segments on each plane
+ * * *Steps* (integer, default: `10000`): steps along each segment
+ * * *Seed* (integer, default: `12345`): seed of the random generator
+ */
+class geo::WireTraversalTest : public art::EDAnalyzer {
+public:
+  struct Config {
+
+    fhicl::Atom<unsigned int> Segments{fhicl::Name{"Segments"},
+                                       fhicl::Comment{"Random segments on each plane"},
+                                       200U};
+
+    fhicl::Atom<unsigned int> Steps{fhicl::Name{"Steps"},
+                                    fhicl::Comment{"Steps along each segment"},
+                                    10000U};
+
+    fhicl::Atom<unsigned int> Seed{fhicl::Name{"Seed"},
+                                   fhicl::Comment{"Seed of the random generator"},
+                                   12345U};
+
+  }; // struct Config
+
+  using Parameters = art::EDAnalyzer::Table<Config>;
+
+  explicit WireTraversalTest(Parameters const& config);
+
+  void analyze(art::Event const&) override {}
+
+  void beginJob() override;
+
+private:
+  unsigned int const fNSegments;
+  unsigned int const fNSteps;
+  unsigned int const fSeed;
+
+  /// Checks `traversal` of `segment` on `plane` of `tpc`.
+  void checkTraversal(TPCGeo const& tpc,
+                      PlaneGeo const& plane,
+                      Segment const& segment,
+                      WireTraversal const& traversal) const;
+
+}; // class geo::WireTraversalTest
+
+// -----------------------------------------------------------------------------
+// ---  geo::WireTraversalTest implementation
+// -----------------------------------------------------------------------------
+geo::WireTraversalTest::WireTraversalTest(Parameters const& config)
+  : art::EDAnalyzer{config}
+  , fNSegments{config().Segments()}
+  , fNSteps{config().Steps()}
+  , fSeed{config().Seed()}
+{}
+
+// -----------------------------------------------------------------------------
+void geo::WireTraversalTest::beginJob()
+{
+  geo::Geometry const& geom = *art::ServiceHandle<geo::Geometry const>();
+  geo::WireReadout const& wireReadout = *art::ServiceHandle<geo::WireReadout const>();
+  geo::WireReadoutGeom const& wireReadoutGeom = wireReadout.Get();
+
+  std::mt19937 rng{fSeed};
+  std::uniform_real_distribution<double> uniform{-0.2, 1.2};
+
+  std::size_t nSegments = 0, nCrossings = 0;
+  for (geo::TPCGeo const& tpc : geom.Iterate<geo::TPCGeo>()) {
+    geo::BoxBoundedGeo const& box = tpc.ActiveBoundingBox();
+    auto randomPoint = [&box, &rng, &uniform]() {
+      return geo::Point_t{box.MinX() + uniform(rng) * (box.MaxX() - box.MinX()),
+                          box.MinY() + uniform(rng) * (box.MaxY() - box.MinY()),
+                          box.MinZ() + uniform(rng) * (box.MaxZ() - box.MinZ())};
+    };
+
+    for (unsigned int p = 0; p < wireReadoutGeom.Nplanes(tpc.ID()); ++p) {
+      geo::PlaneID const planeID{tpc.ID(), p};
+      geo::PlaneGeo const& plane = wireReadoutGeom.Plane(planeID);
+
+      std::vector<geo::Segment> segments;
+      for (unsigned int i = 0; i < fNSegments; ++i) {
+        geo::Segment segment{randomPoint(), randomPoint()};
+        if (i % 20 == 0) segment.end = segment.start; // zero length
+        if (i % 20 == 1) segment.end.SetY(segment.start.Y()).SetZ(segment.start.Z()); // along x
+        segments.push_back(segment);
+      }
+
+      std::vector<geo::WireTraversal> const batch =
+        geo::TraverseWires(tpc, plane, std::span<geo::Segment const>{segments});
+      for (std::size_t i = 0; i < segments.size(); ++i) {
+        geo::WireTraversal const traversal = geo::TraverseWires(tpc, plane, segments[i]);
+        checkTraversal(tpc, plane, segments[i], traversal);
+
+        std::vector<geo::WireCrossing> const& batchWires = batch[i].wires;
+        bool same = (batchWires.size() == traversal.wires.size()) &&
+                    (batch[i].tpcEntry == traversal.tpcEntry) &&
+                    (batch[i].tpcExit == traversal.tpcExit);
+        for (std::size_t j = 0; same && (j < batchWires.size()); ++j) {
+          same = (batchWires[j].wire == traversal.wires[j].wire) &&
+                 (batchWires[j].entry == traversal.wires[j].entry) &&
+                 (batchWires[j].exit == traversal.wires[j].exit);
+        }
+        if (!same) {
+          throw cet::exception("WireTraversalTest")
+            << "Segment #" << i << " on " << planeID
+            << ": batched traversal differs from the single one.\n";
+        }
+        nCrossings += traversal.wires.size();
+      }
+      nSegments += segments.size();
+    }
+  }
+
+  mf::LogInfo("WireTraversalTest") << nSegments << " segments checked, crossing " << nCrossings
+                                   << " wire cells in total";
+}
+
+// -----------------------------------------------------------------------------
+void geo::WireTraversalTest::checkTraversal(TPCGeo const& tpc,
+                                            PlaneGeo const& plane,
+                                            Segment const& segment,
+                                            WireTraversal const& traversal) const
+{
+  constexpr double tolerance = 1e-9;
+  auto fail = [&plane]() -> cet::exception {
+    return cet::exception("WireTraversalTest") << "Traversal on " << plane.ID() << ": ";
+  };
+
+  // structure of the traversal
+  WireCrossing const* previous = nullptr;
+  for (WireCrossing const& crossing : traversal.wires) {
+    if ((crossing.entry < traversal.tpcEntry - tolerance) ||
+        (crossing.exit > traversal.tpcExit + tolerance) || (crossing.exit < crossing.entry)) {
+      throw fail() << crossing.wire << " crossed in [ " << crossing.entry << " ; "
+                   << crossing.exit << " ], out of the TPC range [ " << traversal.tpcEntry
+                   << " ; " << traversal.tpcExit << " ].\n";
+    }
+    if (previous) {
+      long const gap = static_cast<long>(crossing.wire.Wire) - previous->wire.Wire;
+      if ((std::abs(gap) != 1) || (std::abs(crossing.entry - previous->exit) > tolerance)) {
+        throw fail() << crossing.wire << " does not follow " << previous->wire << ".\n";
+      }
+    }
+    if (crossing.fraction() > tolerance) {
+      double const middle = (crossing.entry + crossing.exit) / 2.0;
+      long const nearest = std::lround(plane.WireCoordinate(segment.at(middle)));
+      if (nearest != static_cast<long>(crossing.wire.Wire)) {
+        throw fail() << "the middle of the crossing of " << crossing.wire
+                     << " is closest to wire " << nearest << ".\n";
+      }
+    }
+    previous = &crossing;
+  }
+
+  // every wire met stepping along the segment must be there
+  std::set<geo::WireID::WireID_t> crossed;
+  for (WireCrossing const& crossing : traversal.wires)
+    crossed.insert(crossing.wire.Wire);
+
+  geo::BoxBoundedGeo const& box = tpc.ActiveBoundingBox();
+  for (unsigned int step = 0; step <= fNSteps; ++step) {
+    geo::Point_t const point = segment.at(static_cast<double>(step) / fNSteps);
+    if (!box.ContainsPosition(point)) continue;
+    if (!traversal.crossesTPC) throw fail() << "segment in the TPC reported outside of it.\n";
+    long const wire = std::lround(plane.WireCoordinate(point));
+    if ((wire < 0) || (wire >= static_cast<long>(plane.Nwires()))) continue;
+    if (crossed.count(wire) == 0) {
+      throw fail() << "wire " << wire << " is crossed at step " << step << " but not reported.\n";
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+DEFINE_ART_MODULE(geo::WireTraversalTest)
@@ -0,0 +1,250 @@
+/**
+ * @file   replay_geometry_queries.cc
+ * @brief  Replays a trace of geometry queries, reporting the throughput.
+ * @see    larcore/Geometry/GeometryQueryTracer_service.cc
+ *
+ * Usage:
+ *
+ *     replay_geometry_queries config.fcl trace [threads...]
+ *
+ * The `geo::Geometry` service and the `geo::StandardWireReadout` service are
+ * constructed from the `services.Geometry` and `services.WireReadout`
+ * configurations in `config.fcl` (looked up in `FHICL_FILE_PATH`), which should
+ * be the ones of the job recording the trace. The queries in `trace` are then
+ * replayed once for each of the requested numbers of threads (default: 1 and
+ * the number of hardware threads). With more than one thread, the queries are
+ * split in contiguous blocks, after grouping them by the recording thread.
+ *
+ * The results of the non-hinted queries are summed into a checksum, which
+ * must be the same for all the numbers of threads; the hinted queries depend
+ * on the previous queries of the same thread, and are only timed.
+ *
+ * The channel and wire queries are replayed on the `geo::WireReadout` service;
+ * only the `StandardWireReadout` provider is supported.
+ */
+
+// LArSoft libraries
+#include "larcore/Geometry/Geometry.h"
+#include "larcore/Geometry/GeometryQueryTrace.h"
+#include "larcore/Geometry/StandardWireReadout.h"
+#include "larcoreobj/SimpleTypesAndConstants/RawTypes.h"
+#include "larcoreobj/SimpleTypesAndConstants/geo_types.h"
+
+// framework libraries
+#include "cetlib/filepath_maker.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/ParameterSet.h"
+
+// ROOT libraries
+#include "TGeoMaterial.h"
+#include "TGeoNode.h"
+
+// C/C++ standard libraries
+#include <algorithm> // std::stable_sort(), std::max_element()
+#include <chrono>
+#include <cstdint> // std::uint64_t
+#include <cstdlib> // EXIT_SUCCESS, EXIT_FAILURE
+#include <functional> // std::hash
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+  void printUsage(char const* program)
+  {
+    std::cout << "Usage:  " << program << " config.fcl trace [threads...]"
+              << "\n\nReplays the geometry queries in the trace on the geometry configured"
+              << "\nin `services.Geometry` of config.fcl, with each of the numbers of threads"
+              << "\n(default: 1 and the number of hardware threads)."
+              << "\nThe channel and wire queries are replayed on the `services.WireReadout`"
+              << "\nconfiguration (StandardWireReadout only)." << std::endl;
+  }
+
+  // the arguments of a record are laid out as packed by `geo::QueryProbe`
+  geo::Point_t point(geo::QueryTraceRecord const& record, unsigned int first = 0)
+  {
+    return {record.args[first], record.args[first + 1], record.args[first + 2]};
+  }
+
+  geo::PlaneID planeID(geo::QueryTraceRecord const& record, unsigned int first = 0)
+  {
+    auto const arg = [&record, first](unsigned int i) {
+      return static_cast<unsigned int>(record.args[first + i]);
+    };
+    return {arg(0), arg(1), arg(2)};
+  }
+
+  geo::WireID wireID(geo::QueryTraceRecord const& record)
+  {
+    return {planeID(record), static_cast<geo::WireID::WireID_t>(record.args[3])};
+  }
+
+  raw::ChannelID_t channel(geo::QueryTraceRecord const& record)
+  {
+    return static_cast<raw::ChannelID_t>(record.args[0]);
+  }
+
+  // replays the queries in [begin, end); returns the checksum of their results
+  std::uint64_t replay(geo::Geometry const& geom,
+                       geo::WireReadout const& readout,
+                       geo::QueryTraceRecord const* begin,
+                       geo::QueryTraceRecord const* end)
+  {
+    std::hash<std::string> const hashString;
+    std::hash<double> const hashDouble;
+    std::hash<void const*> const hashPointer;
+    std::uint64_t checksum = 0;
+    for (auto record = begin; record != end; ++record) {
+      switch (record->query) {
+      case geo::GeometryQuery::FindNode:
+        checksum += hashPointer(geom.FindNode(point(*record, 0)));
+        break;
+      case geo::GeometryQuery::VolumeName:
+        checksum += hashString(geom.VolumeName(point(*record, 0)));
+        break;
+      case geo::GeometryQuery::Material:
+        checksum += hashPointer(geom.Material(point(*record, 0)));
+        break;
+      case geo::GeometryQuery::MassBetweenPoints:
+        checksum += hashDouble(geom.MassBetweenPoints(point(*record, 0), point(*record, 3)));
+        break;
+      case geo::GeometryQuery::FindTPCHinted:
+        geom.FindTPCAtPositionHinted(point(*record, 0));
+        break;
+      case geo::GeometryQuery::FindCryostatHinted:
+        geom.PositionToCryostatIDHinted(point(*record, 0));
+        break;
+      case geo::GeometryQuery::FindTPC: {
+        geo::TPCID const tpcID = geom.FindTPCAtPosition(point(*record, 0));
+        checksum += tpcID.isValid ? ((tpcID.Cryostat << 16) | tpcID.TPC) + 1 : 0;
+        break;
+      }
+      case geo::GeometryQuery::FindCryostat: {
+        geo::CryostatID const cryoID = geom.PositionToCryostatID(point(*record, 0));
+        checksum += cryoID.isValid ? cryoID.Cryostat + 1 : 0;
+        break;
+      }
+      case geo::GeometryQuery::ChannelToWire:
+        for (geo::WireID const& wire : readout.ChannelToWire(channel(*record)))
+          checksum += wire.Wire + 1;
+        break;
+      case geo::GeometryQuery::PlaneWireToChannel:
+        checksum += readout.PlaneWireToChannel(wireID(*record));
+        break;
+      case geo::GeometryQuery::NearestWireID:
+        try {
+          checksum += readout.NearestWireID(point(*record), planeID(*record, 3)).Wire + 1;
+        }
+        catch (cet::exception const&) {
+          // the query in the recorded job failed the same way
+        }
+        break;
+      case geo::GeometryQuery::NearestChannel:
+        try {
+          checksum += readout.NearestChannel(point(*record), planeID(*record, 3));
+        }
+        catch (cet::exception const&) {
+        }
+        break;
+      case geo::GeometryQuery::WireCoordinate:
+        checksum += hashDouble(readout.WireCoordinate(point(*record), planeID(*record, 3)));
+        break;
+      case geo::GeometryQuery::NQueries: break;
+      } // switch
+    }
+    return checksum;
+  }
+
+  // replays all `records` with `nThreads` threads; returns the checksum
+  std::uint64_t replay(geo::Geometry const& geom,
+                       geo::WireReadout const& readout,
+                       std::vector<geo::QueryTraceRecord> const& records,
+                       unsigned int nThreads)
+  {
+    std::vector<std::uint64_t> checksums(nThreads, 0);
+    std::vector<std::thread> threads;
+    std::size_t const blockSize = (records.size() + nThreads - 1) / nThreads;
+    for (unsigned int iThread = 0; iThread < nThreads; ++iThread) {
+      std::size_t const first = std::min(records.size(), iThread * blockSize);
+      std::size_t const last = std::min(records.size(), first + blockSize);
+      threads.emplace_back(
+        [&geom, &readout, &records, first, last, &checksum = checksums[iThread]]() {
+          checksum = replay(geom, readout, records.data() + first, records.data() + last);
+        });
+    }
+    for (std::thread& thread : threads)
+      thread.join();
+
+    std::uint64_t checksum = 0;
+    for (std::uint64_t const threadChecksum : checksums)
+      checksum += threadChecksum;
+    return checksum;
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  if ((argc > 1) && ((std::string{argv[1]} == "-h") || (std::string{argv[1]} == "--help"))) {
+    printUsage(argv[0]);
+    return EXIT_SUCCESS;
+  }
+  if (argc < 3) {
+    printUsage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  std::vector<unsigned int> threadCounts;
+  for (int iArg = 3; iArg < argc; ++iArg)
+    threadCounts.push_back(std::max(std::stoi(argv[iArg]), 1));
+  if (threadCounts.empty()) threadCounts = {1U, std::max(std::thread::hardware_concurrency(), 1U)};
+
+  try {
+    cet::filepath_lookup policy{"FHICL_FILE_PATH"};
+    auto const config = fhicl::ParameterSet::make(argv[1], policy);
+    auto geomConfig = config.get<fhicl::ParameterSet>("services.Geometry");
+    geomConfig.put_or_replace(
+      "MaxNavigationThreads",
+      *std::max_element(threadCounts.begin(), threadCounts.end()) + 1U);
+    geo::Geometry const geom{geomConfig};
+    geo::StandardWireReadout const readout{config.get<fhicl::ParameterSet>("services.WireReadout"),
+                                           geom};
+
+    // replay the queries of each recording thread contiguously
+    std::vector<geo::QueryTraceRecord> records = geo::readQueryTrace(argv[2]);
+    std::stable_sort(records.begin(),
+                     records.end(),
+                     [](geo::QueryTraceRecord const& a, geo::QueryTraceRecord const& b) {
+                       return a.thread < b.thread;
+                     });
+    std::cout << "Replaying " << records.size() << " queries from '" << argv[2]
+              << "' on geometry '" << geom.DetectorName() << "'" << std::endl;
+
+    std::uint64_t const reference = replay(geom, readout, records, 1); // also warms up
+    double singleThreadRate = 0.0;
+    for (unsigned int const nThreads : threadCounts) {
+      auto const start = std::chrono::steady_clock::now();
+      std::uint64_t const checksum = replay(geom, readout, records, nThreads);
+      std::chrono::duration<double> const elapsed = std::chrono::steady_clock::now() - start;
+
+      double const rate = records.size() / elapsed.count();
+      if (singleThreadRate == 0.0) singleThreadRate = rate;
+      std::cout << std::setw(3) << nThreads << " threads: " << std::fixed << std::setprecision(0)
+                << rate << " queries/s, speedup " << std::setprecision(2)
+                << (rate / singleThreadRate) << std::endl;
+      if (checksum != reference) {
+        throw cet::exception("replay_geometry_queries")
+          << "Results with " << nThreads << " threads differ from the single-thread ones.\n";
+      }
+    }
+  }
+  catch (cet::exception const& e) {
+    std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}